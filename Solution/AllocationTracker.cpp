@@ -0,0 +1,187 @@
+//***************************************************************************************
+// AllocationTracker.cpp
+//***************************************************************************************
+
+#include "AllocationTracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace AllocationTracker
+{
+	namespace
+	{
+		std::atomic<uint64> gAllocations{ 0 };
+		std::atomic<uint64> gBytes{ 0 };
+
+		// Set while the tracker allocates for its own bookkeeping, so recording a scope
+		// does not show up in the scopes around it.
+		thread_local bool tInTracker = false;
+
+		struct Registry
+		{
+			std::mutex Mutex;
+			std::vector<ScopeStats> Scopes;
+		};
+
+		Registry& GetRegistry()
+		{
+			static Registry registry;
+			return registry;
+		}
+	}
+
+	void CountAllocation(std::size_t size)
+	{
+		if(tInTracker)
+			return;
+		gAllocations.fetch_add(1, std::memory_order_relaxed);
+		gBytes.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	Counts GetTotals()
+	{
+		return { gAllocations.load(std::memory_order_relaxed), gBytes.load(std::memory_order_relaxed) };
+	}
+
+	void Record(const char* name, const Counts& counts)
+	{
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.Mutex);
+		tInTracker = true;
+
+		auto it = std::find_if(registry.Scopes.begin(), registry.Scopes.end(),
+			[name](const ScopeStats& s) { return s.Name == name || std::strcmp(s.Name, name) == 0; });
+		if(it == registry.Scopes.end())
+		{
+			registry.Scopes.emplace_back();
+			it = registry.Scopes.end() - 1;
+			it->Name = name;
+		}
+
+		it->Calls++;
+		it->Total.Allocations += counts.Allocations;
+		it->Total.Bytes += counts.Bytes;
+		it->Max.Allocations = std::max(it->Max.Allocations, counts.Allocations);
+		it->Max.Bytes = std::max(it->Max.Bytes, counts.Bytes);
+		it->Last = counts;
+
+		tInTracker = false;
+	}
+
+	std::vector<ScopeStats> GetScopeStats()
+	{
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.Mutex);
+		return registry.Scopes;
+	}
+
+	void ResetScopeStats()
+	{
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.Mutex);
+		registry.Scopes.clear();
+	}
+
+	bool WriteReport(const char* path)
+	{
+		std::vector<ScopeStats> scopes = GetScopeStats();
+
+		std::FILE* file = std::fopen(path, "w");
+		if(file == nullptr)
+			return false;
+
+		std::fprintf(file, "%-44s %10s %14s %14s %14s %14s\n",
+			"scope", "calls", "allocs/call", "bytes/call", "max allocs", "max bytes");
+		for(const ScopeStats& s : scopes)
+		{
+			double calls = (double)std::max<uint64>(s.Calls, 1);
+			std::fprintf(file, "%-44s %10llu %14.1f %14.1f %14llu %14llu\n", s.Name,
+				(unsigned long long)s.Calls, s.Total.Allocations / calls, s.Total.Bytes / calls,
+				(unsigned long long)s.Max.Allocations, (unsigned long long)s.Max.Bytes);
+		}
+
+		return std::fclose(file) == 0;
+	}
+}
+
+#if ALLOCATION_TRACKING_ENABLED
+
+namespace
+{
+	void* Allocate(std::size_t size)
+	{
+		AllocationTracker::CountAllocation(size);
+		return std::malloc(size == 0 ? 1 : size);
+	}
+
+	void* AllocateAligned(std::size_t size, std::size_t alignment)
+	{
+		AllocationTracker::CountAllocation(size);
+#if defined(_MSC_VER)
+		return _aligned_malloc(size == 0 ? 1 : size, alignment);
+#else
+		void* p = nullptr;
+		return posix_memalign(&p, std::max(alignment, sizeof(void*)), size == 0 ? 1 : size) == 0 ? p : nullptr;
+#endif
+	}
+
+	void FreeAligned(void* p)
+	{
+#if defined(_MSC_VER)
+		_aligned_free(p);
+#else
+		std::free(p);
+#endif
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	if(void* p = Allocate(size))
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	if(void* p = Allocate(size))
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return Allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return Allocate(size); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	if(void* p = AllocateAligned(size, (std::size_t)alignment))
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	if(void* p = AllocateAligned(size, (std::size_t)alignment))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p, std::align_val_t) noexcept { FreeAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { FreeAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { FreeAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { FreeAligned(p); }
+
+#endif
@@ -0,0 +1,102 @@
+//***************************************************************************************
+// AllocationTracker.h
+//
+// Heap allocation counting for test and benchmark builds.  With
+// ALLOCATION_TRACKING_ENABLED=1 the global operator new/delete are replaced by versions
+// that count every allocation and its size, and ALLOCATION_SCOPE("Name") accumulates
+// the allocations made while the enclosing scope runs under that name: per frame,
+// per generated mesh, or any other hot path that should not touch the heap.
+//
+// Counts are process-wide, so a scope also sees the allocations of other threads that
+// run at the same time (the thread pool workers of a frame, for instance).
+//
+// Off by default; ALLOCATION_SCOPE then compiles away and the counters stay at zero.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef ALLOCATION_TRACKING_ENABLED
+#define ALLOCATION_TRACKING_ENABLED 0
+#endif
+
+#include <cstdint>
+#include <vector>
+
+namespace AllocationTracker
+{
+	using uint64 = std::uint64_t;
+
+	const bool Enabled = ALLOCATION_TRACKING_ENABLED != 0;
+
+	struct Counts
+	{
+		uint64 Allocations = 0;
+		uint64 Bytes = 0;
+	};
+
+	struct ScopeStats
+	{
+		const char* Name = nullptr;
+		uint64 Calls = 0;
+		Counts Total;
+		Counts Max;    // Largest single call.
+		Counts Last;
+	};
+
+	///<summary>
+	/// Allocations of every thread since the start of the process.
+	///</summary>
+	Counts GetTotals();
+
+	///<summary>
+	/// Adds one call of the named scope.  name must outlive the tracker; string
+	/// literals are the intended use.
+	///</summary>
+	void Record(const char* name, const Counts& counts);
+
+	///<summary>
+	/// Statistics of every scope recorded so far, in the order they were first seen.
+	///</summary>
+	std::vector<ScopeStats> GetScopeStats();
+
+	///<summary>
+	/// Forgets the recorded scopes, e.g. once loading is done and the steady state begins.
+	///</summary>
+	void ResetScopeStats();
+
+	///<summary>
+	/// Writes a table of the recorded scopes to path.  Returns false if the file
+	/// can't be written.
+	///</summary>
+	bool WriteReport(const char* path);
+
+	// Records the allocations made during the lifetime of the enclosing scope.
+	class Scope
+	{
+	public:
+		explicit Scope(const char* name) : mName(name), mStart(GetTotals()) {}
+		~Scope() { Record(mName, GetCounts()); }
+
+		Scope(const Scope& rhs) = delete;
+		Scope& operator=(const Scope& rhs) = delete;
+
+		Counts GetCounts()const
+		{
+			Counts now = GetTotals();
+			return { now.Allocations - mStart.Allocations, now.Bytes - mStart.Bytes };
+		}
+
+	private:
+		const char* mName;
+		Counts mStart;
+	};
+}
+
+#define ALLOCATION_CONCAT_INNER(a, b) a##b
+#define ALLOCATION_CONCAT(a, b) ALLOCATION_CONCAT_INNER(a, b)
+
+#if ALLOCATION_TRACKING_ENABLED
+#define ALLOCATION_SCOPE(name) AllocationTracker::Scope ALLOCATION_CONCAT(allocationScope, __LINE__)(name)
+#else
+#define ALLOCATION_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,33 @@
+//***************************************************************************************
+// AnimatedTransform.cpp
+//***************************************************************************************
+
+#include "AnimatedTransform.h"
+
+using namespace DirectX;
+
+void PackAnimatedTransforms(const XMFLOAT3* positions, const float* scales,
+	const XMFLOAT4* rotations, std::uint32_t count, AnimatedTransform* dst)
+{
+	for(std::uint32_t i = 0; i < count; ++i)
+	{
+		// Merge the scale into the w lane of the position so both halves of the
+		// struct go out as one aligned 16-byte store each.
+		XMVECTOR position = XMLoadFloat3(&positions[i]);
+		XMVECTOR scale = XMVectorReplicate(scales[i]);
+		XMVECTOR positionScale = XMVectorSelect(position, scale, g_XMSelect0001);
+		XMVECTOR rotation = XMLoadFloat4(&rotations[i]);
+
+		XMStoreFloat4A(reinterpret_cast<XMFLOAT4A*>(&dst[i].Position), positionScale);
+		XMStoreFloat4A(reinterpret_cast<XMFLOAT4A*>(&dst[i].Rotation), rotation);
+	}
+}
+
+XMMATRIX AnimatedTransformToMatrix(const AnimatedTransform& t)
+{
+	XMVECTOR scale = XMVectorReplicate(t.Scale);
+	XMVECTOR rotation = XMLoadFloat4(&t.Rotation);
+	XMVECTOR position = XMLoadFloat3(&t.Position);
+
+	return XMMatrixAffineTransformation(scale, XMVectorZero(), rotation, position);
+}
@@ -0,0 +1,39 @@
+//***************************************************************************************
+// AnimatedTransform.h
+//
+// Compact per-object transform for objects that move every frame.  Instead of a
+// 64-byte world matrix in a 256-byte constant buffer slot, each object uploads a
+// 32-byte position + uniform scale + rotation quaternion into a structured buffer and
+// the vertex shader (VSAnimated in Shaders/VS.hlsl) rebuilds the world matrix.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <DirectXMath.h>
+
+// Matches the AnimatedTransform struct in Shaders/VS.hlsl.  16-byte aligned so that
+// PackAnimatedTransforms can use aligned stores; upload heap allocations and the
+// 32-byte structured buffer stride keep every element there aligned too.
+struct alignas(16) AnimatedTransform
+{
+	DirectX::XMFLOAT3 Position = { 0.0f, 0.0f, 0.0f };
+	float Scale = 1.0f;
+	DirectX::XMFLOAT4 Rotation = { 0.0f, 0.0f, 0.0f, 1.0f };
+};
+
+static_assert(sizeof(AnimatedTransform) == 32, "AnimatedTransform must stay 32 bytes to match the shader.");
+
+///<summary>
+/// Packs count transforms from separate position, scale and rotation arrays into dst.
+/// Every object is written as two aligned 16-byte stores, so dst can point straight at
+/// write-combined upload heap memory; dst must be 16-byte aligned.  Rotations must be unit quaternions.
+///</summary>
+void PackAnimatedTransforms(const DirectX::XMFLOAT3* positions, const float* scales,
+	const DirectX::XMFLOAT4* rotations, std::uint32_t count, AnimatedTransform* dst);
+
+///<summary>
+/// The world matrix the vertex shader reconstructs from t (scale, then rotate, then
+/// translate).  Used on the CPU for picking, culling and validation.
+///</summary>
+DirectX::XMMATRIX AnimatedTransformToMatrix(const AnimatedTransform& t);
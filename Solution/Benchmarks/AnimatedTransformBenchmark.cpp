@@ -0,0 +1,216 @@
+//***************************************************************************************
+// AnimatedTransformBenchmark.cpp
+//
+// Headless comparison of the two ways to upload moving objects: a transposed 64-byte
+// world matrix per object in 256-byte constant buffer slots (ObjectConstants), and
+// the 32-byte AnimatedTransform packed into a structured buffer.  Every object moves
+// every frame.  Reports CPU time and bytes written per frame, and checks both uploads
+// against the quaternion rotation done by hand, the compact one through a CPU copy of
+// the shader's reconstruction; returns non-zero if either is off.
+//
+// Usage: AnimatedTransformBenchmark [objectCount] [frames]
+//***************************************************************************************
+
+#include "../AnimatedTransform.h"
+#include "../FrameConstants.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// Slot size of ObjectConstants in an UploadBuffer constant buffer.
+	const std::size_t kObjectCBByteSize = (sizeof(ObjectConstants) + 255) & ~std::size_t(255);
+
+	// Largest difference allowed between a transformed point and the expected one;
+	// translations go up to 500.
+	const float kMaxMatrixError = 1e-3f;
+
+	struct Scene
+	{
+		std::vector<XMFLOAT3> RestPositions;
+		std::vector<XMFLOAT3> Positions;
+		std::vector<float> Scales;
+		std::vector<XMFLOAT4> Rotations;
+	};
+
+	Scene BuildScene(std::uint32_t objectCount)
+	{
+		std::mt19937 rng(7);
+		std::uniform_real_distribution<float> offset(-500.0f, 500.0f);
+		std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+		Scene scene;
+		scene.RestPositions.resize(objectCount);
+		scene.Positions.resize(objectCount);
+		scene.Scales.resize(objectCount);
+		scene.Rotations.resize(objectCount, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+		for(std::uint32_t i = 0; i < objectCount; ++i)
+		{
+			scene.RestPositions[i] = XMFLOAT3(offset(rng), offset(rng), offset(rng));
+			scene.Scales[i] = scale(rng);
+		}
+		return scene;
+	}
+
+	// Spin and bob, like the diamonds in ShapeComplete, but tumbling about all three axes
+	// so that every term of the quaternion math matters.
+	void Animate(Scene& scene, float t)
+	{
+		std::uint32_t count = (std::uint32_t)scene.Positions.size();
+		for(std::uint32_t i = 0; i < count; ++i)
+		{
+			float phase = 0.001f * i;
+			const XMFLOAT3& rest = scene.RestPositions[i];
+			scene.Positions[i] = XMFLOAT3(rest.x, rest.y + std::sin(2.0f * t + phase), rest.z);
+			XMStoreFloat4(&scene.Rotations[i], XMQuaternionRotationRollPitchYaw(0.5f * t + phase, 1.5f * t + phase, 0.25f * t));
+		}
+	}
+
+	void UploadMatrices(const Scene& scene, std::uint8_t* dst)
+	{
+		std::uint32_t count = (std::uint32_t)scene.Positions.size();
+		for(std::uint32_t i = 0; i < count; ++i)
+		{
+			XMMATRIX world = XMMatrixAffineTransformation(XMVectorReplicate(scene.Scales[i]), XMVectorZero(),
+				XMLoadFloat4(&scene.Rotations[i]), XMLoadFloat3(&scene.Positions[i]));
+
+			ObjectConstants objConstants;
+			XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
+			std::memcpy(dst + i * kObjectCBByteSize, &objConstants, sizeof(objConstants));
+		}
+	}
+
+	void UploadCompact(const Scene& scene, AnimatedTransform* dst)
+	{
+		PackAnimatedTransforms(scene.Positions.data(), scene.Scales.data(), scene.Rotations.data(),
+			(std::uint32_t)scene.Positions.size(), dst);
+	}
+
+	// Object i's rotation applied to p as q p q* (expanded into cross products), then its
+	// scale and translation.
+	XMFLOAT3 RotateScaleTranslate(const Scene& scene, std::uint32_t i, const XMFLOAT3& p)
+	{
+		const XMFLOAT4& q = scene.Rotations[i];
+		float tx = 2.0f * (q.y * p.z - q.z * p.y);
+		float ty = 2.0f * (q.z * p.x - q.x * p.z);
+		float tz = 2.0f * (q.x * p.y - q.y * p.x);
+		float rx = p.x + q.w * tx + (q.y * tz - q.z * ty);
+		float ry = p.y + q.w * ty + (q.z * tx - q.x * tz);
+		float rz = p.z + q.w * tz + (q.x * ty - q.y * tx);
+
+		float s = scene.Scales[i];
+		const XMFLOAT3& t = scene.Positions[i];
+		return XMFLOAT3(rx * s + t.x, ry * s + t.y, rz * s + t.z);
+	}
+
+	// AnimatedWorld in Shaders/VS.hlsl, line for line, on a record read at the HLSL
+	// struct's offsets: Position at 0, Scale at 12, Rotation at 16.
+	XMFLOAT4X4 ShaderAnimatedWorld(const std::uint8_t* record)
+	{
+		float position[3], scale, q[4];
+		std::memcpy(position, record, sizeof(position));
+		std::memcpy(&scale, record + 12, sizeof(scale));
+		std::memcpy(q, record + 16, sizeof(q));
+
+		float q2[3] = { q[0] * 2.0f, q[1] * 2.0f, q[2] * 2.0f };
+		float xx = q[0] * q2[0], yy = q[1] * q2[1], zz = q[2] * q2[2];
+		float xy = q[0] * q2[1], xz = q[0] * q2[2], yz = q[1] * q2[2];
+		float wx = q[3] * q2[0], wy = q[3] * q2[1], wz = q[3] * q2[2];
+
+		return XMFLOAT4X4(
+			(1.0f - (yy + zz)) * scale, (xy + wz) * scale, (xz - wy) * scale, 0.0f,
+			(xy - wz) * scale, (1.0f - (xx + zz)) * scale, (yz + wx) * scale, 0.0f,
+			(xz + wy) * scale, (yz - wx) * scale, (1.0f - (xx + yy)) * scale, 0.0f,
+			position[0], position[1], position[2], 1.0f);
+	}
+
+	// mul(float4(p, 1), m) for a row-vector matrix, or for the transpose of one as the
+	// constant buffer holds it.
+	XMFLOAT3 TransformPoint(const XMFLOAT3& p, const XMFLOAT4X4& m, bool transposed)
+	{
+		float v[4] = { p.x, p.y, p.z, 1.0f };
+		float r[3];
+		for(int c = 0; c < 3; ++c)
+		{
+			r[c] = 0.0f;
+			for(int k = 0; k < 4; ++k)
+				r[c] += v[k] * (transposed ? m.m[c][k] : m.m[k][c]);
+		}
+		return XMFLOAT3(r[0], r[1], r[2]);
+	}
+
+	template<typename Fn>
+	double TimeFrames(Scene& scene, std::uint32_t frames, Fn upload)
+	{
+		double totalMs = 0.0;
+		for(std::uint32_t frame = 0; frame < frames; ++frame)
+		{
+			Animate(scene, 0.016f * frame);
+
+			auto start = std::chrono::high_resolution_clock::now();
+			upload();
+			auto stop = std::chrono::high_resolution_clock::now();
+			totalMs += std::chrono::duration<double, std::milli>(stop - start).count();
+		}
+		return totalMs / frames;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::uint32_t objectCount = argc > 1 ? (std::uint32_t)std::strtoul(argv[1], nullptr, 10) : 100000;
+	std::uint32_t frames = argc > 2 ? (std::uint32_t)std::strtoul(argv[2], nullptr, 10) : 100;
+
+	Scene scene = BuildScene(objectCount);
+
+	// Stand-ins for the mapped upload heaps.
+	std::vector<std::uint8_t> objectCB(objectCount * kObjectCBByteSize);
+	std::vector<AnimatedTransform> animatedBuffer(objectCount);
+
+	double matrixMs = TimeFrames(scene, frames, [&]() { UploadMatrices(scene, objectCB.data()); });
+	double compactMs = TimeFrames(scene, frames, [&]() { UploadCompact(scene, animatedBuffer.data()); });
+
+	// Both uploads must put the object's local points where rotating by the quaternion,
+	// scaling and translating puts them, the uploaded matrix as VS transforms them and the
+	// packed transform as VSAnimated rebuilds its world matrix.
+	const XMFLOAT3 kLocalPoints[] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.3f, -0.7f, 2.0f } };
+	float maxError = 0.0f;
+	for(std::uint32_t i = 0; i < objectCount; ++i)
+	{
+		XMFLOAT4X4 world;
+		std::memcpy(&world, objectCB.data() + i * kObjectCBByteSize, sizeof(world));
+		XMFLOAT4X4 animatedWorld = ShaderAnimatedWorld(reinterpret_cast<const std::uint8_t*>(&animatedBuffer[i]));
+
+		for(const XMFLOAT3& p : kLocalPoints)
+		{
+			XMFLOAT3 expected = RotateScaleTranslate(scene, i, p);
+			XMFLOAT3 fromMatrix = TransformPoint(p, world, true);
+			XMFLOAT3 fromAnimated = TransformPoint(p, animatedWorld, false);
+			maxError = std::max({ maxError,
+				std::fabs(expected.x - fromMatrix.x), std::fabs(expected.y - fromMatrix.y), std::fabs(expected.z - fromMatrix.z),
+				std::fabs(expected.x - fromAnimated.x), std::fabs(expected.y - fromAnimated.y), std::fabs(expected.z - fromAnimated.z) });
+		}
+	}
+
+	double matrixBytes = (double)objectCount * sizeof(ObjectConstants);
+	double matrixSpan = (double)objectCount * kObjectCBByteSize;
+	double compactBytes = (double)objectCount * sizeof(AnimatedTransform);
+
+	std::printf("%u moving objects, %u frames\n", objectCount, frames);
+	std::printf("%-22s %8.3f ms/frame %10.2f MB written/frame %10.2f MB buffer\n", "world matrix CB",
+		matrixMs, matrixBytes / (1024.0 * 1024.0), matrixSpan / (1024.0 * 1024.0));
+	std::printf("%-22s %8.3f ms/frame %10.2f MB written/frame %10.2f MB buffer\n", "animated transform",
+		compactMs, compactBytes / (1024.0 * 1024.0), compactBytes / (1024.0 * 1024.0));
+	bool ok = maxError <= kMaxMatrixError;
+	std::printf("max position difference %g: %s\n", maxError, ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
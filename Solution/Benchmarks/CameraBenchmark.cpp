@@ -0,0 +1,172 @@
+//***************************************************************************************
+// CameraBenchmark.cpp
+//
+// Accuracy and timing checks for OrbitCamera.  The closed-form view, inverse view,
+// inverse projection and inverse view-projection are compared against
+// XMMatrixLookAtLH/XMMatrixInverse over many random cameras, and the frustum planes
+// are checked against points unprojected from clip space.  Timing compares the old
+// UpdateCamera + UpdateMainPassCB matrix work with OrbitCamera::Update for a moving
+// and for a still camera.  Returns non-zero if any error exceeds its tolerance.
+//
+// Usage: CameraBenchmark [cameraCount] [iterations]
+//***************************************************************************************
+
+#include "../OrbitCamera.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	// Largest difference relative to the largest entry of the reference matrix, so
+	// translation terms of a far-away camera don't dominate the rotation terms.
+	float MaxRelativeError(const XMFLOAT4X4& actual, FXMMATRIX expectedM)
+	{
+		XMFLOAT4X4 expected;
+		XMStoreFloat4x4(&expected, expectedM);
+
+		float scale = 1.0f;
+		for(int r = 0; r < 4; ++r)
+			for(int c = 0; c < 4; ++c)
+				scale = std::max(scale, std::fabs(expected.m[r][c]));
+
+		float maxError = 0.0f;
+		for(int r = 0; r < 4; ++r)
+			for(int c = 0; c < 4; ++c)
+				maxError = std::max(maxError, std::fabs(actual.m[r][c] - expected.m[r][c]) / scale);
+		return maxError;
+	}
+
+	struct Errors
+	{
+		float View = 0.0f;
+		float InvView = 0.0f;
+		float InvProj = 0.0f;
+		float InvViewProj = 0.0f;
+		float Frustum = 0.0f;
+	};
+
+	Errors CheckAccuracy(std::uint32_t cameraCount)
+	{
+		std::mt19937 rng(3);
+		std::uniform_real_distribution<float> theta(0.0f, XM_2PI);
+		std::uniform_real_distribution<float> phi(0.1f, XM_PI - 0.1f);
+		std::uniform_real_distribution<float> radius(5.0f, 150.0f);
+		std::uniform_real_distribution<float> fov(0.2f * XM_PI, 0.45f * XM_PI);
+		std::uniform_real_distribution<float> aspect(0.5f, 2.5f);
+		std::uniform_real_distribution<float> target(-50.0f, 50.0f);
+		std::uniform_real_distribution<float> ndc(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> depth(0.0f, 1.0f);
+
+		Errors errors;
+		OrbitCamera camera;
+		for(std::uint32_t i = 0; i < cameraCount; ++i)
+		{
+			XMFLOAT3 t(target(rng), target(rng), target(rng));
+			camera.SetTarget(t);
+			camera.SetOrbit(theta(rng), phi(rng), radius(rng));
+			camera.SetLens(fov(rng), aspect(rng), 1.0f, 1000.0f);
+			camera.Update();
+
+			XMVECTOR pos = XMLoadFloat3(&camera.GetPosition());
+			XMMATRIX view = XMMatrixLookAtLH(XMVectorSetW(pos, 1.0f), XMLoadFloat3(&t), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+			XMMATRIX proj = XMLoadFloat4x4(&camera.GetProj());
+			XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+
+			errors.View = std::max(errors.View, MaxRelativeError(camera.GetView(), view));
+			errors.InvView = std::max(errors.InvView, MaxRelativeError(camera.GetInvView(), XMMatrixInverse(nullptr, view)));
+			errors.InvProj = std::max(errors.InvProj, MaxRelativeError(camera.GetInvProj(), XMMatrixInverse(nullptr, proj)));
+			errors.InvViewProj = std::max(errors.InvViewProj, MaxRelativeError(camera.GetInvViewProj(), XMMatrixInverse(nullptr, viewProj)));
+
+			// A point unprojected from inside the clip volume must be on the inside of
+			// every plane, up to a tolerance scaled by the distance from the eye.
+			XMMATRIX invViewProj = XMLoadFloat4x4(&camera.GetInvViewProj());
+			for(int s = 0; s < 16; ++s)
+			{
+				XMVECTOR p = XMVector3TransformCoord(XMVectorSet(ndc(rng), ndc(rng), depth(rng), 1.0f), invViewProj);
+				float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(p, pos)));
+				for(int k = 0; k < OrbitCamera::PlaneCount; ++k)
+				{
+					float side = XMVectorGetX(XMPlaneDotCoord(XMLoadFloat4(&camera.GetFrustumPlanes()[k]), p));
+					errors.Frustum = std::max(errors.Frustum, -side / std::max(1.0f, distance));
+				}
+			}
+		}
+		return errors;
+	}
+
+	template<typename Fn>
+	double TimeNs(std::uint32_t iterations, Fn fn)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		for(std::uint32_t i = 0; i < iterations; ++i)
+			fn(i);
+		auto stop = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+	}
+
+	// Keeps the optimizer from discarding the timed work.
+	volatile float gSink = 0.0f;
+}
+
+int main(int argc, char* argv[])
+{
+	std::uint32_t cameraCount = argc > 1 ? (std::uint32_t)std::strtoul(argv[1], nullptr, 10) : 100000;
+	std::uint32_t iterations = argc > 2 ? (std::uint32_t)std::strtoul(argv[2], nullptr, 10) : 1000000;
+
+	Errors errors = CheckAccuracy(cameraCount);
+
+	std::printf("accuracy over %u random cameras (max error relative to the largest entry)\n", cameraCount);
+	std::printf("  view           %g\n", errors.View);
+	std::printf("  inverse view   %g\n", errors.InvView);
+	std::printf("  inverse proj   %g\n", errors.InvProj);
+	std::printf("  inverse vp     %g\n", errors.InvViewProj);
+	std::printf("  frustum planes %g\n", errors.Frustum);
+
+	// What UpdateCamera + UpdateMainPassCB did every frame before.
+	XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f * XM_PI, 1.6f, 1.0f, 1000.0f);
+	double generalNs = TimeNs(iterations, [&](std::uint32_t i)
+	{
+		float theta = 0.001f * i;
+		XMVECTOR pos = XMVectorSet(15.0f * std::sin(0.6f) * std::cos(theta), 15.0f * std::cos(0.6f), 15.0f * std::sin(0.6f) * std::sin(theta), 1.0f);
+		XMMATRIX view = XMMatrixLookAtLH(pos, XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+		XMMATRIX invView = XMMatrixInverse(nullptr, view);
+		XMMATRIX invProj = XMMatrixInverse(nullptr, proj);
+		XMMATRIX invViewProj = XMMatrixInverse(nullptr, viewProj);
+		gSink = gSink + XMVectorGetX(invView.r[3]) + XMVectorGetX(invProj.r[0]) + XMVectorGetX(invViewProj.r[3]);
+	});
+
+	OrbitCamera camera;
+	camera.SetLens(0.25f * XM_PI, 1.6f, 1.0f, 1000.0f);
+	double movingNs = TimeNs(iterations, [&](std::uint32_t i)
+	{
+		camera.SetOrbit(0.001f * i, 0.6f, 15.0f);
+		camera.Update();
+		gSink = gSink + camera.GetInvViewProj()._41;
+	});
+
+	double stillNs = TimeNs(iterations, [&](std::uint32_t)
+	{
+		camera.SetOrbit(1.0f, 0.6f, 15.0f);
+		camera.Update();
+		gSink = gSink + camera.GetInvViewProj()._41;
+	});
+
+	std::printf("timing per frame over %u iterations\n", iterations);
+	std::printf("  look-at + general inverses       %8.1f ns\n", generalNs);
+	std::printf("  OrbitCamera, moving (+ frustum)  %8.1f ns\n", movingNs);
+	std::printf("  OrbitCamera, still               %8.1f ns\n", stillNs);
+
+	bool ok = errors.View < 1e-5f && errors.InvView < 1e-5f && errors.InvProj < 1e-5f &&
+		errors.InvViewProj < 1e-4f && errors.Frustum < 1e-4f;
+	std::printf("%s\n", ok ? "PASS" : "FAIL");
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,303 @@
+//***************************************************************************************
+// FrameLoopBenchmark.cpp
+//
+// Headless version of the ShapeComplete per-frame CPU work: orbit the cameras, move a
+// few nodes, propagate the scene graph, write the changed object constants into the
+// current frame resource, write the pass constants, pack the animated transforms and
+// cull every pass.  The upload buffers are plain memory with the same 256-byte
+// constant buffer slots, so only the CPU side is measured.
+//
+// Arguments: tower count (two render items each, plus a diamond on every eighth tower)
+// and pass count.
+//***************************************************************************************
+
+#include "../AllocationTracker.h"
+#include "../AnimatedTransform.h"
+#include "../FrameConstants.h"
+#include "../OrbitCamera.h"
+#include "../SceneGraph.h"
+#include "../ThreadPool.h"
+#include "../ViewCuller.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	const int kNumFrameResources = 3;
+	const std::uint32_t kMaxPasses = 4;
+
+	std::size_t ConstantBufferByteSize(std::size_t size)
+	{
+		return (size + 255) & ~std::size_t(255);
+	}
+
+	struct RenderItem
+	{
+		SceneGraph::NodeHandle Node = SceneGraph::InvalidNode;
+		XMFLOAT4X4 World = IdentityFloat4x4();
+		int NumFramesDirty = kNumFrameResources;
+		std::uint32_t ObjCBIndex = 0;
+		int AnimatedIndex = -1;
+		XMFLOAT4 LocalSphere = { 0.0f, 0.0f, 0.0f, 1.0f };
+	};
+
+	struct FrameResource
+	{
+		std::vector<std::uint8_t> ObjectCB;
+		std::vector<std::uint8_t> PassCB;
+		std::vector<AnimatedTransform> AnimatedTransforms;
+	};
+
+	struct Pass
+	{
+		OrbitCamera Camera;
+		PassConstants Constants;
+		std::uint32_t ConstantsVersion = 0;
+		std::uint32_t CullView = 0;
+	};
+
+	class Scene
+	{
+	public:
+		Scene(std::uint32_t towerCount, std::uint32_t passCount)
+			: mPassCount(passCount)
+		{
+			// Towers on a square grid: a base node with a column and a sphere above it.
+			// Every eighth tower also carries a spinning diamond.
+			std::uint32_t side = (std::uint32_t)std::ceil(std::sqrt((double)towerCount));
+			for(std::uint32_t i = 0; i < towerCount; ++i)
+			{
+				float x = 10.0f * (i % side) - 5.0f * side;
+				float z = 10.0f * (i / side) - 5.0f * side;
+				auto base = mGraph.CreateNode(SceneGraph::InvalidNode, XMMatrixTranslation(x, 0.0f, z));
+				mTowers.push_back(base);
+
+				AddItem(mGraph.CreateNode(base, XMMatrixTranslation(0.0f, 1.5f, 0.0f)), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.6f));
+				AddItem(mGraph.CreateNode(base, XMMatrixTranslation(0.0f, 3.5f, 0.0f)), XMFLOAT4(0.0f, 0.0f, 0.0f, 0.5f));
+
+				if(i % 8 == 0)
+				{
+					auto node = mGraph.CreateNode(base, XMMatrixTranslation(0.0f, 5.0f, 0.0f));
+					AddItem(node, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f)).AnimatedIndex = (int)mAnimated.size();
+					mAnimated.push_back((std::uint32_t)mItems.size() - 1);
+				}
+			}
+
+			mAnimatedPositions.resize(mAnimated.size());
+			mAnimatedScales.assign(mAnimated.size(), 1.0f);
+			mAnimatedRotations.resize(mAnimated.size());
+			mObjectBounds.resize(mItems.size());
+
+			for(auto& frame : mFrames)
+			{
+				frame.ObjectCB.resize(mItems.size() * ConstantBufferByteSize(sizeof(ObjectConstants)));
+				frame.PassCB.resize(kMaxPasses * ConstantBufferByteSize(sizeof(PassConstants)));
+				frame.AnimatedTransforms.resize(mAnimated.size());
+			}
+
+			float radius = 0.75f * side * 10.0f;
+			for(std::uint32_t i = 0; i < mPassCount; ++i)
+				mPasses[i].Camera.SetLens(0.25f * XM_PI, 1.0f / mPassCount, 1.0f, 4.0f * radius);
+			mRadius = radius;
+		}
+
+		void Frame(ThreadPool& pool)
+		{
+			++mFrame;
+			float t = mFrame / 60.0f;
+
+			// The main camera orbits; the others look down from above and turn with it.
+			for(std::uint32_t i = 0; i < mPassCount; ++i)
+			{
+				if(i == 0)
+					mPasses[i].Camera.SetOrbit(0.2f * t, 0.3f * XM_PI, mRadius);
+				else
+					mPasses[i].Camera.SetOrbit(0.2f * t + i, 0.1f, 1.5f * mRadius);
+				mPasses[i].Camera.Update();
+			}
+
+			// About one tower in a hundred is moved every frame.
+			for(std::size_t i = mFrame % 100; i < mTowers.size(); i += 100)
+			{
+				XMMATRIX local = XMLoadFloat4x4(&mGraph.GetLocal(mTowers[i]));
+				mGraph.SetLocal(mTowers[i], XMMatrixRotationY(0.01f) * local);
+			}
+
+			mGraph.Update(&pool);
+
+			mCurrFrame = (mCurrFrame + 1) % kNumFrameResources;
+			UpdateObjectCBs();
+			UpdatePassCBs(t);
+			UpdateAnimatedTransforms(t);
+
+			mCuller.ClearViews();
+			for(std::uint32_t i = 0; i < mPassCount; ++i)
+				mPasses[i].CullView = mCuller.AddView(mPasses[i].Camera.GetFrustumPlanes());
+			mCuller.Cull(mObjectBounds.data(), (std::uint32_t)mObjectBounds.size(), &pool);
+		}
+
+		std::size_t GetItemCount()const { return mItems.size(); }
+
+		std::size_t GetVisibleCount()const
+		{
+			std::size_t visible = 0;
+			for(std::uint32_t i = 0; i < mPassCount; ++i)
+				visible += mCuller.GetVisible(mPasses[i].CullView).size();
+			return visible;
+		}
+
+	private:
+		RenderItem& AddItem(SceneGraph::NodeHandle node, const XMFLOAT4& localSphere)
+		{
+			RenderItem item;
+			item.Node = node;
+			item.ObjCBIndex = (std::uint32_t)mItems.size();
+			item.LocalSphere = localSphere;
+			mItems.push_back(item);
+			return mItems.back();
+		}
+
+		void UpdateObjectCBs()
+		{
+			std::uint8_t* objectCB = mFrames[mCurrFrame].ObjectCB.data();
+			std::size_t stride = ConstantBufferByteSize(sizeof(ObjectConstants));
+			for(auto& e : mItems)
+			{
+				if(mGraph.WorldChanged(e.Node))
+				{
+					e.World = mGraph.GetWorld(e.Node);
+					e.NumFramesDirty = kNumFrameResources;
+					mObjectBounds[e.ObjCBIndex] = TransformBoundingSphere(e.LocalSphere, XMLoadFloat4x4(&e.World));
+				}
+
+				if(e.NumFramesDirty > 0)
+				{
+					ObjectConstants objConstants;
+					XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(XMLoadFloat4x4(&e.World)));
+					std::memcpy(objectCB + e.ObjCBIndex * stride, &objConstants, sizeof(objConstants));
+					e.NumFramesDirty--;
+				}
+			}
+		}
+
+		void UpdatePassCBs(float t)
+		{
+			std::uint8_t* passCB = mFrames[mCurrFrame].PassCB.data();
+			std::size_t stride = ConstantBufferByteSize(sizeof(PassConstants));
+			for(std::uint32_t i = 0; i < mPassCount; ++i)
+			{
+				Pass& pass = mPasses[i];
+				const OrbitCamera& camera = pass.Camera;
+				PassConstants& constants = pass.Constants;
+				if(pass.ConstantsVersion != camera.GetVersion())
+				{
+					XMStoreFloat4x4(&constants.View, XMMatrixTranspose(XMLoadFloat4x4(&camera.GetView())));
+					XMStoreFloat4x4(&constants.InvView, XMMatrixTranspose(XMLoadFloat4x4(&camera.GetInvView())));
+					XMStoreFloat4x4(&constants.Proj, XMMatrixTranspose(XMLoadFloat4x4(&camera.GetProj())));
+					XMStoreFloat4x4(&constants.InvProj, XMMatrixTranspose(XMLoadFloat4x4(&camera.GetInvProj())));
+					XMStoreFloat4x4(&constants.ViewProj, XMMatrixTranspose(XMLoadFloat4x4(&camera.GetViewProj())));
+					XMStoreFloat4x4(&constants.InvViewProj, XMMatrixTranspose(XMLoadFloat4x4(&camera.GetInvViewProj())));
+					constants.EyePosW = camera.GetPosition();
+					constants.NearZ = camera.GetNearZ();
+					constants.FarZ = camera.GetFarZ();
+					pass.ConstantsVersion = camera.GetVersion();
+				}
+				constants.TotalTime = t;
+				constants.DeltaTime = 1.0f / 60.0f;
+				std::memcpy(passCB + i * stride, &constants, sizeof(constants));
+			}
+		}
+
+		void UpdateAnimatedTransforms(float t)
+		{
+			for(std::uint32_t item : mAnimated)
+			{
+				const RenderItem& e = mItems[item];
+				std::uint32_t i = (std::uint32_t)e.AnimatedIndex;
+				const XMFLOAT4X4& rest = mGraph.GetWorld(e.Node);
+				float phase = 1.5f * i;
+
+				mAnimatedPositions[i] = XMFLOAT3(rest._41, rest._42 + 1.5f * std::sin(2.0f * t + phase), rest._43);
+				XMStoreFloat4(&mAnimatedRotations[i], XMQuaternionRotationRollPitchYaw(0.0f, 1.5f * t + phase, 0.0f));
+			}
+
+			PackAnimatedTransforms(mAnimatedPositions.data(), mAnimatedScales.data(), mAnimatedRotations.data(),
+				(std::uint32_t)mAnimated.size(), mFrames[mCurrFrame].AnimatedTransforms.data());
+
+			for(std::uint32_t item : mAnimated)
+			{
+				const RenderItem& e = mItems[item];
+				std::uint32_t i = (std::uint32_t)e.AnimatedIndex;
+				XMMATRIX world = XMMatrixAffineTransformation(XMVectorReplicate(mAnimatedScales[i]), XMVectorZero(),
+					XMLoadFloat4(&mAnimatedRotations[i]), XMLoadFloat3(&mAnimatedPositions[i]));
+				mObjectBounds[e.ObjCBIndex] = TransformBoundingSphere(e.LocalSphere, world);
+			}
+		}
+
+	private:
+		SceneGraph mGraph;
+		ViewCuller mCuller;
+		std::vector<SceneGraph::NodeHandle> mTowers;
+		std::vector<RenderItem> mItems;
+		std::vector<std::uint32_t> mAnimated;
+		std::vector<XMFLOAT3> mAnimatedPositions;
+		std::vector<float> mAnimatedScales;
+		std::vector<XMFLOAT4> mAnimatedRotations;
+		std::vector<XMFLOAT4> mObjectBounds;
+
+		FrameResource mFrames[kNumFrameResources];
+		Pass mPasses[kMaxPasses];
+		std::uint32_t mPassCount = 1;
+		float mRadius = 1.0f;
+		std::uint32_t mFrame = 0;
+		int mCurrFrame = 0;
+	};
+
+	ThreadPool& GetPool()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	void BM_FrameLoop(benchmark::State& state)
+	{
+		Scene scene((std::uint32_t)state.range(0), (std::uint32_t)state.range(1));
+		ThreadPool& pool = GetPool();
+
+		// Settle the frame resource ring so every frame does steady-state work.
+		for(int i = 0; i < kNumFrameResources + 1; ++i)
+			scene.Frame(pool);
+
+		AllocationTracker::Counts before = AllocationTracker::GetTotals();
+		for(auto _ : state)
+		{
+			scene.Frame(pool);
+			benchmark::ClobberMemory();
+		}
+		AllocationTracker::Counts after = AllocationTracker::GetTotals();
+
+		state.counters["render_items"] = (double)scene.GetItemCount();
+		state.counters["visible"] = (double)scene.GetVisibleCount();
+		state.counters["frames/s"] = benchmark::Counter((double)state.iterations(), benchmark::Counter::kIsRate);
+
+		// Steady-state frames should not touch the heap (SOLUTION_TRACK_ALLOCATIONS=ON).
+		if(AllocationTracker::Enabled)
+		{
+			state.counters["allocations/frame"] = (double)(after.Allocations - before.Allocations) / state.iterations();
+			state.counters["bytes/frame"] = (double)(after.Bytes - before.Bytes) / state.iterations();
+		}
+	}
+}
+
+// Ten towers is about the size of the ShapeComplete scene; the larger scenes show how
+// the loop scales.
+BENCHMARK(BM_FrameLoop)->ArgsProduct({ { 10, 1000, 20000 }, { 1, 2 } })->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,212 @@
+//***************************************************************************************
+// GeometryGeneratorBenchmark.cpp
+//
+// Google Benchmark suite for the GeometryGenerator builders across tessellation sweeps.
+// Every benchmark reports vertices/s and the heap bytes and allocations of one call.
+// The geodesic sphere runs at the geosphere's triangle counts and beyond them
+// (Tests/GeometryGeneratorTest.cpp checks that it is closed).
+// The ShapeScene pair builds the ShapeComplete vertex/index buffers both ways: MeshData
+// plus a copy into the app's Vertex, and ShapeWriter straight into it.
+//
+// For regression tracking, write machine-readable results with
+//   GeometryGeneratorBenchmark --benchmark_out=geometry.json --benchmark_out_format=json
+//***************************************************************************************
+
+#include "../AllocationTracker.h"
+#include "../FrameConstants.h"
+#include "../GeometryGenerator.h"
+#include "../ShapeWriter.h"
+#include "../ThreadPool.h"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+	using MeshData = GeometryGenerator::MeshData;
+
+	// Runs build once per iteration and fills in the throughput and allocation counters.
+	template<typename Build>
+	void RunBuilder(benchmark::State& state, Build build)
+	{
+		GeometryGenerator geoGen;
+
+		std::size_t vertexCount = 0;
+		std::size_t indexCount = 0;
+		std::size_t bytes = 0;
+		std::size_t allocations = 0;
+		for(auto _ : state)
+		{
+			AllocationTracker::Counts before = AllocationTracker::GetTotals();
+
+			MeshData mesh = build(geoGen);
+
+			AllocationTracker::Counts after = AllocationTracker::GetTotals();
+			bytes = (std::size_t)(after.Bytes - before.Bytes);
+			allocations = (std::size_t)(after.Allocations - before.Allocations);
+			vertexCount = mesh.Vertices.size();
+			indexCount = mesh.Indices32.size();
+			benchmark::DoNotOptimize(mesh.Vertices.data());
+			benchmark::ClobberMemory();
+		}
+
+		state.counters["vertices"] = (double)vertexCount;
+		state.counters["indices"] = (double)indexCount;
+		state.counters["vertices/s"] = benchmark::Counter((double)vertexCount * state.iterations(), benchmark::Counter::kIsRate);
+		state.counters["bytes_allocated"] = (double)bytes;
+		state.counters["allocations"] = (double)allocations;
+	}
+
+	GeometryGenerator::uint32 Arg(const benchmark::State& state, int i)
+	{
+		return (GeometryGenerator::uint32)state.range(i);
+	}
+
+	void BM_CreateBox(benchmark::State& state)
+	{
+		RunBuilder(state, [&](GeometryGenerator& g) { return g.CreateBox(1.0f, 1.0f, 1.0f, Arg(state, 0)); });
+	}
+
+	void BM_CreateSphere(benchmark::State& state)
+	{
+		RunBuilder(state, [&](GeometryGenerator& g) { return g.CreateSphere(0.5f, Arg(state, 0), Arg(state, 0)); });
+	}
+
+	void BM_CreateGeosphere(benchmark::State& state)
+	{
+		RunBuilder(state, [&](GeometryGenerator& g) { return g.CreateGeosphere(0.5f, Arg(state, 0)); });
+	}
+
+	// Frequency 2^n has the triangle count of BM_CreateGeosphere/n; the pool uses one
+	// worker per hardware thread.
+	void BM_CreateGeodesicSphere(benchmark::State& state)
+	{
+		static ThreadPool pool;
+
+		RunBuilder(state, [&](GeometryGenerator& g) { return g.CreateGeodesicSphere(0.5f, Arg(state, 0), pool); });
+	}
+
+	void BM_CreateCylinder(benchmark::State& state)
+	{
+		RunBuilder(state, [&](GeometryGenerator& g) { return g.CreateCylinder(0.5f, 0.3f, 3.0f, Arg(state, 0), Arg(state, 0)); });
+	}
+
+	void BM_CreateGrid(benchmark::State& state)
+	{
+		RunBuilder(state, [&](GeometryGenerator& g) { return g.CreateGrid(100.0f, 100.0f, Arg(state, 0), Arg(state, 0)); });
+	}
+
+	void BM_CreateCone(benchmark::State& state)
+	{
+		RunBuilder(state, [&](GeometryGenerator& g) { return g.CreateCone(0.5f, 0.5f, 0.5f, 1.0f, Arg(state, 0), Arg(state, 0)); });
+	}
+
+	void BM_CreateWedge(benchmark::State& state)
+	{
+		RunBuilder(state, [&](GeometryGenerator& g) { return g.CreateWedge(2.0f, 2.0f, 2.0f, Arg(state, 0)); });
+	}
+
+	void BM_CreatePyramid(benchmark::State& state)
+	{
+		RunBuilder(state, [&](GeometryGenerator& g) { return g.CreatePyramid(2.0f, 2.0f, 2.0f, Arg(state, 0)); });
+	}
+
+	void BM_CreateDiamond(benchmark::State& state)
+	{
+		RunBuilder(state, [&](GeometryGenerator& g) { return g.CreateDiamond(2.0f, 2.0f, 2.0f, Arg(state, 0)); });
+	}
+
+	void BM_CreateTriPrism(benchmark::State& state)
+	{
+		RunBuilder(state, [&](GeometryGenerator& g) { return g.CreateTriPrism(2.0f, 2.0f, 2.0f, Arg(state, 0)); });
+	}
+
+	// The ShapeComplete shapes, scaled by a tessellation factor so the sweep covers
+	// more than the app's one small scene.
+	void BM_ShapeSceneTwoPass(benchmark::State& state)
+	{
+		GeometryGenerator geoGen;
+		GeometryGenerator::uint32 f = Arg(state, 0);
+
+		std::vector<Vertex> vertices;
+		std::vector<std::uint16_t> indices;
+		for(auto _ : state)
+		{
+			MeshData meshes[] =
+			{
+				geoGen.CreateBox(1.0f, 1.0f, 1.0f, 0),
+				geoGen.CreateGrid(75.0f, 75.0f, 60 * f, 20 * f),
+				geoGen.CreateSphere(0.5f, 20 * f, 20 * f),
+				geoGen.CreateCylinder(0.5f, 0.4f, 3.0f, 20 * f, 20 * f),
+				geoGen.CreateCone(0.5f, 0.5f, 0.5f, 1.0f, 10 * f, 10 * f),
+				geoGen.CreateWedge(2.0f, 2.0f, 2.0f, 4),
+				geoGen.CreatePyramid(2.0f, 2.0f, 2.0f, 4),
+				geoGen.CreateDiamond(2.0f, 2.0f, 2.0f, 4),
+				geoGen.CreateTriPrism(2.0f, 2.0f, 2.0f, 4),
+			};
+
+			vertices.clear();
+			indices.clear();
+			for(MeshData& mesh : meshes)
+			{
+				for(const GeometryGenerator::Vertex& v : mesh.Vertices)
+					vertices.push_back({ v.Position, DirectX::XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f) });
+				indices.insert(indices.end(), mesh.GetIndices16().begin(), mesh.GetIndices16().end());
+			}
+			benchmark::DoNotOptimize(vertices.data());
+			benchmark::DoNotOptimize(indices.data());
+			benchmark::ClobberMemory();
+		}
+		state.counters["vertices"] = (double)vertices.size();
+		state.counters["vertices/s"] = benchmark::Counter((double)vertices.size() * state.iterations(), benchmark::Counter::kIsRate);
+	}
+
+	void BM_ShapeSceneWriter(benchmark::State& state)
+	{
+		using namespace ShapeWriter;
+		GeometryGenerator::uint32 f = Arg(state, 0);
+		PositionColorWriter<Vertex> writer{ DirectX::XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f) };
+
+		std::vector<Vertex> vertices;
+		std::vector<std::uint16_t> indices;
+		for(auto _ : state)
+		{
+			vertices.clear();
+			indices.clear();
+			AppendBox(vertices, indices, writer, 1.0f, 1.0f, 1.0f, 0);
+			AppendGrid(vertices, indices, writer, 75.0f, 75.0f, 60 * f, 20 * f);
+			AppendSphere(vertices, indices, writer, 0.5f, 20 * f, 20 * f);
+			AppendCylinder(vertices, indices, writer, 0.5f, 0.4f, 3.0f, 20 * f, 20 * f);
+			AppendCone(vertices, indices, writer, 0.5f, 0.5f, 0.5f, 1.0f, 10 * f, 10 * f);
+			AppendWedge(vertices, indices, writer, 2.0f, 2.0f, 2.0f, 4);
+			AppendPyramid(vertices, indices, writer, 2.0f, 2.0f, 2.0f, 4);
+			AppendDiamond(vertices, indices, writer, 2.0f, 2.0f, 2.0f, 4);
+			AppendTriPrism(vertices, indices, writer, 2.0f, 2.0f, 2.0f, 4);
+			benchmark::DoNotOptimize(vertices.data());
+			benchmark::DoNotOptimize(indices.data());
+			benchmark::ClobberMemory();
+		}
+		state.counters["vertices"] = (double)vertices.size();
+		state.counters["vertices/s"] = benchmark::Counter((double)vertices.size() * state.iterations(), benchmark::Counter::kIsRate);
+	}
+}
+
+// Subdivided builders: every level the generator supports (it clamps at 6).
+BENCHMARK(BM_CreateBox)->DenseRange(0, 6);
+BENCHMARK(BM_CreateGeosphere)->DenseRange(0, 6);
+BENCHMARK(BM_CreateGeodesicSphere)->RangeMultiplier(2)->Range(1, 64)->Arg(100)->Arg(300);
+BENCHMARK(BM_CreateWedge)->DenseRange(0, 6);
+BENCHMARK(BM_CreatePyramid)->DenseRange(0, 6);
+BENCHMARK(BM_CreateDiamond)->DenseRange(0, 6);
+BENCHMARK(BM_CreateTriPrism)->DenseRange(0, 6);
+
+// Sliced builders: slices = stacks (rows = columns for the grid), doubling each step.
+BENCHMARK(BM_CreateSphere)->RangeMultiplier(2)->Range(8, 512);
+BENCHMARK(BM_CreateCylinder)->RangeMultiplier(2)->Range(8, 512);
+BENCHMARK(BM_CreateCone)->RangeMultiplier(2)->Range(8, 512);
+BENCHMARK(BM_CreateGrid)->RangeMultiplier(2)->Range(8, 1024);
+
+// The ShapeComplete scene at 1x (the app), 2x and 4x tessellation.
+BENCHMARK(BM_ShapeSceneTwoPass)->Arg(1)->Arg(2)->Arg(4);
+BENCHMARK(BM_ShapeSceneWriter)->Arg(1)->Arg(2)->Arg(4);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,201 @@
+//***************************************************************************************
+// GeometryStreamingBenchmark.cpp
+//
+// Startup of a ShapeComplete-like scene against a headless backend: plain memory for
+// the default heap buffers and a SimulatedCopyQueue with a fixed bandwidth and latency
+// for the copy engine.  Two ways:
+//
+//   Blocking   What Initialize used to do: generate every shape on the main thread,
+//              upload it and wait for the copies before the first frame.
+//   Streaming  GeometryStreamer: the shapes are generated on the pool and uploaded as
+//              they finish while frames keep going, one Pump per frame.
+//
+// Frames are simulated by sleeping out a fixed frame period.  The benchmark time is
+// time-to-full-scene; the counters add time-to-first-frame and the time until the
+// first mesh is drawable, in milliseconds.
+//
+// Arguments: tessellation factor of the sliced shapes, and worker threads for the
+// streaming runs.
+//***************************************************************************************
+
+#include "../FrameConstants.h"
+#include "../GeometryStreamer.h"
+#include "../ScenePacker.h"
+#include "../SimulatedCopyQueue.h"
+#include "../StagingUploader.h"
+#include "../ThreadPool.h"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using ColorWriter = ShapeWriter::PositionColorWriter<Vertex>;
+	using Packer = ScenePacker<ColorWriter, std::uint16_t>;
+	using Clock = std::chrono::steady_clock;
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	const uint64 kStagingBytes = 4 * 1024 * 1024;
+	const uint64 kUploadBytesPerFrame = 1024 * 1024;
+	const double kCopyBytesPerSecond = 4.0e9;
+	const double kCopyLatencySeconds = 100.0e-6;
+	const std::chrono::microseconds kFramePeriod(4000);
+
+	// The ShapeComplete shapes, four times over, with the sliced ones tessellated f
+	// times finer.
+	void AddScene(Packer& packer, uint32 f)
+	{
+		ColorWriter writer{ DirectX::XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f) };
+
+		for(uint32 copy = 0; copy < 4; ++copy)
+		{
+			packer.AddBox(writer, 1.0f, 1.0f, 1.0f, 0);
+			packer.AddGrid(writer, 75.0f, 75.0f, 60 * f, 20 * f);
+			packer.AddSphere(writer, 0.5f, 20 * f, 20 * f);
+			packer.AddCylinder(writer, 0.5f, 0.4f, 3.0f, 20 * f, 20 * f);
+			packer.AddCone(writer, 0.5f, 0.5f, 0.5f, 1.0f, 10 * f, 10 * f);
+			packer.AddWedge(writer, 2.0f, 2.0f, 2.0f, 4);
+			packer.AddPyramid(writer, 2.0f, 2.0f, 2.0f, 4);
+			packer.AddDiamond(writer, 2.0f, 2.0f, 2.0f, 4);
+			packer.AddTriPrism(writer, 2.0f, 2.0f, 2.0f, 4);
+		}
+	}
+
+	double Milliseconds(Clock::time_point from, Clock::time_point to)
+	{
+		return std::chrono::duration<double, std::milli>(to - from).count();
+	}
+
+	// Declared so the uploader drains before the buffers it copies into go away.
+	struct Backend
+	{
+		std::vector<std::uint8_t> VertexBuffer;
+		std::vector<std::uint8_t> IndexBuffer;
+		std::unique_ptr<std::uint8_t[]> Staging{ new std::uint8_t[kStagingBytes] };
+		SimulatedCopyQueue Queue{ Staging.get(), kCopyBytesPerSecond, kCopyLatencySeconds };
+		StagingUploader Uploader{ Queue, Staging.get(), kStagingBytes };
+	};
+
+	void Finish(benchmark::State& state, double firstFrame, double firstMesh, double fullScene, double frames)
+	{
+		double runs = (double)state.iterations();
+		state.counters["first_frame_ms"] = firstFrame / runs;
+		state.counters["first_mesh_ms"] = firstMesh / runs;
+		state.counters["full_scene_ms"] = fullScene / runs;
+		state.counters["frames"] = frames / runs;
+	}
+
+	void BM_StartupBlocking(benchmark::State& state)
+	{
+		uint32 f = (uint32)state.range(0);
+		double firstFrame = 0.0, fullScene = 0.0;
+
+		for(auto _ : state)
+		{
+			Backend backend;
+			auto start = Clock::now();
+
+			Packer packer;
+			AddScene(packer, f);
+			backend.VertexBuffer.resize((std::size_t)packer.GetVertexByteSize());
+			backend.IndexBuffer.resize((std::size_t)packer.GetIndexByteSize());
+
+			// Generated into memory first: at the larger factors the scene outgrows the
+			// ring and goes up in pieces.
+			std::vector<Vertex> vertices(packer.GetVertexCount());
+			std::vector<std::uint16_t> indices(packer.GetIndexCount());
+			packer.Write(vertices.data(), packer.GetVertexCount(), indices.data(), packer.GetIndexCount());
+			backend.Uploader.Upload(backend.VertexBuffer.data(), 0, vertices.data(), packer.GetVertexByteSize());
+			backend.Uploader.Upload(backend.IndexBuffer.data(), 0, indices.data(), packer.GetIndexByteSize());
+			backend.Uploader.WaitIdle();
+
+			double ms = Milliseconds(start, Clock::now());
+			firstFrame += ms;
+			fullScene += ms;
+			state.SetIterationTime(ms / 1000.0);
+		}
+		Finish(state, firstFrame, fullScene, fullScene, (double)state.iterations());
+	}
+
+	void BM_StartupStreaming(benchmark::State& state)
+	{
+		uint32 f = (uint32)state.range(0);
+		ThreadPool pool((uint32)state.range(1));
+		double firstFrame = 0.0, firstMesh = 0.0, fullScene = 0.0, frames = 0.0;
+
+		for(auto _ : state)
+		{
+			Backend backend;
+			auto start = Clock::now();
+
+			Packer packer;
+			AddScene(packer, f);
+			backend.VertexBuffer.resize((std::size_t)packer.GetVertexByteSize());
+			backend.IndexBuffer.resize((std::size_t)packer.GetIndexByteSize());
+
+			GeometryStreamer streamer(pool, backend.Uploader);
+			for(uint32 e = 0; e < packer.GetEntryCount(); ++e)
+			{
+				const ShapeWriter::Range& range = packer.GetEntry(e).Range;
+
+				GeometryStreamer::Request request;
+				request.Generate = [&packer, e](GeometryStreamer::MeshData& mesh)
+				{
+					const ShapeWriter::Range& range = packer.GetEntry(e).Range;
+					mesh.Vertices.resize(range.VertexCount * sizeof(Vertex));
+					mesh.Indices.resize(range.IndexCount * sizeof(std::uint16_t));
+					packer.WriteEntry(e, reinterpret_cast<Vertex*>(mesh.Vertices.data()),
+						reinterpret_cast<std::uint16_t*>(mesh.Indices.data()));
+				};
+				request.VertexDestination = backend.VertexBuffer.data();
+				request.VertexOffset = range.BaseVertex * sizeof(Vertex);
+				request.IndexDestination = backend.IndexBuffer.data();
+				request.IndexOffset = range.StartIndex * sizeof(std::uint16_t);
+				streamer.Add(std::move(request));
+			}
+
+			// The frame loop: pump, then sleep out the rest of the frame.
+			bool firstMeshSeen = false;
+			for(uint32 frame = 0; ; ++frame)
+			{
+				auto frameStart = Clock::now();
+				streamer.Pump(kUploadBytesPerFrame);
+				backend.Uploader.EndFrame();
+
+				auto now = Clock::now();
+				if(frame == 0)
+					firstFrame += Milliseconds(start, now);
+				if(!firstMeshSeen && streamer.GetResidentCount() > 0)
+				{
+					firstMesh += Milliseconds(start, now);
+					firstMeshSeen = true;
+				}
+				if(streamer.IsComplete())
+				{
+					double ms = Milliseconds(start, now);
+					fullScene += ms;
+					frames += frame + 1;
+					state.SetIterationTime(ms / 1000.0);
+					break;
+				}
+
+				std::this_thread::sleep_until(frameStart + kFramePeriod);
+			}
+		}
+
+		Finish(state, firstFrame, firstMesh, fullScene, frames);
+	}
+}
+
+BENCHMARK(BM_StartupBlocking)->Arg(1)->Arg(4)->Arg(8)->UseManualTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StartupStreaming)->Args({ 1, 1 })->Args({ 4, 1 })->Args({ 8, 1 })->Args({ 8, 3 })
+	->UseManualTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,175 @@
+//***************************************************************************************
+// GeometryUploadBenchmark.cpp
+//
+// The ShapeComplete scene taken from the generators to a stand-in GPU buffer three ways,
+// with plain CPU memory standing in for the upload and default heaps:
+//
+//   Vectors      Append into std::vectors, CopyMemory into the CPU blobs, and copy into
+//                the upload heap the way d3dUtil::CreateDefaultBuffer does.
+//   PackedBlob   ScenePacker writes into the retained CPU blobs, which are copied
+//                into the upload heap once.
+//   PackedDirect ScenePacker writes straight into the mapped upload heap; no CPU blobs.
+//
+// Every path ends with the upload-to-default copy the GPU would make.  The counters
+// come from a CopyLedger: bytes written in place, bytes the CPU copied and bytes the
+// GPU copied, per frame of work.
+//***************************************************************************************
+
+#include "../CopyLedger.h"
+#include "../FrameConstants.h"
+#include "../ScenePacker.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	using ColorWriter = ShapeWriter::PositionColorWriter<Vertex>;
+	using Packer = ScenePacker<ColorWriter, std::uint16_t>;
+	using uint32 = std::uint32_t;
+
+	// The ShapeComplete shapes, with the sliced ones tessellated f times finer.
+	Packer MakeScene(uint32 f)
+	{
+		ColorWriter writer{ DirectX::XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f) };
+
+		Packer packer;
+		packer.AddBox(writer, 1.0f, 1.0f, 1.0f, 0);
+		packer.AddGrid(writer, 75.0f, 75.0f, 60 * f, 20 * f);
+		packer.AddSphere(writer, 0.5f, 20 * f, 20 * f);
+		packer.AddCylinder(writer, 0.5f, 0.4f, 3.0f, 20 * f, 20 * f);
+		packer.AddCone(writer, 0.5f, 0.5f, 0.5f, 1.0f, 10 * f, 10 * f);
+		packer.AddWedge(writer, 2.0f, 2.0f, 2.0f, 4);
+		packer.AddPyramid(writer, 2.0f, 2.0f, 2.0f, 4);
+		packer.AddDiamond(writer, 2.0f, 2.0f, 2.0f, 4);
+		packer.AddTriPrism(writer, 2.0f, 2.0f, 2.0f, 4);
+		return packer;
+	}
+
+	// Stand-ins for the D3D12 heaps, allocated once like persistent resources.
+	struct Heaps
+	{
+		std::vector<std::uint8_t> Upload;
+		std::vector<std::uint8_t> Default;
+		std::vector<std::uint8_t> VertexBlob;
+		std::vector<std::uint8_t> IndexBlob;
+
+		Heaps(std::size_t vbByteSize, std::size_t ibByteSize)
+			: Upload(vbByteSize + ibByteSize), Default(vbByteSize + ibByteSize),
+			VertexBlob(vbByteSize), IndexBlob(ibByteSize)
+		{
+		}
+	};
+
+	void CopyToDefault(Heaps& heaps, CopyLedger& ledger)
+	{
+		std::memcpy(heaps.Default.data(), heaps.Upload.data(), heaps.Upload.size());
+		ledger.Record("upload heap to default heap", CopyLedger::Kind::GpuCopy, heaps.Upload.size());
+	}
+
+	void Finish(benchmark::State& state, const CopyLedger& ledger, uint32 vertexCount)
+	{
+		double frames = (double)state.iterations();
+		state.counters["vertices"] = vertexCount;
+		state.counters["written_bytes"] = ledger.GetBytes(CopyLedger::Kind::Write) / frames;
+		state.counters["cpu_copied_bytes"] = ledger.GetBytes(CopyLedger::Kind::CpuCopy) / frames;
+		state.counters["gpu_copied_bytes"] = ledger.GetBytes(CopyLedger::Kind::GpuCopy) / frames;
+	}
+
+	void BM_UploadVectors(benchmark::State& state)
+	{
+		ColorWriter writer{ DirectX::XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f) };
+		uint32 f = (uint32)state.range(0);
+		Packer sizes = MakeScene(f);
+		Heaps heaps((std::size_t)sizes.GetVertexByteSize(), (std::size_t)sizes.GetIndexByteSize());
+		CopyLedger ledger;
+
+		for(auto _ : state)
+		{
+			std::vector<Vertex> vertices;
+			std::vector<std::uint16_t> indices;
+			ShapeWriter::AppendBox(vertices, indices, writer, 1.0f, 1.0f, 1.0f, 0);
+			ShapeWriter::AppendGrid(vertices, indices, writer, 75.0f, 75.0f, 60 * f, 20 * f);
+			ShapeWriter::AppendSphere(vertices, indices, writer, 0.5f, 20 * f, 20 * f);
+			ShapeWriter::AppendCylinder(vertices, indices, writer, 0.5f, 0.4f, 3.0f, 20 * f, 20 * f);
+			ShapeWriter::AppendCone(vertices, indices, writer, 0.5f, 0.5f, 0.5f, 1.0f, 10 * f, 10 * f);
+			ShapeWriter::AppendWedge(vertices, indices, writer, 2.0f, 2.0f, 2.0f, 4);
+			ShapeWriter::AppendPyramid(vertices, indices, writer, 2.0f, 2.0f, 2.0f, 4);
+			ShapeWriter::AppendDiamond(vertices, indices, writer, 2.0f, 2.0f, 2.0f, 4);
+			ShapeWriter::AppendTriPrism(vertices, indices, writer, 2.0f, 2.0f, 2.0f, 4);
+
+			std::size_t vbByteSize = vertices.size() * sizeof(Vertex);
+			std::size_t ibByteSize = indices.size() * sizeof(std::uint16_t);
+			ledger.Record("generate into vectors", CopyLedger::Kind::Write, vbByteSize + ibByteSize);
+
+			std::memcpy(heaps.VertexBlob.data(), vertices.data(), vbByteSize);
+			std::memcpy(heaps.IndexBlob.data(), indices.data(), ibByteSize);
+			ledger.Record("vectors to CPU blobs", CopyLedger::Kind::CpuCopy, vbByteSize + ibByteSize);
+
+			std::memcpy(heaps.Upload.data(), vertices.data(), vbByteSize);
+			std::memcpy(heaps.Upload.data() + vbByteSize, indices.data(), ibByteSize);
+			ledger.Record("vectors to upload heap", CopyLedger::Kind::CpuCopy, vbByteSize + ibByteSize);
+
+			CopyToDefault(heaps, ledger);
+			benchmark::DoNotOptimize(heaps.Default.data());
+			benchmark::ClobberMemory();
+		}
+		Finish(state, ledger, sizes.GetVertexCount());
+	}
+
+	void BM_UploadPackedBlob(benchmark::State& state)
+	{
+		Packer packer = MakeScene((uint32)state.range(0));
+		std::size_t vbByteSize = (std::size_t)packer.GetVertexByteSize();
+		std::size_t ibByteSize = (std::size_t)packer.GetIndexByteSize();
+		Heaps heaps(vbByteSize, ibByteSize);
+		CopyLedger ledger;
+
+		for(auto _ : state)
+		{
+			packer.Write(reinterpret_cast<Vertex*>(heaps.VertexBlob.data()), packer.GetVertexCount(),
+				reinterpret_cast<std::uint16_t*>(heaps.IndexBlob.data()), packer.GetIndexCount());
+			ledger.Record("generate into CPU blobs", CopyLedger::Kind::Write, vbByteSize + ibByteSize);
+
+			std::memcpy(heaps.Upload.data(), heaps.VertexBlob.data(), vbByteSize);
+			std::memcpy(heaps.Upload.data() + vbByteSize, heaps.IndexBlob.data(), ibByteSize);
+			ledger.Record("CPU blobs to upload heap", CopyLedger::Kind::CpuCopy, vbByteSize + ibByteSize);
+
+			CopyToDefault(heaps, ledger);
+			benchmark::DoNotOptimize(heaps.Default.data());
+			benchmark::ClobberMemory();
+		}
+		Finish(state, ledger, packer.GetVertexCount());
+	}
+
+	void BM_UploadPackedDirect(benchmark::State& state)
+	{
+		Packer packer = MakeScene((uint32)state.range(0));
+		std::size_t vbByteSize = (std::size_t)packer.GetVertexByteSize();
+		std::size_t ibByteSize = (std::size_t)packer.GetIndexByteSize();
+		Heaps heaps(vbByteSize, ibByteSize);
+		CopyLedger ledger;
+
+		for(auto _ : state)
+		{
+			packer.Write(reinterpret_cast<Vertex*>(heaps.Upload.data()), packer.GetVertexCount(),
+				reinterpret_cast<std::uint16_t*>(heaps.Upload.data() + vbByteSize), packer.GetIndexCount());
+			ledger.Record("generate into upload heap", CopyLedger::Kind::Write, vbByteSize + ibByteSize);
+
+			CopyToDefault(heaps, ledger);
+			benchmark::DoNotOptimize(heaps.Default.data());
+			benchmark::ClobberMemory();
+		}
+		Finish(state, ledger, packer.GetVertexCount());
+	}
+}
+
+// The ShapeComplete scene at 1x (the app), 2x and 4x tessellation.
+BENCHMARK(BM_UploadVectors)->Arg(1)->Arg(2)->Arg(4);
+BENCHMARK(BM_UploadPackedBlob)->Arg(1)->Arg(2)->Arg(4);
+BENCHMARK(BM_UploadPackedDirect)->Arg(1)->Arg(2)->Arg(4);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,331 @@
+//***************************************************************************************
+// GlbLoadBenchmark.cpp
+//
+// GlbFile on binary glTF files written here from a GeometryGenerator grid, laid out the
+// way exporters usually write them: float3 positions and normals, float4 tangents and
+// float2 texture coordinates in separate buffer views, and 32-bit indices.
+//
+//   OpenViews   Maps the file, parses the JSON and takes the positions and indices as
+//               views, then reads one position per page: what a consumer that uploads
+//               or uses the data in place pays.
+//   CopyTo      Open plus decoding the primitive into a MeshData.
+//   Pack        Open plus ScenePacker::AddCustom writing the app Vertex format straight
+//               from the mapping.
+//   Regenerate  GeometryGenerator builds the same grid, for reference.
+//
+// The files stay on disk, and after the first run in the page cache, for the whole
+// process.  Bytes processed are file bytes.  The grid is stored right-handed: z negated
+// and every triangle reversed.  Each file is checked once first: the views must be
+// plain arrays holding what was stored, the decoded MeshData must be the grid itself,
+// winding included, and decoding without the conversion must keep the stored indices.
+//
+// Argument: grid vertices per side.
+//***************************************************************************************
+
+#include "../FrameConstants.h"
+#include "../GlbFile.h"
+#include "../ScenePacker.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	using ColorWriter = ShapeWriter::PositionColorWriter<Vertex>;
+	using Packer = ScenePacker<ColorWriter, std::uint32_t>;
+	using uint32 = std::uint32_t;
+
+	const ColorWriter kWriter{ DirectX::XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f) };
+	const float kGridSize = 160.0f;
+
+	struct GlbSource
+	{
+		std::string Path;
+		GeometryGenerator::MeshData Grid;
+		std::vector<uint32> Indices;         // as stored: each grid triangle reversed
+		std::size_t FileBytes = 0;
+	};
+
+	GeometryGenerator::MeshData MakeGrid(uint32 side)
+	{
+		GeometryGenerator geoGen;
+		return geoGen.CreateGrid(kGridSize, kGridSize, side, side);
+	}
+
+	// The files written so far by grid side; removed when the process exits.
+	class GlbFiles
+	{
+	public:
+		~GlbFiles()
+		{
+			for(auto& file : mFiles)
+				std::remove(file.second.Path.c_str());
+		}
+
+		const GlbSource* Get(uint32 side)
+		{
+			auto found = mFiles.find(side);
+			if(found != mFiles.end())
+				return &found->second;
+
+			GlbSource file;
+			file.Path = "GlbLoadBenchmark_" + std::to_string(side) + ".glb";
+			file.Grid = MakeGrid(side);
+			file.Indices = file.Grid.Indices32;
+			for(std::size_t i = 0; i + 2 < file.Indices.size(); i += 3)
+				std::swap(file.Indices[i + 1], file.Indices[i + 2]);
+			if(!Write(file))
+				return nullptr;
+
+			return &(mFiles[side] = std::move(file));
+		}
+
+	private:
+		static void Append(std::vector<std::uint8_t>& bin, const void* data, std::size_t size)
+		{
+			const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+			bin.insert(bin.end(), bytes, bytes + size);
+		}
+
+		static void AppendUint32(std::vector<std::uint8_t>& out, uint32 value)
+		{
+			Append(out, &value, sizeof(value));
+		}
+
+		// One mesh with one primitive.  The grid is stored right-handed and
+		// counter-clockwise, so loading it back with the default conversion gives the
+		// grid itself.
+		static bool Write(GlbSource& file)
+		{
+			const std::vector<GeometryGenerator::Vertex>& vertices = file.Grid.Vertices;
+			uint32 n = (uint32)vertices.size();
+
+			std::vector<std::uint8_t> bin;
+			for(const GeometryGenerator::Vertex& v : vertices)
+			{
+				float p[3] = { v.Position.x, v.Position.y, -v.Position.z };
+				Append(bin, p, sizeof(p));
+			}
+			for(const GeometryGenerator::Vertex& v : vertices)
+			{
+				float normal[3] = { v.Normal.x, v.Normal.y, -v.Normal.z };
+				Append(bin, normal, sizeof(normal));
+			}
+			for(const GeometryGenerator::Vertex& v : vertices)
+			{
+				float tangent[4] = { v.TangentU.x, v.TangentU.y, -v.TangentU.z, 1.0f };
+				Append(bin, tangent, sizeof(tangent));
+			}
+			for(const GeometryGenerator::Vertex& v : vertices)
+				Append(bin, &v.TexC, 8);
+			Append(bin, file.Indices.data(), file.Indices.size() * sizeof(uint32));
+
+			std::size_t offsets[] = { 0, 12 * (std::size_t)n, 24 * (std::size_t)n, 40 * (std::size_t)n, 48 * (std::size_t)n, bin.size() };
+			const char* types[] = { "VEC3", "VEC3", "VEC4", "VEC2", "SCALAR" };
+			uint32 indexCount = (uint32)file.Grid.Indices32.size();
+
+			std::string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"GlbLoadBenchmark\"},"
+				"\"meshes\":[{\"name\":\"grid\",\"primitives\":[{\"attributes\":"
+				"{\"POSITION\":0,\"NORMAL\":1,\"TANGENT\":2,\"TEXCOORD_0\":3},\"indices\":4,\"mode\":4}]}],"
+				"\"buffers\":[{\"byteLength\":" + std::to_string(bin.size()) + "}],\"bufferViews\":[";
+			for(int k = 0; k < 5; ++k)
+			{
+				json += (k ? ",{" : "{") + std::string("\"buffer\":0,\"byteOffset\":") + std::to_string(offsets[k]) +
+					",\"byteLength\":" + std::to_string(offsets[k + 1] - offsets[k]) + "}";
+			}
+			json += "],\"accessors\":[";
+			for(int k = 0; k < 5; ++k)
+			{
+				json += (k ? ",{" : "{") + std::string("\"bufferView\":") + std::to_string(k) + ",\"componentType\":" +
+					std::to_string(k == 4 ? Gltf::UnsignedInt : Gltf::Float) + ",\"count\":" + std::to_string(k == 4 ? indexCount : n) +
+					",\"type\":\"" + types[k] + "\"}";
+			}
+			json += "]}";
+			while(json.size() % 4 != 0)
+				json += ' ';
+			while(bin.size() % 4 != 0)
+				bin.push_back(0);
+
+			std::vector<std::uint8_t> out;
+			AppendUint32(out, 0x46546C67);
+			AppendUint32(out, 2);
+			AppendUint32(out, (uint32)(12 + 8 + json.size() + 8 + bin.size()));
+			AppendUint32(out, (uint32)json.size());
+			AppendUint32(out, 0x4E4F534A);
+			Append(out, json.data(), json.size());
+			AppendUint32(out, (uint32)bin.size());
+			AppendUint32(out, 0x004E4942);
+
+			std::FILE* f = std::fopen(file.Path.c_str(), "wb");
+			if(f == nullptr)
+				return false;
+			bool written = std::fwrite(out.data(), 1, out.size(), f) == out.size() &&
+				std::fwrite(bin.data(), 1, bin.size(), f) == bin.size();
+			file.FileBytes = out.size() + bin.size();
+			return std::fclose(f) == 0 && written;
+		}
+
+		std::map<uint32, GlbSource> mFiles;
+	};
+
+	GlbFiles gFiles;
+
+	bool Verify(const GlbSource& source)
+	{
+		GlbFile file;
+		if(!file.Open(source.Path.c_str()) || file.GetMeshCount() != 1 || file.FindMesh("grid") != 0)
+			return false;
+
+		const Gltf::Primitive& primitive = file.GetMesh(0).Primitives[0];
+		const GeometryGenerator::MeshData& grid = source.Grid;
+
+		Gltf::AccessorView<DirectX::XMFLOAT3> positions;
+		Gltf::AccessorView<uint32> indices;
+		if(!GlbFile::GetView(primitive.Position, positions) || positions.GetArray() == nullptr ||
+			!GlbFile::GetView(primitive.Indices, indices) || indices.GetArray() == nullptr ||
+			positions.Count != grid.Vertices.size() || indices.Count != grid.Indices32.size() ||
+			std::memcmp(indices.GetArray(), source.Indices.data(), source.Indices.size() * sizeof(uint32)) != 0)
+			return false;
+
+		GeometryGenerator::MeshData mesh;
+		if(!GlbFile::CopyTo(primitive, mesh, false) || mesh.Indices32 != source.Indices)
+			return false;
+		if(!GlbFile::CopyTo(primitive, mesh) || mesh.Indices32 != grid.Indices32)
+			return false;
+
+		for(std::size_t i = 0; i < grid.Vertices.size(); ++i)
+		{
+			const GeometryGenerator::Vertex& a = mesh.Vertices[i];
+			const GeometryGenerator::Vertex& b = grid.Vertices[i];
+			if(positions[(uint32)i].z != -b.Position.z ||
+				std::memcmp(&a.Position, &b.Position, sizeof(a.Position)) != 0 ||
+				std::memcmp(&a.Normal, &b.Normal, sizeof(a.Normal)) != 0 ||
+				std::memcmp(&a.TangentU, &b.TangentU, sizeof(a.TangentU)) != 0 ||
+				std::memcmp(&a.TexC, &b.TexC, sizeof(a.TexC)) != 0)
+				return false;
+		}
+		return true;
+	}
+
+	// Writes and checks the file for the argument; nullptr skips the benchmark.
+	const GlbSource* Prepare(benchmark::State& state)
+	{
+		static std::map<uint32, bool> verified;
+
+		uint32 side = (uint32)state.range(0);
+		const GlbSource* source = gFiles.Get(side);
+		if(source == nullptr)
+		{
+			state.SkipWithError("could not write the GLB file");
+			return nullptr;
+		}
+		if(verified.find(side) == verified.end())
+			verified[side] = Verify(*source);
+		if(!verified[side])
+		{
+			state.SkipWithError("GLB file does not match the grid");
+			return nullptr;
+		}
+
+		state.counters["file_mb"] = source->FileBytes / (1024.0 * 1024.0);
+		state.counters["vertices"] = (double)source->Grid.Vertices.size();
+		return source;
+	}
+
+	void BM_OpenViews(benchmark::State& state)
+	{
+		const GlbSource* source = Prepare(state);
+		if(source == nullptr)
+			return;
+
+		for(auto _ : state)
+		{
+			GlbFile file;
+			file.Open(source->Path.c_str());
+			const Gltf::Primitive& primitive = file.GetMesh(0).Primitives[0];
+
+			Gltf::AccessorView<DirectX::XMFLOAT3> positions;
+			Gltf::AccessorView<uint32> indices;
+			GlbFile::GetView(primitive.Position, positions);
+			GlbFile::GetView(primitive.Indices, indices);
+
+			float sum = 0.0f;
+			for(uint32 i = 0; i < positions.Count; i += 4096 / sizeof(DirectX::XMFLOAT3))
+				sum += positions[i].y;
+			benchmark::DoNotOptimize(sum);
+			benchmark::DoNotOptimize(indices.GetArray());
+		}
+		state.SetBytesProcessed((int64_t)(state.iterations() * source->FileBytes));
+	}
+
+	void BM_CopyTo(benchmark::State& state)
+	{
+		const GlbSource* source = Prepare(state);
+		if(source == nullptr)
+			return;
+
+		GeometryGenerator::MeshData mesh;
+		for(auto _ : state)
+		{
+			GlbFile file;
+			file.Open(source->Path.c_str());
+			GlbFile::CopyTo(file.GetMesh(0).Primitives[0], mesh);
+			benchmark::DoNotOptimize(mesh.Vertices.data());
+		}
+		state.SetBytesProcessed((int64_t)(state.iterations() * source->FileBytes));
+	}
+
+	void BM_Pack(benchmark::State& state)
+	{
+		const GlbSource* source = Prepare(state);
+		if(source == nullptr)
+			return;
+
+		std::vector<Vertex> vertices;
+		std::vector<uint32> indices;
+		for(auto _ : state)
+		{
+			GlbFile file;
+			file.Open(source->Path.c_str());
+			const Gltf::Primitive& primitive = file.GetMesh(0).Primitives[0];
+
+			Packer packer;
+			packer.AddCustom(kWriter, { primitive.GetVertexCount(), primitive.GetIndexCount() },
+				[&primitive](Vertex* v, uint32* i, const auto& writer) { GlbFile::WritePrimitive(primitive, v, i, writer); });
+
+			vertices.resize(packer.GetVertexCount());
+			indices.resize(packer.GetIndexCount());
+			packer.Write(vertices.data(), packer.GetVertexCount(), indices.data(), packer.GetIndexCount());
+			benchmark::DoNotOptimize(vertices.data());
+		}
+		state.SetBytesProcessed((int64_t)(state.iterations() * source->FileBytes));
+	}
+
+	void BM_Regenerate(benchmark::State& state)
+	{
+		const GlbSource* source = Prepare(state);
+		if(source == nullptr)
+			return;
+
+		for(auto _ : state)
+		{
+			GeometryGenerator::MeshData mesh = MakeGrid((uint32)state.range(0));
+			benchmark::DoNotOptimize(mesh.Vertices.data());
+		}
+		state.SetBytesProcessed((int64_t)(state.iterations() * source->FileBytes));
+	}
+}
+
+BENCHMARK(BM_OpenViews)->Arg(257)->Arg(1025)->Arg(2049)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CopyTo)->Arg(257)->Arg(1025)->Arg(2049)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Pack)->Arg(257)->Arg(1025)->Arg(2049)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Regenerate)->Arg(257)->Arg(1025)->Arg(2049)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
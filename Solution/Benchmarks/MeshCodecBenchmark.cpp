@@ -0,0 +1,161 @@
+//***************************************************************************************
+// MeshCodecBenchmark.cpp
+//
+// MeshCodec on GeometryGenerator meshes, one shape per argument: a box, a sphere, a
+// large geosphere, a terrain-chunk-sized grid and a cylinder.
+//
+//   DecodeIndices   The index stream into 32-bit indices.
+//   DecodeVertices  The vertex stream into QuantizedVertex records.
+//   Decompress      Both streams plus dequantization back into a MeshData.
+//   Compress        Quantization and both encoders, for reference.
+//
+// Bytes processed are decoded (or, for Compress, source) bytes, so the rates read as
+// output bandwidth.  The counters give the compressed size as a fraction of the index
+// buffer the apps would upload (16-bit when the vertices allow it), of the quantized
+// vertices and of the whole uncompressed MeshData.  Each shape is checked first: the
+// indices and quantized vertices must come back exactly.
+//***************************************************************************************
+
+#include "../MeshCodec.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	const char* const kShapeNames[] = { "box", "sphere", "geosphere", "grid", "cylinder" };
+
+	GeometryGenerator::MeshData MakeShape(int shape)
+	{
+		GeometryGenerator geoGen;
+		switch(shape)
+		{
+		case 0: return geoGen.CreateBox(1.0f, 1.0f, 1.0f, 3);
+		case 1: return geoGen.CreateSphere(0.5f, 160, 160);
+		case 2: return geoGen.CreateGeosphere(0.5f, 7);
+		case 3: return geoGen.CreateGrid(160.0f, 160.0f, 257, 257);
+		default: return geoGen.CreateCylinder(0.5f, 0.4f, 3.0f, 160, 160);
+		}
+	}
+
+	struct Shape
+	{
+		GeometryGenerator::MeshData Mesh;
+		MeshCodec::CompressedMesh Compressed;
+		std::vector<MeshCodec::QuantizedVertex> Quantized;
+	};
+
+	// Builds and compresses the shape and checks that it decodes; false skips the run.
+	bool Prepare(benchmark::State& state, Shape& shape)
+	{
+		int index = (int)state.range(0);
+		state.SetLabel(kShapeNames[index]);
+
+		shape.Mesh = MakeShape(index);
+		MeshCodec::Compress(shape.Mesh, shape.Compressed);
+
+		uint32 vertexCount = shape.Compressed.VertexCount;
+		shape.Quantized.resize(vertexCount);
+		MeshCodec::Quantize(shape.Quantized.data(), shape.Mesh.Vertices.data(), vertexCount, shape.Compressed.Quantization);
+
+		std::vector<MeshCodec::QuantizedVertex> vertices(vertexCount);
+		std::vector<uint32> indices(shape.Compressed.IndexCount);
+		bool decoded =
+			MeshCodec::DecodeVertices(vertices.data(), vertexCount, sizeof(MeshCodec::QuantizedVertex),
+				shape.Compressed.Vertices.data(), shape.Compressed.Vertices.size()) &&
+			MeshCodec::DecodeIndices(indices.data(), shape.Compressed.IndexCount,
+				shape.Compressed.Indices.data(), shape.Compressed.Indices.size());
+
+		if(!decoded || indices != shape.Mesh.Indices32 ||
+			std::memcmp(vertices.data(), shape.Quantized.data(), vertexCount * sizeof(MeshCodec::QuantizedVertex)) != 0)
+		{
+			state.SkipWithError("decoded mesh does not match the source");
+			return false;
+		}
+
+		std::size_t indexSize = vertexCount <= 0x10000 ? 2 : 4;
+		std::size_t rawBytes = vertexCount * sizeof(GeometryGenerator::Vertex) + shape.Compressed.IndexCount * sizeof(uint32);
+		std::size_t compressedBytes = shape.Compressed.Vertices.size() + shape.Compressed.Indices.size();
+
+		state.counters["index_ratio"] = (double)shape.Compressed.Indices.size() / (shape.Compressed.IndexCount * indexSize);
+		state.counters["vertex_ratio"] = (double)shape.Compressed.Vertices.size() / (vertexCount * sizeof(MeshCodec::QuantizedVertex));
+		state.counters["mesh_ratio"] = (double)compressedBytes / rawBytes;
+		return true;
+	}
+
+	void BM_DecodeIndices(benchmark::State& state)
+	{
+		Shape shape;
+		if(!Prepare(state, shape))
+			return;
+
+		const MeshCodec::CompressedMesh& c = shape.Compressed;
+		std::vector<uint32> indices(c.IndexCount);
+		for(auto _ : state)
+		{
+			MeshCodec::DecodeIndices(indices.data(), c.IndexCount, c.Indices.data(), c.Indices.size());
+			benchmark::ClobberMemory();
+		}
+		state.SetBytesProcessed((int64_t)state.iterations() * c.IndexCount * sizeof(uint32));
+	}
+
+	void BM_DecodeVertices(benchmark::State& state)
+	{
+		Shape shape;
+		if(!Prepare(state, shape))
+			return;
+
+		const MeshCodec::CompressedMesh& c = shape.Compressed;
+		std::vector<MeshCodec::QuantizedVertex> vertices(c.VertexCount);
+		for(auto _ : state)
+		{
+			MeshCodec::DecodeVertices(vertices.data(), c.VertexCount, sizeof(MeshCodec::QuantizedVertex), c.Vertices.data(), c.Vertices.size());
+			benchmark::ClobberMemory();
+		}
+		state.SetBytesProcessed((int64_t)state.iterations() * c.VertexCount * sizeof(MeshCodec::QuantizedVertex));
+	}
+
+	void BM_Decompress(benchmark::State& state)
+	{
+		Shape shape;
+		if(!Prepare(state, shape))
+			return;
+
+		GeometryGenerator::MeshData mesh;
+		for(auto _ : state)
+		{
+			MeshCodec::Decompress(shape.Compressed, mesh);
+			benchmark::DoNotOptimize(mesh.Vertices.data());
+		}
+		state.SetBytesProcessed((int64_t)state.iterations() *
+			(mesh.Vertices.size() * sizeof(GeometryGenerator::Vertex) + mesh.Indices32.size() * sizeof(uint32)));
+	}
+
+	void BM_Compress(benchmark::State& state)
+	{
+		Shape shape;
+		if(!Prepare(state, shape))
+			return;
+
+		MeshCodec::CompressedMesh compressed;
+		for(auto _ : state)
+		{
+			MeshCodec::Compress(shape.Mesh, compressed);
+			benchmark::DoNotOptimize(compressed.Vertices.data());
+		}
+		state.SetBytesProcessed((int64_t)state.iterations() *
+			(shape.Mesh.Vertices.size() * sizeof(GeometryGenerator::Vertex) + shape.Mesh.Indices32.size() * sizeof(uint32)));
+	}
+}
+
+BENCHMARK(BM_DecodeIndices)->DenseRange(0, 4)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DecodeVertices)->DenseRange(0, 4)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Decompress)->DenseRange(0, 4)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Compress)->DenseRange(0, 4)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,271 @@
+//***************************************************************************************
+// MeshFileBenchmark.cpp
+//
+// Getting the sphere, geosphere, grid and cylinder of a scene into a packed vertex
+// buffer, either by running the generators or from a mesh file:
+//
+//   Regenerate  GeometryGenerator builds each shape and ScenePacker writes it out.
+//   LoadPacked  MappedMesh maps the file and ScenePacker::AddMesh writes each submesh
+//               out straight from the mapping.
+//   OpenMapped  Only maps the file and reads one position per page: what a consumer
+//               that uses the file as it lies pays before its first draw.
+//
+// Before timing, the file is written and read back and every submesh is compared with
+// the mesh it came from, and the packed output of the two packing paths is compared;
+// a mismatch fails the benchmark.
+//
+// Argument: tessellation factor of the shapes.
+//***************************************************************************************
+
+#include "../FrameConstants.h"
+#include "../MeshFile.h"
+#include "../ScenePacker.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using ColorWriter = ShapeWriter::PositionColorWriter<Vertex>;
+	using Packer = ScenePacker<ColorWriter, std::uint32_t>;
+	using uint32 = std::uint32_t;
+
+	const char* const kShapeNames[] = { "sphere", "geosphere", "grid", "cylinder" };
+	const uint32 kShapeCount = 4;
+
+	std::vector<GeometryGenerator::MeshData> Generate(uint32 f)
+	{
+		GeometryGenerator geoGen;
+
+		std::vector<GeometryGenerator::MeshData> meshes;
+		meshes.push_back(geoGen.CreateSphere(0.5f, 20 * f, 20 * f));
+		meshes.push_back(geoGen.CreateGeosphere(0.5f, f < 4 ? 2 + f : 6));
+		meshes.push_back(geoGen.CreateGrid(75.0f, 75.0f, 60 * f, 20 * f));
+		meshes.push_back(geoGen.CreateCylinder(0.5f, 0.4f, 3.0f, 20 * f, 20 * f));
+		return meshes;
+	}
+
+	std::string FilePath(uint32 f)
+	{
+		return "MeshFileBenchmark_" + std::to_string(f) + ".msh";
+	}
+
+	// One file with a submesh per shape; 16-bit indices when every submesh allows them.
+	bool WriteScene(const char* path, const std::vector<GeometryGenerator::MeshData>& meshes)
+	{
+		std::vector<GeometryGenerator::Vertex> vertices;
+		std::vector<uint32> indices;
+		std::vector<MeshFile::SubmeshDesc> submeshes;
+		bool fits16 = true;
+
+		for(uint32 s = 0; s < kShapeCount; ++s)
+		{
+			MeshFile::SubmeshDesc desc;
+			desc.Name = kShapeNames[s];
+			desc.Range.BaseVertex = (uint32)vertices.size();
+			desc.Range.VertexCount = (uint32)meshes[s].Vertices.size();
+			desc.Range.StartIndex = (uint32)indices.size();
+			desc.Range.IndexCount = (uint32)meshes[s].Indices32.size();
+			submeshes.push_back(desc);
+
+			fits16 = fits16 && meshes[s].Vertices.size() <= 0x10000;
+			vertices.insert(vertices.end(), meshes[s].Vertices.begin(), meshes[s].Vertices.end());
+			indices.insert(indices.end(), meshes[s].Indices32.begin(), meshes[s].Indices32.end());
+		}
+
+		if(fits16)
+		{
+			std::vector<std::uint16_t> indices16(indices.begin(), indices.end());
+			return MeshFile::Write(path, vertices.data(), (uint32)vertices.size(), indices16.data(), 2, (uint32)indices16.size(),
+				submeshes.data(), kShapeCount);
+		}
+		return MeshFile::Write(path, vertices.data(), (uint32)vertices.size(), indices.data(), 4, (uint32)indices.size(),
+			submeshes.data(), kShapeCount);
+	}
+
+	template<typename Index>
+	bool SameIndices(const Index* indices, const std::vector<uint32>& expected)
+	{
+		for(std::size_t i = 0; i < expected.size(); ++i)
+		{
+			if(indices[i] != expected[i])
+				return false;
+		}
+		return true;
+	}
+
+	bool RoundTrips(const MappedMesh& file, const std::vector<GeometryGenerator::MeshData>& meshes)
+	{
+		if(file.GetSubmeshCount() != kShapeCount)
+			return false;
+
+		for(uint32 s = 0; s < kShapeCount; ++s)
+		{
+			const GeometryGenerator::MeshData& mesh = meshes[s];
+			uint32 submesh = file.FindSubmesh(kShapeNames[s]);
+			if(submesh == kShapeCount)
+				return false;
+
+			ShapeWriter::Range range = file.GetRange(submesh);
+			if(range.VertexCount != mesh.Vertices.size() || range.IndexCount != mesh.Indices32.size())
+				return false;
+			if(std::memcmp(file.GetVertices() + range.BaseVertex, mesh.Vertices.data(), mesh.Vertices.size() * sizeof(GeometryGenerator::Vertex)) != 0)
+				return false;
+
+			bool same = file.GetIndexSize() == 2 ?
+				SameIndices(file.GetIndices16() + range.StartIndex, mesh.Indices32) :
+				SameIndices(file.GetIndices32() + range.StartIndex, mesh.Indices32);
+			if(!same)
+				return false;
+		}
+		return true;
+	}
+
+	struct Output
+	{
+		std::vector<Vertex> Vertices;
+		std::vector<uint32> Indices;
+
+		void Write(Packer& packer)
+		{
+			Vertices.resize(packer.GetVertexCount());
+			Indices.resize(packer.GetIndexCount());
+			packer.Write(Vertices.data(), packer.GetVertexCount(), Indices.data(), packer.GetIndexCount());
+		}
+	};
+
+	const ColorWriter kWriter{ DirectX::XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f) };
+
+	void PackGenerated(uint32 f, Output& output)
+	{
+		std::vector<GeometryGenerator::MeshData> meshes = Generate(f);
+
+		Packer packer;
+		for(const GeometryGenerator::MeshData& mesh : meshes)
+			packer.AddMesh(kWriter, mesh.Vertices.data(), (uint32)mesh.Vertices.size(), mesh.Indices32.data(), (uint32)mesh.Indices32.size());
+		output.Write(packer);
+	}
+
+	bool PackMapped(const char* path, Output& output)
+	{
+		MappedMesh file;
+		if(!file.Open(path))
+			return false;
+
+		Packer packer;
+		for(uint32 s = 0; s < file.GetSubmeshCount(); ++s)
+		{
+			ShapeWriter::Range range = file.GetRange(s);
+			const GeometryGenerator::Vertex* vertices = file.GetVertices() + range.BaseVertex;
+			if(file.GetIndexSize() == 2)
+				packer.AddMesh(kWriter, vertices, range.VertexCount, file.GetIndices16() + range.StartIndex, range.IndexCount);
+			else
+				packer.AddMesh(kWriter, vertices, range.VertexCount, file.GetIndices32() + range.StartIndex, range.IndexCount);
+		}
+		output.Write(packer);
+		return true;
+	}
+
+	// Writes the file for this factor and checks it; false skips the benchmark.
+	bool Prepare(benchmark::State& state, uint32 f)
+	{
+		std::string path = FilePath(f);
+		std::vector<GeometryGenerator::MeshData> meshes = Generate(f);
+
+		MappedMesh file;
+		if(!WriteScene(path.c_str(), meshes) || !file.Open(path.c_str()))
+		{
+			std::remove(path.c_str());
+			state.SkipWithError("could not write the mesh file");
+			return false;
+		}
+		if(!RoundTrips(file, meshes))
+		{
+			std::remove(path.c_str());
+			state.SkipWithError("mesh file does not match the generated meshes");
+			return false;
+		}
+
+		Output generated, loaded;
+		PackGenerated(f, generated);
+		if(!PackMapped(path.c_str(), loaded) ||
+			generated.Indices != loaded.Indices ||
+			std::memcmp(generated.Vertices.data(), loaded.Vertices.data(), generated.Vertices.size() * sizeof(Vertex)) != 0)
+		{
+			std::remove(path.c_str());
+			state.SkipWithError("packed mesh file does not match the packed generated meshes");
+			return false;
+		}
+
+		state.counters["file_bytes"] = (double)file.GetHeader().FileSize;
+		state.counters["vertices"] = (double)file.GetVertexCount();
+		return true;
+	}
+
+	void BM_Regenerate(benchmark::State& state)
+	{
+		uint32 f = (uint32)state.range(0);
+		if(!Prepare(state, f))
+			return;
+
+		Output output;
+		for(auto _ : state)
+		{
+			PackGenerated(f, output);
+			benchmark::DoNotOptimize(output.Vertices.data());
+		}
+
+		std::remove(FilePath(f).c_str());
+	}
+
+	void BM_LoadPacked(benchmark::State& state)
+	{
+		uint32 f = (uint32)state.range(0);
+		if(!Prepare(state, f))
+			return;
+
+		std::string path = FilePath(f);
+		Output output;
+		for(auto _ : state)
+		{
+			PackMapped(path.c_str(), output);
+			benchmark::DoNotOptimize(output.Vertices.data());
+		}
+
+		std::remove(path.c_str());
+	}
+
+	void BM_OpenMapped(benchmark::State& state)
+	{
+		uint32 f = (uint32)state.range(0);
+		if(!Prepare(state, f))
+			return;
+
+		std::string path = FilePath(f);
+		const uint32 verticesPerPage = 4096 / sizeof(GeometryGenerator::Vertex);
+		for(auto _ : state)
+		{
+			MappedMesh file;
+			file.Open(path.c_str());
+
+			float sum = 0.0f;
+			const GeometryGenerator::Vertex* vertices = file.GetVertices();
+			for(uint32 v = 0; v < file.GetVertexCount(); v += verticesPerPage)
+				sum += vertices[v].Position.x;
+			benchmark::DoNotOptimize(sum);
+		}
+
+		std::remove(path.c_str());
+	}
+}
+
+BENCHMARK(BM_Regenerate)->Arg(1)->Arg(4)->Arg(8)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LoadPacked)->Arg(1)->Arg(4)->Arg(8)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_OpenMapped)->Arg(1)->Arg(4)->Arg(8)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
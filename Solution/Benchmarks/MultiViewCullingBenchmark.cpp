@@ -0,0 +1,140 @@
+//***************************************************************************************
+// MultiViewCullingBenchmark.cpp
+//
+// Headless benchmark for ViewCuller at 4 and 8 views.  Compares culling every pass on
+// its own (one full scan of the objects per pass) with the shared path, where passes
+// on the same frustum share a view and every object is tested against all views in
+// one scan, single threaded and on the thread pool.  The shared results are checked
+// against the per-pass results.
+//
+// Usage: MultiViewCullingBenchmark [objectCount] [frames]
+//***************************************************************************************
+
+#include "../OrbitCamera.h"
+#include "../ThreadPool.h"
+#include "../ViewCuller.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// Frustum of pass p.  With sharedEvery > 1, that many consecutive passes use the
+	// same camera, like a depth prepass and a color pass of one split-screen view.
+	std::vector<OrbitCamera> BuildPassCameras(std::uint32_t passCount, std::uint32_t sharedEvery)
+	{
+		std::vector<OrbitCamera> cameras(passCount);
+		for(std::uint32_t p = 0; p < passCount; ++p)
+		{
+			std::uint32_t view = p / sharedEvery;
+			cameras[p].SetLens(0.25f * XM_PI, 16.0f / 9.0f, 1.0f, 1000.0f);
+			cameras[p].SetOrbit(0.7f * view, 0.35f * XM_PI, 600.0f);
+			cameras[p].Update();
+		}
+		return cameras;
+	}
+
+	// Every pass culls on its own: one scan of all objects per pass.
+	std::uint32_t CullPerPass(const std::vector<OrbitCamera>& cameras, const std::vector<XMFLOAT4>& spheres,
+		std::vector<std::vector<std::uint32_t>>& visible)
+	{
+		std::uint32_t total = 0;
+		visible.resize(cameras.size());
+		for(std::size_t p = 0; p < cameras.size(); ++p)
+		{
+			const XMFLOAT4* planes = cameras[p].GetFrustumPlanes();
+			visible[p].clear();
+			for(std::uint32_t i = 0; i < (std::uint32_t)spheres.size(); ++i)
+			{
+				XMVECTOR center = XMLoadFloat4(&spheres[i]);
+				bool inside = true;
+				for(int k = 0; k < OrbitCamera::PlaneCount && inside; ++k)
+					inside = XMVectorGetX(XMPlaneDotCoord(XMLoadFloat4(&planes[k]), center)) >= -spheres[i].w;
+
+				if(inside)
+					visible[p].push_back(i);
+			}
+			total += (std::uint32_t)visible[p].size();
+		}
+		return total;
+	}
+
+	// Registers each pass's frustum and culls all views in one scan.
+	std::uint32_t CullShared(ViewCuller& culler, const std::vector<OrbitCamera>& cameras,
+		const std::vector<XMFLOAT4>& spheres, std::vector<std::uint32_t>& passViews, ThreadPool* pool)
+	{
+		culler.ClearViews();
+		passViews.resize(cameras.size());
+		for(std::size_t p = 0; p < cameras.size(); ++p)
+			passViews[p] = culler.AddView(cameras[p].GetFrustumPlanes());
+
+		culler.Cull(spheres.data(), (std::uint32_t)spheres.size(), pool);
+
+		std::uint32_t total = 0;
+		for(std::size_t p = 0; p < cameras.size(); ++p)
+			total += (std::uint32_t)culler.GetVisible(passViews[p]).size();
+		return total;
+	}
+
+	template<typename Fn>
+	double TimeMs(std::uint32_t frames, Fn fn)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		for(std::uint32_t i = 0; i < frames; ++i)
+			fn();
+		auto stop = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::milli>(stop - start).count() / frames;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::uint32_t objectCount = argc > 1 ? (std::uint32_t)std::strtoul(argv[1], nullptr, 10) : 500000;
+	std::uint32_t frames = argc > 2 ? (std::uint32_t)std::strtoul(argv[2], nullptr, 10) : 20;
+
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float> offset(-1000.0f, 1000.0f);
+	std::uniform_real_distribution<float> radius(0.5f, 10.0f);
+	std::vector<XMFLOAT4> spheres(objectCount);
+	for(auto& s : spheres)
+		s = XMFLOAT4(offset(rng), 0.1f * offset(rng), offset(rng), radius(rng));
+
+	ThreadPool pool;
+	ViewCuller culler;
+
+	std::printf("%u objects, %u frames, %u threads\n", objectCount, frames, pool.GetThreadCount());
+	std::printf("%-26s %12s %12s %12s %12s\n", "passes (distinct frusta)", "per pass", "shared", "shared+pool", "visible");
+
+	bool ok = true;
+	const std::uint32_t configs[][2] = { { 4, 1 }, { 8, 1 }, { 8, 2 } };
+	for(const auto& config : configs)
+	{
+		std::uint32_t passCount = config[0];
+		std::vector<OrbitCamera> cameras = BuildPassCameras(passCount, config[1]);
+
+		std::vector<std::vector<std::uint32_t>> perPassVisible;
+		std::vector<std::uint32_t> passViews;
+		std::uint32_t perPassTotal = 0;
+		std::uint32_t sharedTotal = 0;
+
+		double perPassMs = TimeMs(frames, [&]() { perPassTotal = CullPerPass(cameras, spheres, perPassVisible); });
+		double sharedMs = TimeMs(frames, [&]() { sharedTotal = CullShared(culler, cameras, spheres, passViews, nullptr); });
+		double pooledMs = TimeMs(frames, [&]() { sharedTotal = CullShared(culler, cameras, spheres, passViews, &pool); });
+
+		for(std::uint32_t p = 0; p < passCount; ++p)
+			ok = ok && perPassVisible[p] == culler.GetVisible(passViews[p]);
+
+		char label[64];
+		std::snprintf(label, sizeof(label), "%u (%u)", passCount, culler.GetViewCount());
+		std::printf("%-26s %9.3f ms %9.3f ms %9.3f ms %12u\n", label, perPassMs, sharedMs, pooledMs, sharedTotal);
+		ok = ok && perPassTotal == sharedTotal;
+	}
+
+	std::printf("%s\n", ok ? "results match" : "RESULTS DIFFER");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+//***************************************************************************************
+// NameLookupBenchmark.cpp
+//
+// Per-frame cost of finding a PSO and a geometry for every draw, by name in a
+// std::unordered_map<std::string, ...> (the way Draw used mPSOs["opaque"]) and by
+// interned handle in a NamedTable.  Sweeps the number of named PSOs and geometries;
+// every frame issues a fixed number of draws that pick them at random.
+//***************************************************************************************
+
+#include "../NameRegistry.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	const int kDrawsPerFrame = 4096;
+
+	struct Resource
+	{
+		int Id = 0;
+	};
+
+	// Names as long as the app's ("opaque_animated_wireframe"), past the small-string
+	// buffer, so looking one up from a literal allocates.
+	std::vector<std::string> MakeNames(const char* prefix, int count)
+	{
+		std::vector<std::string> names;
+		char buffer[64];
+		for(int i = 0; i < count; ++i)
+		{
+			std::snprintf(buffer, sizeof(buffer), "%s_opaque_animated_wireframe_%d", prefix, i);
+			names.push_back(buffer);
+		}
+		return names;
+	}
+
+	struct Scene
+	{
+		std::vector<std::string> PsoNames;
+		std::vector<std::string> GeoNames;
+
+		// What each draw asks for.
+		std::vector<int> DrawPso;
+		std::vector<int> DrawGeo;
+
+		explicit Scene(int count)
+			: PsoNames(MakeNames("pso", count)), GeoNames(MakeNames("geo", count))
+		{
+			std::mt19937 rng(7);
+			std::uniform_int_distribution<int> pick(0, count - 1);
+			for(int i = 0; i < kDrawsPerFrame; ++i)
+			{
+				DrawPso.push_back(pick(rng));
+				DrawGeo.push_back(pick(rng));
+			}
+		}
+	};
+
+	void Finish(benchmark::State& state)
+	{
+		state.SetItemsProcessed(state.iterations() * kDrawsPerFrame * 2);
+		state.counters["draws/frame"] = kDrawsPerFrame;
+	}
+
+	// The old path: the name is a C string at the call site, so every lookup builds a
+	// std::string and hashes it.
+	void BM_StringMapFromLiteral(benchmark::State& state)
+	{
+		Scene scene((int)state.range(0));
+		std::unordered_map<std::string, Resource> psos, geos;
+		for(int i = 0; i < (int)scene.PsoNames.size(); ++i)
+		{
+			psos[scene.PsoNames[i]].Id = i;
+			geos[scene.GeoNames[i]].Id = i;
+		}
+
+		for(auto _ : state)
+		{
+			int sum = 0;
+			for(int d = 0; d < kDrawsPerFrame; ++d)
+			{
+				sum += psos[scene.PsoNames[scene.DrawPso[d]].c_str()].Id;
+				sum += geos[scene.GeoNames[scene.DrawGeo[d]].c_str()].Id;
+			}
+			benchmark::DoNotOptimize(sum);
+		}
+		Finish(state);
+	}
+
+	// Hashing alone: the keys already exist as std::string.
+	void BM_StringMapFromString(benchmark::State& state)
+	{
+		Scene scene((int)state.range(0));
+		std::unordered_map<std::string, Resource> psos, geos;
+		for(int i = 0; i < (int)scene.PsoNames.size(); ++i)
+		{
+			psos[scene.PsoNames[i]].Id = i;
+			geos[scene.GeoNames[i]].Id = i;
+		}
+
+		for(auto _ : state)
+		{
+			int sum = 0;
+			for(int d = 0; d < kDrawsPerFrame; ++d)
+			{
+				sum += psos.find(scene.PsoNames[scene.DrawPso[d]])->second.Id;
+				sum += geos.find(scene.GeoNames[scene.DrawGeo[d]])->second.Id;
+			}
+			benchmark::DoNotOptimize(sum);
+		}
+		Finish(state);
+	}
+
+	// Names resolved once at build time; the frame only indexes arrays.
+	void BM_InternedHandle(benchmark::State& state)
+	{
+		Scene scene((int)state.range(0));
+		NamedTable<Resource> psos, geos;
+		for(int i = 0; i < (int)scene.PsoNames.size(); ++i)
+		{
+			psos[scene.PsoNames[i]].Id = i;
+			geos[scene.GeoNames[i]].Id = i;
+		}
+
+		std::vector<NameRegistry::Handle> drawPso, drawGeo;
+		for(int d = 0; d < kDrawsPerFrame; ++d)
+		{
+			drawPso.push_back(psos.Find(scene.PsoNames[scene.DrawPso[d]]));
+			drawGeo.push_back(geos.Find(scene.GeoNames[scene.DrawGeo[d]]));
+		}
+
+		for(auto _ : state)
+		{
+			int sum = 0;
+			for(int d = 0; d < kDrawsPerFrame; ++d)
+			{
+				sum += psos[drawPso[d]].Id;
+				sum += geos[drawGeo[d]].Id;
+			}
+			benchmark::DoNotOptimize(sum);
+		}
+		Finish(state);
+	}
+}
+
+BENCHMARK(BM_StringMapFromLiteral)->RangeMultiplier(8)->Range(4, 16384);
+BENCHMARK(BM_StringMapFromString)->RangeMultiplier(8)->Range(4, 16384);
+BENCHMARK(BM_InternedHandle)->RangeMultiplier(8)->Range(4, 16384);
+
+BENCHMARK_MAIN();
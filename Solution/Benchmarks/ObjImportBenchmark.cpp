@@ -0,0 +1,155 @@
+//***************************************************************************************
+// ObjImportBenchmark.cpp
+//
+// ObjImporter::Load on OBJ files written here from a GeometryGenerator grid, with
+// v, vt and vn records and v/vt/vn faces the way modelling tools export them.  The
+// files stay on disk (and, after the first run, in the page cache) for the whole
+// process, so the rate is parse-and-weld throughput rather than disk speed.
+//
+// Arguments: approximate file size in MB, and worker threads for the pool (0 for one
+// per hardware thread).  Bytes processed are file bytes, so the rate reads as MB/s of
+// OBJ text.  The grid is written the way a right-handed tool would have it: z, v and
+// the winding mirrored.  Each file is checked once first: every welded vertex the faces
+// use must be the grid vertex at that corner, in the grid's own clockwise order, and
+// there must be exactly as many vertices as the grid has.
+//***************************************************************************************
+
+#include "../ObjImporter.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	// Roughly what a grid vertex costs in the file: its three records and two faces.
+	const double kBytesPerVertex = 230.0;
+
+	struct ObjFile
+	{
+		std::string Path;
+		GeometryGenerator::MeshData Grid;
+	};
+
+	// The files written so far by size; removed when the process exits.
+	class ObjFiles
+	{
+	public:
+		~ObjFiles()
+		{
+			for(auto& file : mFiles)
+				std::remove(file.second.Path.c_str());
+		}
+
+		const ObjFile* Get(uint32 megabytes)
+		{
+			auto found = mFiles.find(megabytes);
+			if(found != mFiles.end())
+				return &found->second;
+
+			ObjFile file;
+			file.Path = "ObjImportBenchmark_" + std::to_string(megabytes) + ".obj";
+
+			uint32 side = (uint32)std::sqrt(megabytes * 1024.0 * 1024.0 / kBytesPerVertex);
+			GeometryGenerator geoGen;
+			file.Grid = geoGen.CreateGrid(160.0f, 160.0f, side, side);
+			if(!Write(file))
+				return nullptr;
+
+			return &(mFiles[megabytes] = std::move(file));
+		}
+
+	private:
+		static bool Write(const ObjFile& file)
+		{
+			std::FILE* out = std::fopen(file.Path.c_str(), "wb");
+			if(out == nullptr)
+				return false;
+
+			// Right-handed and counter-clockwise, so the importer's conversion has to give
+			// the grid back as it is.
+			std::fprintf(out, "# %u vertices\no grid\n", (uint32)file.Grid.Vertices.size());
+			for(const GeometryGenerator::Vertex& v : file.Grid.Vertices)
+			{
+				std::fprintf(out, "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n",
+					v.Position.x, v.Position.y, -v.Position.z, v.TexC.x, 1.0f - v.TexC.y, v.Normal.x, v.Normal.y, -v.Normal.z);
+			}
+
+			const std::vector<uint32>& indices = file.Grid.Indices32;
+			for(std::size_t i = 0; i + 2 < indices.size(); i += 3)
+			{
+				uint32 a = indices[i] + 1, b = indices[i + 2] + 1, c = indices[i + 1] + 1;
+				std::fprintf(out, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c);
+			}
+			return std::fclose(out) == 0;
+		}
+
+		std::map<uint32, ObjFile> mFiles;
+	};
+
+	ObjFiles gFiles;
+
+	bool Near(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+	{
+		return std::fabs(a.x - b.x) <= 1e-4f && std::fabs(a.y - b.y) <= 1e-4f && std::fabs(a.z - b.z) <= 1e-4f;
+	}
+
+	bool Matches(const GeometryGenerator::MeshData& mesh, const GeometryGenerator::MeshData& grid)
+	{
+		if(mesh.Vertices.size() != grid.Vertices.size() || mesh.Indices32.size() != grid.Indices32.size())
+			return false;
+
+		// Corner by corner, so a triangle that comes back the other way round fails.
+		for(std::size_t i = 0; i < grid.Indices32.size(); ++i)
+		{
+			const GeometryGenerator::Vertex& v = mesh.Vertices[mesh.Indices32[i]];
+			const GeometryGenerator::Vertex& w = grid.Vertices[grid.Indices32[i]];
+			if(!Near(v.Position, w.Position) || !Near(v.Normal, w.Normal) ||
+				std::fabs(v.TexC.x - w.TexC.x) > 1e-4f || std::fabs(v.TexC.y - w.TexC.y) > 1e-4f)
+				return false;
+		}
+		return true;
+	}
+
+	void BM_LoadObj(benchmark::State& state)
+	{
+		const ObjFile* file = gFiles.Get((uint32)state.range(0));
+		if(file == nullptr)
+		{
+			state.SkipWithError("could not write the OBJ file");
+			return;
+		}
+
+		ThreadPool pool((uint32)state.range(1));
+		GeometryGenerator::MeshData mesh;
+		ObjImporter::Stats stats;
+		if(!ObjImporter::Load(file->Path.c_str(), mesh, pool, ObjImporter::Options(), &stats) ||
+			stats.MalformedLines != 0 || !Matches(mesh, file->Grid))
+		{
+			state.SkipWithError("imported mesh does not match the grid");
+			return;
+		}
+
+		for(auto _ : state)
+		{
+			ObjImporter::Load(file->Path.c_str(), mesh, pool);
+			benchmark::DoNotOptimize(mesh.Vertices.data());
+		}
+
+		state.SetBytesProcessed((int64_t)(state.iterations() * stats.FileBytes));
+		state.counters["file_mb"] = stats.FileBytes / (1024.0 * 1024.0);
+		state.counters["triangles"] = stats.Triangles;
+		state.counters["vertices"] = stats.Vertices;
+	}
+}
+
+BENCHMARK(BM_LoadObj)->Args({ 16, 0 })->Args({ 256, 0 })->Args({ 256, 3 })->Args({ 256, 7 })
+	->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
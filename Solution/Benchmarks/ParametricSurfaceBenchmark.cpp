@@ -0,0 +1,172 @@
+//***************************************************************************************
+// ParametricSurfaceBenchmark.cpp
+//
+// The ParametricSurface tessellator against the hand-written builders it can replace,
+// shape by shape, at slices = stacks = the second argument:
+//
+//   Sphere, Cylinder, Cone   GeometryGenerator::Create* (hand-written: first argument 0)
+//                            against ParametricSurface on one thread (1) and with rows
+//                            shared out to a pool (2).
+//   Torus                    The loop CreateTorus used to be (commented out) against the
+//                            same.
+//   Superellipsoid           ParametricSurface only, rounded-box exponents.
+//
+// Items processed are vertices.  Tests/ParametricSurfaceTest.cpp checks the meshes.
+//***************************************************************************************
+
+#include "../GeometryGenerator.h"
+#include "../ParametricSurface.h"
+#include "../ThreadPool.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using MeshData = GeometryGenerator::MeshData;
+
+	enum Shape { ShapeSphere, ShapeCylinder, ShapeCone, ShapeTorus, ShapeSuperellipsoid };
+
+	const float kRadius = 2.0f;
+	const float kHeight = 3.0f;
+	const float kTubeRadius = 0.5f;
+
+	// What CreateTorus was before ParametricSurface, uncommented.
+	MeshData CreateHandTorus(float outerRadius, float innerRadius, uint32 sliceCount, uint32 stackCount)
+	{
+		MeshData meshData;
+
+		float thetaStep = 2.0f * XM_PI / sliceCount;
+		float phiStep = 2.0f * XM_PI / stackCount;
+
+		for(uint32 i = 0; i <= stackCount; ++i)
+		{
+			float phi = i * phiStep;
+			for(uint32 j = 0; j <= sliceCount; ++j)
+			{
+				float theta = j * thetaStep;
+
+				GeometryGenerator::Vertex v;
+				v.Position.x = (outerRadius + innerRadius * cosf(phi)) * cosf(theta);
+				v.Position.y = innerRadius * sinf(phi);
+				v.Position.z = (outerRadius + innerRadius * cosf(phi)) * sinf(theta);
+
+				v.Normal.x = cosf(phi) * cosf(theta);
+				v.Normal.y = sinf(phi);
+				v.Normal.z = cosf(phi) * sinf(theta);
+
+				XMVECTOR p = XMLoadFloat3(&v.Position);
+				XMVECTOR n = XMLoadFloat3(&v.Normal);
+				XMStoreFloat3(&v.TangentU, XMVector3Normalize(XMVector3Cross(p, n)));
+
+				v.TexC.x = theta / XM_2PI;
+				v.TexC.y = phi / XM_2PI;
+
+				meshData.Vertices.push_back(v);
+			}
+		}
+
+		for(uint32 i = 0; i < stackCount; ++i)
+		{
+			for(uint32 j = 0; j < sliceCount; ++j)
+			{
+				meshData.Indices32.push_back(i * (sliceCount + 1) + j);
+				meshData.Indices32.push_back(i * (sliceCount + 1) + j + 1);
+				meshData.Indices32.push_back((i + 1) * (sliceCount + 1) + j);
+
+				meshData.Indices32.push_back((i + 1) * (sliceCount + 1) + j);
+				meshData.Indices32.push_back(i * (sliceCount + 1) + j + 1);
+				meshData.Indices32.push_back((i + 1) * (sliceCount + 1) + j + 1);
+			}
+		}
+
+		return meshData;
+	}
+
+	MeshData BuildHand(Shape shape, uint32 n)
+	{
+		GeometryGenerator geoGen;
+		switch(shape)
+		{
+		case ShapeSphere: return geoGen.CreateSphere(kRadius, n, n);
+		case ShapeCylinder: return geoGen.CreateCylinder(kRadius, 0.5f * kRadius, kHeight, n, n);
+		case ShapeCone: return geoGen.CreateCone(kRadius, 0.0f, kRadius, kHeight, n, n);
+		default: return CreateHandTorus(kRadius, kTubeRadius, n, n);
+		}
+	}
+
+	MeshData BuildParametric(Shape shape, uint32 n, ThreadPool* pool)
+	{
+		MeshData mesh;
+		ShapeWriter::GeneratorVertexWriter writer;
+		switch(shape)
+		{
+		case ShapeSphere:
+			ParametricSurface::Append(mesh.Vertices, mesh.Indices32, writer, ParametricSurface::Sphere{ kRadius }, n, n, pool);
+			break;
+		case ShapeCylinder:
+			ParametricSurface::AppendCylinder(mesh.Vertices, mesh.Indices32, writer, kRadius, 0.5f * kRadius, kHeight, n, n, pool);
+			break;
+		case ShapeCone:
+			ParametricSurface::AppendCone(mesh.Vertices, mesh.Indices32, writer, kRadius, kHeight, n, n, pool);
+			break;
+		case ShapeTorus:
+			ParametricSurface::Append(mesh.Vertices, mesh.Indices32, writer, ParametricSurface::Torus{ kRadius, kTubeRadius }, n, n, pool);
+			break;
+		default:
+		{
+			ParametricSurface::Superellipsoid box{ XMFLOAT3(kRadius, 0.5f * kHeight, kRadius), 0.3f, 0.3f };
+			ParametricSurface::Append(mesh.Vertices, mesh.Indices32, writer, box, n, n, pool);
+			break;
+		}
+		}
+		return mesh;
+	}
+
+	void BM_Tessellate(benchmark::State& state, Shape shape)
+	{
+		int64_t path = state.range(0);
+		uint32 n = (uint32)state.range(1);
+		ThreadPool pool;
+
+		std::size_t vertexCount = 0;
+		for(auto _ : state)
+		{
+			MeshData mesh = path == 0 ? BuildHand(shape, n) : BuildParametric(shape, n, path == 2 ? &pool : nullptr);
+			vertexCount = mesh.Vertices.size();
+			benchmark::DoNotOptimize(mesh.Vertices.data());
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed((int64_t)(state.iterations() * vertexCount));
+		state.SetLabel(path == 0 ? "hand-written" : path == 1 ? "parametric" : "parametric, pool");
+		state.counters["threads"] = path == 2 ? pool.GetThreadCount() : 1;
+	}
+
+	void Paths(benchmark::internal::Benchmark* b, bool hasHandWritten)
+	{
+		for(int64_t n : { 64, 512, 2048 })
+		{
+			for(int64_t path = hasHandWritten ? 0 : 1; path <= 2; ++path)
+				b->Args({ path, n });
+		}
+	}
+}
+
+BENCHMARK_CAPTURE(BM_Tessellate, Sphere, ShapeSphere)->Apply([](benchmark::internal::Benchmark* b) { Paths(b, true); })
+	->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Tessellate, Cylinder, ShapeCylinder)->Apply([](benchmark::internal::Benchmark* b) { Paths(b, true); })
+	->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Tessellate, Cone, ShapeCone)->Apply([](benchmark::internal::Benchmark* b) { Paths(b, true); })
+	->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Tessellate, Torus, ShapeTorus)->Apply([](benchmark::internal::Benchmark* b) { Paths(b, true); })
+	->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Tessellate, Superellipsoid, ShapeSuperellipsoid)->Apply([](benchmark::internal::Benchmark* b) { Paths(b, false); })
+	->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,221 @@
+//***************************************************************************************
+// PlanetTerrainBenchmark.cpp
+//
+// PlanetTerrain along a headless camera path: an OrbitCamera looking at the planet's
+// center, spiralling in from three radii out to a few hundred meters above the ground.
+//
+//   BM_Select    Update alone, with every mesh of the path already resident: the cost
+//                of selection, balancing and stitching per frame.
+//   BM_Generate  A fresh terrain flown along the path, each frame waiting for its
+//                meshes (Finish), so the time is dominated by mesh generation.
+//                Arguments: worker threads (0 for one per hardware thread) and the
+//                memory budget in MB.  Items processed are generated meshes.
+//
+// Before timing, a few frames of the path are checked without frustum culling: the
+// drawn nodes must cover the sphere without cracks or T-junctions (every triangle edge,
+// by its exact end positions, is used once each way), both before and after the frame's
+// meshes are in, and the cache must stay within its budget.
+//***************************************************************************************
+
+#include "../OrbitCamera.h"
+#include "../PlanetTerrain.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	const float kRadius = 6000.0f;
+	const float kMaxHeight = 60.0f;
+	const uint32 kPathFrames = 64;
+
+	float Height(const XMFLOAT3& d)
+	{
+		float h = std::sin(d.x * 23.0f + d.y * 7.0f) * std::cos(d.z * 17.0f - d.x * 5.0f) * 0.6f
+			+ std::sin(d.y * 61.0f + d.z * 41.0f) * 0.3f
+			+ std::sin(d.z * 173.0f + d.x * 131.0f) * 0.1f;
+		return h * kMaxHeight;
+	}
+
+	PlanetTerrain::Desc MakeDesc(uint64 budgetMB)
+	{
+		PlanetTerrain::Desc desc;
+		desc.Radius = kRadius;
+		desc.Height = Height;
+		desc.MaxHeight = kMaxHeight;
+		desc.GridSize = 32;
+		desc.MaxLevel = 12;
+		desc.MemoryBudget = budgetMB << 20;
+		return desc;
+	}
+
+	// Frame f of the path: altitude falls geometrically from 2 radii to 300 m while the
+	// camera goes a third of the way round.
+	void PlaceCamera(OrbitCamera& camera, uint32 frame)
+	{
+		float t = (float)frame / (float)(kPathFrames - 1);
+		float altitude = 2.0f * kRadius * std::pow(300.0f / (2.0f * kRadius), t);
+		camera.SetOrbit(0.3f + t * XM_2PI / 3.0f, 0.4f * XM_PI + t * 0.2f, kRadius + altitude);
+		camera.SetLens(0.25f * XM_PI, 16.0f / 9.0f, 1.0f, 4.0f * kRadius);
+		camera.Update();
+	}
+
+	struct PositionKey
+	{
+		float P[3];
+		bool operator==(const PositionKey& rhs)const { return std::memcmp(P, rhs.P, sizeof(P)) == 0; }
+	};
+
+	struct EdgeKey
+	{
+		PositionKey A;
+		PositionKey B;
+		bool operator==(const EdgeKey& rhs)const { return A == rhs.A && B == rhs.B; }
+	};
+
+	struct EdgeHash
+	{
+		std::size_t operator()(const EdgeKey& e)const
+		{
+			uint32 bits[6];
+			std::memcpy(bits, &e, sizeof(bits));
+			std::size_t h = 0;
+			for(uint32 b : bits)
+				h = h * 0x9E3779B1u + b;
+			return h;
+		}
+	};
+
+	bool IsWatertight(const PlanetTerrain& terrain)
+	{
+		std::unordered_map<EdgeKey, int, EdgeHash> edges;
+		for(const PlanetTerrain::DrawNode& node : terrain.GetDrawNodes())
+		{
+			const std::vector<PlanetTerrain::uint16>& indices = terrain.GetIndices(node.StitchMask);
+			for(std::size_t i = 0; i < indices.size(); i += 3)
+			{
+				for(int k = 0; k < 3; ++k)
+				{
+					const XMFLOAT3& a = node.Vertices[indices[i + k]].Position;
+					const XMFLOAT3& b = node.Vertices[indices[i + (k + 1) % 3]].Position;
+					EdgeKey edge = { { { a.x, a.y, a.z } }, { { b.x, b.y, b.z } } };
+					EdgeKey reverse = { edge.B, edge.A };
+					++edges[edge];
+					--edges[reverse];
+				}
+			}
+		}
+
+		// Each edge one way cancels the same edge the other way.
+		for(const auto& edge : edges)
+		{
+			if(edge.second != 0)
+				return false;
+		}
+		return true;
+	}
+
+	const char* CheckPath()
+	{
+		ThreadPool pool(0);
+		PlanetTerrain::Desc desc = MakeDesc(256);
+		desc.MaxLevel = 10;
+		PlanetTerrain terrain(pool, desc);
+
+		OrbitCamera camera;
+		for(uint32 frame = 0; frame < kPathFrames; frame += 9)
+		{
+			PlaceCamera(camera, frame);
+
+			// Partly generated, then complete.
+			terrain.Update(camera.GetPosition());
+			if(!IsWatertight(terrain))
+				return "partly generated terrain has cracks";
+			terrain.Finish();
+			if(!IsWatertight(terrain))
+				return "terrain has cracks";
+			if(terrain.GetStats().MissingNodes != 0)
+				return "terrain not fully generated";
+			if(terrain.GetStats().ResidentBytes > desc.MemoryBudget)
+				return "terrain cache over budget";
+		}
+		return nullptr;
+	}
+
+	void BM_Select(benchmark::State& state)
+	{
+		if(const char* error = CheckPath())
+		{
+			state.SkipWithError(error);
+			return;
+		}
+
+		ThreadPool pool(0);
+		PlanetTerrain terrain(pool, MakeDesc(4096));
+		OrbitCamera camera;
+		for(uint32 frame = 0; frame < kPathFrames; ++frame)
+		{
+			PlaceCamera(camera, frame);
+			terrain.Update(camera.GetPosition(), camera.GetFrustumPlanes());
+			terrain.Finish();
+		}
+
+		uint32 frame = 0;
+		uint64 drawNodes = 0;
+		for(auto _ : state)
+		{
+			state.PauseTiming();
+			PlaceCamera(camera, frame);
+			frame = (frame + 1) % kPathFrames;
+			state.ResumeTiming();
+
+			terrain.Update(camera.GetPosition(), camera.GetFrustumPlanes());
+			drawNodes += terrain.GetStats().DrawNodes;
+		}
+
+		state.SetItemsProcessed((int64_t)state.iterations());
+		state.counters["drawNodes"] = (double)drawNodes / (double)state.iterations();
+		state.counters["missing"] = terrain.GetStats().MissingNodes;
+	}
+
+	void BM_Generate(benchmark::State& state)
+	{
+		ThreadPool pool((uint32)state.range(0));
+		PlanetTerrain::Desc desc = MakeDesc((uint64)state.range(1));
+
+		OrbitCamera camera;
+		uint64 generated = 0, evicted = 0;
+		for(auto _ : state)
+		{
+			PlanetTerrain terrain(pool, desc);
+			for(uint32 frame = 0; frame < kPathFrames; ++frame)
+			{
+				PlaceCamera(camera, frame);
+				terrain.Update(camera.GetPosition(), camera.GetFrustumPlanes());
+				terrain.Finish();
+			}
+			generated += terrain.GetStats().Generated;
+			evicted += terrain.GetStats().Evicted;
+		}
+
+		state.SetItemsProcessed((int64_t)generated);
+		state.counters["meshes"] = (double)generated / (double)state.iterations();
+		state.counters["evicted"] = (double)evicted / (double)state.iterations();
+		state.counters["threads"] = pool.GetThreadCount();
+	}
+}
+
+BENCHMARK(BM_Select)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Generate)->Args({ 0, 256 })->Args({ 3, 256 })->Args({ 0, 16 })
+	->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
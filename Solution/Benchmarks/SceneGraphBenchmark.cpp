@@ -0,0 +1,134 @@
+//***************************************************************************************
+// SceneGraphBenchmark.cpp
+//
+// Headless benchmark for SceneGraph::Update.  Builds a 1M node hierarchy, moves a small
+// fraction of the nodes every frame and reports the average update time, single
+// threaded and on the thread pool, next to a full recompute of every node.
+//
+// Usage: SceneGraphBenchmark [nodeCount] [movingPercent] [frames]
+//***************************************************************************************
+
+#include "../SceneGraph.h"
+#include "../ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	struct Result
+	{
+		double MsPerFrame = 0.0;
+		double RecomputedPerFrame = 0.0;
+	};
+
+	// Roots get a random placement; deeper levels pick a random parent from the level
+	// above, so the fan-out grows towards the leaves like a typical scene.
+	std::vector<SceneGraph::NodeHandle> BuildHierarchy(SceneGraph& graph, std::uint32_t nodeCount, std::mt19937& rng)
+	{
+		std::uniform_real_distribution<float> offset(-10.0f, 10.0f);
+		std::vector<SceneGraph::NodeHandle> nodes;
+		nodes.reserve(nodeCount);
+
+		std::uint32_t rootCount = std::max<std::uint32_t>(nodeCount / 1000, 1);
+		std::vector<SceneGraph::NodeHandle> prevLevel;
+		for(std::uint32_t i = 0; i < rootCount && nodes.size() < nodeCount; ++i)
+		{
+			auto node = graph.CreateNode(SceneGraph::InvalidNode, XMMatrixTranslation(offset(rng), 0.0f, offset(rng)));
+			nodes.push_back(node);
+			prevLevel.push_back(node);
+		}
+
+		while(nodes.size() < nodeCount)
+		{
+			std::vector<SceneGraph::NodeHandle> level;
+			std::uint32_t levelSize = (std::uint32_t)prevLevel.size() * 4;
+			std::uniform_int_distribution<std::size_t> pick(0, prevLevel.size() - 1);
+			for(std::uint32_t i = 0; i < levelSize && nodes.size() < nodeCount; ++i)
+			{
+				XMMATRIX local = XMMatrixScaling(0.9f, 0.9f, 0.9f) * XMMatrixTranslation(offset(rng), offset(rng), offset(rng));
+				auto node = graph.CreateNode(prevLevel[pick(rng)], local);
+				nodes.push_back(node);
+				level.push_back(node);
+			}
+			prevLevel.swap(level);
+		}
+
+		return nodes;
+	}
+
+	Result Run(SceneGraph& graph, const std::vector<SceneGraph::NodeHandle>& nodes,
+		std::uint32_t movingCount, std::uint32_t frames, ThreadPool* pool, bool moveAll)
+	{
+		std::mt19937 rng(1234);
+		std::uniform_int_distribution<std::size_t> pick(0, nodes.size() - 1);
+
+		Result result;
+		double totalMs = 0.0;
+		double totalRecomputed = 0.0;
+		for(std::uint32_t frame = 0; frame < frames; ++frame)
+		{
+			float angle = 0.01f * (frame + 1);
+
+			if(moveAll)
+			{
+				for(auto node : nodes)
+					graph.SetLocal(node, graph.GetLocal(node));
+			}
+			else
+			{
+				for(std::uint32_t i = 0; i < movingCount; ++i)
+				{
+					auto node = nodes[pick(rng)];
+					XMMATRIX local = XMMatrixRotationY(angle) * XMLoadFloat4x4(&graph.GetLocal(node));
+					graph.SetLocal(node, local);
+				}
+			}
+
+			auto start = std::chrono::high_resolution_clock::now();
+			totalRecomputed += graph.Update(pool);
+			auto stop = std::chrono::high_resolution_clock::now();
+
+			totalMs += std::chrono::duration<double, std::milli>(stop - start).count();
+		}
+
+		result.MsPerFrame = totalMs / frames;
+		result.RecomputedPerFrame = totalRecomputed / frames;
+		return result;
+	}
+
+	void Print(const char* name, const Result& r)
+	{
+		std::printf("%-28s %10.3f ms/frame %12.0f recomputed/frame\n", name, r.MsPerFrame, r.RecomputedPerFrame);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::uint32_t nodeCount = argc > 1 ? (std::uint32_t)std::strtoul(argv[1], nullptr, 10) : 1000000;
+	double movingPercent = argc > 2 ? std::strtod(argv[2], nullptr) : 1.0;
+	std::uint32_t frames = argc > 3 ? (std::uint32_t)std::strtoul(argv[3], nullptr, 10) : 100;
+
+	std::mt19937 rng(42);
+	SceneGraph graph;
+	auto nodes = BuildHierarchy(graph, nodeCount, rng);
+	graph.Update();
+
+	ThreadPool pool;
+	std::uint32_t movingCount = (std::uint32_t)(nodeCount * movingPercent / 100.0);
+
+	std::printf("%u nodes, %u levels, %u moving per frame (%.2f%%), %u frames, %u threads\n",
+		graph.GetNodeCount(), graph.GetDepthCount(), movingCount, movingPercent, frames, pool.GetThreadCount());
+
+	Print("dirty subset, 1 thread", Run(graph, nodes, movingCount, frames, nullptr, false));
+	Print("dirty subset, thread pool", Run(graph, nodes, movingCount, frames, &pool, false));
+	Print("full recompute, 1 thread", Run(graph, nodes, movingCount, frames / 10 + 1, nullptr, true));
+	Print("full recompute, thread pool", Run(graph, nodes, movingCount, frames / 10 + 1, &pool, true));
+
+	return 0;
+}
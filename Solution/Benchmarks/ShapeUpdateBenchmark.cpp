@@ -0,0 +1,177 @@
+//***************************************************************************************
+// ShapeUpdateBenchmark.cpp
+//
+// A frame of 64 animated shapes (spheres, capped cylinders, grids and parametric tori)
+// that change radius, height or width every frame without changing their slices and
+// stacks.  All of them share one vertex and one index buffer, uploaded through a
+// StagingUploader to plain memory standing in for the default heap:
+//
+//   BM_Regenerate  Clears the buffers, appends every shape again with the new
+//                  parameters and uploads both buffers whole, which is what
+//                  rebuilding the MeshData costs.
+//   BM_Update      Rewrites each shape's vertices in place with ShapeWriter::Update*
+//                  and ParametricSurface::Update and uploads the DirtyRanges they
+//                  return; the index buffer is never touched again.
+//
+// The argument is the tessellation: slices around each shape.  Items processed are
+// vertices.  Tests/ShapeUpdateTest.cpp checks the updates on the same scene.
+//***************************************************************************************
+
+#include "../ParametricSurface.h"
+#include "../ShapeWriter.h"
+#include "../SimulatedCopyQueue.h"
+#include "../StagingUploader.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+	using Vertex = GeometryGenerator::Vertex;
+
+	const uint32 kShapeCount = 64;
+	const uint64 kRingBytes = 16 * 1024 * 1024;
+	const float kTimeStep = 1.0f / 60.0f;
+
+	// One animated scene in one concatenated vertex and index buffer.
+	struct Scene
+	{
+		uint32 Slices = 0;
+		std::vector<Vertex> Vertices;
+		std::vector<uint32> Indices;
+		std::vector<ShapeWriter::Range> Ranges;
+
+		explicit Scene(uint32 slices)
+			: Slices(slices)
+		{
+		}
+
+		// Shape i's size at time t.
+		static float GetScale(uint32 shape, float t)
+		{
+			return 1.0f + 0.25f * std::sin(2.0f * t + 0.37f * shape);
+		}
+
+		void Build(float t)
+		{
+			Vertices.clear();
+			Indices.clear();
+			Ranges.clear();
+
+			ShapeWriter::GeneratorVertexWriter writer;
+			for(uint32 shape = 0; shape < kShapeCount; ++shape)
+			{
+				float s = GetScale(shape, t);
+				switch(shape % 4)
+				{
+				case 0:
+					Ranges.push_back(ShapeWriter::AppendSphere(Vertices, Indices, writer, s, Slices, Slices / 2));
+					break;
+				case 1:
+					Ranges.push_back(ShapeWriter::AppendCylinder(Vertices, Indices, writer, s, 0.5f * s, 2.0f / s, Slices, Slices / 4));
+					break;
+				case 2:
+					Ranges.push_back(ShapeWriter::AppendGrid(Vertices, Indices, writer, 4.0f * s, 4.0f, Slices / 2, Slices / 2));
+					break;
+				default:
+					Ranges.push_back(ParametricSurface::Append(Vertices, Indices, writer,
+						ParametricSurface::Torus{ s, 0.25f * s }, Slices, Slices / 2));
+					break;
+				}
+			}
+		}
+
+		ShapeWriter::DirtyRange Update(uint32 shape, float t, uint32 slices)
+		{
+			ShapeWriter::GeneratorVertexWriter writer;
+			const ShapeWriter::Range& range = Ranges[shape];
+			float s = GetScale(shape, t);
+			switch(shape % 4)
+			{
+			case 0:
+				return ShapeWriter::UpdateSphere(Vertices.data(), range, writer, s, slices, slices / 2);
+			case 1:
+				return ShapeWriter::UpdateCylinder(Vertices.data(), range, writer, s, 0.5f * s, 2.0f / s, slices, slices / 4);
+			case 2:
+				return ShapeWriter::UpdateGrid(Vertices.data(), range, writer, 4.0f * s, 4.0f, slices / 2, slices / 2);
+			default:
+				return ParametricSurface::Update(Vertices.data(), range, writer,
+					ParametricSurface::Torus{ s, 0.25f * s }, slices, slices / 2);
+			}
+		}
+	};
+
+	// Regenerating or updating a frame, then uploading, through one ring.
+	template<typename FrameFn>
+	void RunFrames(benchmark::State& state, Scene& scene, const FrameFn& frame)
+	{
+		std::vector<Vertex> vertexBuffer(scene.Vertices.size());
+		std::vector<uint32> indexBuffer(scene.Indices.size());
+		std::unique_ptr<std::uint8_t[]> staging(new std::uint8_t[(std::size_t)kRingBytes]);
+		SimulatedCopyQueue queue(staging.get());
+
+		StagingUploader::Stats stats;
+		{
+			StagingUploader uploader(queue, staging.get(), kRingBytes);
+			uploader.Upload(indexBuffer.data(), 0, scene.Indices.data(), scene.Indices.size() * sizeof(uint32));
+
+			float t = 0.0f;
+			for(auto _ : state)
+			{
+				t += kTimeStep;
+				frame(uploader, vertexBuffer.data(), indexBuffer.data(), t);
+				uploader.Flush();
+				uploader.EndFrame();
+			}
+
+			uploader.WaitIdle();
+			stats = uploader.GetStats();
+		}
+
+		state.SetItemsProcessed((int64_t)(state.iterations() * scene.Vertices.size()));
+		state.counters["upload_bytes_per_frame"] = stats.Frames > 0 ? (double)stats.TotalBytes / stats.Frames : 0.0;
+		state.counters["vertices"] = (double)scene.Vertices.size();
+	}
+
+	void BM_Regenerate(benchmark::State& state)
+	{
+		uint32 slices = (uint32)state.range(0);
+		Scene scene(slices);
+		scene.Build(0.0f);
+
+		RunFrames(state, scene, [&](StagingUploader& uploader, Vertex* vertexBuffer, uint32* indexBuffer, float t)
+		{
+			scene.Build(t);
+			uploader.Upload(vertexBuffer, 0, scene.Vertices.data(), scene.Vertices.size() * sizeof(Vertex));
+			uploader.Upload(indexBuffer, 0, scene.Indices.data(), scene.Indices.size() * sizeof(uint32));
+		});
+	}
+
+	void BM_Update(benchmark::State& state)
+	{
+		uint32 slices = (uint32)state.range(0);
+		Scene scene(slices);
+		scene.Build(0.0f);
+
+		RunFrames(state, scene, [&](StagingUploader& uploader, Vertex* vertexBuffer, uint32*, float t)
+		{
+			const std::uint8_t* source = reinterpret_cast<const std::uint8_t*>(scene.Vertices.data());
+			for(uint32 shape = 0; shape < kShapeCount; ++shape)
+			{
+				ShapeWriter::DirtyRange dirty = scene.Update(shape, t, slices);
+				uploader.Upload(vertexBuffer, dirty.Offset, source + dirty.Offset, dirty.Size);
+			}
+		});
+	}
+}
+
+BENCHMARK(BM_Regenerate)->Arg(32)->Arg(128)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Update)->Arg(32)->Arg(128)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
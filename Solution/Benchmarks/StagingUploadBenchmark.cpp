@@ -0,0 +1,165 @@
+//***************************************************************************************
+// StagingUploadBenchmark.cpp
+//
+// Streams a number of meshes per frame to destination buffers, with plain memory
+// standing in for the upload and default heaps and a SimulatedCopyQueue standing in
+// for the copy engine and its fence:
+//
+//   PerGeometry  One staging buffer allocated per mesh, the way d3dUtil::CreateDefaultBuffer
+//                makes an uploader per call, released after kNumFrameResources frames
+//                once the frame fence has certainly passed.
+//   Ring         StagingUploader through one persistently mapped ring, one batch per
+//                frame, staging space released by the copy fence.
+//
+// Arguments are meshes per frame, KB per mesh and, for the ring, its size in KB.  The
+// counters report upload bytes per frame, peak staging memory, staging allocations per
+// frame and, for the ring, how often an upload waited for the copy engine.  Both paths
+// check every destination against its source once the copies have drained.
+//***************************************************************************************
+
+#include "../SimulatedCopyQueue.h"
+#include "../StagingUploader.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	// As in the apps: a frame's resources are free once this many later frames started.
+	const int kNumFrameResources = 3;
+
+	struct Meshes
+	{
+		std::vector<std::vector<std::uint8_t>> Sources;
+		std::vector<std::vector<std::uint8_t>> Destinations;
+
+		Meshes(uint32 count, uint64 byteSize)
+			: Sources(count), Destinations(count)
+		{
+			for(uint32 m = 0; m < count; ++m)
+			{
+				Sources[m].resize((std::size_t)byteSize);
+				for(std::size_t b = 0; b < Sources[m].size(); ++b)
+					Sources[m][b] = (std::uint8_t)(b * 31 + m * 7);
+				Destinations[m].assign((std::size_t)byteSize, 0);
+			}
+		}
+
+		bool Verify()const
+		{
+			for(std::size_t m = 0; m < Sources.size(); ++m)
+			{
+				if(Sources[m] != Destinations[m])
+					return false;
+			}
+			return true;
+		}
+	};
+
+	void BM_UploadPerGeometry(benchmark::State& state)
+	{
+		uint32 meshCount = (uint32)state.range(0);
+		uint64 meshBytes = (uint64)state.range(1) * 1024;
+		Meshes meshes(meshCount, meshBytes);
+
+		// Staging buffers in flight, by the frame that created them.
+		std::deque<std::vector<std::unique_ptr<std::uint8_t[]>>> inFlight;
+		uint64 staged = 0;
+		uint64 peakStaged = 0;
+		uint64 allocations = 0;
+
+		for(auto _ : state)
+		{
+			std::vector<std::unique_ptr<std::uint8_t[]>> frame;
+			for(uint32 m = 0; m < meshCount; ++m)
+			{
+				// CreateCommittedResource on the upload heap, Map and CopyMemory...
+				std::unique_ptr<std::uint8_t[]> uploader(new std::uint8_t[(std::size_t)meshBytes]);
+				std::memcpy(uploader.get(), meshes.Sources[m].data(), (std::size_t)meshBytes);
+				++allocations;
+
+				// ...and CopyBufferRegion into the default heap.
+				std::memcpy(meshes.Destinations[m].data(), uploader.get(), (std::size_t)meshBytes);
+
+				frame.push_back(std::move(uploader));
+				staged += meshBytes;
+			}
+			inFlight.push_back(std::move(frame));
+			peakStaged = std::max(peakStaged, staged);
+
+			if(inFlight.size() > (std::size_t)kNumFrameResources)
+			{
+				staged -= inFlight.front().size() * meshBytes;
+				inFlight.pop_front();
+			}
+			benchmark::ClobberMemory();
+		}
+
+		if(!meshes.Verify())
+			state.SkipWithError("destination does not match source");
+
+		double frames = (double)state.iterations();
+		state.SetBytesProcessed((int64_t)(state.iterations() * meshCount * meshBytes));
+		state.counters["upload_bytes_per_frame"] = (double)(meshCount * meshBytes);
+		state.counters["peak_staging_bytes"] = (double)peakStaged;
+		state.counters["staging_allocs_per_frame"] = allocations / frames;
+	}
+
+	void BM_UploadRing(benchmark::State& state)
+	{
+		uint32 meshCount = (uint32)state.range(0);
+		uint64 meshBytes = (uint64)state.range(1) * 1024;
+		uint64 ringBytes = (uint64)state.range(2) * 1024;
+		Meshes meshes(meshCount, meshBytes);
+
+		std::unique_ptr<std::uint8_t[]> staging(new std::uint8_t[(std::size_t)ringBytes]);
+		SimulatedCopyQueue queue(staging.get());
+
+		StagingUploader::Stats stats;
+		{
+			StagingUploader uploader(queue, staging.get(), ringBytes);
+
+			for(auto _ : state)
+			{
+				for(uint32 m = 0; m < meshCount; ++m)
+					uploader.Upload(meshes.Destinations[m].data(), 0, meshes.Sources[m].data(), meshBytes);
+
+				uploader.Flush();
+				uploader.EndFrame();
+			}
+
+			uploader.WaitIdle();
+			stats = uploader.GetStats();
+		}
+
+		if(!meshes.Verify())
+			state.SkipWithError("destination does not match source");
+
+		double frames = (double)state.iterations();
+		state.SetBytesProcessed((int64_t)stats.TotalBytes);
+		state.counters["upload_bytes_per_frame"] = stats.Frames > 0 ? (double)stats.TotalBytes / stats.Frames : 0.0;
+		state.counters["peak_staging_bytes"] = (double)stats.PeakStagingBytes;
+		state.counters["staging_allocs_per_frame"] = 0;
+		state.counters["batches_per_frame"] = stats.Batches / frames;
+		state.counters["stalls_per_frame"] = stats.Stalls / frames;
+	}
+}
+
+// 16 meshes of 64 KB and 64 meshes of 16 KB per frame (1 MB), then a 16 MB frame.
+BENCHMARK(BM_UploadPerGeometry)->Args({ 16, 64 })->Args({ 64, 16 })->Args({ 64, 256 })->UseRealTime();
+
+// The same frames through an 8 MB ring, which holds several frames, and a 2 MB ring,
+// which makes the big frame wait on the copy engine as it goes.
+BENCHMARK(BM_UploadRing)->Args({ 16, 64, 8192 })->Args({ 64, 16, 8192 })->Args({ 64, 256, 8192 })
+	->Args({ 64, 256, 2048 })->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,59 @@
+//***************************************************************************************
+// TangentGenerationBenchmark.cpp
+//
+// TangentGenerator::Generate on the LandApp hills: a GeometryGenerator grid lifted onto
+// the height field, with the height field's normals, whose generated tangents are
+// wrong once displaced.  The largest grid has 10M triangles.
+//
+// Arguments: grid vertices per side, and worker threads for the pool (0 for one per
+// hardware thread).  Items processed are triangles.  Tests/TangentGeneratorTest.cpp
+// checks the tangents on the same hills.
+//***************************************************************************************
+
+#include "../TangentGenerator.h"
+#include "../Terrain.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	const float kGridSize = 160.0f;
+
+	GeometryGenerator::MeshData MakeHills(uint32 side)
+	{
+		GeometryGenerator geoGen;
+		GeometryGenerator::MeshData grid = geoGen.CreateGrid(kGridSize, kGridSize, side, side);
+		for(GeometryGenerator::Vertex& v : grid.Vertices)
+		{
+			v.Position.y = GetHillsHeight(v.Position.x, v.Position.z);
+			v.Normal = GetHillsNormal(v.Position.x, v.Position.z);
+		}
+		return grid;
+	}
+
+	void BM_GenerateTangents(benchmark::State& state)
+	{
+		GeometryGenerator::MeshData mesh = MakeHills((uint32)state.range(0));
+		ThreadPool pool((uint32)state.range(1));
+
+		for(auto _ : state)
+		{
+			TangentGenerator::Generate(mesh, pool);
+			benchmark::ClobberMemory();
+		}
+
+		uint32 triangles = (uint32)(mesh.Indices32.size() / 3);
+		state.SetItemsProcessed((int64_t)state.iterations() * triangles);
+		state.counters["triangles"] = triangles;
+		state.counters["threads"] = pool.GetThreadCount();
+	}
+}
+
+BENCHMARK(BM_GenerateTangents)->Args({ 317, 0 })->Args({ 2237, 0 })->Args({ 2237, 3 })
+	->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
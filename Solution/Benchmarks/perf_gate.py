@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+#****************************************************************************************
+# perf_gate.py
+#
+# Performance regression gate for the Google Benchmark executables.  Runs each
+# benchmark several times, reduces the repetitions to a mean and a 95% confidence
+# interval, and compares them with the baseline stored in --baseline-dir (baselines/ in
+# the current directory by default; the CMake targets use <build>/Benchmarks/baselines).
+#
+# A benchmark regresses when its mean time grew by more than --threshold AND the
+# confidence intervals no longer overlap, so a noisy run alone does not fail the gate.
+#
+#   perf_gate.py update <build>/Benchmarks/GeometryGeneratorBenchmark <build>/Benchmarks/FrameLoopBenchmark
+#   perf_gate.py check  <build>/Benchmarks/GeometryGeneratorBenchmark <build>/Benchmarks/FrameLoopBenchmark
+#
+# A benchmark that reports an error (SkipWithError, e.g. a failed self-check) fails the
+# gate, and no baseline is recorded for an executable that has one.  Baselines depend on
+# the machine, so they are recorded locally with 'update' rather than kept in the
+# repository, and 'check' fails for an executable without one: a gate that compares
+# nothing must not pass.  --allow-missing skips those executables with a note instead.
+#
+# Exit code: 0 when every benchmark is within the threshold, 1 on a regression, 2 when a
+# benchmark could not be run, reported an error or has no baseline to compare with.
+#****************************************************************************************
+
+import argparse
+import json
+import math
+import os
+import platform
+import subprocess
+import sys
+import tempfile
+
+# Two-sided 95% Student t critical values by degrees of freedom.
+T95 = {1: 12.706, 2: 4.303, 3: 3.182, 4: 2.776, 5: 2.571, 6: 2.447, 7: 2.365, 8: 2.306,
+       9: 2.262, 10: 2.228, 12: 2.179, 15: 2.131, 20: 2.086, 30: 2.042}
+
+
+def t_critical(dof):
+    if dof <= 0:
+        return float("inf")
+    for d in sorted(T95):
+        if dof <= d:
+            return T95[d]
+    return 1.960
+
+
+def summarize(samples):
+    n = len(samples)
+    mean = sum(samples) / n
+    if n < 2:
+        return {"mean_ns": mean, "ci_ns": 0.0, "runs": n}
+    var = sum((s - mean) ** 2 for s in samples) / (n - 1)
+    return {"mean_ns": mean, "ci_ns": t_critical(n - 1) * math.sqrt(var / n), "runs": n}
+
+
+def to_ns(value, unit):
+    return value * {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}[unit]
+
+
+def run_benchmark(exe, repetitions, min_time, bench_filter):
+    """Runs exe and returns {benchmark name: summary} from its per-repetition results,
+    and the "name: message" of every run that reported an error."""
+    with tempfile.TemporaryDirectory() as tmp:
+        out = os.path.join(tmp, "result.json")
+        cmd = [exe,
+               "--benchmark_repetitions=%d" % repetitions,
+               "--benchmark_min_time=%g" % min_time,
+               "--benchmark_out=%s" % out,
+               "--benchmark_out_format=json"]
+        if bench_filter:
+            cmd.append("--benchmark_filter=%s" % bench_filter)
+        subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL)
+        with open(out) as f:
+            report = json.load(f)
+
+    samples, errors = {}, []
+    for b in report["benchmarks"]:
+        if b.get("run_type", "iteration") != "iteration":
+            continue
+        name = b.get("run_name", b["name"])
+        if b.get("error_occurred"):
+            errors.append("%s: %s" % (name, b.get("error_message", "error")))
+            continue
+        samples.setdefault(name, []).append(to_ns(b["real_time"], b.get("time_unit", "ns")))
+
+    context = report.get("context", {})
+    return errors, {
+        "context": {
+            "host": context.get("host_name", platform.node()),
+            "num_cpus": context.get("num_cpus"),
+            "mhz_per_cpu": context.get("mhz_per_cpu"),
+            "build_type": context.get("library_build_type"),
+        },
+        "benchmarks": {name: summarize(s) for name, s in samples.items()},
+    }
+
+
+def baseline_path(baseline_dir, exe):
+    return os.path.join(baseline_dir, os.path.splitext(os.path.basename(exe))[0] + ".json")
+
+
+def format_time(ns):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if ns >= scale:
+            return "%.3f %s" % (ns / scale, unit)
+    return "%.1f ns" % ns
+
+
+def compare(name, baseline, current, threshold):
+    """Prints the diff table for one executable and returns (regressions, missing)."""
+    print("\n%s" % name)
+    bctx, cctx = baseline.get("context", {}), current["context"]
+    if (bctx.get("host"), bctx.get("num_cpus")) != (cctx.get("host"), cctx.get("num_cpus")):
+        print("  note: baseline was recorded on %s (%s cpus), this run is %s (%s cpus)"
+              % (bctx.get("host"), bctx.get("num_cpus"), cctx.get("host"), cctx.get("num_cpus")))
+
+    header = "  %-44s %24s %24s %9s  %s" % ("benchmark", "baseline", "current", "change", "status")
+    print(header)
+    print("  " + "-" * (len(header) - 2))
+
+    regressions, missing = [], []
+    for bench, cur in sorted(current["benchmarks"].items()):
+        base = baseline["benchmarks"].get(bench)
+        if base is None:
+            missing.append(bench)
+            print("  %-44s %24s %24s %9s  %s" % (bench, "-", format_time(cur["mean_ns"]), "-", "NEW"))
+            continue
+
+        change = cur["mean_ns"] / base["mean_ns"] - 1.0
+        separated = cur["mean_ns"] - cur["ci_ns"] > base["mean_ns"] + base["ci_ns"]
+        faster = cur["mean_ns"] + cur["ci_ns"] < base["mean_ns"] - base["ci_ns"]
+        if change > threshold and separated:
+            status = "REGRESSED"
+            regressions.append(bench)
+        elif change > threshold:
+            status = "noisy"
+        elif faster and -change > threshold:
+            status = "improved"
+        else:
+            status = "ok"
+
+        print("  %-44s %24s %24s %+8.1f%%  %s" % (
+            bench,
+            "%s +/- %s" % (format_time(base["mean_ns"]), format_time(base["ci_ns"])),
+            "%s +/- %s" % (format_time(cur["mean_ns"]), format_time(cur["ci_ns"])),
+            100.0 * change, status))
+
+    for bench in sorted(set(baseline["benchmarks"]) - set(current["benchmarks"])):
+        print("  %-44s %24s %24s %9s  %s" % (bench, format_time(baseline["benchmarks"][bench]["mean_ns"]), "-", "-", "GONE"))
+
+    return regressions, missing
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark regression gate against stored baselines.")
+    parser.add_argument("mode", choices=["check", "update"])
+    parser.add_argument("executables", nargs="+")
+    parser.add_argument("--repetitions", type=int, default=5)
+    parser.add_argument("--min-time", type=float, default=0.05, help="seconds per repetition")
+    parser.add_argument("--threshold", type=float, default=0.10, help="allowed slowdown, 0.10 = 10%%")
+    parser.add_argument("--filter", default="", help="--benchmark_filter passed to every executable")
+    parser.add_argument("--baseline-dir", default="baselines", help="where baselines are read and written")
+    parser.add_argument("--allow-missing", action="store_true",
+                        help="skip executables without a baseline instead of failing")
+    args = parser.parse_args()
+
+    all_regressions, failed, compared = [], False, 0
+    for exe in args.executables:
+        name = os.path.basename(exe)
+        try:
+            errors, current = run_benchmark(exe, args.repetitions, args.min_time, args.filter)
+        except (OSError, subprocess.CalledProcessError) as e:
+            print("%s: could not run (%s)" % (name, e), file=sys.stderr)
+            failed = True
+            continue
+        if errors:
+            print("%s: %d run(s) reported an error:" % (name, len(errors)), file=sys.stderr)
+            for e in sorted(set(errors)):
+                print("  " + e, file=sys.stderr)
+            failed = True
+            continue
+
+        path = baseline_path(args.baseline_dir, exe)
+        if args.mode == "update":
+            os.makedirs(args.baseline_dir, exist_ok=True)
+            with open(path, "w") as f:
+                json.dump(current, f, indent=2, sort_keys=True)
+                f.write("\n")
+            print("%s: wrote %d benchmarks to %s" % (name, len(current["benchmarks"]), path))
+            continue
+
+        if not os.path.exists(path):
+            if args.allow_missing:
+                print("%s: skipped, no baseline at %s; run with 'update' to record one" % (name, path))
+            else:
+                print("%s: no baseline at %s; run with 'update' to record one" % (name, path), file=sys.stderr)
+                failed = True
+            continue
+
+        with open(path) as f:
+            baseline = json.load(f)
+        regressions, _ = compare(name, baseline, current, args.threshold)
+        compared += 1
+        all_regressions += ["%s/%s" % (name, r) for r in regressions]
+
+    if all_regressions:
+        print("\n%d benchmark(s) regressed by more than %.0f%%:" % (len(all_regressions), 100.0 * args.threshold))
+        for r in all_regressions:
+            print("  " + r)
+        return 1
+    if failed:
+        return 2
+    if args.mode == "check" and compared == 0:
+        print("\nNo baselines to compare with; nothing checked.")
+    elif args.mode == "check":
+        print("\nNo regressions beyond %.0f%%." % (100.0 * args.threshold))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,76 @@
+//***************************************************************************************
+// CopyLedger.cpp
+//***************************************************************************************
+
+#include "CopyLedger.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	const char* KindName(CopyLedger::Kind kind)
+	{
+		switch(kind)
+		{
+		case CopyLedger::Kind::Write: return "write";
+		case CopyLedger::Kind::CpuCopy: return "cpu copy";
+		case CopyLedger::Kind::GpuCopy: return "gpu copy";
+		}
+		return "?";
+	}
+}
+
+void CopyLedger::Record(const char* name, Kind kind, uint64 bytes)
+{
+	for(Stage& stage : mStages)
+	{
+		if(stage.StageKind == kind && std::strcmp(stage.Name, name) == 0)
+		{
+			++stage.Count;
+			stage.Bytes += bytes;
+			return;
+		}
+	}
+
+	Stage stage;
+	stage.Name = name;
+	stage.StageKind = kind;
+	stage.Count = 1;
+	stage.Bytes = bytes;
+	mStages.push_back(stage);
+}
+
+CopyLedger::uint64 CopyLedger::GetBytes(Kind kind)const
+{
+	uint64 bytes = 0;
+	for(const Stage& stage : mStages)
+	{
+		if(stage.StageKind == kind)
+			bytes += stage.Bytes;
+	}
+	return bytes;
+}
+
+bool CopyLedger::WriteReport(const char* path)const
+{
+	std::FILE* file = std::fopen(path, "w");
+	if(file == nullptr)
+		return false;
+
+	std::fprintf(file, "%-40s %-10s %8s %14s\n", "stage", "kind", "count", "bytes");
+	for(const Stage& stage : mStages)
+	{
+		std::fprintf(file, "%-40s %-10s %8llu %14llu\n", stage.Name, KindName(stage.StageKind),
+			(unsigned long long)stage.Count, (unsigned long long)stage.Bytes);
+	}
+
+	uint64 written = GetBytes(Kind::Write);
+	uint64 cpuCopied = GetBytes(Kind::CpuCopy);
+	std::fprintf(file, "\nwritten %llu, cpu copied %llu (%.2fx written), gpu copied %llu\n",
+		(unsigned long long)written, (unsigned long long)cpuCopied,
+		written > 0 ? (double)cpuCopied / (double)written : 0.0,
+		(unsigned long long)GetBytes(Kind::GpuCopy));
+
+	return std::fclose(file) == 0;
+}
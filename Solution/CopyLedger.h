@@ -0,0 +1,59 @@
+//***************************************************************************************
+// CopyLedger.h
+//
+// Byte accounting for getting geometry from the generators to the GPU.  Each stage
+// records how many bytes it wrote: either produced in place by a generator (a write)
+// or moved from one buffer to another (a copy).  The report lists the stages and the
+// copied-to-written ratio, so two upload paths can be compared stage for stage.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class CopyLedger
+{
+public:
+
+	using uint64 = std::uint64_t;
+
+	enum class Kind
+	{
+		Write,      // bytes produced where they end up, e.g. generated into a mapped buffer
+		CpuCopy,    // bytes moved by the CPU, e.g. CopyMemory into a blob or upload heap
+		GpuCopy     // bytes moved by the GPU, e.g. upload heap to default heap
+	};
+
+	struct Stage
+	{
+		const char* Name = nullptr;
+		Kind StageKind = Kind::Write;
+		uint64 Count = 0;
+		uint64 Bytes = 0;
+	};
+
+	///<summary>
+	/// Adds bytes to the named stage.  name must outlive the ledger; string literals
+	/// are the intended use.
+	///</summary>
+	void Record(const char* name, Kind kind, uint64 bytes);
+
+	///<summary>
+	/// Total bytes of every stage of the given kind.
+	///</summary>
+	uint64 GetBytes(Kind kind)const;
+
+	const std::vector<Stage>& GetStages()const { return mStages; }
+
+	void Reset() { mStages.clear(); }
+
+	///<summary>
+	/// Writes a table of the stages and the totals to path.  Returns false if the file
+	/// can't be written.
+	///</summary>
+	bool WriteReport(const char* path)const;
+
+private:
+	std::vector<Stage> mStages;
+};
@@ -0,0 +1,104 @@
+//***************************************************************************************
+// D3D12CopyQueue.cpp
+//***************************************************************************************
+
+#include "D3D12CopyQueue.h"
+
+using Microsoft::WRL::ComPtr;
+
+D3D12CopyQueue::D3D12CopyQueue(ID3D12Device* device, UINT64 stagingByteSize)
+	: mDevice(device), mStagingByteSize(stagingByteSize)
+{
+	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+	queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+	queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+	ThrowIfFailed(device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(mQueue.GetAddressOf())));
+
+	ID3D12CommandAllocator* alloc = AcquireAllocator(0);
+	ThrowIfFailed(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, alloc, nullptr,
+		IID_PPV_ARGS(mCommandList.GetAddressOf())));
+	ThrowIfFailed(mCommandList->Close());
+
+	ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(mFence.GetAddressOf())));
+	mFenceEvent = CreateEventEx(nullptr, nullptr, false, EVENT_ALL_ACCESS);
+
+	ThrowIfFailed(device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(stagingByteSize),
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(mStaging.GetAddressOf())));
+
+	// Upload heaps can stay mapped while the GPU reads them; the fence keeps the CPU
+	// off the parts still in flight.
+	ThrowIfFailed(mStaging->Map(0, nullptr, &mMappedStaging));
+}
+
+D3D12CopyQueue::~D3D12CopyQueue()
+{
+	if(mNextFence > 1)
+		WaitForFence(mNextFence - 1);
+
+	mStaging->Unmap(0, nullptr);
+	CloseHandle(mFenceEvent);
+}
+
+CopyQueue::uint64 D3D12CopyQueue::Submit(const Copy* copies, uint32 count)
+{
+	uint64 fence = mNextFence++;
+
+	ID3D12CommandAllocator* alloc = AcquireAllocator(fence);
+	ThrowIfFailed(alloc->Reset());
+	ThrowIfFailed(mCommandList->Reset(alloc, nullptr));
+
+	for(uint32 i = 0; i < count; ++i)
+	{
+		const Copy& copy = copies[i];
+		mCommandList->CopyBufferRegion(static_cast<ID3D12Resource*>(copy.Destination), copy.DestinationOffset,
+			mStaging.Get(), copy.SourceOffset, copy.Size);
+	}
+
+	ThrowIfFailed(mCommandList->Close());
+	ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
+	mQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+	ThrowIfFailed(mQueue->Signal(mFence.Get(), fence));
+
+	return fence;
+}
+
+CopyQueue::uint64 D3D12CopyQueue::GetCompletedFence()
+{
+	return mFence->GetCompletedValue();
+}
+
+void D3D12CopyQueue::WaitForFence(uint64 value)
+{
+	if(mFence->GetCompletedValue() >= value)
+		return;
+
+	ThrowIfFailed(mFence->SetEventOnCompletion(value, mFenceEvent));
+	WaitForSingleObject(mFenceEvent, INFINITE);
+}
+
+ID3D12CommandAllocator* D3D12CopyQueue::AcquireAllocator(uint64 fenceValue)
+{
+	// Reuse an allocator whose batch has finished; there are only ever as many as
+	// batches in flight at once.
+	uint64 completed = mFence != nullptr ? mFence->GetCompletedValue() : 0;
+	for(Allocator& a : mAllocators)
+	{
+		if(a.FenceValue <= completed)
+		{
+			a.FenceValue = fenceValue;
+			return a.CmdListAlloc.Get();
+		}
+	}
+
+	Allocator a;
+	ThrowIfFailed(mDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY,
+		IID_PPV_ARGS(a.CmdListAlloc.GetAddressOf())));
+	a.FenceValue = fenceValue;
+	mAllocators.push_back(a);
+	return mAllocators.back().CmdListAlloc.Get();
+}
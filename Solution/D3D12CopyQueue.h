@@ -0,0 +1,66 @@
+//***************************************************************************************
+// D3D12CopyQueue.h
+//
+// The D3D12 CopyQueue for StagingUploader.  Owns the staging buffer (an upload heap
+// buffer mapped for its whole life) and a copy command queue with its own fence.  Each
+// Submit records the batch's CopyBufferRegion calls into one command list, executes it
+// and signals the fence.
+//
+// Destination buffers are created in D3D12_RESOURCE_STATE_COMMON: the copy queue
+// promotes them to COPY_DEST and they decay back to COMMON once the batch completes,
+// after which the direct queue promotes them to the vertex and index buffer states on
+// first use.  Nothing makes the direct queue Wait on GetFence(): instead the CPU keeps
+// it from drawing early.  GeometryStreamer::RetireUploads marks a mesh resident only
+// once GetCompletedFence() has reached its batch's fence value, and ShapeComplete
+// draws only resident meshes.  Drawing from a buffer before that check (or dropping
+// it) would need a queue Wait on GetFence() in its place.
+//***************************************************************************************
+
+#pragma once
+
+#include "../../Common/d3dUtil.h"
+#include "StagingUploader.h"
+
+#include <vector>
+
+class D3D12CopyQueue : public CopyQueue
+{
+public:
+
+	D3D12CopyQueue(ID3D12Device* device, UINT64 stagingByteSize);
+	D3D12CopyQueue(const D3D12CopyQueue& rhs) = delete;
+	D3D12CopyQueue& operator=(const D3D12CopyQueue& rhs) = delete;
+	~D3D12CopyQueue();
+
+	void* GetStagingMemory()const { return mMappedStaging; }
+	UINT64 GetStagingByteSize()const { return mStagingByteSize; }
+
+	ID3D12Fence* GetFence()const { return mFence.Get(); }
+
+	uint64 Submit(const Copy* copies, uint32 count)override;
+	uint64 GetCompletedFence()override;
+	void WaitForFence(uint64 value)override;
+
+private:
+	// A command allocator can only be reset once the batch recorded with it is done.
+	struct Allocator
+	{
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> CmdListAlloc;
+		uint64 FenceValue = 0;
+	};
+
+	ID3D12CommandAllocator* AcquireAllocator(uint64 fenceValue);
+
+	Microsoft::WRL::ComPtr<ID3D12Device> mDevice;
+	Microsoft::WRL::ComPtr<ID3D12CommandQueue> mQueue;
+	Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> mCommandList;
+	std::vector<Allocator> mAllocators;
+
+	Microsoft::WRL::ComPtr<ID3D12Fence> mFence;
+	uint64 mNextFence = 1;
+	HANDLE mFenceEvent = nullptr;
+
+	Microsoft::WRL::ComPtr<ID3D12Resource> mStaging;
+	void* mMappedStaging = nullptr;
+	UINT64 mStagingByteSize = 0;
+};
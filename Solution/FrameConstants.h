@@ -0,0 +1,48 @@
+//***************************************************************************************
+// FrameConstants.h
+//
+// CPU-side layouts of the constant buffers and the vertex format shared with the
+// shaders.  Kept free of D3D12 headers so the engine core builds on any platform.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+
+inline DirectX::XMFLOAT4X4 IdentityFloat4x4()
+{
+    return DirectX::XMFLOAT4X4(
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+struct ObjectConstants
+{
+    DirectX::XMFLOAT4X4 World = IdentityFloat4x4();
+};
+
+struct PassConstants
+{
+    DirectX::XMFLOAT4X4 View = IdentityFloat4x4();
+    DirectX::XMFLOAT4X4 InvView = IdentityFloat4x4();
+    DirectX::XMFLOAT4X4 Proj = IdentityFloat4x4();
+    DirectX::XMFLOAT4X4 InvProj = IdentityFloat4x4();
+    DirectX::XMFLOAT4X4 ViewProj = IdentityFloat4x4();
+    DirectX::XMFLOAT4X4 InvViewProj = IdentityFloat4x4();
+    DirectX::XMFLOAT3 EyePosW = { 0.0f, 0.0f, 0.0f };
+    float cbPerObjectPad1 = 0.0f;
+    DirectX::XMFLOAT2 RenderTargetSize = { 0.0f, 0.0f };
+    DirectX::XMFLOAT2 InvRenderTargetSize = { 0.0f, 0.0f };
+    float NearZ = 0.0f;
+    float FarZ = 0.0f;
+    float TotalTime = 0.0f;
+    float DeltaTime = 0.0f;
+};
+
+struct Vertex
+{
+    DirectX::XMFLOAT3 Pos;
+    DirectX::XMFLOAT4 Color;
+};
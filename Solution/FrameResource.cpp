@@ -1,6 +1,6 @@
 #include "FrameResource.h"
 
-FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount)
+FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount, UINT animatedCount)
 {
     ThrowIfFailed(device->CreateCommandAllocator(
         D3D12_COMMAND_LIST_TYPE_DIRECT,
@@ -8,9 +8,19 @@ FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCo
 
     PassCB = std::make_unique<UploadBuffer<PassConstants>>(device, passCount, true);
     ObjectCB = std::make_unique<UploadBuffer<ObjectConstants>>(device, objectCount, true);
+
+    if (animatedCount > 0)
+    {
+        // Map calls are reference counted, so this mapping lives alongside the
+        // one UploadBuffer keeps for CopyData.
+        AnimatedTransforms = std::make_unique<UploadBuffer<AnimatedTransform>>(device, animatedCount, false);
+        ThrowIfFailed(AnimatedTransforms->Resource()->Map(0, nullptr, reinterpret_cast<void**>(&MappedAnimatedTransforms)));
+    }
 }
 
 FrameResource::~FrameResource()
 {
+    if (AnimatedTransforms != nullptr)
+        AnimatedTransforms->Resource()->Unmap(0, nullptr);
 
 }
\ No newline at end of file
@@ -3,124 +3,93 @@
 //***************************************************************************************
 
 #include "GeometryGenerator.h"
+#include "AllocationTracker.h"
+#include "ParametricSurface.h"
+#include "Profiler.h"
+#include "ShapeWriter.h"
+#include "ThreadPool.h"
 #include <algorithm>
 
 using namespace DirectX;
 
-
-GeometryGenerator::MeshData GeometryGenerator::CreateSphere(float radius, uint32 sliceCount, uint32 stackCount)
+namespace
 {
-    MeshData meshData;
-
-	//
-	// Compute the vertices stating at the top pole and moving down the stacks.
-	//
-
-	// Poles: note that there will be texture coordinate distortion as there is
-	// not a unique point on the texture map to assign to the pole when mapping
-	// a rectangular texture onto a sphere.
-	Vertex topVertex(0.0f, +radius, 0.0f, 0.0f, +1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	Vertex bottomVertex(0.0f, -radius, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	// The icosahedron the geospheres start from.
+	const float IcosahedronX = 0.525731f;
+	const float IcosahedronZ = 0.850651f;
 
-	meshData.Vertices.push_back( topVertex );
-
-	float phiStep   = XM_PI/stackCount;
-	float thetaStep = 2.0f*XM_PI/sliceCount;
-
-	// Compute vertices for each stack ring (do not count the poles as rings).
-	for(uint32 i = 1; i <= stackCount-1; ++i)
+	const XMFLOAT3 IcosahedronPositions[12] =
 	{
-		float phi = i*phiStep;
-
-		// Vertices of ring.
-        for(uint32 j = 0; j <= sliceCount; ++j)
-		{
-			float theta = j*thetaStep;
+		XMFLOAT3(-IcosahedronX, 0.0f, IcosahedronZ),  XMFLOAT3(IcosahedronX, 0.0f, IcosahedronZ),
+		XMFLOAT3(-IcosahedronX, 0.0f, -IcosahedronZ), XMFLOAT3(IcosahedronX, 0.0f, -IcosahedronZ),
+		XMFLOAT3(0.0f, IcosahedronZ, IcosahedronX),   XMFLOAT3(0.0f, IcosahedronZ, -IcosahedronX),
+		XMFLOAT3(0.0f, -IcosahedronZ, IcosahedronX),  XMFLOAT3(0.0f, -IcosahedronZ, -IcosahedronX),
+		XMFLOAT3(IcosahedronZ, IcosahedronX, 0.0f),   XMFLOAT3(-IcosahedronZ, IcosahedronX, 0.0f),
+		XMFLOAT3(IcosahedronZ, -IcosahedronX, 0.0f),  XMFLOAT3(-IcosahedronZ, -IcosahedronX, 0.0f)
+	};
 
-			Vertex v;
+	const std::uint32_t IcosahedronIndices[60] =
+	{
+		1,4,0,  4,9,0,  4,5,9,  8,5,4,  1,8,4,
+		1,10,8, 10,3,8, 8,3,5,  3,2,5,  3,7,2,
+		3,10,7, 10,6,7, 6,11,7, 6,0,11, 6,1,0,
+		10,1,6, 11,0,9, 2,11,9, 5,2,9,  11,2,7
+	};
 
-			// spherical to cartesian
-			v.Position.x = radius*sinf(phi)*cosf(theta);
-			v.Position.y = radius*cosf(phi);
-			v.Position.z = radius*sinf(phi)*sinf(theta);
+	// Projects a point of the tessellated icosahedron onto the sphere and gives it the
+	// sphere's normal, spherical texture coordinates and tangent.
+	GeometryGenerator::Vertex MakeGeosphereVertex(const XMFLOAT3& flat, float radius)
+	{
+		GeometryGenerator::Vertex v;
 
-			// Partial derivative of P with respect to theta
-			v.TangentU.x = -radius*sinf(phi)*sinf(theta);
-			v.TangentU.y = 0.0f;
-			v.TangentU.z = +radius*sinf(phi)*cosf(theta);
+		// Project onto unit sphere.
+		XMVECTOR n = XMVector3Normalize(XMLoadFloat3(&flat));
 
-			XMVECTOR T = XMLoadFloat3(&v.TangentU);
-			XMStoreFloat3(&v.TangentU, XMVector3Normalize(T));
+		// Project onto sphere.
+		XMVECTOR p = radius*n;
 
-			XMVECTOR p = XMLoadFloat3(&v.Position);
-			XMStoreFloat3(&v.Normal, XMVector3Normalize(p));
+		XMStoreFloat3(&v.Position, p);
+		XMStoreFloat3(&v.Normal, n);
 
-			v.TexC.x = theta / XM_2PI;
-			v.TexC.y = phi / XM_PI;
+		// Derive texture coordinates from spherical coordinates.
+		float theta = atan2f(v.Position.z, v.Position.x);
 
-			meshData.Vertices.push_back( v );
-		}
-	}
+		// Put in [0, 2pi].
+		if(theta < 0.0f)
+			theta += XM_2PI;
 
-	meshData.Vertices.push_back( bottomVertex );
+		float phi = acosf(v.Position.y / radius);
 
-	//
-	// Compute indices for top stack.  The top stack was written first to the vertex buffer
-	// and connects the top pole to the first ring.
-	//
+		v.TexC.x = theta/XM_2PI;
+		v.TexC.y = phi/XM_PI;
 
-    for(uint32 i = 1; i <= sliceCount; ++i)
-	{
-		meshData.Indices32.push_back(0);
-		meshData.Indices32.push_back(i+1);
-		meshData.Indices32.push_back(i);
-	}
-	
-	//
-	// Compute indices for inner stacks (not connected to poles).
-	//
-
-	// Offset the indices to the index of the first vertex in the first ring.
-	// This is just skipping the top pole vertex.
-    uint32 baseIndex = 1;
-    uint32 ringVertexCount = sliceCount + 1;
-	for(uint32 i = 0; i < stackCount-2; ++i)
-	{
-		for(uint32 j = 0; j < sliceCount; ++j)
-		{
-			meshData.Indices32.push_back(baseIndex + i*ringVertexCount + j);
-			meshData.Indices32.push_back(baseIndex + i*ringVertexCount + j+1);
-			meshData.Indices32.push_back(baseIndex + (i+1)*ringVertexCount + j);
+		// Partial derivative of P with respect to theta
+		v.TangentU.x = -radius*sinf(phi)*sinf(theta);
+		v.TangentU.y = 0.0f;
+		v.TangentU.z = +radius*sinf(phi)*cosf(theta);
 
-			meshData.Indices32.push_back(baseIndex + (i+1)*ringVertexCount + j);
-			meshData.Indices32.push_back(baseIndex + i*ringVertexCount + j+1);
-			meshData.Indices32.push_back(baseIndex + (i+1)*ringVertexCount + j+1);
-		}
+		XMVECTOR T = XMLoadFloat3(&v.TangentU);
+		XMStoreFloat3(&v.TangentU, XMVector3Normalize(T));
+		return v;
 	}
+}
 
-	//
-	// Compute indices for bottom stack.  The bottom stack was written last to the vertex buffer
-	// and connects the bottom pole to the bottom ring.
-	//
-
-	// South pole vertex was added last.
-	uint32 southPoleIndex = (uint32)meshData.Vertices.size()-1;
 
-	// Offset the indices to the index of the first vertex in the last ring.
-	baseIndex = southPoleIndex - ringVertexCount;
-	
-	for(uint32 i = 0; i < sliceCount; ++i)
-	{
-		meshData.Indices32.push_back(southPoleIndex);
-		meshData.Indices32.push_back(baseIndex+i);
-		meshData.Indices32.push_back(baseIndex+i+1);
-	}
+GeometryGenerator::MeshData GeometryGenerator::CreateSphere(float radius, uint32 sliceCount, uint32 stackCount)
+{
+    PROFILE_SCOPE("GeometryGenerator::CreateSphere");
+    ALLOCATION_SCOPE("GeometryGenerator::CreateSphere");
 
+    MeshData meshData;
+    ShapeWriter::AppendSphere(meshData.Vertices, meshData.Indices32, ShapeWriter::GeneratorVertexWriter(), radius, sliceCount, stackCount);
     return meshData;
 }
  
 void GeometryGenerator::Subdivide(MeshData& meshData)
 {
+	PROFILE_SCOPE("GeometryGenerator::Subdivide");
+	ALLOCATION_SCOPE("GeometryGenerator::Subdivide");
+
 	// Save a copy of the input geometry.
 	MeshData inputCopy = meshData;
 
@@ -130,11 +99,11 @@ void GeometryGenerator::Subdivide(MeshData& meshData)
 
 	//       v1
 	//       *
-	//      / \
-	//     /   \
-	//  m0*-----*m1
-	//   / \   / \
-	//  /   \ /   \
+	//      / \       m0, m1 and m2 are
+	//     /   \      the edge midpoints;
+	//  m0*-----*m1   each input triangle
+	//   / \   / \    becomes the four
+	//  /   \ /   \   drawn here.
 	// *-----*-----*
 	// v0    m2     v2
 
@@ -214,315 +183,181 @@ GeometryGenerator::Vertex GeometryGenerator::MidPoint(const Vertex& v0, const Ve
 
 GeometryGenerator::MeshData GeometryGenerator::CreateGeosphere(float radius, uint32 numSubdivisions)
 {
+    PROFILE_SCOPE("GeometryGenerator::CreateGeosphere");
+    ALLOCATION_SCOPE("GeometryGenerator::CreateGeosphere");
+
     MeshData meshData;
 
 	// Put a cap on the number of subdivisions.
     numSubdivisions = std::min<uint32>(numSubdivisions, 6u);
 
 	// Approximate a sphere by tessellating an icosahedron.
-
-	const float X = 0.525731f; 
-	const float Z = 0.850651f;
-
-	XMFLOAT3 pos[12] = 
-	{
-		XMFLOAT3(-X, 0.0f, Z),  XMFLOAT3(X, 0.0f, Z),  
-		XMFLOAT3(-X, 0.0f, -Z), XMFLOAT3(X, 0.0f, -Z),    
-		XMFLOAT3(0.0f, Z, X),   XMFLOAT3(0.0f, Z, -X), 
-		XMFLOAT3(0.0f, -Z, X),  XMFLOAT3(0.0f, -Z, -X),    
-		XMFLOAT3(Z, X, 0.0f),   XMFLOAT3(-Z, X, 0.0f), 
-		XMFLOAT3(Z, -X, 0.0f),  XMFLOAT3(-Z, -X, 0.0f)
-	};
-
-    uint32 k[60] =
-	{
-		1,4,0,  4,9,0,  4,5,9,  8,5,4,  1,8,4,    
-		1,10,8, 10,3,8, 8,3,5,  3,2,5,  3,7,2,    
-		3,10,7, 10,6,7, 6,11,7, 6,0,11, 6,1,0, 
-		10,1,6, 11,0,9, 2,11,9, 5,2,9,  11,2,7 
-	};
-
     meshData.Vertices.resize(12);
-    meshData.Indices32.assign(&k[0], &k[60]);
+    meshData.Indices32.assign(&IcosahedronIndices[0], &IcosahedronIndices[60]);
 
 	for(uint32 i = 0; i < 12; ++i)
-		meshData.Vertices[i].Position = pos[i];
+		meshData.Vertices[i].Position = IcosahedronPositions[i];
 
 	for(uint32 i = 0; i < numSubdivisions; ++i)
 		Subdivide(meshData);
 
 	// Project vertices onto sphere and scale.
 	for(uint32 i = 0; i < meshData.Vertices.size(); ++i)
-	{
-		// Project onto unit sphere.
-		XMVECTOR n = XMVector3Normalize(XMLoadFloat3(&meshData.Vertices[i].Position));
-
-		// Project onto sphere.
-		XMVECTOR p = radius*n;
-
-		XMStoreFloat3(&meshData.Vertices[i].Position, p);
-		XMStoreFloat3(&meshData.Vertices[i].Normal, n);
-
-		// Derive texture coordinates from spherical coordinates.
-        float theta = atan2f(meshData.Vertices[i].Position.z, meshData.Vertices[i].Position.x);
-
-        // Put in [0, 2pi].
-        if(theta < 0.0f)
-            theta += XM_2PI;
-
-		float phi = acosf(meshData.Vertices[i].Position.y / radius);
-
-		meshData.Vertices[i].TexC.x = theta/XM_2PI;
-		meshData.Vertices[i].TexC.y = phi/XM_PI;
-
-		// Partial derivative of P with respect to theta
-		meshData.Vertices[i].TangentU.x = -radius*sinf(phi)*sinf(theta);
-		meshData.Vertices[i].TangentU.y = 0.0f;
-		meshData.Vertices[i].TangentU.z = +radius*sinf(phi)*cosf(theta);
-
-		XMVECTOR T = XMLoadFloat3(&meshData.Vertices[i].TangentU);
-		XMStoreFloat3(&meshData.Vertices[i].TangentU, XMVector3Normalize(T));
-	}
+		meshData.Vertices[i] = MakeGeosphereVertex(meshData.Vertices[i].Position, radius);
 
     return meshData;
 }
 
-GeometryGenerator::MeshData GeometryGenerator::CreateCylinder(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount)
+GeometryGenerator::MeshData GeometryGenerator::CreateGeodesicSphere(float radius, uint32 frequency, ThreadPool& pool)
 {
-    MeshData meshData;
-
-	//
-	// Build Stacks.
-	// 
-
-	float stackHeight = height / stackCount;
+	PROFILE_SCOPE("GeometryGenerator::CreateGeodesicSphere");
+	ALLOCATION_SCOPE("GeometryGenerator::CreateGeodesicSphere");
+
+	// Put a cap on the frequency so the index count stays within a uint32.
+	static_assert(60ull * MaxGeodesicFrequency * MaxGeodesicFrequency <= 0xffffffffull &&
+		60ull * (MaxGeodesicFrequency + 1) * (MaxGeodesicFrequency + 1) > 0xffffffffull,
+		"MaxGeodesicFrequency is not the largest frequency with a uint32 index count");
+	const uint32 f = std::min(std::max(frequency, 1u), (uint32)MaxGeodesicFrequency);
+
+	// The 30 icosahedron edges in the order the faces first use them.  A vertex on an
+	// edge is always computed from the edge's lower-numbered end, so the two faces that
+	// share it refer to the one copy, written once.
+	uint32 edgeEnds[30][2];
+	std::int8_t edgeOf[12][12];
+	std::fill(&edgeOf[0][0], &edgeOf[0][0] + 144, (std::int8_t)-1);
+	uint32 edgeCount = 0;
+	for(uint32 i = 0; i < 60; ++i)
+	{
+		uint32 a = IcosahedronIndices[i];
+		uint32 b = IcosahedronIndices[i % 3 == 2 ? i - 2 : i + 1];
+		if(edgeOf[a][b] >= 0)
+			continue;
+		edgeEnds[edgeCount][0] = std::min(a, b);
+		edgeEnds[edgeCount][1] = std::max(a, b);
+		edgeOf[a][b] = edgeOf[b][a] = (std::int8_t)edgeCount++;
+	}
 
-	// Amount to increment radius as we move up each stack level from bottom to top.
-	float radiusStep = (topRadius - bottomRadius) / stackCount;
+	// Vertices: the 12 corners, then (f - 1) per edge, then (f - 1)(f - 2)/2 inside
+	// each face.
+	const uint32 edgeBase = 12;
+	const uint32 faceBase = edgeBase + 30 * (f - 1);
+	const uint32 perFace = (f - 1) * (f - 2) / 2;
 
-	uint32 ringCount = stackCount+1;
+	MeshData meshData;
+	meshData.Vertices.resize(faceBase + 20 * perFace);
+	meshData.Indices32.resize(60 * f * f);
 
-	// Compute vertices for each stack ring starting at the bottom and moving up.
-	for(uint32 i = 0; i < ringCount; ++i)
+	auto blend = [f](const XMFLOAT3& p0, uint32 w0, const XMFLOAT3& p1, uint32 w1, const XMFLOAT3& p2, uint32 w2)
 	{
-		float y = -0.5f*height + i*stackHeight;
-		float r = bottomRadius + i*radiusStep;
+		float s = 1.0f / f;
+		return XMFLOAT3(
+			(p0.x * w0 + p1.x * w1 + p2.x * w2) * s,
+			(p0.y * w0 + p1.y * w1 + p2.y * w2) * s,
+			(p0.z * w0 + p1.z * w1 + p2.z * w2) * s);
+	};
 
-		// vertices of ring
-		float dTheta = 2.0f*XM_PI/sliceCount;
-		for(uint32 j = 0; j <= sliceCount; ++j)
-		{
-			Vertex vertex;
-
-			float c = cosf(j*dTheta);
-			float s = sinf(j*dTheta);
-
-			vertex.Position = XMFLOAT3(r*c, y, r*s);
-
-			vertex.TexC.x = (float)j/sliceCount;
-			vertex.TexC.y = 1.0f - (float)i/stackCount;
-
-			// Cylinder can be parameterized as follows, where we introduce v
-			// parameter that goes in the same direction as the v tex-coord
-			// so that the bitangent goes in the same direction as the v tex-coord.
-			//   Let r0 be the bottom radius and let r1 be the top radius.
-			//   y(v) = h - hv for v in [0,1].
-			//   r(v) = r1 + (r0-r1)v
-			//
-			//   x(t, v) = r(v)*cos(t)
-			//   y(t, v) = h - hv
-			//   z(t, v) = r(v)*sin(t)
-			// 
-			//  dx/dt = -r(v)*sin(t)
-			//  dy/dt = 0
-			//  dz/dt = +r(v)*cos(t)
-			//
-			//  dx/dv = (r0-r1)*cos(t)
-			//  dy/dv = -h
-			//  dz/dv = (r0-r1)*sin(t)
-
-			// This is unit length.
-			vertex.TangentU = XMFLOAT3(-s, 0.0f, c);
-
-			float dr = bottomRadius-topRadius;
-			XMFLOAT3 bitangent(dr*c, -height, dr*s);
-
-			XMVECTOR T = XMLoadFloat3(&vertex.TangentU);
-			XMVECTOR B = XMLoadFloat3(&bitangent);
-			XMVECTOR N = XMVector3Normalize(XMVector3Cross(T, B));
-			XMStoreFloat3(&vertex.Normal, N);
-
-			meshData.Vertices.push_back(vertex);
-		}
-	}
+	auto edgeVertex = [&](uint32 from, uint32 to, uint32 step)
+	{
+		uint32 e = (uint32)edgeOf[from][to];
+		uint32 k = from == edgeEnds[e][0] ? step : f - step;
+		return edgeBase + e * (f - 1) + k - 1;
+	};
 
-	// Add one because we duplicate the first and last vertex per ring
-	// since the texture coordinates are different.
-	uint32 ringVertexCount = sliceCount+1;
+	for(uint32 i = 0; i < 12; ++i)
+		meshData.Vertices[i] = MakeGeosphereVertex(IcosahedronPositions[i], radius);
 
-	// Compute indices for each stack.
-	for(uint32 i = 0; i < stackCount; ++i)
+	pool.ParallelFor(edgeCount, 1, [&](uint32 begin, uint32 end)
 	{
-		for(uint32 j = 0; j < sliceCount; ++j)
+		for(uint32 e = begin; e < end; ++e)
 		{
-			meshData.Indices32.push_back(i*ringVertexCount + j);
-			meshData.Indices32.push_back((i+1)*ringVertexCount + j);
-			meshData.Indices32.push_back((i+1)*ringVertexCount + j+1);
-
-			meshData.Indices32.push_back(i*ringVertexCount + j);
-			meshData.Indices32.push_back((i+1)*ringVertexCount + j+1);
-			meshData.Indices32.push_back(i*ringVertexCount + j+1);
+			const XMFLOAT3& p0 = IcosahedronPositions[edgeEnds[e][0]];
+			const XMFLOAT3& p1 = IcosahedronPositions[edgeEnds[e][1]];
+			for(uint32 k = 1; k < f; ++k)
+				meshData.Vertices[edgeBase + e * (f - 1) + k - 1] = MakeGeosphereVertex(blend(p0, f - k, p1, k, p1, 0), radius);
 		}
-	}
-
-	BuildCylinderTopCap(bottomRadius, topRadius, height, sliceCount, stackCount, meshData);
-	BuildCylinderBottomCap(bottomRadius, topRadius, height, sliceCount, stackCount, meshData);
-
-    return meshData;
-}
-
-void GeometryGenerator::BuildCylinderTopCap(float bottomRadius, float topRadius, float height,
-											uint32 sliceCount, uint32 stackCount, MeshData& meshData)
-{
-	uint32 baseIndex = (uint32)meshData.Vertices.size();
-
-	float y = 0.5f*height;
-	float dTheta = 2.0f*XM_PI/sliceCount;
+	});
 
-	// Duplicate cap ring vertices because the texture coordinates and normals differ.
-	for(uint32 i = 0; i <= sliceCount; ++i)
+	// Each face is a triangular grid: row r runs from the v0-v1 edge (c = 0) to the
+	// v0-v2 edge (c = r), and the point at (r, c) has weights (f - r, r - c, c).
+	pool.ParallelFor(20, 1, [&](uint32 begin, uint32 end)
 	{
-		float x = topRadius*cosf(i*dTheta);
-		float z = topRadius*sinf(i*dTheta);
-
-		// Scale down by the height to try and make top cap texture coord area
-		// proportional to base.
-		float u = x/height + 0.5f;
-		float v = z/height + 0.5f;
-
-		meshData.Vertices.push_back( Vertex(x, y, z, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, u, v) );
-	}
-
-	// Cap center vertex.
-	meshData.Vertices.push_back( Vertex(0.0f, y, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f) );
-
-	// Index of center vertex.
-	uint32 centerIndex = (uint32)meshData.Vertices.size()-1;
+		std::vector<uint32> above(f + 1), below(f + 1);
+		for(uint32 face = begin; face < end; ++face)
+		{
+			const uint32 i0 = IcosahedronIndices[face * 3 + 0];
+			const uint32 i1 = IcosahedronIndices[face * 3 + 1];
+			const uint32 i2 = IcosahedronIndices[face * 3 + 2];
+			const XMFLOAT3& p0 = IcosahedronPositions[i0];
+			const XMFLOAT3& p1 = IcosahedronPositions[i1];
+			const XMFLOAT3& p2 = IcosahedronPositions[i2];
+			uint32 interior = faceBase + face * perFace;
+			uint32* indices = &meshData.Indices32[face * 3 * f * f];
+
+			above[0] = i0;
+			for(uint32 r = 1; r <= f; ++r)
+			{
+				for(uint32 c = 0; c <= r; ++c)
+				{
+					if(r == f)
+						below[c] = c == 0 ? i1 : c == f ? i2 : edgeVertex(i1, i2, c);
+					else if(c == 0)
+						below[c] = edgeVertex(i0, i1, r);
+					else if(c == r)
+						below[c] = edgeVertex(i0, i2, c);
+					else
+					{
+						below[c] = interior++;
+						meshData.Vertices[below[c]] = MakeGeosphereVertex(blend(p0, f - r, p1, r - c, p2, c), radius);
+					}
+				}
+
+				// Row r - 1 to row r: r triangles pointing up and r - 1 pointing down,
+				// wound like the face.
+				for(uint32 c = 0; c < r; ++c)
+				{
+					*indices++ = above[c];
+					*indices++ = below[c];
+					*indices++ = below[c + 1];
+					if(c + 1 < r)
+					{
+						*indices++ = above[c];
+						*indices++ = below[c + 1];
+						*indices++ = above[c + 1];
+					}
+				}
+				std::swap(above, below);
+			}
+		}
+	});
 
-	for(uint32 i = 0; i < sliceCount; ++i)
-	{
-		meshData.Indices32.push_back(centerIndex);
-		meshData.Indices32.push_back(baseIndex + i+1);
-		meshData.Indices32.push_back(baseIndex + i);
-	}
+	return meshData;
 }
 
-void GeometryGenerator::BuildCylinderBottomCap(float bottomRadius, float topRadius, float height,
-											   uint32 sliceCount, uint32 stackCount, MeshData& meshData)
+GeometryGenerator::MeshData GeometryGenerator::CreateCylinder(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount)
 {
-	// 
-	// Build bottom cap.
-	//
-
-	uint32 baseIndex = (uint32)meshData.Vertices.size();
-	float y = -0.5f*height;
-
-	// vertices of ring
-	float dTheta = 2.0f*XM_PI/sliceCount;
-	for(uint32 i = 0; i <= sliceCount; ++i)
-	{
-		float x = bottomRadius*cosf(i*dTheta);
-		float z = bottomRadius*sinf(i*dTheta);
-
-		// Scale down by the height to try and make top cap texture coord area
-		// proportional to base.
-		float u = x/height + 0.5f;
-		float v = z/height + 0.5f;
-
-		meshData.Vertices.push_back( Vertex(x, y, z, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, u, v) );
-	}
-
-	// Cap center vertex.
-	meshData.Vertices.push_back( Vertex(0.0f, y, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f) );
+    PROFILE_SCOPE("GeometryGenerator::CreateCylinder");
+    ALLOCATION_SCOPE("GeometryGenerator::CreateCylinder");
 
-	// Cache the index of center vertex.
-	uint32 centerIndex = (uint32)meshData.Vertices.size()-1;
-
-	for(uint32 i = 0; i < sliceCount; ++i)
-	{
-		meshData.Indices32.push_back(centerIndex);
-		meshData.Indices32.push_back(baseIndex + i);
-		meshData.Indices32.push_back(baseIndex + i+1);
-	}
+    MeshData meshData;
+    ShapeWriter::AppendCylinder(meshData.Vertices, meshData.Indices32, ShapeWriter::GeneratorVertexWriter(), bottomRadius, topRadius, height, sliceCount, stackCount);
+    return meshData;
 }
 
 GeometryGenerator::MeshData GeometryGenerator::CreateGrid(float width, float depth, uint32 m, uint32 n)
 {
-    MeshData meshData;
-
-	uint32 vertexCount = m*n;
-	uint32 faceCount   = (m-1)*(n-1)*2;
-
-	//
-	// Create the vertices.
-	//
-
-	float halfWidth = 0.5f*width;
-	float halfDepth = 0.5f*depth;
-
-	float dx = width / (n-1);
-	float dz = depth / (m-1);
-
-	float du = 1.0f / (n-1);
-	float dv = 1.0f / (m-1);
-
-	meshData.Vertices.resize(vertexCount);
-	for(uint32 i = 0; i < m; ++i)
-	{
-		float z = halfDepth - i*dz;
-		for(uint32 j = 0; j < n; ++j)
-		{
-			float x = -halfWidth + j*dx;
-
-			meshData.Vertices[i*n+j].Position = XMFLOAT3(x, 0.0f, z);
-			meshData.Vertices[i*n+j].Normal   = XMFLOAT3(0.0f, 1.0f, 0.0f);
-			meshData.Vertices[i*n+j].TangentU = XMFLOAT3(1.0f, 0.0f, 0.0f);
-
-			// Stretch texture over grid.
-			meshData.Vertices[i*n+j].TexC.x = j*du;
-			meshData.Vertices[i*n+j].TexC.y = i*dv;
-		}
-	}
- 
-    //
-	// Create the indices.
-	//
-
-	meshData.Indices32.resize(faceCount*3); // 3 indices per face
-
-	// Iterate over each quad and compute indices.
-	uint32 k = 0;
-	for(uint32 i = 0; i < m-1; ++i)
-	{
-		for(uint32 j = 0; j < n-1; ++j)
-		{
-			meshData.Indices32[k]   = i*n+j;
-			meshData.Indices32[k+1] = i*n+j+1;
-			meshData.Indices32[k+2] = (i+1)*n+j;
-
-			meshData.Indices32[k+3] = (i+1)*n+j;
-			meshData.Indices32[k+4] = i*n+j+1;
-			meshData.Indices32[k+5] = (i+1)*n+j+1;
-
-			k += 6; // next quad
-		}
-	}
+    PROFILE_SCOPE("GeometryGenerator::CreateGrid");
+    ALLOCATION_SCOPE("GeometryGenerator::CreateGrid");
 
+    MeshData meshData;
+    ShapeWriter::AppendGrid(meshData.Vertices, meshData.Indices32, ShapeWriter::GeneratorVertexWriter(), width, depth, m, n);
     return meshData;
 }
 
 GeometryGenerator::MeshData GeometryGenerator::CreateQuad(float x, float y, float w, float h, float depth)
 {
+    PROFILE_SCOPE("GeometryGenerator::CreateQuad");
+    ALLOCATION_SCOPE("GeometryGenerator::CreateQuad");
+
     MeshData meshData;
 
 	meshData.Vertices.resize(4);
@@ -566,577 +401,71 @@ GeometryGenerator::MeshData GeometryGenerator::CreateQuad(float x, float y, floa
 
 GeometryGenerator::MeshData GeometryGenerator::CreateCone(float radius,float topRadius, float bottomRadius, float height, uint32 sliceCount, uint32 stackCount)
 {
-	MeshData meshData;
-
-	//
-	// Compute the vertices.
-	//
-
-	float y = height / 2;
-	float dTheta = XM_2PI / sliceCount;
-
-	for (uint32 j = 0; j <= stackCount; ++j)
-	{
-		float r = radius * (stackCount - j) / stackCount;
-
-		for (uint32 i = 0; i <= sliceCount; ++i)
-		{
-			Vertex vertex;
-
-			float c = cosf(i * dTheta);
-			float s = sinf(i * dTheta);
-
-			vertex.Position = XMFLOAT3(r * c, -y + j * height / stackCount, r * s);
-
-			vertex.Normal = XMFLOAT3(c, (radius / height) + 0.5f, s);
-			vertex.Normal = XMFLOAT3(vertex.Normal.x, vertex.Normal.y, vertex.Normal.z);
-
-			vertex.TexC.x = (float)i / sliceCount;
-			vertex.TexC.y = (float)j / stackCount;
-
-			meshData.Vertices.push_back(vertex);
-		}
-	}
-
-	//
-	// Compute the indices.
-	//
-
-	for (uint32 j = 0; j < stackCount; ++j)
-	{
-		for (uint32 i = 0; i < sliceCount; ++i)
-		{
-			meshData.Indices32.push_back((j + 0) * (sliceCount + 1) + i);
-			meshData.Indices32.push_back((j + 1) * (sliceCount + 1) + i);
-			meshData.Indices32.push_back((j + 1) * (sliceCount + 1) + i + 1);
-
-			meshData.Indices32.push_back((j + 0) * (sliceCount + 1) + i);
-			meshData.Indices32.push_back((j + 1) * (sliceCount + 1) + i + 1);
-			meshData.Indices32.push_back((j + 0) * (sliceCount + 1) + i + 1);
-		}
-	}
-
-	BuildConeBottomCap(bottomRadius, topRadius, height, sliceCount, stackCount, meshData);
+	PROFILE_SCOPE("GeometryGenerator::CreateCone");
+	ALLOCATION_SCOPE("GeometryGenerator::CreateCone");
 
+	MeshData meshData;
+	ShapeWriter::AppendCone(meshData.Vertices, meshData.Indices32, ShapeWriter::GeneratorVertexWriter(), radius, topRadius, bottomRadius, height, sliceCount, stackCount);
 	return meshData;
 }
 
-void GeometryGenerator::BuildConeBottomCap(float bottomRadius, float topRadius, float height,
-	uint32 sliceCount, uint32 stackCount, MeshData& meshData)
-{
-	// 
-	// Build bottom cap.
-	//
-
-	uint32 baseIndex = (uint32)meshData.Vertices.size();
-	float y = -0.5f * height;
-
-	// vertices of ring
-	float dTheta = 2.0f * XM_PI / sliceCount;
-	for (uint32 i = 0; i <= sliceCount; ++i)
-	{
-		float x = bottomRadius * cosf(i * dTheta);
-		float z = bottomRadius * sinf(i * dTheta);
-
-		// Scale down by the height to try and make top cap texture coord area
-		// proportional to base.
-		float u = x / height + 0.5f;
-		float v = z / height + 0.5f;
-
-		meshData.Vertices.push_back(Vertex(x, y, z, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, u, v));
-	}
-
-	// Cap center vertex.
-	meshData.Vertices.push_back(Vertex(0.0f, y, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f));
-
-	// Cache the index of center vertex.
-	uint32 centerIndex = (uint32)meshData.Vertices.size() - 1;
-
-	for (uint32 i = 0; i < sliceCount; ++i)
-	{
-		meshData.Indices32.push_back(centerIndex);
-		meshData.Indices32.push_back(baseIndex + i);
-		meshData.Indices32.push_back(baseIndex + i + 1);
-	}
-}
-
 GeometryGenerator::MeshData GeometryGenerator::CreateBox(float width, float height, float depth, uint32 numSubdivisions)
 {
-    MeshData meshData;
-
-    //
-	// Create the vertices.
-	//
-
-	Vertex v[24];
-
-	float w2 = 0.5f*width;
-	float h2 = 0.5f*height;
-	float d2 = 0.5f*depth;
-    
-	// Fill in the front face vertex data.
-	v[0] = Vertex(-w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[1] = Vertex(-w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[2] = Vertex(+w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-	v[3] = Vertex(+w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-
-	// Fill in the back face vertex data.
-	v[4] = Vertex(-w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[5] = Vertex(+w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[6] = Vertex(+w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[7] = Vertex(-w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-
-	// Fill in the top face vertex data.
-	v[8]  = Vertex(-w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[9]  = Vertex(-w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[10] = Vertex(+w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-	v[11] = Vertex(+w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-
-	// Fill in the bottom face vertex data.
-	v[12] = Vertex(-w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[13] = Vertex(+w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[14] = Vertex(+w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[15] = Vertex(-w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-
-	// Fill in the left face vertex data.
-	v[16] = Vertex(-w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f);
-	v[17] = Vertex(-w2, +h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f);
-	v[18] = Vertex(-w2, +h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f);
-	v[19] = Vertex(-w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f);
-
-	// Fill in the right face vertex data.
-	v[20] = Vertex(+w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
-	v[21] = Vertex(+w2, +h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
-	v[22] = Vertex(+w2, +h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
-	v[23] = Vertex(+w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
-
-	meshData.Vertices.assign(&v[0], &v[24]);
- 
-	//
-	// Create the indices.
-	//
-
-	uint32 i[36];
-
-	// Fill in the front face index data
-	i[0] = 0; i[1] = 1; i[2] = 2;
-	i[3] = 0; i[4] = 2; i[5] = 3;
-
-	// Fill in the back face index data
-	i[6] = 4; i[7]  = 5; i[8]  = 6;
-	i[9] = 4; i[10] = 6; i[11] = 7;
-
-	// Fill in the top face index data
-	i[12] = 8; i[13] =  9; i[14] = 10;
-	i[15] = 8; i[16] = 10; i[17] = 11;
-
-	// Fill in the bottom face index data
-	i[18] = 12; i[19] = 13; i[20] = 14;
-	i[21] = 12; i[22] = 14; i[23] = 15;
-
-	// Fill in the left face index data
-	i[24] = 16; i[25] = 17; i[26] = 18;
-	i[27] = 16; i[28] = 18; i[29] = 19;
-
-	// Fill in the right face index data
-	i[30] = 20; i[31] = 21; i[32] = 22;
-	i[33] = 20; i[34] = 22; i[35] = 23;
-
-	meshData.Indices32.assign(&i[0], &i[36]);
-
-    // Put a cap on the number of subdivisions.
-    numSubdivisions = std::min<uint32>(numSubdivisions, 6u);
-
-    for(uint32 i = 0; i < numSubdivisions; ++i)
-        Subdivide(meshData);
+    PROFILE_SCOPE("GeometryGenerator::CreateBox");
+    ALLOCATION_SCOPE("GeometryGenerator::CreateBox");
 
+    MeshData meshData;
+    ShapeWriter::AppendBox(meshData.Vertices, meshData.Indices32, ShapeWriter::GeneratorVertexWriter(), width, height, depth, numSubdivisions);
     return meshData;
 }
 
 GeometryGenerator::MeshData GeometryGenerator::CreateWedge(float width, float height, float depth, uint32 numSubdivisions)
 {
-	MeshData meshData;
-
-	//
-	// Create the vertices.
-	//
-
-	Vertex v[18];
-
-	float w2 = 0.5f * width;
-	float h2 = 0.5f * height;
-	float d2 = 0.5f * depth;
-
-	// Fill in the front face vertex data.
-	v[0] = Vertex(-w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[3] = Vertex(+w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[2] = Vertex(+w2, +h2, +d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-	v[1] = Vertex(-w2, +h2, +d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-
-	// Fill in the back face vertex data.
-	v[4] = Vertex(-w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[5] = Vertex(+w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[6] = Vertex(+w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[7] = Vertex(-w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-
-	// Fill in the bottom face vertex data.
-	v[8] = Vertex(-w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[9] = Vertex(+w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[10] = Vertex(+w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[11] = Vertex(-w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-
-	// Fill in the left face vertex data.
-	v[12] = Vertex(-w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f);
-	v[13] = Vertex(-w2, +h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f);
-	v[14] = Vertex(-w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f);
-
-	// Fill in the right face vertex data.
-	v[15] = Vertex(+w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
-	v[16] = Vertex(+w2, +h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
-	v[17] = Vertex(+w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
-
-	meshData.Vertices.assign(&v[0], &v[18]);
-
-	//
-	// Create the indices.
-	//
-
-	uint32 i[24];
-
-	// Fill in the front face index data
-	i[0] = 0; i[1] = 1; i[2] = 2;
-	i[3] = 0; i[4] = 2; i[5] = 3;
-
-	// Fill in the back face index data
-	i[6] = 4; i[7] = 5; i[8] = 6;
-	i[9] = 4; i[10] = 6; i[11] = 7;
-
-	// Fill in the bottom face index data
-	i[12] = 8; i[13] = 9; i[14] = 10;
-	i[15] = 8; i[16] = 10; i[17] = 11;
-
-	// Fill in the left face index data
-	i[18] = 12; i[19] = 13; i[20] = 14;
-
-	// Fill in the right face index data
-	i[21] = 15; i[22] = 16; i[23] = 17;
-
-	meshData.Indices32.assign(&i[0], &i[24]);
-
-	// Put a cap on the number of subdivisions.
-	numSubdivisions = std::min<uint32>(numSubdivisions, 6u);
-
-	for (uint32 i = 0; i < numSubdivisions; ++i)
-		Subdivide(meshData);
+	PROFILE_SCOPE("GeometryGenerator::CreateWedge");
+	ALLOCATION_SCOPE("GeometryGenerator::CreateWedge");
 
+	MeshData meshData;
+	ShapeWriter::AppendWedge(meshData.Vertices, meshData.Indices32, ShapeWriter::GeneratorVertexWriter(), width, height, depth, numSubdivisions);
 	return meshData;
 }
 
 GeometryGenerator::MeshData GeometryGenerator::CreatePyramid(float width, float height, float depth, uint32 numSubdivisions)
 {
-	MeshData meshData;
-
-	//
-	// Create the vertices.
-	//
-
-	Vertex v[16];
-
-	float w2 = 0.5f * width;
-	float h2 = 0.5f * height;
-	float d2 = 0.5f * depth;
-
-	// Fill in the front Triange face vertex data.
-	v[0] = Vertex(0.0f, +h2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[1] = Vertex(-w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[2] = Vertex(+w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-
-	// Fill in the back Triange face vertex data.
-	v[3] = Vertex(0.0f, +h2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[4] = Vertex(+w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[5] = Vertex(-w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-
-	// Fill in the left Triange face vertex data.
-	v[6] = Vertex(0.0f, +h2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[7] = Vertex(-w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f);
-	v[8] = Vertex(-w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f);
-
-	// Fill in the right Triange face vertex data.
-	v[9] = Vertex(0.0f, +h2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[10] = Vertex(+w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
-	v[11] = Vertex(+w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
-
-	// Fill in the bottom Square face vertex data.
-	v[12] = Vertex(-w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[13] = Vertex(+w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[14] = Vertex(+w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[15] = Vertex(-w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-
-	meshData.Vertices.assign(&v[0], &v[16]);
-
-	//
-	// Create the indices.
-	//
-
-	uint32 i[18];
-
-	// Fill in the front face index data
-	i[0] = 0; i[1] = 2; i[2] = 1;
-
-	// Fill in the right face index data
-	i[3] = 2; i[4] = 3; i[5] = 4;
-
-	// Fill in the back face index data
-	i[6] = 4; i[7] = 6; i[8] = 5;
-
-	// Fill in the left face index data
-	i[9] = 6; i[10] = 8; i[11] = 7;
-
-	// Fill in the bottom face index data
-	i[12] = 5; i[13] = 1; i[14] = 2; 
-	i[15] = 2; i[16] = 4; i[17] = 5;
-
-	meshData.Indices32.assign(&i[0], &i[18]);
-
-	// Put a cap on the number of subdivisions.
-	numSubdivisions = std::min<uint32>(numSubdivisions, 6u);
-
-	for (uint32 i = 0; i < numSubdivisions; ++i)
-		Subdivide(meshData);
+	PROFILE_SCOPE("GeometryGenerator::CreatePyramid");
+	ALLOCATION_SCOPE("GeometryGenerator::CreatePyramid");
 
+	MeshData meshData;
+	ShapeWriter::AppendPyramid(meshData.Vertices, meshData.Indices32, ShapeWriter::GeneratorVertexWriter(), width, height, depth, numSubdivisions);
 	return meshData;
 }
 
 GeometryGenerator::MeshData GeometryGenerator::CreateDiamond(float width, float height, float depth, uint32 numSubdivisions)
 {
-	MeshData meshData;
-
-	//
-	// Create the vertices.
-	//
-
-	Vertex v[24];
-
-	float w2 = 0.5f * width;
-	float h2 = 0.5f * height;
-	float d2 = 0.5f * depth;
-
-	// TOP HALF
-	// Fill in the Top front Triange face vertex data.
-	v[0] = Vertex(0.0f, +h2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[1] = Vertex(-w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[2] = Vertex(+w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-
-	// Fill in the Top back Triange face vertex data.
-	v[3] = Vertex(0.0f, +h2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[4] = Vertex(+w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[5] = Vertex(-w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-
-	// Fill in the Top left Triange face vertex data.
-	v[6] = Vertex(0.0f, +h2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[7] = Vertex(-w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f);
-	v[8] = Vertex(-w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f);
-
-	// Fill in the Top right Triange face vertex data.
-	v[9] = Vertex(0.0f, +h2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[10] = Vertex(+w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
-	v[11] = Vertex(+w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
-
-
-	// BOTTOM HALF
-	// Fill in the Bottom front Triange face vertex data.
-	v[12] = Vertex(0.0f, -h2 * 2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[13] = Vertex(-w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[14] = Vertex(+w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-
-	//Fill in the Bottom back Triange face vertex data.
-	v[15] = Vertex(0.0f, -h2 * 2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[16] = Vertex(+w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[17] = Vertex(-w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-
-	//Fill in the Bottom left Triange face vertex data.
-	v[18] = Vertex(0.0f, -h2 * 2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[19] = Vertex(-w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f);
-	v[20] = Vertex(-w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f);
-
-	//Fill in the Bottom right Triange face vertex data.
-	v[21] = Vertex(0.0f, -h2 *2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[22] = Vertex(+w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
-	v[23] = Vertex(+w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
-
-	meshData.Vertices.assign(&v[0], &v[24]);
-
-	//
-	// Create the indices.
-	//
-
-	uint32 i[24];
-
-	// Fill in the Top front face index data
-	i[0] = 0; i[1] = 2; i[2] = 1;
-
-	// Fill in the Top right face index data
-	i[3] = 2; i[4] = 3; i[5] = 4;
-
-	// Fill in the Top back face index data
-	i[6] = 4; i[7] = 6; i[8] = 5;
-
-	// Fill in the Top left face index data
-	i[9] = 6; i[10] = 8; i[11] = 7;
-
-
-	// Fill in the Bottom left face index data
-	i[12] = 8; i[13] = 12; i[14] = 7;
-
-	// Fill in the Bottom right face index data
-	i[15] = 12; i[16] = 10; i[17] = 11;
-
-	// Fill in the Bottom front face index data
-	i[18] = 12; i[19] = 13; i[20] = 14;
-
-	// Fill in the Bottom back face index data
-	i[21] = 7; i[22] = 12; i[23] = 11;
-
-	meshData.Indices32.assign(&i[0], &i[24]);
-
-	// Put a cap on the number of subdivisions.
-	numSubdivisions = std::min<uint32>(numSubdivisions, 6u);
-
-	for (uint32 i = 0; i < numSubdivisions; ++i)
-		Subdivide(meshData);
+	PROFILE_SCOPE("GeometryGenerator::CreateDiamond");
+	ALLOCATION_SCOPE("GeometryGenerator::CreateDiamond");
 
+	MeshData meshData;
+	ShapeWriter::AppendDiamond(meshData.Vertices, meshData.Indices32, ShapeWriter::GeneratorVertexWriter(), width, height, depth, numSubdivisions);
 	return meshData;
 }
 
 GeometryGenerator::MeshData GeometryGenerator::CreateTriPrism(float width, float height, float depth, uint32 numSubdivisions)
 {
-	MeshData meshData;
-
-	//
-	// Create the vertices.
-	//
-
-	Vertex v[18];
-
-	float w2 = 0.5f * width;
-	float h2 = 0.5f * height;
-	float d2 = 0.5f * depth;
-
-	// Fill in the front face vertex data.
-	v[0] = Vertex(-w2*2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[3] = Vertex(+w2 * 2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[2] = Vertex(+w2 * 2, +h2, +d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-	v[1] = Vertex(-w2*2, +h2, +d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-
-	// Fill in the back face vertex data.
-	v[4] = Vertex(-w2 * 2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[5] = Vertex(+w2 * 2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[6] = Vertex(+w2 * 2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[7] = Vertex(-w2 * 2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-
-	// Fill in the bottom face vertex data.
-	v[8] = Vertex(-w2 * 2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[9] = Vertex(+w2 * 2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[10] = Vertex(+w2 * 2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[11] = Vertex(-w2 * 2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-
-	// Fill in the left face vertex data.
-	v[12] = Vertex(-w2 * 2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f);
-	v[13] = Vertex(-w2 * 2, +h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f);
-	v[14] = Vertex(-w2 * 2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f);
-
-	// Fill in the right face vertex data.
-	v[15] = Vertex(+w2 * 2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
-	v[16] = Vertex(+w2 * 2, +h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
-	v[17] = Vertex(+w2 * 2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
-
-	meshData.Vertices.assign(&v[0], &v[18]);
-
-	//
-	// Create the indices.
-	//
-
-	uint32 i[24];
-
-	// Fill in the front face index data
-	i[0] = 0; i[1] = 1; i[2] = 2;
-	i[3] = 0; i[4] = 2; i[5] = 3;
-
-	// Fill in the back face index data
-	i[6] = 4; i[7] = 5; i[8] = 6;
-	i[9] = 4; i[10] = 6; i[11] = 7;
-
-	// Fill in the bottom face index data
-	i[12] = 8; i[13] = 9; i[14] = 10;
-	i[15] = 8; i[16] = 10; i[17] = 11;
-
-	// Fill in the left face index data
-	i[18] = 12; i[19] = 13; i[20] = 14;
-
-	// Fill in the right face index data
-	i[21] = 15; i[22] = 16; i[23] = 17;
-
-	meshData.Indices32.assign(&i[0], &i[24]);
-
-	// Put a cap on the number of subdivisions.
-	numSubdivisions = std::min<uint32>(numSubdivisions, 6u);
-
-	for (uint32 i = 0; i < numSubdivisions; ++i)
-		Subdivide(meshData);
+	PROFILE_SCOPE("GeometryGenerator::CreateTriPrism");
+	ALLOCATION_SCOPE("GeometryGenerator::CreateTriPrism");
 
+	MeshData meshData;
+	ShapeWriter::AppendTriPrism(meshData.Vertices, meshData.Indices32, ShapeWriter::GeneratorVertexWriter(), width, height, depth, numSubdivisions);
 	return meshData;
 }
 
-//GeometryGenerator::MeshData GeometryGenerator::CreateTorus(float outerRadius, float innerRadius, uint32 sliceCount, uint32 stackCount)
-//{
-//	MeshData meshData;
-//
-//	float thetaStep = 2.0f * XM_PI / sliceCount;
-//	float phiStep = 2.0f * XM_PI / stackCount;
-//
-//	for (uint32 i = 0; i <= stackCount; ++i)
-//	{
-//		float phi = i * phiStep;
-//
-//		for (uint32 j = 0; j <= sliceCount; ++j)
-//		{
-//			float theta = j * thetaStep;
-//
-//			Vertex v;
-//
-//			v.Position.x = (outerRadius + innerRadius * cosf(phi)) * cosf(theta);
-//			v.Position.y = innerRadius * sinf(phi);
-//			v.Position.z = (outerRadius + innerRadius * cosf(phi)) * sinf(theta);
-//
-//			v.Normal.x = cosf(phi) * cosf(theta);
-//			v.Normal.y = sinf(phi);
-//			v.Normal.z = cosf(phi) * sinf(theta);
-//
-//			XMVECTOR p = XMLoadFloat3(&v.Position);
-//			XMVECTOR n = XMLoadFloat3(&v.Normal);
-//			XMVECTOR T = XMVector3Normalize(XMVector3Cross(p, n));
-//			XMStoreFloat3(&v.TangentU, T);
-//
-//			v.TexC.x = theta / XM_2PI;
-//			v.TexC.y = phi / XM_2PI;
-//
-//			meshData.Vertices.push_back(v);
-//		}
-//	}
-//
-//	for (uint32 i = 0; i < stackCount; ++i)
-//	{
-//		for (uint32 j = 0; j < sliceCount; ++j)
-//		{
-//			meshData.Indices32.push_back(i * (sliceCount + 1) + j);
-//			meshData.Indices32.push_back(i * (sliceCount + 1) + j + 1);
-//			meshData.Indices32.push_back((i + 1) * (sliceCount + 1) + j);
-//
-//			meshData.Indices32.push_back((i + 1) * (sliceCount + 1) + j);
-//			meshData.Indices32.push_back(i * (sliceCount + 1) + j + 1);
-//			meshData.Indices32.push_back((i + 1) * (sliceCount + 1) + j + 1);
-//		}
-//	}
-//
-//	return meshData;
-//}
\ No newline at end of file
+GeometryGenerator::MeshData GeometryGenerator::CreateTorus(float outerRadius, float innerRadius, uint32 sliceCount, uint32 stackCount)
+{
+	PROFILE_SCOPE("GeometryGenerator::CreateTorus");
+	ALLOCATION_SCOPE("GeometryGenerator::CreateTorus");
+
+	MeshData meshData;
+	ParametricSurface::Torus torus{ outerRadius, innerRadius };
+	ParametricSurface::Append(meshData.Vertices, meshData.Indices32, ShapeWriter::GeneratorVertexWriter(), torus, sliceCount, stackCount);
+	return meshData;
+}
\ No newline at end of file
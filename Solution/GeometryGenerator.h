@@ -18,6 +18,8 @@
 #include <DirectXMath.h>
 #include <vector>
 
+class ThreadPool;
+
 class GeometryGenerator
 {
 public:
@@ -92,6 +94,19 @@ public:
 	///</summary>
     MeshData CreateGeosphere(float radius, uint32 numSubdivisions);
 
+	///<summary>
+	/// Creates a geosphere at any frequency: each icosahedron face is cut into a
+	/// frequency x frequency triangular grid (frequency 2^n gives the triangles of
+	/// CreateGeosphere with n subdivisions) with no duplicated vertices.  The faces are built in parallel on
+	/// the pool, and the result does not depend on the thread count.  The frequency
+	/// is clamped to [1, MaxGeodesicFrequency].
+	///</summary>
+	MeshData CreateGeodesicSphere(float radius, uint32 frequency, ThreadPool& pool);
+
+	// The mesh has 60 * frequency^2 indices; this is the largest frequency whose
+	// index count fits in a uint32.
+	static const uint32 MaxGeodesicFrequency = 8460;
+
 	///<summary>
 	/// Creates a cylinder parallel to the y-axis, and centered about the origin.  
 	/// The bottom and top radius can vary to form various cone shapes rather than true
@@ -120,14 +135,16 @@ public:
 
 	MeshData CreateDiamond(float width, float height, float depth, uint32 numSubdivisions);
 
-    //MeshData CreateTorus(float outerRadius, float innerRadius, uint32 sliceCount, uint32 stackCount);
+	///<summary>
+	/// Creates a torus around the y-axis: a tube of innerRadius around a circle of
+	/// outerRadius, with sliceCount segments around the y-axis and stackCount around
+	/// the tube.  Built on ParametricSurface.
+	///</summary>
+	MeshData CreateTorus(float outerRadius, float innerRadius, uint32 sliceCount, uint32 stackCount);
 
 	void Subdivide(MeshData& meshData);
 private:
 	
     Vertex MidPoint(const Vertex& v0, const Vertex& v1);
-    void BuildCylinderTopCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, MeshData& meshData);
-    void BuildCylinderBottomCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, MeshData& meshData);
-    void BuildConeBottomCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, MeshData& meshData);
 };
 
@@ -0,0 +1,174 @@
+//***************************************************************************************
+// GeometryStreamer.cpp
+//***************************************************************************************
+
+#include "GeometryStreamer.h"
+
+#include <cassert>
+
+GeometryStreamer::GeometryStreamer(ThreadPool& pool, StagingUploader& uploader, uint32 slotCount)
+	: mPool(pool), mUploader(uploader), mSlots(slotCount > 0 ? slotCount : 1)
+{
+	uint32 count = (uint32)mSlots.size();
+	mFinished.resize(count);
+	mDrained.reserve(count);
+	mFreeSlots.reserve(count);
+	for(uint32 i = count; i > 0; --i)
+		mFreeSlots.push_back(i - 1);
+}
+
+GeometryStreamer::~GeometryStreamer()
+{
+	// Workers may still be generating into the slots.
+	uint32 outstanding = (uint32)(mSlots.size() - mFreeSlots.size());
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	mSlotFinished.wait(lock, [this, outstanding]() { return mFinishedCount == outstanding; });
+}
+
+GeometryStreamer::Handle GeometryStreamer::Add(Request request)
+{
+	assert(request.Generate);
+
+	mRequests.push_back(std::move(request));
+	mStates.push_back(State::Pending);
+	return (Handle)mStates.size() - 1;
+}
+
+GeometryStreamer::uint32 GeometryStreamer::Pump(uint64 uploadBudget)
+{
+	uint32 resident = RetireUploads();
+
+	// Start work before draining, so with no worker threads (where the pool runs tasks
+	// inline) the meshes generated now go up in this same batch.
+	Dispatch();
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		uint64 bytes = 0;
+		while(mFinishedCount > 0 && (mDrained.empty() || bytes < uploadBudget))
+		{
+			uint32 slot = mFinished[mFinishedHead];
+			mFinishedHead = (mFinishedHead + 1) % (uint32)mFinished.size();
+			--mFinishedCount;
+
+			const MeshData& mesh = mSlots[slot].Mesh;
+			bytes += mesh.Vertices.size() + mesh.Indices.size();
+			mDrained.push_back(slot);
+		}
+	}
+
+	if(mDrained.empty())
+		return resident;
+
+	for(uint32 slot : mDrained)
+	{
+		Slot& s = mSlots[slot];
+		const Request& request = mRequests[s.Request];
+
+		if(!s.Mesh.Vertices.empty())
+			mUploader.Upload(request.VertexDestination, request.VertexOffset, s.Mesh.Vertices.data(), s.Mesh.Vertices.size());
+		if(!s.Mesh.Indices.empty())
+			mUploader.Upload(request.IndexDestination, request.IndexOffset, s.Mesh.Indices.data(), s.Mesh.Indices.size());
+
+		mStates[s.Request] = State::Uploading;
+		mUploads.push_back({ s.Request, 0 });
+
+		s.Request = InvalidHandle;
+		mFreeSlots.push_back(slot);
+	}
+
+	// One batch for everything drained this call.
+	uint64 fence = mUploader.Flush();
+	for(uint32 i = (uint32)(mUploads.size() - mDrained.size()); i < mUploads.size(); ++i)
+		mUploads[i].FenceValue = fence;
+	mDrained.clear();
+
+	// The freed slots can start on the next requests straight away.
+	Dispatch();
+
+	return resident;
+}
+
+void GeometryStreamer::Finish()
+{
+	while(!IsComplete())
+	{
+		Pump();
+		if(IsComplete())
+			break;
+
+		// Pump uploaded everything that had finished, so any slot still out is being
+		// generated.  Otherwise only the copies are left to wait for.
+		bool generating = mFreeSlots.size() < mSlots.size();
+		if(generating)
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mSlotFinished.wait(lock, [this]() { return mFinishedCount > 0; });
+		}
+		else if(!mUploads.empty())
+		{
+			mUploader.WaitIdle();
+		}
+	}
+}
+
+void GeometryStreamer::Dispatch()
+{
+	while(!mFreeSlots.empty() && mNextPending < mStates.size())
+	{
+		uint32 slot = mFreeSlots.back();
+		mFreeSlots.pop_back();
+
+		Handle handle = mNextPending++;
+		mStates[handle] = State::Generating;
+
+		Slot& s = mSlots[slot];
+		s.Request = handle;
+		s.Generate = std::move(mRequests[handle].Generate);
+
+		mPool.Submit([this, slot]() { GenerateSlot(slot); });
+	}
+}
+
+void GeometryStreamer::GenerateSlot(uint32 slot)
+{
+	Slot& s = mSlots[slot];
+	s.Generate(s.Mesh);
+	s.Generate = nullptr;
+
+	// Notify under the lock: once the count is up, the destructor may be free to run.
+	std::lock_guard<std::mutex> lock(mMutex);
+	uint32 tail = (mFinishedHead + mFinishedCount) % (uint32)mFinished.size();
+	mFinished[tail] = slot;
+	++mFinishedCount;
+	mSlotFinished.notify_all();
+}
+
+GeometryStreamer::uint32 GeometryStreamer::RetireUploads()
+{
+	if(mUploads.empty())
+		return 0;
+
+	uint64 completed = mUploader.GetCompletedFence();
+
+	// Uploads are in fence order.
+	uint32 retired = 0;
+	while(retired < mUploads.size() && mUploads[retired].FenceValue <= completed)
+	{
+		Handle handle = mUploads[retired].Request;
+		mStates[handle] = State::Resident;
+		++mResidentCount;
+
+		Request& request = mRequests[handle];
+		if(request.OnResident)
+			request.OnResident();
+
+		// Nothing reads the request again; let go of whatever the functions captured.
+		request = Request();
+		++retired;
+	}
+
+	mUploads.erase(mUploads.begin(), mUploads.begin() + retired);
+	return retired;
+}
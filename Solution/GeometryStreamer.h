@@ -0,0 +1,139 @@
+//***************************************************************************************
+// GeometryStreamer.h
+//
+// Loads geometry in the background so the first frame doesn't wait for the whole
+// scene.  Each request names a function that generates (or loads) one mesh and where
+// its vertices and indices go.  Pump, called once a frame, hands pending requests to
+// the thread pool, moves finished meshes into the StagingUploader and reports a mesh
+// resident once its copy fence has completed; until then its render items are simply
+// not drawn.
+//
+// Finished meshes wait in a bounded queue: only as many requests are generated ahead
+// of the uploader as there are mesh slots, so a slow copy engine holds generation back
+// instead of piling up CPU copies, and workers never block on a full queue.
+//***************************************************************************************
+
+#pragma once
+
+#include "StagingUploader.h"
+#include "ThreadPool.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class GeometryStreamer
+{
+public:
+
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+	using Handle = uint32;
+
+	static const Handle InvalidHandle = ~0u;
+
+	// Vertex and index bytes of one generated mesh.  A slot's vectors are reused from
+	// one request to the next, so steady streaming settles without allocating.
+	struct MeshData
+	{
+		std::vector<std::uint8_t> Vertices;
+		std::vector<std::uint8_t> Indices;
+	};
+
+	struct Request
+	{
+		// Fills the mesh; runs on a worker thread.
+		std::function<void(MeshData&)> Generate;
+
+		// Destination buffers as the uploader's CopyQueue names them.
+		void* VertexDestination = nullptr;
+		uint64 VertexOffset = 0;
+		void* IndexDestination = nullptr;
+		uint64 IndexOffset = 0;
+
+		// Runs inside Pump once the mesh is resident; may be empty.
+		std::function<void()> OnResident;
+	};
+
+	///<summary>
+	/// slotCount bounds how many meshes are generated but not yet uploaded.  pool and
+	/// uploader must outlive the streamer.
+	///</summary>
+	GeometryStreamer(ThreadPool& pool, StagingUploader& uploader, uint32 slotCount = 4);
+	GeometryStreamer(const GeometryStreamer& rhs) = delete;
+	GeometryStreamer& operator=(const GeometryStreamer& rhs) = delete;
+	~GeometryStreamer();
+
+	///<summary>
+	/// Queues a request.  Requests are generated in the order they are added.
+	///</summary>
+	Handle Add(Request request);
+
+	///<summary>
+	/// Advances the pipeline without blocking on the workers: retires uploads whose
+	/// fence has completed, starts generating pending requests, and uploads finished
+	/// meshes as one batch, stopping after uploadBudget bytes (at least one mesh goes
+	/// through).  Returns how many meshes became resident.
+	///</summary>
+	uint32 Pump(uint64 uploadBudget = ~0ull);
+
+	///<summary>
+	/// Pumps until every request is resident, waiting on the workers and the copy
+	/// engine in between.
+	///</summary>
+	void Finish();
+
+	bool IsResident(Handle handle)const { return handle < mStates.size() && mStates[handle] == State::Resident; }
+
+	uint32 GetRequestCount()const { return (uint32)mStates.size(); }
+	uint32 GetResidentCount()const { return mResidentCount; }
+	bool IsComplete()const { return mResidentCount == mStates.size(); }
+
+private:
+	enum class State
+	{
+		Pending,
+		Generating,
+		Uploading,
+		Resident
+	};
+
+	struct Slot
+	{
+		Handle Request = InvalidHandle;
+		std::function<void(MeshData&)> Generate;
+		MeshData Mesh;
+	};
+
+	struct Upload
+	{
+		Handle Request;
+		uint64 FenceValue;
+	};
+
+	void Dispatch();
+	void GenerateSlot(uint32 slot);
+	uint32 RetireUploads();
+
+	ThreadPool& mPool;
+	StagingUploader& mUploader;
+
+	// Main thread only.
+	std::vector<Request> mRequests;
+	std::vector<State> mStates;
+	std::vector<Slot> mSlots;
+	std::vector<uint32> mFreeSlots;
+	std::vector<Upload> mUploads;
+	std::vector<uint32> mDrained;
+	uint32 mNextPending = 0;
+	uint32 mResidentCount = 0;
+
+	// Finished slots, written by the workers.  Never holds more than mSlots.size().
+	std::mutex mMutex;
+	std::condition_variable mSlotFinished;
+	std::vector<uint32> mFinished;
+	uint32 mFinishedHead = 0;
+	uint32 mFinishedCount = 0;
+};
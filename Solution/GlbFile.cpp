@@ -0,0 +1,592 @@
+//***************************************************************************************
+// GlbFile.cpp
+//***************************************************************************************
+
+#include "GlbFile.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+using namespace Gltf;
+
+namespace
+{
+	using uint64 = std::uint64_t;
+
+	const uint32 GlbMagic = 0x46546C67;    // "glTF"
+	const uint32 GlbVersion = 2;
+	const uint32 JsonChunk = 0x4E4F534A;   // "JSON"
+	const uint32 BinChunk = 0x004E4942;    // "BIN\0"
+	const uint32 MaxJsonDepth = 64;
+
+	uint32 ReadUint32(const std::uint8_t* p)
+	{
+		uint32 value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	// Just enough of a JSON document model for the glTF header: the JSON chunk is small
+	// next to the binary data, so it is parsed into a tree once and walked afterwards.
+	struct JsonValue
+	{
+		enum Kind { Null, Bool, Number, String, Array, Object };
+
+		Kind Type = Null;
+		double NumberValue = 0.0;
+		std::string StringValue;
+		std::vector<JsonValue> Elements;
+		std::vector<std::pair<std::string, JsonValue>> Members;
+
+		const JsonValue* Find(const char* key)const
+		{
+			for(const auto& member : Members)
+			{
+				if(member.first == key)
+					return &member.second;
+			}
+			return nullptr;
+		}
+	};
+
+	class JsonParser
+	{
+	public:
+		JsonParser(const char* text, std::size_t size) : mText(text), mEnd(text + size) {}
+
+		bool Parse(JsonValue& root)
+		{
+			if(!ParseValue(root, 0))
+				return false;
+			SkipSpace();
+			return mText == mEnd;
+		}
+
+	private:
+		void SkipSpace()
+		{
+			while(mText != mEnd && (*mText == ' ' || *mText == '\t' || *mText == '\n' || *mText == '\r'))
+				++mText;
+		}
+
+		bool Consume(char c)
+		{
+			SkipSpace();
+			if(mText == mEnd || *mText != c)
+				return false;
+			++mText;
+			return true;
+		}
+
+		bool ConsumeWord(const char* word)
+		{
+			std::size_t length = std::strlen(word);
+			if((std::size_t)(mEnd - mText) < length || std::memcmp(mText, word, length) != 0)
+				return false;
+			mText += length;
+			return true;
+		}
+
+		bool ParseValue(JsonValue& value, uint32 depth)
+		{
+			if(depth > MaxJsonDepth)
+				return false;
+
+			SkipSpace();
+			if(mText == mEnd)
+				return false;
+
+			switch(*mText)
+			{
+			case '{': return ParseObject(value, depth);
+			case '[': return ParseArray(value, depth);
+			case '"': value.Type = JsonValue::String; return ParseString(value.StringValue);
+			case 't': value.Type = JsonValue::Bool; value.NumberValue = 1.0; return ConsumeWord("true");
+			case 'f': value.Type = JsonValue::Bool; return ConsumeWord("false");
+			case 'n': value.Type = JsonValue::Null; return ConsumeWord("null");
+			default: value.Type = JsonValue::Number; return ParseNumber(value.NumberValue);
+			}
+		}
+
+		bool ParseObject(JsonValue& value, uint32 depth)
+		{
+			value.Type = JsonValue::Object;
+			++mText;
+			if(Consume('}'))
+				return true;
+
+			do
+			{
+				std::pair<std::string, JsonValue> member;
+				SkipSpace();
+				if(mText == mEnd || *mText != '"' || !ParseString(member.first) || !Consume(':') ||
+					!ParseValue(member.second, depth + 1))
+					return false;
+				value.Members.push_back(std::move(member));
+			} while(Consume(','));
+
+			return Consume('}');
+		}
+
+		bool ParseArray(JsonValue& value, uint32 depth)
+		{
+			value.Type = JsonValue::Array;
+			++mText;
+			if(Consume(']'))
+				return true;
+
+			do
+			{
+				value.Elements.emplace_back();
+				if(!ParseValue(value.Elements.back(), depth + 1))
+					return false;
+			} while(Consume(','));
+
+			return Consume(']');
+		}
+
+		bool ParseString(std::string& out)
+		{
+			++mText;
+			while(mText != mEnd && *mText != '"')
+			{
+				char c = *mText++;
+				if((unsigned char)c < 0x20)
+					return false;
+				if(c != '\\')
+				{
+					out += c;
+					continue;
+				}
+
+				if(mText == mEnd)
+					return false;
+				switch(*mText++)
+				{
+				case '"': out += '"'; break;
+				case '\\': out += '\\'; break;
+				case '/': out += '/'; break;
+				case 'b': out += '\b'; break;
+				case 'f': out += '\f'; break;
+				case 'n': out += '\n'; break;
+				case 'r': out += '\r'; break;
+				case 't': out += '\t'; break;
+				case 'u':
+				{
+					// Names are all the loader reads, so code points are kept as UTF-8
+					// without pairing surrogates.
+					uint32 code = 0;
+					for(int k = 0; k < 4; ++k, ++mText)
+					{
+						if(mText == mEnd)
+							return false;
+						char h = *mText;
+						uint32 digit = h >= '0' && h <= '9' ? h - '0' : h >= 'a' && h <= 'f' ? h - 'a' + 10 :
+							h >= 'A' && h <= 'F' ? h - 'A' + 10 : 16;
+						if(digit == 16)
+							return false;
+						code = code * 16 + digit;
+					}
+					if(code < 0x80)
+						out += (char)code;
+					else if(code < 0x800)
+					{
+						out += (char)(0xC0 | (code >> 6));
+						out += (char)(0x80 | (code & 0x3F));
+					}
+					else
+					{
+						out += (char)(0xE0 | (code >> 12));
+						out += (char)(0x80 | ((code >> 6) & 0x3F));
+						out += (char)(0x80 | (code & 0x3F));
+					}
+					break;
+				}
+				default:
+					return false;
+				}
+			}
+
+			if(mText == mEnd)
+				return false;
+			++mText;
+			return true;
+		}
+
+		bool ParseNumber(double& out)
+		{
+			char buffer[64];
+			std::size_t length = 0;
+			while(mText != mEnd && length + 1 < sizeof(buffer) &&
+				((*mText >= '0' && *mText <= '9') || *mText == '-' || *mText == '+' || *mText == '.' || *mText == 'e' || *mText == 'E'))
+				buffer[length++] = *mText++;
+			buffer[length] = '\0';
+
+			char* end = nullptr;
+			out = std::strtod(buffer, &end);
+			return length != 0 && end == buffer + length;
+		}
+
+		const char* mText;
+		const char* mEnd;
+	};
+
+	// The unsigned integer member key, or fallback if there is none.  False if the
+	// member is there but isn't one.
+	bool GetUint(const JsonValue& object, const char* key, uint64 fallback, uint64& out)
+	{
+		const JsonValue* value = object.Find(key);
+		if(value == nullptr)
+		{
+			out = fallback;
+			return true;
+		}
+
+		double number = value->NumberValue;
+		if(value->Type != JsonValue::Number || number < 0.0 || number > 4294967295.0 || number != (double)(uint64)number)
+			return false;
+
+		out = (uint64)number;
+		return true;
+	}
+
+	const JsonValue* GetElement(const JsonValue* array, uint64 index)
+	{
+		if(array == nullptr || array->Type != JsonValue::Array || index >= array->Elements.size())
+			return nullptr;
+		return &array->Elements[(std::size_t)index];
+	}
+
+	uint32 GetComponentSize(uint32 componentType)
+	{
+		switch(componentType)
+		{
+		case Byte: case UnsignedByte: return 1;
+		case Short: case UnsignedShort: return 2;
+		case UnsignedInt: case Float: return 4;
+		default: return 0;
+		}
+	}
+
+	uint32 GetComponentCount(const std::string& type)
+	{
+		if(type == "SCALAR") return 1;
+		if(type == "VEC2") return 2;
+		if(type == "VEC3") return 3;
+		if(type == "VEC4") return 4;
+		return 0;
+	}
+
+	struct Buffer
+	{
+		const std::uint8_t* Data = nullptr;
+		uint64 Size = 0;
+	};
+
+	// The parsed JSON and the buffers it refers to, while the meshes are read.
+	struct Document
+	{
+		JsonValue Root;
+		std::vector<Buffer> Buffers;
+
+		// Resolves accessor index into a pointer into its buffer, checking that all of it
+		// is inside the buffer and aligned to its component size.
+		bool ResolveAccessor(uint64 index, uint32 componentCount, Accessor& accessor)const
+		{
+			const JsonValue* json = GetElement(Root.Find("accessors"), index);
+			if(json == nullptr || json->Find("sparse") != nullptr)
+				return false;
+
+			uint64 viewIndex, offset, componentType, count;
+			const JsonValue* type = json->Find("type");
+			const JsonValue* normalized = json->Find("normalized");
+			if(!GetUint(*json, "bufferView", UINT64_MAX, viewIndex) || !GetUint(*json, "byteOffset", 0, offset) ||
+				!GetUint(*json, "componentType", 0, componentType) || !GetUint(*json, "count", UINT64_MAX, count) ||
+				type == nullptr || GetComponentCount(type->StringValue) != componentCount)
+				return false;
+
+			const JsonValue* view = GetElement(Root.Find("bufferViews"), viewIndex);
+			uint64 bufferIndex, viewOffset, viewLength, stride;
+			if(view == nullptr || !GetUint(*view, "buffer", UINT64_MAX, bufferIndex) || !GetUint(*view, "byteOffset", 0, viewOffset) ||
+				!GetUint(*view, "byteLength", UINT64_MAX, viewLength) || !GetUint(*view, "byteStride", 0, stride) ||
+				bufferIndex >= Buffers.size() || Buffers[(std::size_t)bufferIndex].Data == nullptr)
+				return false;
+
+			const Buffer& buffer = Buffers[(std::size_t)bufferIndex];
+			uint32 componentSize = GetComponentSize((uint32)componentType);
+			uint64 elementSize = (uint64)componentSize * componentCount;
+			if(stride == 0)
+				stride = elementSize;
+			if(componentSize == 0 || count == UINT64_MAX || stride < elementSize || stride > 252 ||
+				viewOffset + viewLength > buffer.Size ||
+				(count != 0 && offset + (count - 1) * stride + elementSize > viewLength) ||
+				(viewOffset + offset) % componentSize != 0 || stride % componentSize != 0)
+				return false;
+
+			accessor.Data = buffer.Data + viewOffset + offset;
+			accessor.Count = (uint32)count;
+			accessor.Stride = (uint32)stride;
+			accessor.ComponentType = (uint32)componentType;
+			accessor.ComponentCount = componentCount;
+			accessor.Normalized = normalized != nullptr && normalized->Type == JsonValue::Bool && normalized->NumberValue != 0.0;
+			return true;
+		}
+
+		// The attribute's accessor, if the primitive has it.
+		bool ResolveAttribute(const JsonValue& attributes, const char* name, uint32 componentCount, Accessor& accessor)const
+		{
+			if(attributes.Find(name) == nullptr)
+				return true;
+
+			uint64 index;
+			return GetUint(attributes, name, 0, index) && ResolveAccessor(index, componentCount, accessor);
+		}
+
+		bool ReadPrimitive(const JsonValue& json, Primitive& primitive)const
+		{
+			const JsonValue* attributes = json.Find("attributes");
+			uint64 mode;
+			if(attributes == nullptr || attributes->Type != JsonValue::Object || !GetUint(json, "mode", TrianglesMode, mode) ||
+				!ResolveAttribute(*attributes, "POSITION", 3, primitive.Position) ||
+				!ResolveAttribute(*attributes, "NORMAL", 3, primitive.Normal) ||
+				!ResolveAttribute(*attributes, "TANGENT", 4, primitive.Tangent) ||
+				!ResolveAttribute(*attributes, "TEXCOORD_0", 2, primitive.TexCoord))
+				return false;
+			primitive.Mode = (uint32)mode;
+
+			// Every attribute of a primitive has one element per vertex.
+			uint32 vertexCount = primitive.Position.Count;
+			if(!primitive.Position.IsPresent() ||
+				(primitive.Normal.IsPresent() && primitive.Normal.Count != vertexCount) ||
+				(primitive.Tangent.IsPresent() && primitive.Tangent.Count != vertexCount) ||
+				(primitive.TexCoord.IsPresent() && primitive.TexCoord.Count != vertexCount))
+				return false;
+
+			uint64 indices;
+			if(json.Find("indices") == nullptr)
+				return true;
+			if(!GetUint(json, "indices", 0, indices) || !ResolveAccessor(indices, 1, primitive.Indices))
+				return false;
+
+			const Accessor& a = primitive.Indices;
+			if(a.Normalized || a.Stride != GetComponentSize(a.ComponentType) ||
+				(a.ComponentType != UnsignedByte && a.ComponentType != UnsignedShort && a.ComponentType != UnsignedInt))
+				return false;
+
+			// Like a face referring to a missing element in an OBJ, an index past the
+			// vertices refuses the file rather than being read out of bounds later.
+			for(uint32 i = 0; i < a.Count; ++i)
+			{
+				if(ReadIndex(a, i) >= vertexCount)
+					return false;
+			}
+			return true;
+		}
+	};
+}
+
+float Gltf::ReadComponent(const Accessor& accessor, uint32 i, uint32 c)
+{
+	const std::uint8_t* p = accessor.Data + (std::size_t)i * accessor.Stride;
+	switch(accessor.ComponentType)
+	{
+	case Float:
+	{
+		float value;
+		std::memcpy(&value, p + c * 4, sizeof(value));
+		return value;
+	}
+	case UnsignedByte:
+		return accessor.Normalized ? p[c] / 255.0f : (float)p[c];
+	case Byte:
+	{
+		float value = (float)(std::int8_t)p[c];
+		return accessor.Normalized ? std::max(value / 127.0f, -1.0f) : value;
+	}
+	case UnsignedShort:
+	{
+		std::uint16_t value;
+		std::memcpy(&value, p + c * 2, sizeof(value));
+		return accessor.Normalized ? value / 65535.0f : (float)value;
+	}
+	case Short:
+	{
+		std::int16_t value;
+		std::memcpy(&value, p + c * 2, sizeof(value));
+		return accessor.Normalized ? std::max(value / 32767.0f, -1.0f) : (float)value;
+	}
+	case UnsignedInt:
+	{
+		uint32 value;
+		std::memcpy(&value, p + c * 4, sizeof(value));
+		return (float)value;
+	}
+	default:
+		return 0.0f;
+	}
+}
+
+uint32 Gltf::ReadIndex(const Accessor& accessor, uint32 i)
+{
+	switch(accessor.ComponentType)
+	{
+	case UnsignedByte:
+		return accessor.Data[i];
+	case UnsignedShort:
+	{
+		std::uint16_t value;
+		std::memcpy(&value, accessor.Data + (std::size_t)i * 2, sizeof(value));
+		return value;
+	}
+	default:
+		return ReadUint32(accessor.Data + (std::size_t)i * 4);
+	}
+}
+
+bool GlbFile::Open(const char* path)
+{
+	Close();
+	if(!mFile.Open(path))
+		return false;
+
+	const std::uint8_t* data = mFile.GetData();
+	uint64 size = mFile.GetSize();
+	if(size < 20 || ReadUint32(data) != GlbMagic || ReadUint32(data + 4) != GlbVersion || ReadUint32(data + 8) > size)
+	{
+		Close();
+		return false;
+	}
+	size = ReadUint32(data + 8);
+
+	// The JSON chunk comes first and the BIN chunk, if any, right after it.
+	uint64 jsonLength = ReadUint32(data + 12);
+	Document document;
+	Buffer bin;
+	if(ReadUint32(data + 16) != JsonChunk || 20 + jsonLength > size || jsonLength % 4 != 0 ||
+		!JsonParser((const char*)data + 20, (std::size_t)jsonLength).Parse(document.Root) ||
+		document.Root.Type != JsonValue::Object)
+	{
+		Close();
+		return false;
+	}
+
+	uint64 binOffset = 20 + jsonLength;
+	if(binOffset + 8 <= size && ReadUint32(data + binOffset + 4) == BinChunk)
+	{
+		bin.Data = data + binOffset + 8;
+		bin.Size = ReadUint32(data + binOffset);
+		if(binOffset + 8 + bin.Size > size)
+		{
+			Close();
+			return false;
+		}
+	}
+
+	// Only the first buffer can live in the file; buffers with a uri stay unresolved.
+	const JsonValue* buffers = document.Root.Find("buffers");
+	for(uint64 b = 0; GetElement(buffers, b) != nullptr; ++b)
+	{
+		const JsonValue& json = *GetElement(buffers, b);
+		uint64 byteLength;
+		Buffer buffer;
+		if(b == 0 && json.Find("uri") == nullptr && bin.Data != nullptr &&
+			GetUint(json, "byteLength", UINT64_MAX, byteLength) && byteLength <= bin.Size)
+		{
+			buffer.Data = bin.Data;
+			buffer.Size = byteLength;
+		}
+		document.Buffers.push_back(buffer);
+	}
+
+	const JsonValue* meshes = document.Root.Find("meshes");
+	for(uint64 m = 0; GetElement(meshes, m) != nullptr; ++m)
+	{
+		const JsonValue& json = *GetElement(meshes, m);
+		const JsonValue* name = json.Find("name");
+		const JsonValue* primitives = json.Find("primitives");
+
+		Gltf::Mesh mesh;
+		mesh.Name = name != nullptr ? name->StringValue : std::string();
+		for(uint64 p = 0; GetElement(primitives, p) != nullptr; ++p)
+		{
+			mesh.Primitives.emplace_back();
+			if(!document.ReadPrimitive(*GetElement(primitives, p), mesh.Primitives.back()))
+			{
+				Close();
+				return false;
+			}
+		}
+		mMeshes.push_back(std::move(mesh));
+	}
+	return true;
+}
+
+void GlbFile::Close()
+{
+	mMeshes.clear();
+	mFile.Close();
+}
+
+GlbFile::uint32 GlbFile::FindMesh(const char* name)const
+{
+	for(uint32 m = 0; m < GetMeshCount(); ++m)
+	{
+		if(mMeshes[m].Name == name)
+			return m;
+	}
+	return GetMeshCount();
+}
+
+void GlbFile::ReadVertex(const Primitive& primitive, uint32 i, bool convertToLeftHanded, ShapeWriter::GeneratedVertex& vertex)
+{
+	vertex = ShapeWriter::GeneratedVertex(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+
+	// Float attributes, the common case, are read as they are.
+	const Accessor& position = primitive.Position;
+	if(position.ComponentType == Float)
+		std::memcpy(&vertex.Position, position.Data + (std::size_t)i * position.Stride, sizeof(vertex.Position));
+	else
+		vertex.Position = DirectX::XMFLOAT3(ReadComponent(position, i, 0), ReadComponent(position, i, 1), ReadComponent(position, i, 2));
+
+	const Accessor& normal = primitive.Normal;
+	if(normal.ComponentType == Float)
+		std::memcpy(&vertex.Normal, normal.Data + (std::size_t)i * normal.Stride, sizeof(vertex.Normal));
+	else if(normal.IsPresent())
+		vertex.Normal = DirectX::XMFLOAT3(ReadComponent(normal, i, 0), ReadComponent(normal, i, 1), ReadComponent(normal, i, 2));
+
+	// The w of a glTF tangent gives the bitangent's handedness, which TangentU has no
+	// room for.
+	const Accessor& tangent = primitive.Tangent;
+	if(tangent.ComponentType == Float)
+		std::memcpy(&vertex.TangentU, tangent.Data + (std::size_t)i * tangent.Stride, sizeof(vertex.TangentU));
+	else if(tangent.IsPresent())
+		vertex.TangentU = DirectX::XMFLOAT3(ReadComponent(tangent, i, 0), ReadComponent(tangent, i, 1), ReadComponent(tangent, i, 2));
+
+	// glTF texture coordinates already start at the top left, as Direct3D's do.
+	const Accessor& texC = primitive.TexCoord;
+	if(texC.ComponentType == Float)
+		std::memcpy(&vertex.TexC, texC.Data + (std::size_t)i * texC.Stride, sizeof(vertex.TexC));
+	else if(texC.IsPresent())
+		vertex.TexC = DirectX::XMFLOAT2(ReadComponent(texC, i, 0), ReadComponent(texC, i, 1));
+
+	if(convertToLeftHanded)
+	{
+		vertex.Position.z = -vertex.Position.z;
+		vertex.Normal.z = -vertex.Normal.z;
+		vertex.TangentU.z = -vertex.TangentU.z;
+	}
+}
+
+bool GlbFile::CopyTo(const Primitive& primitive, GeometryGenerator::MeshData& mesh, bool convertToLeftHanded)
+{
+	mesh.Vertices.clear();
+	mesh.Indices32.clear();
+	if(primitive.Mode != TrianglesMode)
+		return false;
+
+	mesh.Vertices.resize(primitive.GetVertexCount());
+	mesh.Indices32.resize(primitive.GetIndexCount());
+	WritePrimitive(primitive, mesh.Vertices.data(), mesh.Indices32.data(), ShapeWriter::GeneratorVertexWriter(), convertToLeftHanded);
+	return true;
+}
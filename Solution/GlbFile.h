@@ -0,0 +1,218 @@
+//***************************************************************************************
+// GlbFile.h
+//
+// Reads the meshes of binary glTF 2.0 (.glb) files without copying their data.  The
+// file is mapped, the JSON chunk is parsed once for its meshes, accessors and buffer
+// views, and every accessor is handed out as a pointer into the mapped BIN chunk with
+// its stride and element type.  When an accessor's layout is already what the caller
+// wants (float3 positions, 16- or 32-bit indices, ...) GetView returns it as a typed
+// view, usable in place or uploaded as is; only other layouts need converting.
+//
+// Conversion happens only on request: CopyTo fills a GeometryGenerator::MeshData, and
+// WritePrimitive runs a ShapeWriter vertex writer over the primitive so it can be
+// written straight into the app's vertex format, e.g. through ScenePacker::AddCustom.
+// Views show the data as stored (right-handed, counter-clockwise); the conversions
+// negate z and reverse each triangle to give the apps' left-handed, clockwise
+// convention unless told not to.
+//
+// Only what meshes need is read: node transforms, materials, skins, morph targets,
+// sparse accessors and external buffers are not supported.
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+#include "MappedFile.h"
+#include "ShapeWriter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace Gltf
+{
+	using uint32 = std::uint32_t;
+
+	enum ComponentType : uint32
+	{
+		Byte = 5120,
+		UnsignedByte = 5121,
+		Short = 5122,
+		UnsignedShort = 5123,
+		UnsignedInt = 5125,
+		Float = 5126
+	};
+
+	const uint32 TrianglesMode = 4;
+
+	// An accessor resolved against the mapped file.  ComponentCount is 0 if the
+	// primitive doesn't have the attribute.
+	struct Accessor
+	{
+		const std::uint8_t* Data = nullptr;
+		uint32 Count = 0;
+		uint32 Stride = 0;
+		uint32 ComponentType = 0;
+		uint32 ComponentCount = 0;
+		bool Normalized = false;
+
+		bool IsPresent()const { return ComponentCount != 0; }
+	};
+
+	struct Primitive
+	{
+		Accessor Position;
+		Accessor Normal;
+		Accessor Tangent;
+		Accessor TexCoord;
+		Accessor Indices;           // not present for non-indexed primitives
+		uint32 Mode = TrianglesMode;
+
+		uint32 GetVertexCount()const { return Position.Count; }
+		uint32 GetIndexCount()const { return Indices.IsPresent() ? Indices.Count : Position.Count; }
+	};
+
+	struct Mesh
+	{
+		std::string Name;
+		std::vector<Primitive> Primitives;
+	};
+
+	// Elements of type T, Stride bytes apart, in the mapped file.
+	template<typename T>
+	struct AccessorView
+	{
+		const std::uint8_t* Data = nullptr;
+		uint32 Count = 0;
+		uint32 Stride = 0;
+
+		const T& operator[](uint32 i)const { return *reinterpret_cast<const T*>(Data + (std::size_t)i * Stride); }
+
+		///<summary>
+		/// The elements as a plain array, or nullptr if they are interleaved with other data.
+		///</summary>
+		const T* GetArray()const { return Stride == sizeof(T) ? reinterpret_cast<const T*>(Data) : nullptr; }
+	};
+
+	// The accessor layout each view type stands for.
+	template<typename T> struct ViewLayout;
+	template<> struct ViewLayout<float> { static const uint32 Type = Float, Count = 1; };
+	template<> struct ViewLayout<DirectX::XMFLOAT2> { static const uint32 Type = Float, Count = 2; };
+	template<> struct ViewLayout<DirectX::XMFLOAT3> { static const uint32 Type = Float, Count = 3; };
+	template<> struct ViewLayout<DirectX::XMFLOAT4> { static const uint32 Type = Float, Count = 4; };
+	template<> struct ViewLayout<std::uint8_t> { static const uint32 Type = UnsignedByte, Count = 1; };
+	template<> struct ViewLayout<std::uint16_t> { static const uint32 Type = UnsignedShort, Count = 1; };
+	template<> struct ViewLayout<std::uint32_t> { static const uint32 Type = UnsignedInt, Count = 1; };
+
+	///<summary>
+	/// Component c of element i, as a float: normalized integers map to [0, 1] or
+	/// [-1, 1] and other integers convert as they are.
+	///</summary>
+	float ReadComponent(const Accessor& accessor, uint32 i, uint32 c);
+
+	uint32 ReadIndex(const Accessor& accessor, uint32 i);
+}
+
+class GlbFile
+{
+public:
+
+	using uint32 = std::uint32_t;
+
+	GlbFile() = default;
+	GlbFile(const GlbFile& rhs) = delete;
+	GlbFile& operator=(const GlbFile& rhs) = delete;
+
+	///<summary>
+	/// Maps the file and reads its meshes.  Returns false, leaving the file closed, if it
+	/// is not a well-formed glTF 2.0 binary, an accessor reaches outside its buffer or an
+	/// index refers past its primitive's vertices.
+	///</summary>
+	bool Open(const char* path);
+	void Close();
+
+	bool IsOpen()const { return mFile.IsOpen(); }
+
+	uint32 GetMeshCount()const { return (uint32)mMeshes.size(); }
+	const Gltf::Mesh& GetMesh(uint32 mesh)const { return mMeshes[mesh]; }
+
+	///<summary>
+	/// Index of the mesh with the given name, or GetMeshCount() if there is none.
+	///</summary>
+	uint32 FindMesh(const char* name)const;
+
+	///<summary>
+	/// The accessor as elements of T without copying.  Returns false if its layout is
+	/// not T's, in which case the data has to be converted.
+	///</summary>
+	template<typename T>
+	static bool GetView(const Gltf::Accessor& accessor, Gltf::AccessorView<T>& view)
+	{
+		if(accessor.ComponentType != Gltf::ViewLayout<T>::Type || accessor.ComponentCount != Gltf::ViewLayout<T>::Count ||
+			(accessor.Normalized && accessor.ComponentType != Gltf::Float))
+			return false;
+
+		view.Data = accessor.Data;
+		view.Count = accessor.Count;
+		view.Stride = accessor.Stride;
+		return true;
+	}
+
+	///<summary>
+	/// Decodes a triangle-list primitive into a MeshData.  Returns false for other modes.
+	///</summary>
+	static bool CopyTo(const Gltf::Primitive& primitive, GeometryGenerator::MeshData& mesh, bool convertToLeftHanded = true);
+
+	///<summary>
+	/// Runs writer over every vertex of the primitive into vertices and copies its
+	/// indices, like the ShapeWriter Write functions.  vertices and indices hold
+	/// GetVertexCount() and GetIndexCount() elements.  Converting reverses the winding
+	/// and so assumes a triangle list.  Index has to be able to number every vertex.
+	///</summary>
+	template<typename Writer, typename Index>
+	static void WritePrimitive(const Gltf::Primitive& primitive, typename Writer::VertexType* vertices, Index* indices,
+		const Writer& writer, bool convertToLeftHanded = true)
+	{
+		// Open has checked every index against the vertex count, so this is the only way
+		// one could be truncated.
+		assert(primitive.GetVertexCount() == 0 ||
+			primitive.GetVertexCount() - 1 <= (std::uint64_t)std::numeric_limits<Index>::max());
+
+		ShapeWriter::GeneratedVertex v;
+		for(uint32 i = 0; i < primitive.GetVertexCount(); ++i)
+		{
+			ReadVertex(primitive, i, convertToLeftHanded, v);
+			writer(vertices[i], v);
+		}
+
+		// Negating z turns the triangles round, so the stored indices can only be copied
+		// as they are when not converting; otherwise corners 1 and 2 trade places.
+		Gltf::AccessorView<Index> view;
+		if(!convertToLeftHanded && GetView(primitive.Indices, view) && view.GetArray() != nullptr)
+		{
+			std::copy(view.GetArray(), view.GetArray() + view.Count, indices);
+			return;
+		}
+		uint32 count = primitive.GetIndexCount();
+		for(uint32 i = 0; i < count; ++i)
+		{
+			uint32 corner = i;
+			if(convertToLeftHanded && i % 3 != 0 && i - i % 3 + 3 <= count)
+				corner = i % 3 == 1 ? i + 1 : i - 1;
+			indices[i] = static_cast<Index>(primitive.Indices.IsPresent() ? Gltf::ReadIndex(primitive.Indices, corner) : corner);
+		}
+	}
+
+	///<summary>
+	/// Vertex i of the primitive as the generators make them.  Missing attributes are
+	/// zero.
+	///</summary>
+	static void ReadVertex(const Gltf::Primitive& primitive, uint32 i, bool convertToLeftHanded, ShapeWriter::GeneratedVertex& vertex);
+
+private:
+	MappedFile mFile;
+	std::vector<Gltf::Mesh> mMeshes;
+};
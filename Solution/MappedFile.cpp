@@ -0,0 +1,95 @@
+//***************************************************************************************
+// MappedFile.cpp
+//***************************************************************************************
+
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const char* path)
+{
+	Close();
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	HANDLE mapping = nullptr;
+	const void* view = nullptr;
+	if(GetFileSizeEx(file, &size) && size.QuadPart > 0)
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(mapping != nullptr)
+		view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if(view == nullptr)
+	{
+		if(mapping != nullptr)
+			CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	mFile = file;
+	mMapping = mapping;
+	mData = static_cast<const std::uint8_t*>(view);
+	mSize = (std::uint64_t)size.QuadPart;
+#else
+	int fd = open(path, O_RDONLY);
+	if(fd < 0)
+		return false;
+
+	struct stat info;
+	void* view = MAP_FAILED;
+	if(fstat(fd, &info) == 0 && info.st_size > 0)
+		view = mmap(nullptr, (std::size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping keeps the file alive on its own.
+	close(fd);
+	if(view == MAP_FAILED)
+		return false;
+
+	mData = static_cast<const std::uint8_t*>(view);
+	mSize = (std::uint64_t)info.st_size;
+#endif
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if(mData == nullptr)
+		return;
+
+#if defined(_WIN32)
+	UnmapViewOfFile(mData);
+	CloseHandle(mMapping);
+	CloseHandle(mFile);
+	mMapping = nullptr;
+	mFile = nullptr;
+#else
+	munmap(const_cast<std::uint8_t*>(mData), (std::size_t)mSize);
+#endif
+
+	mData = nullptr;
+	mSize = 0;
+}
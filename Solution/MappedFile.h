@@ -0,0 +1,41 @@
+//***************************************************************************************
+// MappedFile.h
+//
+// A whole file mapped read-only into memory, for loaders that parse or use a file in
+// place rather than reading it into a buffer first.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+
+class MappedFile
+{
+public:
+
+	MappedFile() = default;
+	MappedFile(const MappedFile& rhs) = delete;
+	MappedFile& operator=(const MappedFile& rhs) = delete;
+	~MappedFile();
+
+	///<summary>
+	/// Maps the file.  Returns false, leaving the file closed, if it can't be opened or
+	/// is empty.
+	///</summary>
+	bool Open(const char* path);
+	void Close();
+
+	bool IsOpen()const { return mData != nullptr; }
+
+	const std::uint8_t* GetData()const { return mData; }
+	std::uint64_t GetSize()const { return mSize; }
+
+private:
+	const std::uint8_t* mData = nullptr;
+	std::uint64_t mSize = 0;
+
+#if defined(_WIN32)
+	void* mFile = nullptr;
+	void* mMapping = nullptr;
+#endif
+};
@@ -0,0 +1,764 @@
+//***************************************************************************************
+// MeshCodec.cpp
+//***************************************************************************************
+
+#include "MeshCodec.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+// SSE2 is part of x64 and of any x86 target built for it.  Define MESH_CODEC_SSE2 as 0
+// to build the portable decoders instead.
+#if !defined(MESH_CODEC_SSE2)
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define MESH_CODEC_SSE2 1
+#else
+#define MESH_CODEC_SSE2 0
+#endif
+#endif
+
+#if MESH_CODEC_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace MeshCodec;
+
+namespace
+{
+	//
+	// Index stream: the format byte, then per block of up to IndexBlockSize indices a
+	// header byte (lag code in the high nibble, width code in the low one) and the
+	// zigzagged differences, padded to a multiple of 16 and packed at that width.
+	//
+
+	const uint32 IndexBlockSize = 48;
+	const uint32 IndexLags[] = { 6, 12 };
+	const uint32 IndexLagCount = 2;
+	const uint32 IndexWidths[] = { 0, 2, 4, 8, 16, 32 };
+	const uint32 IndexWidthCount = 6;
+
+	// Within a group of 16, 2-bit value j sits in byte j % 4 at bit 2 * (j / 4), and
+	// 4-bit value j in byte j % 8 at bit 4 * (j / 8), so SSE2 can unpack a group with
+	// whole-register shifts.
+	const uint32 GroupSize = 16;
+
+	uint32 RoundUpToGroup(uint32 count)
+	{
+		return (count + GroupSize - 1) / GroupSize * GroupSize;
+	}
+
+	uint32 ZigZag(uint32 delta)
+	{
+		return (delta << 1) ^ (uint32)((std::int32_t)delta >> 31);
+	}
+
+	uint32 UnZigZag(uint32 value)
+	{
+		return (value >> 1) ^ (0u - (value & 1));
+	}
+
+	uint8 ZigZag8(uint8 delta)
+	{
+		return (uint8)((delta << 1) ^ (uint8)((std::int8_t)delta >> 7));
+	}
+
+	// Packs count (a multiple of 16) values at width bits and returns the bytes written.
+	template<typename Value>
+	std::size_t PackValues(uint8* dst, const Value* values, uint32 count, uint32 width)
+	{
+		std::size_t bytes = (std::size_t)count * width / 8;
+		std::memset(dst, 0, bytes);
+
+		for(uint32 i = 0; i < count; ++i)
+		{
+			uint32 group = i / GroupSize, j = i % GroupSize;
+			uint32 value = (uint32)values[i];
+			switch(width)
+			{
+			case 2: dst[group * 4 + j % 4] |= (uint8)(value << (2 * (j / 4))); break;
+			case 4: dst[group * 8 + j % 8] |= (uint8)(value << (4 * (j / 8))); break;
+			case 8: dst[i] = (uint8)value; break;
+			case 16: dst[2 * i] = (uint8)value; dst[2 * i + 1] = (uint8)(value >> 8); break;
+			case 32: std::memcpy(dst + 4 * i, &value, 4); break;
+			}
+		}
+		return bytes;
+	}
+
+	template<typename Value>
+	void UnpackValues(Value* dst, const uint8* src, uint32 count, uint32 width)
+	{
+		for(uint32 i = 0; i < count; ++i)
+		{
+			uint32 group = i / GroupSize, j = i % GroupSize;
+			uint32 value = 0;
+			switch(width)
+			{
+			case 2: value = (src[group * 4 + j % 4] >> (2 * (j / 4))) & 3; break;
+			case 4: value = (src[group * 8 + j % 8] >> (4 * (j / 8))) & 15; break;
+			case 8: value = src[i]; break;
+			case 16: value = src[2 * i] | (uint32)src[2 * i + 1] << 8; break;
+			case 32: std::memcpy(&value, src + 4 * i, 4); break;
+			}
+			dst[i] = (Value)value;
+		}
+	}
+
+	uint32 GetIndexWidthCode(uint32 maxValue)
+	{
+		uint32 code = 0;
+		while(code + 1 < IndexWidthCount && (maxValue >> IndexWidths[code]) != 0)
+			++code;
+		return code;
+	}
+
+	template<typename Index>
+	std::size_t EncodeIndexStream(uint8* dst, std::size_t dstSize, const Index* indices, uint32 indexCount)
+	{
+		if(dstSize < GetIndexBufferBound(indexCount))
+			return 0;
+
+		uint8* out = dst;
+		*out++ = IndexFormat;
+
+		uint32 zigzags[IndexLagCount][IndexBlockSize];
+		for(uint32 start = 0; start < indexCount; start += IndexBlockSize)
+		{
+			uint32 count = std::min(IndexBlockSize, indexCount - start);
+
+			uint32 bestLag = 0, bestWidth = IndexWidthCount;
+			for(uint32 lag = 0; lag < IndexLagCount; ++lag)
+			{
+				uint32 maxValue = 0;
+				for(uint32 i = 0; i < count; ++i)
+				{
+					uint32 index = start + i;
+					uint32 predicted = index >= IndexLags[lag] ? (uint32)indices[index - IndexLags[lag]] : 0;
+					zigzags[lag][i] = ZigZag((uint32)indices[index] - predicted);
+					maxValue = std::max(maxValue, zigzags[lag][i]);
+				}
+
+				uint32 width = GetIndexWidthCode(maxValue);
+				if(width < bestWidth)
+				{
+					bestLag = lag;
+					bestWidth = width;
+				}
+			}
+
+			uint32 padded = RoundUpToGroup(count);
+			std::fill(zigzags[bestLag] + count, zigzags[bestLag] + padded, 0u);
+
+			*out++ = (uint8)(bestLag << 4 | bestWidth);
+			out += PackValues(out, zigzags[bestLag], padded, IndexWidths[bestWidth]);
+		}
+
+		return (std::size_t)(out - dst);
+	}
+
+	// Reads a block header and returns the byte size of the data after it, or 0 with
+	// valid set to false if the header is not one this format writes.
+	std::size_t GetIndexBlockSize(uint8 header, uint32 count, uint32& lag, uint32& width, bool& valid)
+	{
+		uint32 lagCode = header >> 4, widthCode = header & 15;
+		valid = lagCode < IndexLagCount && widthCode < IndexWidthCount;
+		if(!valid)
+			return 0;
+
+		lag = IndexLags[lagCode];
+		width = IndexWidths[widthCode];
+		return (std::size_t)RoundUpToGroup(count) * width / 8;
+	}
+
+	template<typename Index>
+	bool StoreIndex(Index* dst, uint32 value)
+	{
+		*dst = (Index)value;
+		return sizeof(Index) == 4 || value <= 0xFFFF;
+	}
+
+	// Decodes a block one index at a time.  history holds the IndexLags[max] indices
+	// before the block and afterwards the ones at its end.
+	template<typename Index>
+	bool DecodeIndexBlockScalar(Index* dst, uint32 count, const uint8* data, uint32 lag, uint32 width, uint32* history)
+	{
+		const uint32 historySize = IndexLags[IndexLagCount - 1];
+
+		uint32 window[historySize + IndexBlockSize];
+		std::memcpy(window, history, historySize * sizeof(uint32));
+		UnpackValues(window + historySize, data, count, width);
+
+		bool fits = true;
+		for(uint32 i = 0; i < count; ++i)
+		{
+			uint32 value = UnZigZag(window[historySize + i]) + window[historySize + i - lag];
+			window[historySize + i] = value;
+			fits = StoreIndex(dst + i, value) && fits;
+		}
+
+		std::memcpy(history, window + count, historySize * sizeof(uint32));
+		return fits;
+	}
+
+#if MESH_CODEC_SSE2
+	// 16 bytes widened to four vectors of 32-bit values.
+	void WidenBytes(__m128i bytes, __m128i* values)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i lo = _mm_unpacklo_epi8(bytes, zero);
+		__m128i hi = _mm_unpackhi_epi8(bytes, zero);
+		values[0] = _mm_unpacklo_epi16(lo, zero);
+		values[1] = _mm_unpackhi_epi16(lo, zero);
+		values[2] = _mm_unpacklo_epi16(hi, zero);
+		values[3] = _mm_unpackhi_epi16(hi, zero);
+	}
+
+	// A group of 16 packed 2-, 4- or 8-bit values as 16 bytes.
+	__m128i UnpackGroupBytes(const uint8* src, uint32 width)
+	{
+		if(width == 2)
+		{
+			uint32 packed;
+			std::memcpy(&packed, src, 4);
+			__m128i spread = _mm_set_epi32((int)(packed >> 6), (int)(packed >> 4), (int)(packed >> 2), (int)packed);
+			return _mm_and_si128(spread, _mm_set1_epi8(3));
+		}
+		if(width == 4)
+		{
+			std::uint64_t packed;
+			std::memcpy(&packed, src, 8);
+			__m128i spread = _mm_set_epi64x((long long)(packed >> 4), (long long)packed);
+			return _mm_and_si128(spread, _mm_set1_epi8(15));
+		}
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+	}
+
+	__m128i UnZigZag(__m128i value)
+	{
+		__m128i sign = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(value, _mm_set1_epi32(1)));
+		return _mm_xor_si128(_mm_srli_epi32(value, 1), sign);
+	}
+
+	void StoreIndices(uint32* dst, __m128i values)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), values);
+	}
+
+	void StoreIndices(uint16* dst, __m128i values)
+	{
+		// packs saturates signed values; sign-extending the low halves keeps them intact.
+		__m128i low = _mm_srai_epi32(_mm_slli_epi32(values, 16), 16);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packs_epi32(low, low));
+	}
+
+	// Decodes a whole block four indices at a time.  Lag 12 reads the vector three
+	// before; lag 6 joins the top half of the vector two before with the bottom half of
+	// the one before.
+	template<typename Index>
+	bool DecodeIndexBlock(Index* dst, const uint8* data, uint32 lag, uint32 width, uint32* history)
+	{
+		const uint32 vectorCount = IndexBlockSize / 4;
+
+		__m128i v[3 + vectorCount];
+		for(uint32 k = 0; k < 3; ++k)
+			v[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(history + 4 * k));
+
+		__m128i* z = v + 3;
+		for(uint32 g = 0; g < IndexBlockSize / GroupSize; ++g)
+		{
+			switch(width)
+			{
+			case 0:
+				for(uint32 k = 0; k < 4; ++k)
+					z[4 * g + k] = _mm_setzero_si128();
+				break;
+			case 16:
+			{
+				__m128i zero = _mm_setzero_si128();
+				for(uint32 h = 0; h < 2; ++h)
+				{
+					__m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + g * 32 + h * 16));
+					z[4 * g + 2 * h] = _mm_unpacklo_epi16(words, zero);
+					z[4 * g + 2 * h + 1] = _mm_unpackhi_epi16(words, zero);
+				}
+				break;
+			}
+			case 32:
+				for(uint32 k = 0; k < 4; ++k)
+					z[4 * g + k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + g * 64 + k * 16));
+				break;
+			default:
+				WidenBytes(UnpackGroupBytes(data + g * width * 2, width), z + 4 * g);
+				break;
+			}
+		}
+
+		__m128i overflow = _mm_setzero_si128();
+		for(uint32 k = 3; k < 3 + vectorCount; ++k)
+		{
+			__m128i predicted = lag == 12 ? v[k - 3] :
+				_mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(v[k - 2]), _mm_castsi128_ps(v[k - 1]), _MM_SHUFFLE(1, 0, 3, 2)));
+			v[k] = _mm_add_epi32(UnZigZag(v[k]), predicted);
+			overflow = _mm_or_si128(overflow, v[k]);
+			StoreIndices(dst + 4 * (k - 3), v[k]);
+		}
+
+		for(uint32 k = 0; k < 3; ++k)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(history + 4 * k), v[vectorCount + k]);
+
+		return sizeof(Index) == 4 || _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_srli_epi32(overflow, 16), _mm_setzero_si128())) == 0xFFFF;
+	}
+#endif
+
+	template<typename Index>
+	bool DecodeIndexStream(Index* dst, uint32 indexCount, const uint8* src, std::size_t srcSize)
+	{
+		if(srcSize < 1 || src[0] != IndexFormat)
+			return false;
+
+		const uint8* in = src + 1;
+		const uint8* end = src + srcSize;
+
+		uint32 history[12] = {};
+		for(uint32 start = 0; start < indexCount; start += IndexBlockSize)
+		{
+			uint32 count = std::min(IndexBlockSize, indexCount - start);
+			if(in == end)
+				return false;
+
+			uint32 lag, width;
+			bool valid;
+			std::size_t bytes = GetIndexBlockSize(*in++, count, lag, width, valid);
+			if(!valid || (std::size_t)(end - in) < bytes)
+				return false;
+
+			bool fits;
+#if MESH_CODEC_SSE2
+			if(count == IndexBlockSize)
+				fits = DecodeIndexBlock(dst + start, in, lag, width, history);
+			else
+#endif
+				fits = DecodeIndexBlockScalar(dst + start, count, in, lag, width, history);
+
+			if(!fits)
+				return false;
+			in += bytes;
+		}
+
+		return in == end;
+	}
+
+	//
+	// Vertex stream: the format byte, then per block of 16 vertices stride / 4 header
+	// bytes, holding a 2-bit mode for each byte plane (0, 2, 4 or 8 bits), and the
+	// planes' zigzagged differences packed at those widths.  A partial last block is
+	// padded with copies of its last vertex.
+	//
+
+	const uint32 VertexBlockSize = GroupSize;
+	const uint32 PlaneWidths[] = { 0, 2, 4, 8 };
+
+	uint32 GetPlaneMode(const uint8* zigzags)
+	{
+		uint8 maxValue = 0;
+		for(uint32 v = 0; v < VertexBlockSize; ++v)
+			maxValue = std::max(maxValue, zigzags[v]);
+
+		return maxValue == 0 ? 0 : maxValue < 4 ? 1 : maxValue < 16 ? 2 : 3;
+	}
+
+	// Reads the block headers and returns the byte size of the plane data after them.
+	std::size_t GetVertexBlockSize(const uint8* headers, uint32 stride)
+	{
+		std::size_t bytes = 0;
+		for(uint32 p = 0; p < stride; ++p)
+			bytes += PlaneWidths[(headers[p / 4] >> (2 * (p % 4))) & 3] * VertexBlockSize / 8;
+		return bytes;
+	}
+
+#if !MESH_CODEC_SSE2
+	uint8 UnZigZag8(uint8 value)
+	{
+		return (uint8)((value >> 1) ^ (0u - (value & 1)));
+	}
+
+	// Decodes a block into dst, VertexBlockSize records of stride bytes.  last holds the
+	// final byte of every plane so far.
+	void DecodeVertexBlockScalar(uint8* dst, uint32 stride, const uint8* headers, const uint8* data, uint8* last)
+	{
+		uint8 zigzags[VertexBlockSize];
+		for(uint32 p = 0; p < stride; ++p)
+		{
+			uint32 width = PlaneWidths[(headers[p / 4] >> (2 * (p % 4))) & 3];
+			UnpackValues(zigzags, data, VertexBlockSize, width);
+			data += width * VertexBlockSize / 8;
+
+			uint8 value = last[p];
+			for(uint32 v = 0; v < VertexBlockSize; ++v)
+			{
+				value = (uint8)(value + UnZigZag8(zigzags[v]));
+				dst[v * stride + p] = value;
+			}
+			last[p] = value;
+		}
+	}
+#else
+	// A plane of 16 zigzagged byte differences turned back into bytes: undo the zigzag,
+	// then a running sum across the register starting from the plane's last byte.
+	__m128i DecodePlane(__m128i zigzags, uint8& last)
+	{
+		__m128i one = _mm_set1_epi8(1);
+		__m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(zigzags, one));
+		__m128i half = _mm_and_si128(_mm_srli_epi16(zigzags, 1), _mm_set1_epi8(0x7F));
+		__m128i x = _mm_xor_si128(half, sign);
+
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 1));
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 2));
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+		x = _mm_add_epi8(x, _mm_set1_epi8((char)last));
+
+		last = (uint8)(_mm_extract_epi16(x, 7) >> 8);
+		return x;
+	}
+
+	// Decodes four planes at a time and transposes them back into 4-byte columns of the
+	// records.
+	void DecodeVertexBlock(uint8* dst, uint32 stride, const uint8* headers, const uint8* data, uint8* last)
+	{
+		for(uint32 column = 0; column < stride; column += 4)
+		{
+			uint8 modes = headers[column / 4];
+
+			__m128i planes[4];
+			for(uint32 i = 0; i < 4; ++i)
+			{
+				uint32 width = PlaneWidths[(modes >> (2 * i)) & 3];
+				__m128i zigzags = width == 0 ? _mm_setzero_si128() : UnpackGroupBytes(data, width);
+				data += width * VertexBlockSize / 8;
+
+				planes[i] = DecodePlane(zigzags, last[column + i]);
+			}
+
+			__m128i lo01 = _mm_unpacklo_epi8(planes[0], planes[1]);
+			__m128i hi01 = _mm_unpackhi_epi8(planes[0], planes[1]);
+			__m128i lo23 = _mm_unpacklo_epi8(planes[2], planes[3]);
+			__m128i hi23 = _mm_unpackhi_epi8(planes[2], planes[3]);
+
+			__m128i words[4] =
+			{
+				_mm_unpacklo_epi16(lo01, lo23),
+				_mm_unpackhi_epi16(lo01, lo23),
+				_mm_unpacklo_epi16(hi01, hi23),
+				_mm_unpackhi_epi16(hi01, hi23)
+			};
+
+			uint8* out = dst + column;
+			for(uint32 w = 0; w < 4; ++w)
+			{
+				__m128i x = words[w];
+				for(uint32 v = 0; v < 4; ++v)
+				{
+					std::int32_t word = _mm_cvtsi128_si32(x);
+					std::memcpy(out, &word, 4);
+					out += stride;
+					x = _mm_srli_si128(x, 4);
+				}
+			}
+		}
+	}
+#endif
+
+	//
+	// Quantization.
+	//
+
+	uint16 QuantizeUnorm(float value, float minValue, float scale)
+	{
+		if(scale <= 0.0f)
+			return 0;
+
+		float q = (value - minValue) / scale + 0.5f;
+		return (uint16)std::min(std::max(q, 0.0f), 65535.0f);
+	}
+
+	int16 QuantizeSnorm(float value)
+	{
+		float q = std::min(std::max(value, -1.0f), 1.0f) * 32767.0f;
+		return (int16)(q < 0.0f ? q - 0.5f : q + 0.5f);
+	}
+
+	float SignNotZero(float value)
+	{
+		return value < 0.0f ? -1.0f : 1.0f;
+	}
+
+	// Octahedral encoding: the unit vector projected onto the octahedron |x|+|y|+|z| = 1,
+	// with the lower half folded over the upper one.
+	void EncodeOctahedral(const DirectX::XMFLOAT3& v, int16* dst)
+	{
+		float l1 = std::fabs(v.x) + std::fabs(v.y) + std::fabs(v.z);
+		if(l1 == 0.0f)
+		{
+			dst[0] = dst[1] = 0;
+			return;
+		}
+
+		float x = v.x / l1, y = v.y / l1;
+		if(v.z < 0.0f)
+		{
+			float fx = (1.0f - std::fabs(y)) * SignNotZero(x);
+			float fy = (1.0f - std::fabs(x)) * SignNotZero(y);
+			x = fx;
+			y = fy;
+		}
+		dst[0] = QuantizeSnorm(x);
+		dst[1] = QuantizeSnorm(y);
+	}
+
+	DirectX::XMFLOAT3 DecodeOctahedral(const int16* src)
+	{
+		float x = std::max(src[0] / 32767.0f, -1.0f);
+		float y = std::max(src[1] / 32767.0f, -1.0f);
+		float z = 1.0f - std::fabs(x) - std::fabs(y);
+		if(z < 0.0f)
+		{
+			float fx = (1.0f - std::fabs(y)) * SignNotZero(x);
+			float fy = (1.0f - std::fabs(x)) * SignNotZero(y);
+			x = fx;
+			y = fy;
+		}
+
+		float length = std::sqrt(x * x + y * y + z * z);
+		return DirectX::XMFLOAT3(x / length, y / length, z / length);
+	}
+}
+
+std::size_t MeshCodec::GetIndexBufferBound(uint32 indexCount)
+{
+	std::size_t blocks = (indexCount + IndexBlockSize - 1) / IndexBlockSize;
+	return 1 + blocks * (1 + IndexBlockSize * sizeof(uint32));
+}
+
+std::size_t MeshCodec::EncodeIndices(uint8* dst, std::size_t dstSize, const uint32* indices, uint32 indexCount)
+{
+	return EncodeIndexStream(dst, dstSize, indices, indexCount);
+}
+
+std::size_t MeshCodec::EncodeIndices(uint8* dst, std::size_t dstSize, const uint16* indices, uint32 indexCount)
+{
+	return EncodeIndexStream(dst, dstSize, indices, indexCount);
+}
+
+bool MeshCodec::DecodeIndices(uint32* dst, uint32 indexCount, const uint8* src, std::size_t srcSize)
+{
+	return DecodeIndexStream(dst, indexCount, src, srcSize);
+}
+
+bool MeshCodec::DecodeIndices(uint16* dst, uint32 indexCount, const uint8* src, std::size_t srcSize)
+{
+	return DecodeIndexStream(dst, indexCount, src, srcSize);
+}
+
+std::size_t MeshCodec::GetVertexBufferBound(uint32 vertexCount, uint32 stride)
+{
+	std::size_t blocks = (vertexCount + VertexBlockSize - 1) / VertexBlockSize;
+	return 1 + blocks * (stride / 4 + (std::size_t)stride * VertexBlockSize);
+}
+
+std::size_t MeshCodec::EncodeVertices(uint8* dst, std::size_t dstSize, const void* vertices, uint32 vertexCount, uint32 stride)
+{
+	if(stride == 0 || stride % 4 != 0 || stride > MaxVertexStride || dstSize < GetVertexBufferBound(vertexCount, stride))
+		return 0;
+
+	const uint8* records = static_cast<const uint8*>(vertices);
+
+	uint8* out = dst;
+	*out++ = VertexFormat;
+
+	uint8 last[MaxVertexStride] = {};
+	uint8 zigzags[VertexBlockSize];
+	for(uint32 start = 0; start < vertexCount; start += VertexBlockSize)
+	{
+		uint32 count = std::min(VertexBlockSize, vertexCount - start);
+
+		uint8* headers = out;
+		std::memset(headers, 0, stride / 4);
+		out += stride / 4;
+
+		for(uint32 p = 0; p < stride; ++p)
+		{
+			uint8 previous = last[p];
+			for(uint32 v = 0; v < VertexBlockSize; ++v)
+			{
+				uint8 value = records[(std::size_t)(start + std::min(v, count - 1)) * stride + p];
+				zigzags[v] = ZigZag8((uint8)(value - previous));
+				previous = value;
+			}
+			last[p] = previous;
+
+			uint32 mode = GetPlaneMode(zigzags);
+			headers[p / 4] |= (uint8)(mode << (2 * (p % 4)));
+			out += PackValues(out, zigzags, VertexBlockSize, PlaneWidths[mode]);
+		}
+	}
+
+	return (std::size_t)(out - dst);
+}
+
+bool MeshCodec::DecodeVertices(void* dst, uint32 vertexCount, uint32 stride, const uint8* src, std::size_t srcSize)
+{
+	if(stride == 0 || stride % 4 != 0 || stride > MaxVertexStride || srcSize < 1 || src[0] != VertexFormat)
+		return false;
+
+	uint8* records = static_cast<uint8*>(dst);
+	const uint8* in = src + 1;
+	const uint8* end = src + srcSize;
+
+	uint8 last[MaxVertexStride] = {};
+	uint8 partial[MaxVertexStride * VertexBlockSize];
+	for(uint32 start = 0; start < vertexCount; start += VertexBlockSize)
+	{
+		uint32 count = std::min(VertexBlockSize, vertexCount - start);
+		if((std::size_t)(end - in) < stride / 4)
+			return false;
+
+		const uint8* headers = in;
+		in += stride / 4;
+		std::size_t bytes = GetVertexBlockSize(headers, stride);
+		if((std::size_t)(end - in) < bytes)
+			return false;
+
+		// The last block is decoded aside and only its real vertices copied out.
+		uint8* out = count == VertexBlockSize ? records + (std::size_t)start * stride : partial;
+#if MESH_CODEC_SSE2
+		DecodeVertexBlock(out, stride, headers, in, last);
+#else
+		DecodeVertexBlockScalar(out, stride, headers, in, last);
+#endif
+		if(out == partial)
+			std::memcpy(records + (std::size_t)start * stride, partial, (std::size_t)count * stride);
+
+		in += bytes;
+	}
+
+	return in == end;
+}
+
+Quantization MeshCodec::GetQuantization(const GeometryGenerator::Vertex* vertices, uint32 vertexCount)
+{
+	float positionMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float positionMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	float texCMin[2] = { FLT_MAX, FLT_MAX };
+	float texCMax[2] = { -FLT_MAX, -FLT_MAX };
+
+	for(uint32 i = 0; i < vertexCount; ++i)
+	{
+		const GeometryGenerator::Vertex& v = vertices[i];
+		const float position[3] = { v.Position.x, v.Position.y, v.Position.z };
+		const float texC[2] = { v.TexC.x, v.TexC.y };
+
+		for(int k = 0; k < 3; ++k)
+		{
+			positionMin[k] = std::min(positionMin[k], position[k]);
+			positionMax[k] = std::max(positionMax[k], position[k]);
+		}
+		for(int k = 0; k < 2; ++k)
+		{
+			texCMin[k] = std::min(texCMin[k], texC[k]);
+			texCMax[k] = std::max(texCMax[k], texC[k]);
+		}
+	}
+
+	Quantization quantization = {};
+	if(vertexCount == 0)
+		return quantization;
+
+	for(int k = 0; k < 3; ++k)
+	{
+		quantization.PositionMin[k] = positionMin[k];
+		quantization.PositionScale[k] = (positionMax[k] - positionMin[k]) / 65535.0f;
+	}
+	for(int k = 0; k < 2; ++k)
+	{
+		quantization.TexCMin[k] = texCMin[k];
+		quantization.TexCScale[k] = (texCMax[k] - texCMin[k]) / 65535.0f;
+	}
+	return quantization;
+}
+
+void MeshCodec::Quantize(QuantizedVertex* dst, const GeometryGenerator::Vertex* src, uint32 vertexCount, const Quantization& quantization)
+{
+	const Quantization& q = quantization;
+	for(uint32 i = 0; i < vertexCount; ++i)
+	{
+		const GeometryGenerator::Vertex& v = src[i];
+		QuantizedVertex& out = dst[i];
+
+		out.Position[0] = QuantizeUnorm(v.Position.x, q.PositionMin[0], q.PositionScale[0]);
+		out.Position[1] = QuantizeUnorm(v.Position.y, q.PositionMin[1], q.PositionScale[1]);
+		out.Position[2] = QuantizeUnorm(v.Position.z, q.PositionMin[2], q.PositionScale[2]);
+		EncodeOctahedral(v.Normal, out.Normal);
+		EncodeOctahedral(v.TangentU, out.TangentU);
+		out.TexC[0] = QuantizeUnorm(v.TexC.x, q.TexCMin[0], q.TexCScale[0]);
+		out.TexC[1] = QuantizeUnorm(v.TexC.y, q.TexCMin[1], q.TexCScale[1]);
+		out.Padding = 0;
+	}
+}
+
+void MeshCodec::Dequantize(GeometryGenerator::Vertex* dst, const QuantizedVertex* src, uint32 vertexCount, const Quantization& quantization)
+{
+	const Quantization& q = quantization;
+	for(uint32 i = 0; i < vertexCount; ++i)
+	{
+		const QuantizedVertex& v = src[i];
+		GeometryGenerator::Vertex& out = dst[i];
+
+		out.Position = DirectX::XMFLOAT3(
+			q.PositionMin[0] + v.Position[0] * q.PositionScale[0],
+			q.PositionMin[1] + v.Position[1] * q.PositionScale[1],
+			q.PositionMin[2] + v.Position[2] * q.PositionScale[2]);
+		out.Normal = DecodeOctahedral(v.Normal);
+		out.TangentU = DecodeOctahedral(v.TangentU);
+		out.TexC = DirectX::XMFLOAT2(
+			q.TexCMin[0] + v.TexC[0] * q.TexCScale[0],
+			q.TexCMin[1] + v.TexC[1] * q.TexCScale[1]);
+	}
+}
+
+void MeshCodec::Compress(const GeometryGenerator::MeshData& mesh, CompressedMesh& compressed)
+{
+	uint32 vertexCount = (uint32)mesh.Vertices.size();
+	uint32 indexCount = (uint32)mesh.Indices32.size();
+
+	compressed.Quantization = GetQuantization(mesh.Vertices.data(), vertexCount);
+	compressed.VertexCount = vertexCount;
+	compressed.IndexCount = indexCount;
+
+	std::vector<QuantizedVertex> quantized(vertexCount);
+	Quantize(quantized.data(), mesh.Vertices.data(), vertexCount, compressed.Quantization);
+
+	compressed.Vertices.resize(GetVertexBufferBound(vertexCount, sizeof(QuantizedVertex)));
+	compressed.Vertices.resize(EncodeVertices(compressed.Vertices.data(), compressed.Vertices.size(),
+		quantized.data(), vertexCount, sizeof(QuantizedVertex)));
+
+	compressed.Indices.resize(GetIndexBufferBound(indexCount));
+	compressed.Indices.resize(EncodeIndices(compressed.Indices.data(), compressed.Indices.size(),
+		mesh.Indices32.data(), indexCount));
+}
+
+bool MeshCodec::Decompress(const CompressedMesh& compressed, GeometryGenerator::MeshData& mesh)
+{
+	std::vector<QuantizedVertex> quantized(compressed.VertexCount);
+	if(!DecodeVertices(quantized.data(), compressed.VertexCount, sizeof(QuantizedVertex),
+		compressed.Vertices.data(), compressed.Vertices.size()))
+		return false;
+
+	mesh.Vertices.resize(compressed.VertexCount);
+	Dequantize(mesh.Vertices.data(), quantized.data(), compressed.VertexCount, compressed.Quantization);
+
+	mesh.Indices32.resize(compressed.IndexCount);
+	return DecodeIndices(mesh.Indices32.data(), compressed.IndexCount, compressed.Indices.data(), compressed.Indices.size());
+}
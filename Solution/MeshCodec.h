@@ -0,0 +1,130 @@
+//***************************************************************************************
+// MeshCodec.h
+//
+// Lossless compression of index and vertex buffers, for storing terrain chunks and
+// large meshes compactly and expanding them quickly at load time.
+//
+// Indices are coded in blocks of 48.  Each index is predicted by the index 6 or 12
+// places before it, the same corner of the previous quad or of the previous group of
+// four triangles, whichever suits the block better; the generators emit their
+// triangles in such regular runs that the differences are mostly 0, 1 or 2.  The
+// zigzagged differences are stored at the narrowest of 0, 2, 4, 8, 16 or 32 bits.
+//
+// Vertices are coded as fixed-size records in blocks of 16.  Every byte of the record
+// is a plane: the byte is replaced by its difference from the same byte of the
+// previous vertex and the 16 differences of a plane are stored at 0, 2, 4 or 8 bits.
+// This works on any record layout but pays off on quantized ones, where neighbouring
+// vertices differ in few bits; QuantizedVertex is the quantized GeometryGenerator
+// vertex, and Compress/Decompress run a whole MeshData through both codecs.
+//
+// The decoders use SSE2 on x86 and x64 and plain C++ elsewhere; both read the same
+// streams.
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MeshCodec
+{
+	using uint8 = std::uint8_t;
+	using int16 = std::int16_t;
+	using uint16 = std::uint16_t;
+	using uint32 = std::uint32_t;
+
+	const uint8 IndexFormat = 1;
+	const uint8 VertexFormat = 1;
+	const uint32 MaxVertexStride = 256;
+
+	///<summary>
+	/// Largest encoding of indexCount indices.
+	///</summary>
+	std::size_t GetIndexBufferBound(uint32 indexCount);
+
+	///<summary>
+	/// Encodes the indices into dst and returns the bytes written, or 0 if dstSize is
+	/// too small.
+	///</summary>
+	std::size_t EncodeIndices(uint8* dst, std::size_t dstSize, const uint32* indices, uint32 indexCount);
+	std::size_t EncodeIndices(uint8* dst, std::size_t dstSize, const uint16* indices, uint32 indexCount);
+
+	///<summary>
+	/// Decodes indexCount indices.  Returns false if src is not a complete index stream
+	/// of this format; decoding into 16-bit indices also fails on an index above 65535.
+	///</summary>
+	bool DecodeIndices(uint32* dst, uint32 indexCount, const uint8* src, std::size_t srcSize);
+	bool DecodeIndices(uint16* dst, uint32 indexCount, const uint8* src, std::size_t srcSize);
+
+	///<summary>
+	/// Largest encoding of vertexCount records of stride bytes.
+	///</summary>
+	std::size_t GetVertexBufferBound(uint32 vertexCount, uint32 stride);
+
+	///<summary>
+	/// Encodes vertexCount records of stride bytes.  stride is a multiple of 4 and at
+	/// most MaxVertexStride.  Returns the bytes written, or 0 if the stride is not
+	/// supported or dstSize is too small.
+	///</summary>
+	std::size_t EncodeVertices(uint8* dst, std::size_t dstSize, const void* vertices, uint32 vertexCount, uint32 stride);
+
+	///<summary>
+	/// Decodes vertexCount records of stride bytes.  Returns false if src is not a
+	/// complete vertex stream of this format and stride.
+	///</summary>
+	bool DecodeVertices(void* dst, uint32 vertexCount, uint32 stride, const uint8* src, std::size_t srcSize);
+
+	// GeometryGenerator::Vertex in 20 bytes: position and texture coordinates as 16-bit
+	// fractions of the mesh bounds, normal and tangent as octahedral 16-bit pairs.  The
+	// normal and tangent dequantize to unit length whatever length they had.
+	struct QuantizedVertex
+	{
+		uint16 Position[3];
+		int16 Normal[2];
+		int16 TangentU[2];
+		uint16 TexC[2];
+		uint16 Padding;
+	};
+
+	static_assert(sizeof(QuantizedVertex) % 4 == 0, "EncodeVertices needs a multiple of 4 bytes");
+
+	// Maps the 16-bit positions and texture coordinates back into the mesh bounds.
+	struct Quantization
+	{
+		float PositionMin[3];
+		float PositionScale[3];
+		float TexCMin[2];
+		float TexCScale[2];
+	};
+
+	///<summary>
+	/// Quantization covering the positions and texture coordinates of the vertices.
+	///</summary>
+	Quantization GetQuantization(const GeometryGenerator::Vertex* vertices, uint32 vertexCount);
+
+	void Quantize(QuantizedVertex* dst, const GeometryGenerator::Vertex* src, uint32 vertexCount, const Quantization& quantization);
+	void Dequantize(GeometryGenerator::Vertex* dst, const QuantizedVertex* src, uint32 vertexCount, const Quantization& quantization);
+
+	struct CompressedMesh
+	{
+		MeshCodec::Quantization Quantization;
+		uint32 VertexCount = 0;
+		uint32 IndexCount = 0;
+		std::vector<uint8> Vertices;
+		std::vector<uint8> Indices;
+	};
+
+	///<summary>
+	/// Quantizes and encodes a mesh.  Only the quantization loses anything: the indices
+	/// and the quantized vertices come back exactly.
+	///</summary>
+	void Compress(const GeometryGenerator::MeshData& mesh, CompressedMesh& compressed);
+
+	///<summary>
+	/// Decodes and dequantizes a mesh.  Returns false if either stream is corrupt.
+	///</summary>
+	bool Decompress(const CompressedMesh& compressed, GeometryGenerator::MeshData& mesh);
+}
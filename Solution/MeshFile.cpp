@@ -0,0 +1,256 @@
+//***************************************************************************************
+// MeshFile.cpp
+//***************************************************************************************
+
+#include "MeshFile.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace MeshFile;
+
+namespace
+{
+	uint64 AlignUp(uint64 offset)
+	{
+		return (offset + StreamAlignment - 1) / StreamAlignment * StreamAlignment;
+	}
+
+	void GrowBounds(const GeometryGenerator::Vertex* vertices, uint32 count, float boundsMin[3], float boundsMax[3])
+	{
+		for(uint32 i = 0; i < count; ++i)
+		{
+			const DirectX::XMFLOAT3& p = vertices[i].Position;
+			boundsMin[0] = std::min(boundsMin[0], p.x);
+			boundsMin[1] = std::min(boundsMin[1], p.y);
+			boundsMin[2] = std::min(boundsMin[2], p.z);
+			boundsMax[0] = std::max(boundsMax[0], p.x);
+			boundsMax[1] = std::max(boundsMax[1], p.y);
+			boundsMax[2] = std::max(boundsMax[2], p.z);
+		}
+	}
+
+	void ResetBounds(float boundsMin[3], float boundsMax[3])
+	{
+		for(int k = 0; k < 3; ++k)
+		{
+			boundsMin[k] = FLT_MAX;
+			boundsMax[k] = -FLT_MAX;
+		}
+	}
+
+	template<typename Index>
+	bool IndicesBelow(const Index* indices, uint32 count, uint32 vertexCount)
+	{
+		for(uint32 i = 0; i < count; ++i)
+		{
+			if(indices[i] >= vertexCount)
+				return false;
+		}
+		return true;
+	}
+
+	// Pads the file with zeros up to offset.
+	bool PadTo(std::FILE* file, uint64 written, uint64 offset)
+	{
+		static const std::uint8_t zeros[StreamAlignment] = {};
+		return offset - written <= StreamAlignment && std::fwrite(zeros, 1, (std::size_t)(offset - written), file) == offset - written;
+	}
+}
+
+bool MeshFile::Write(const char* path, const GeometryGenerator::Vertex* vertices, uint32 vertexCount,
+	const void* indices, uint32 indexSize, uint32 indexCount,
+	const SubmeshDesc* submeshes, uint32 submeshCount, uint32 attributes)
+{
+	if(indexSize != 2 && indexSize != 4)
+		return false;
+
+	Header header = {};
+	header.Magic = Magic;
+	header.VersionMajor = VersionMajor;
+	header.VersionMinor = VersionMinor;
+	header.HeaderSize = sizeof(Header);
+	header.Attributes = attributes;
+	header.VertexStride = sizeof(GeometryGenerator::Vertex);
+	header.VertexCount = vertexCount;
+	header.IndexSize = indexSize;
+	header.IndexCount = indexCount;
+	header.SubmeshCount = submeshCount;
+
+	header.SubmeshOffset = AlignUp(sizeof(Header));
+	header.VertexOffset = AlignUp(header.SubmeshOffset + (uint64)submeshCount * sizeof(Submesh));
+	header.IndexOffset = AlignUp(header.VertexOffset + (uint64)vertexCount * header.VertexStride);
+	header.FileSize = header.IndexOffset + (uint64)indexCount * indexSize;
+
+	std::vector<Submesh> table(submeshCount);
+	ResetBounds(header.BoundsMin, header.BoundsMax);
+	for(uint32 s = 0; s < submeshCount; ++s)
+	{
+		const ShapeWriter::Range& range = submeshes[s].Range;
+		if((uint64)range.BaseVertex + range.VertexCount > vertexCount || (uint64)range.StartIndex + range.IndexCount > indexCount)
+			return false;
+
+		Submesh& submesh = table[s];
+		std::memset(&submesh, 0, sizeof(Submesh));
+		if(submeshes[s].Name != nullptr)
+			std::strncpy(submesh.Name, submeshes[s].Name, MaxNameLength);
+		submesh.BaseVertex = range.BaseVertex;
+		submesh.VertexCount = range.VertexCount;
+		submesh.StartIndex = range.StartIndex;
+		submesh.IndexCount = range.IndexCount;
+
+		ResetBounds(submesh.BoundsMin, submesh.BoundsMax);
+		GrowBounds(vertices + range.BaseVertex, range.VertexCount, submesh.BoundsMin, submesh.BoundsMax);
+	}
+	GrowBounds(vertices, vertexCount, header.BoundsMin, header.BoundsMax);
+
+	std::FILE* file = std::fopen(path, "wb");
+	if(file == nullptr)
+		return false;
+
+	bool ok = std::fwrite(&header, sizeof(Header), 1, file) == 1;
+	ok = ok && PadTo(file, sizeof(Header), header.SubmeshOffset);
+	ok = ok && (submeshCount == 0 || std::fwrite(table.data(), sizeof(Submesh), submeshCount, file) == submeshCount);
+	ok = ok && PadTo(file, header.SubmeshOffset + (uint64)submeshCount * sizeof(Submesh), header.VertexOffset);
+	ok = ok && (vertexCount == 0 || std::fwrite(vertices, header.VertexStride, vertexCount, file) == vertexCount);
+	ok = ok && PadTo(file, header.VertexOffset + (uint64)vertexCount * header.VertexStride, header.IndexOffset);
+	ok = ok && (indexCount == 0 || std::fwrite(indices, indexSize, indexCount, file) == indexCount);
+
+	return std::fclose(file) == 0 && ok;
+}
+
+bool MeshFile::Write(const char* path, const GeometryGenerator::MeshData& mesh, const char* name)
+{
+	SubmeshDesc submesh;
+	submesh.Name = name;
+	submesh.Range.BaseVertex = 0;
+	submesh.Range.VertexCount = (uint32)mesh.Vertices.size();
+	submesh.Range.StartIndex = 0;
+	submesh.Range.IndexCount = (uint32)mesh.Indices32.size();
+
+	if(mesh.Vertices.size() <= 0x10000)
+	{
+		std::vector<uint16> indices16(mesh.Indices32.begin(), mesh.Indices32.end());
+		return Write(path, mesh.Vertices.data(), submesh.Range.VertexCount, indices16.data(), 2, submesh.Range.IndexCount, &submesh, 1);
+	}
+
+	return Write(path, mesh.Vertices.data(), submesh.Range.VertexCount, mesh.Indices32.data(), 4, submesh.Range.IndexCount, &submesh, 1);
+}
+
+bool MappedMesh::Open(const char* path)
+{
+	Close();
+	if(!mFile.Open(path))
+		return false;
+
+	mBase = mFile.GetData();
+
+	// Check everything the accessors rely on, so they don't have to.
+	const Header& h = GetHeader();
+	bool valid = mFile.GetSize() >= sizeof(Header) &&
+		h.Magic == Magic &&
+		h.VersionMajor == VersionMajor &&
+		h.HeaderSize >= sizeof(Header) &&
+		h.VertexStride == sizeof(GeometryGenerator::Vertex) &&
+		(h.IndexSize == 2 || h.IndexSize == 4) &&
+		h.SubmeshOffset % StreamAlignment == 0 && h.VertexOffset % StreamAlignment == 0 && h.IndexOffset % StreamAlignment == 0 &&
+		h.SubmeshOffset >= h.HeaderSize &&
+		h.FileSize <= mFile.GetSize() &&
+		h.SubmeshOffset + (std::uint64_t)h.SubmeshCount * sizeof(Submesh) <= h.FileSize &&
+		h.VertexOffset + (std::uint64_t)h.VertexCount * h.VertexStride <= h.FileSize &&
+		h.IndexOffset + (std::uint64_t)h.IndexCount * h.IndexSize <= h.FileSize;
+
+	for(uint32 s = 0; valid && s < h.SubmeshCount; ++s)
+	{
+		const Submesh& submesh = GetSubmesh(s);
+		valid = (std::uint64_t)submesh.BaseVertex + submesh.VertexCount <= h.VertexCount &&
+			(std::uint64_t)submesh.StartIndex + submesh.IndexCount <= h.IndexCount &&
+			std::memchr(submesh.Name, 0, sizeof(submesh.Name)) != nullptr;
+	}
+
+	// As GlbFile does, an index past the vertices refuses the file rather than being
+	// read out of bounds later: past the whole vertex stream, or past its submesh's
+	// vertices, since indices are relative to the submesh's BaseVertex.
+	if(valid)
+	{
+		valid = h.IndexSize == 2 ?
+			IndicesBelow(GetIndices16(), h.IndexCount, h.VertexCount) :
+			IndicesBelow(GetIndices32(), h.IndexCount, h.VertexCount);
+	}
+
+	for(uint32 s = 0; valid && s < h.SubmeshCount; ++s)
+	{
+		const Submesh& submesh = GetSubmesh(s);
+		valid = h.IndexSize == 2 ?
+			IndicesBelow(GetIndices16() + submesh.StartIndex, submesh.IndexCount, submesh.VertexCount) :
+			IndicesBelow(GetIndices32() + submesh.StartIndex, submesh.IndexCount, submesh.VertexCount);
+	}
+
+	if(!valid)
+		Close();
+
+	return valid;
+}
+
+void MappedMesh::Close()
+{
+	mFile.Close();
+	mBase = nullptr;
+}
+
+const GeometryGenerator::Vertex* MappedMesh::GetVertices()const
+{
+	return reinterpret_cast<const GeometryGenerator::Vertex*>(mBase + GetHeader().VertexOffset);
+}
+
+const std::uint16_t* MappedMesh::GetIndices16()const
+{
+	return GetIndexSize() == 2 ? reinterpret_cast<const std::uint16_t*>(GetIndexData()) : nullptr;
+}
+
+const std::uint32_t* MappedMesh::GetIndices32()const
+{
+	return GetIndexSize() == 4 ? reinterpret_cast<const std::uint32_t*>(GetIndexData()) : nullptr;
+}
+
+const Submesh& MappedMesh::GetSubmesh(uint32 submesh)const
+{
+	return reinterpret_cast<const Submesh*>(mBase + GetHeader().SubmeshOffset)[submesh];
+}
+
+ShapeWriter::Range MappedMesh::GetRange(uint32 submesh)const
+{
+	const Submesh& s = GetSubmesh(submesh);
+
+	ShapeWriter::Range range;
+	range.BaseVertex = s.BaseVertex;
+	range.VertexCount = s.VertexCount;
+	range.StartIndex = s.StartIndex;
+	range.IndexCount = s.IndexCount;
+	return range;
+}
+
+MappedMesh::uint32 MappedMesh::FindSubmesh(const char* name)const
+{
+	uint32 count = GetSubmeshCount();
+	for(uint32 s = 0; s < count; ++s)
+	{
+		if(std::strcmp(GetSubmesh(s).Name, name) == 0)
+			return s;
+	}
+	return count;
+}
+
+void MappedMesh::CopyTo(GeometryGenerator::MeshData& mesh)const
+{
+	const GeometryGenerator::Vertex* vertices = GetVertices();
+	mesh.Vertices.assign(vertices, vertices + GetVertexCount());
+
+	if(const std::uint16_t* indices16 = GetIndices16())
+		mesh.Indices32.assign(indices16, indices16 + GetIndexCount());
+	else
+		mesh.Indices32.assign(GetIndices32(), GetIndices32() + GetIndexCount());
+}
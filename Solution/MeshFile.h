@@ -0,0 +1,152 @@
+//***************************************************************************************
+// MeshFile.h
+//
+// A binary container for pre-generated and imported meshes, laid out so that a file
+// can be memory-mapped and used where it lies:
+//
+//   Header        magic, version, counts, stream offsets and the bounds of the mesh
+//   Submeshes     a fixed-size record per submesh: name, ranges and bounds
+//   Vertices      GeometryGenerator::Vertex, VertexStride bytes apiece
+//   Indices       16- or 32-bit, IndexSize bytes apiece
+//
+// Every section starts on a StreamAlignment boundary and the header records each
+// offset, so a reader never has to parse its way through the file.  Readers accept any
+// file with the same major version; minor versions only add to the reserved space.
+//
+// MappedMesh maps a file read-only and hands out pointers into the mapping: the
+// vertices as GeometryGenerator::Vertex, the indices, and a ShapeWriter::Range per
+// submesh for ScenePacker::AddMesh or a SubmeshGeometry.
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+#include "MappedFile.h"
+#include "ShapeWriter.h"
+
+#include <cstdint>
+
+namespace MeshFile
+{
+	using uint16 = std::uint16_t;
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	const uint32 Magic = 0x3148534D;    // "MSH1"
+	const uint16 VersionMajor = 1;
+	const uint16 VersionMinor = 0;
+	const uint32 StreamAlignment = 64;
+	const uint32 MaxNameLength = 23;
+
+	struct Header
+	{
+		uint32 Magic;
+		uint16 VersionMajor;
+		uint16 VersionMinor;
+		uint32 HeaderSize;
+		uint32 Attributes;              // ShapeWriter::Attribute bits present in the vertices
+
+		uint32 VertexStride;
+		uint32 VertexCount;
+		uint32 IndexSize;               // 2 or 4
+		uint32 IndexCount;
+		uint32 SubmeshCount;
+		uint32 Reserved0;
+
+		uint64 SubmeshOffset;
+		uint64 VertexOffset;
+		uint64 IndexOffset;
+		uint64 FileSize;
+
+		float BoundsMin[3];
+		float BoundsMax[3];
+
+		uint32 Reserved[8];
+	};
+
+	struct Submesh
+	{
+		char Name[MaxNameLength + 1];   // zero-terminated
+		uint32 BaseVertex;
+		uint32 VertexCount;
+		uint32 StartIndex;
+		uint32 IndexCount;
+		float BoundsMin[3];
+		float BoundsMax[3];
+	};
+
+	static_assert(sizeof(Header) == 128, "MeshFile::Header is part of the file format");
+	static_assert(sizeof(Submesh) == 64, "MeshFile::Submesh is part of the file format");
+
+	struct SubmeshDesc
+	{
+		const char* Name;               // at most MaxNameLength characters are kept
+		ShapeWriter::Range Range;
+	};
+
+	///<summary>
+	/// Writes a mesh file.  indexSize is 2 or 4.  Indices are relative to their
+	/// submesh's BaseVertex, as ShapeWriter and ScenePacker produce them.  Returns false
+	/// if the file can't be written.
+	///</summary>
+	bool Write(const char* path, const GeometryGenerator::Vertex* vertices, uint32 vertexCount,
+		const void* indices, uint32 indexSize, uint32 indexCount,
+		const SubmeshDesc* submeshes, uint32 submeshCount, uint32 attributes = ShapeWriter::AllAttributes);
+
+	///<summary>
+	/// Writes a MeshData as a single submesh, with 16-bit indices when they fit.
+	///</summary>
+	bool Write(const char* path, const GeometryGenerator::MeshData& mesh, const char* name);
+}
+
+class MappedMesh
+{
+public:
+
+	using uint32 = std::uint32_t;
+
+	MappedMesh() = default;
+	MappedMesh(const MappedMesh& rhs) = delete;
+	MappedMesh& operator=(const MappedMesh& rhs) = delete;
+
+	///<summary>
+	/// Maps the file and checks its header, section bounds and indices.  Returns false,
+	/// leaving the mesh closed, if the file is missing, truncated, not a mesh file of
+	/// this major version or has an index past its submesh's vertices.
+	///</summary>
+	bool Open(const char* path);
+	void Close();
+
+	bool IsOpen()const { return mBase != nullptr; }
+
+	const MeshFile::Header& GetHeader()const { return *reinterpret_cast<const MeshFile::Header*>(mBase); }
+
+	uint32 GetVertexCount()const { return GetHeader().VertexCount; }
+	const GeometryGenerator::Vertex* GetVertices()const;
+
+	uint32 GetIndexCount()const { return GetHeader().IndexCount; }
+	uint32 GetIndexSize()const { return GetHeader().IndexSize; }
+	const void* GetIndexData()const { return mBase + GetHeader().IndexOffset; }
+
+	// nullptr unless the file holds indices of that size.
+	const std::uint16_t* GetIndices16()const;
+	const std::uint32_t* GetIndices32()const;
+
+	uint32 GetSubmeshCount()const { return GetHeader().SubmeshCount; }
+	const MeshFile::Submesh& GetSubmesh(uint32 submesh)const;
+	ShapeWriter::Range GetRange(uint32 submesh)const;
+
+	///<summary>
+	/// Index of the submesh with the given name, or GetSubmeshCount() if there is none.
+	///</summary>
+	uint32 FindSubmesh(const char* name)const;
+
+	///<summary>
+	/// Copies the whole mesh into a MeshData, for code that wants vectors.
+	///</summary>
+	void CopyTo(GeometryGenerator::MeshData& mesh)const;
+
+private:
+	MappedFile mFile;
+	const std::uint8_t* mBase = nullptr;
+};
@@ -0,0 +1,23 @@
+//***************************************************************************************
+// NameRegistry.cpp
+//***************************************************************************************
+
+#include "NameRegistry.h"
+
+NameRegistry::Handle NameRegistry::Intern(const std::string& name)
+{
+	auto it = mHandles.find(name);
+	if(it != mHandles.end())
+		return it->second;
+
+	Handle handle = (Handle)mNames.size();
+	mNames.push_back(name);
+	mHandles.emplace(name, handle);
+	return handle;
+}
+
+NameRegistry::Handle NameRegistry::Find(const std::string& name)const
+{
+	auto it = mHandles.find(name);
+	return it != mHandles.end() ? it->second : InvalidHandle;
+}
@@ -0,0 +1,86 @@
+//***************************************************************************************
+// NameRegistry.h
+//
+// String interning for resources that are named at build time and used every frame.
+// NameRegistry maps each distinct name to a dense handle, 0, 1, 2, ... in the order
+// the names are first seen.  NamedTable keeps one value per handle in a vector, so
+// code resolves a name once while building and then looks the value up by index,
+// without hashing or constructing a std::string per lookup.
+//***************************************************************************************
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class NameRegistry
+{
+public:
+
+	using uint32 = std::uint32_t;
+	using Handle = std::uint32_t;
+
+	static const Handle InvalidHandle = 0xffffffff;
+
+	///<summary>
+	/// Returns the handle of name, assigning the next free handle the first time.
+	///</summary>
+	Handle Intern(const std::string& name);
+
+	///<summary>
+	/// Returns the handle of name, or InvalidHandle if it was never interned.
+	///</summary>
+	Handle Find(const std::string& name)const;
+
+	const std::string& GetName(Handle handle)const { return mNames[handle]; }
+	uint32 GetCount()const { return (uint32)mNames.size(); }
+
+private:
+	std::vector<std::string> mNames;
+	std::unordered_map<std::string, Handle> mHandles;
+};
+
+// Values addressed by interned name.  Indexing by name interns it (like
+// std::unordered_map::operator[]) and is meant for build time; indexing by handle is
+// a plain array access.
+template<typename T>
+class NamedTable
+{
+public:
+
+	using Handle = NameRegistry::Handle;
+
+	Handle Intern(const std::string& name)
+	{
+		Handle handle = mNames.Intern(name);
+		if(handle >= mValues.size())
+			mValues.resize(handle + 1);
+		return handle;
+	}
+
+	Handle Find(const std::string& name)const { return mNames.Find(name); }
+
+	T& operator[](const std::string& name) { return mValues[Intern(name)]; }
+
+	T& operator[](Handle handle)
+	{
+		assert(handle < mValues.size());
+		return mValues[handle];
+	}
+
+	const T& operator[](Handle handle)const
+	{
+		assert(handle < mValues.size());
+		return mValues[handle];
+	}
+
+	const std::string& GetName(Handle handle)const { return mNames.GetName(handle); }
+	NameRegistry::uint32 GetCount()const { return mNames.GetCount(); }
+
+private:
+	NameRegistry mNames;
+	std::vector<T> mValues;
+};
@@ -0,0 +1,404 @@
+//***************************************************************************************
+// Noise.cpp
+//***************************************************************************************
+
+#include "Noise.h"
+
+#include <algorithm>
+#include <cstring>
+
+// AVX2 only when the build targets it (/arch:AVX2, -mavx2); SSE2 is part of x64 and of
+// any x86 target built for it.  Define NOISE_AVX2 or NOISE_SSE2 as 0 to leave a path out.
+#if !defined(NOISE_AVX2)
+#if defined(__AVX2__)
+#define NOISE_AVX2 1
+#else
+#define NOISE_AVX2 0
+#endif
+#endif
+
+#if !defined(NOISE_SSE2)
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define NOISE_SSE2 1
+#else
+#define NOISE_SSE2 0
+#endif
+#endif
+
+#if NOISE_AVX2
+#include <immintrin.h>
+#elif NOISE_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace Noise;
+
+namespace
+{
+	using int32 = std::int32_t;
+
+	const uint32 MaxOctaves = 16;
+
+	// Skew to and from the simplex lattice, (sqrt(3) - 1) / 2 and (3 - sqrt(3)) / 6.
+	const float F2 = 0.366025403784f;
+	const float G2 = 0.211324865405f;
+
+	// Brings the sum of the three corners to about [-1, 1] for gradients of length
+	// sqrt(1.25).
+	const float SimplexScale = 88.0f;
+
+	const uint32 OctaveSeedStep = 0x9E3779B9u;
+	const uint32 WarpSeedX = 0x68BC21EBu;
+	const uint32 WarpSeedY = 0x02E5BE93u;
+
+	//
+	// Lanes: the operations the noise is written in, on one float at a time or on a
+	// whole register.  Masks are integer vectors of all ones or all zeros.  Every float
+	// operation rounds the same in each, so the results agree to the bit; the scalar
+	// Floor, Min and Max spell out what the SIMD instructions do, signed zeros included.
+	//
+
+	struct ScalarLanes
+	{
+		using F = float;
+		using I = uint32;
+		static const uint32 Width = 1;
+
+		static F Set(float a) { return a; }
+		static I SetI(uint32 a) { return a; }
+		static F Add(F a, F b) { return a + b; }
+		static F Sub(F a, F b) { return a - b; }
+		static F Mul(F a, F b) { return a * b; }
+		static F Min(F a, F b) { return a < b ? a : b; }
+		static F Max(F a, F b) { return a > b ? a : b; }
+		static I Greater(F a, F b) { return a > b ? ~0u : 0u; }
+		static F Select(I mask, F a, F b) { return mask != 0 ? a : b; }
+		static F Floor(F a)
+		{
+			F t = (F)(int32)a;
+			return t - (t > a ? 1.0f : 0.0f);
+		}
+		static I ToInt(F a) { return (I)(int32)a; }
+		static F ToFloat(I a) { return (F)(int32)a; }
+		static F XorBits(F a, I bits)
+		{
+			uint32 u;
+			std::memcpy(&u, &a, 4);
+			u ^= bits;
+			std::memcpy(&a, &u, 4);
+			return a;
+		}
+		static F AndBits(F a, I bits)
+		{
+			uint32 u;
+			std::memcpy(&u, &a, 4);
+			u &= bits;
+			std::memcpy(&a, &u, 4);
+			return a;
+		}
+		static I AddI(I a, I b) { return a + b; }
+		static I MulI(I a, I b) { return a * b; }
+		static I XorI(I a, I b) { return a ^ b; }
+		static I AndI(I a, I b) { return a & b; }
+		template<int N> static I ShiftLeft(I a) { return a << N; }
+		template<int N> static I ShiftRight(I a) { return a >> N; }
+		template<int N> static I ShiftRightSigned(I a) { return (I)((int32)a >> N); }
+		static I Iota(uint32 first) { return first; }
+		static void Store(float* dst, F a) { *dst = a; }
+	};
+
+#if NOISE_SSE2 && !NOISE_AVX2
+	struct SimdLanes
+	{
+		using F = __m128;
+		using I = __m128i;
+		static const uint32 Width = 4;
+
+		static F Set(float a) { return _mm_set1_ps(a); }
+		static I SetI(uint32 a) { return _mm_set1_epi32((int)a); }
+		static F Add(F a, F b) { return _mm_add_ps(a, b); }
+		static F Sub(F a, F b) { return _mm_sub_ps(a, b); }
+		static F Mul(F a, F b) { return _mm_mul_ps(a, b); }
+		static F Min(F a, F b) { return _mm_min_ps(a, b); }
+		static F Max(F a, F b) { return _mm_max_ps(a, b); }
+		static I Greater(F a, F b) { return _mm_castps_si128(_mm_cmpgt_ps(a, b)); }
+		static F Select(I mask, F a, F b)
+		{
+			F m = _mm_castsi128_ps(mask);
+			return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+		}
+		static F Floor(F a)
+		{
+			F t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+			return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a), _mm_set1_ps(1.0f)));
+		}
+		static I ToInt(F a) { return _mm_cvttps_epi32(a); }
+		static F ToFloat(I a) { return _mm_cvtepi32_ps(a); }
+		static F XorBits(F a, I bits) { return _mm_xor_ps(a, _mm_castsi128_ps(bits)); }
+		static F AndBits(F a, I bits) { return _mm_and_ps(a, _mm_castsi128_ps(bits)); }
+		static I AddI(I a, I b) { return _mm_add_epi32(a, b); }
+		static I MulI(I a, I b)
+		{
+			// No 32-bit multiply before SSE4.1: even and odd lanes through the 64-bit one.
+			I even = _mm_mul_epu32(a, b);
+			I odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+			return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+		}
+		static I XorI(I a, I b) { return _mm_xor_si128(a, b); }
+		static I AndI(I a, I b) { return _mm_and_si128(a, b); }
+		template<int N> static I ShiftLeft(I a) { return _mm_slli_epi32(a, N); }
+		template<int N> static I ShiftRight(I a) { return _mm_srli_epi32(a, N); }
+		template<int N> static I ShiftRightSigned(I a) { return _mm_srai_epi32(a, N); }
+		static I Iota(uint32 first) { return _mm_add_epi32(_mm_set1_epi32((int)first), _mm_set_epi32(3, 2, 1, 0)); }
+		static void Store(float* dst, F a) { _mm_storeu_ps(dst, a); }
+	};
+#endif
+
+#if NOISE_AVX2
+	struct SimdLanes
+	{
+		using F = __m256;
+		using I = __m256i;
+		static const uint32 Width = 8;
+
+		static F Set(float a) { return _mm256_set1_ps(a); }
+		static I SetI(uint32 a) { return _mm256_set1_epi32((int)a); }
+		static F Add(F a, F b) { return _mm256_add_ps(a, b); }
+		static F Sub(F a, F b) { return _mm256_sub_ps(a, b); }
+		static F Mul(F a, F b) { return _mm256_mul_ps(a, b); }
+		static F Min(F a, F b) { return _mm256_min_ps(a, b); }
+		static F Max(F a, F b) { return _mm256_max_ps(a, b); }
+		static I Greater(F a, F b) { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GT_OQ)); }
+		static F Select(I mask, F a, F b) { return _mm256_blendv_ps(b, a, _mm256_castsi256_ps(mask)); }
+		static F Floor(F a)
+		{
+			// Not _mm256_floor_ps, which keeps the sign of -0 where the others don't.
+			F t = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(a));
+			return _mm256_sub_ps(t, _mm256_and_ps(_mm256_cmp_ps(t, a, _CMP_GT_OQ), _mm256_set1_ps(1.0f)));
+		}
+		static I ToInt(F a) { return _mm256_cvttps_epi32(a); }
+		static F ToFloat(I a) { return _mm256_cvtepi32_ps(a); }
+		static F XorBits(F a, I bits) { return _mm256_xor_ps(a, _mm256_castsi256_ps(bits)); }
+		static F AndBits(F a, I bits) { return _mm256_and_ps(a, _mm256_castsi256_ps(bits)); }
+		static I AddI(I a, I b) { return _mm256_add_epi32(a, b); }
+		static I MulI(I a, I b) { return _mm256_mullo_epi32(a, b); }
+		static I XorI(I a, I b) { return _mm256_xor_si256(a, b); }
+		static I AndI(I a, I b) { return _mm256_and_si256(a, b); }
+		template<int N> static I ShiftLeft(I a) { return _mm256_slli_epi32(a, N); }
+		template<int N> static I ShiftRight(I a) { return _mm256_srli_epi32(a, N); }
+		template<int N> static I ShiftRightSigned(I a) { return _mm256_srai_epi32(a, N); }
+		static I Iota(uint32 first) { return _mm256_add_epi32(_mm256_set1_epi32((int)first), _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0)); }
+		static void Store(float* dst, F a) { _mm256_storeu_ps(dst, a); }
+	};
+#endif
+
+	// A well-mixed 32-bit hash of a lattice point.
+	template<typename L>
+	typename L::I Hash(typename L::I i, typename L::I j, typename L::I seed)
+	{
+		typename L::I h = L::XorI(L::XorI(L::MulI(i, L::SetI(0x8DA6B343u)), L::MulI(j, L::SetI(0xD8163841u))), seed);
+		h = L::XorI(h, L::template ShiftRight<15>(h));
+		h = L::MulI(h, L::SetI(0x2C1B3C6Du));
+		h = L::XorI(h, L::template ShiftRight<12>(h));
+		h = L::MulI(h, L::SetI(0x297A2D39u));
+		return L::XorI(h, L::template ShiftRight<15>(h));
+	}
+
+	// One of the eight gradients (+-1, +-0.5) and (+-0.5, +-1), picked by the low three
+	// bits of the hash, dotted with (x, y).
+	template<typename L>
+	typename L::F Gradient(typename L::I h, typename L::F x, typename L::F y)
+	{
+		typename L::I swap = L::template ShiftRightSigned<31>(L::template ShiftLeft<29>(h));
+		typename L::F u = L::Select(swap, y, x);
+		typename L::F v = L::Select(swap, x, y);
+		typename L::I signBit = L::SetI(0x80000000u);
+		u = L::XorBits(u, L::template ShiftLeft<31>(h));
+		v = L::XorBits(v, L::AndI(L::template ShiftLeft<30>(h), signBit));
+		return L::Add(u, L::Mul(v, L::Set(0.5f)));
+	}
+
+	template<typename L>
+	typename L::F Corner(typename L::I h, typename L::F x, typename L::F y)
+	{
+		typename L::F a = L::Sub(L::Set(0.5f), L::Add(L::Mul(x, x), L::Mul(y, y)));
+		a = L::Max(a, L::Set(0.0f));
+		a = L::Mul(a, a);
+		return L::Mul(L::Mul(a, a), Gradient<L>(h, x, y));
+	}
+
+	template<typename L>
+	typename L::F SimplexLanes(typename L::F x, typename L::F y, typename L::I seed)
+	{
+		using F = typename L::F;
+		using I = typename L::I;
+
+		// The simplex cell and the offsets from its three corners.
+		F s = L::Mul(L::Add(x, y), L::Set(F2));
+		F fi = L::Floor(L::Add(x, s));
+		F fj = L::Floor(L::Add(y, s));
+		F t = L::Mul(L::Add(fi, fj), L::Set(G2));
+		F x0 = L::Sub(x, L::Sub(fi, t));
+		F y0 = L::Sub(y, L::Sub(fj, t));
+
+		// The lower triangle (x0 > y0) steps along x first, the upper one along y.
+		I lower = L::Greater(x0, y0);
+		F one = L::Set(1.0f);
+		F i1 = L::Select(lower, one, L::Set(0.0f));
+		F j1 = L::Sub(one, i1);
+		F x1 = L::Add(L::Sub(x0, i1), L::Set(G2));
+		F y1 = L::Add(L::Sub(y0, j1), L::Set(G2));
+		F x2 = L::Add(L::Sub(x0, one), L::Set(2.0f * G2));
+		F y2 = L::Add(L::Sub(y0, one), L::Set(2.0f * G2));
+
+		I i = L::ToInt(fi);
+		I j = L::ToInt(fj);
+		I di = L::AndI(lower, L::SetI(1));
+		I dj = L::XorI(di, L::SetI(1));
+		I h0 = Hash<L>(i, j, seed);
+		I h1 = Hash<L>(L::AddI(i, di), L::AddI(j, dj), seed);
+		I h2 = Hash<L>(L::AddI(i, L::SetI(1)), L::AddI(j, L::SetI(1)), seed);
+
+		F n = L::Add(L::Add(Corner<L>(h0, x0, y0), Corner<L>(h1, x1, y1)), Corner<L>(h2, x2, y2));
+		return L::Mul(n, L::Set(SimplexScale));
+	}
+
+	// Desc unpacked per octave, in scalars every path reads alike.
+	struct Octaves
+	{
+		Fractal Type;
+		uint32 Count;
+		float Frequency[MaxOctaves];
+		float Amplitude[MaxOctaves];
+		uint32 Seed[MaxOctaves];
+		float Scale;
+		bool Warp;
+		float WarpDistance;
+		float WarpFrequency;
+		uint32 WarpSeedX;
+		uint32 WarpSeedY;
+	};
+
+	Octaves Unpack(const Desc& desc)
+	{
+		Octaves octaves;
+		octaves.Type = desc.Type;
+		octaves.Count = std::max(1u, std::min(MaxOctaves, desc.Octaves));
+
+		float frequency = desc.Frequency, amplitude = 1.0f, total = 0.0f;
+		for(uint32 o = 0; o < octaves.Count; ++o)
+		{
+			octaves.Frequency[o] = frequency;
+			octaves.Amplitude[o] = amplitude;
+			octaves.Seed[o] = desc.Seed + o * OctaveSeedStep;
+			total += amplitude;
+			frequency *= desc.Lacunarity;
+			amplitude *= desc.Gain;
+		}
+
+		// fBm divides by the total amplitude; ridged octaves lie in [0, 1], so their
+		// normalized sum is stretched over [-1, 1].
+		octaves.Scale = desc.Type == Fractal::Fbm ? desc.Amplitude / total : 2.0f / total;
+
+		octaves.Warp = desc.WarpDistance != 0.0f;
+		octaves.WarpDistance = desc.WarpDistance;
+		octaves.WarpFrequency = desc.WarpFrequency;
+		octaves.WarpSeedX = desc.Seed ^ WarpSeedX;
+		octaves.WarpSeedY = desc.Seed ^ WarpSeedY;
+		return octaves;
+	}
+
+	template<typename L>
+	typename L::F Evaluate(const Octaves& octaves, const Desc& desc, typename L::F x, typename L::F y)
+	{
+		using F = typename L::F;
+
+		if(octaves.Warp)
+		{
+			F wf = L::Set(octaves.WarpFrequency);
+			F wx = L::Mul(x, wf);
+			F wy = L::Mul(y, wf);
+
+			// The second field is offset so the two don't move together.
+			F warpX = SimplexLanes<L>(wx, wy, L::SetI(octaves.WarpSeedX));
+			F warpY = SimplexLanes<L>(L::Add(wx, L::Set(5.2f)), L::Add(wy, L::Set(1.3f)), L::SetI(octaves.WarpSeedY));
+			x = L::Add(x, L::Mul(warpX, L::Set(octaves.WarpDistance)));
+			y = L::Add(y, L::Mul(warpY, L::Set(octaves.WarpDistance)));
+		}
+
+		F sum = L::Set(0.0f);
+		if(octaves.Type == Fractal::Fbm)
+		{
+			for(uint32 o = 0; o < octaves.Count; ++o)
+			{
+				F f = L::Set(octaves.Frequency[o]);
+				F n = SimplexLanes<L>(L::Mul(x, f), L::Mul(y, f), L::SetI(octaves.Seed[o]));
+				sum = L::Add(sum, L::Mul(n, L::Set(octaves.Amplitude[o])));
+			}
+			return L::Mul(sum, L::Set(octaves.Scale));
+		}
+
+		F weight = L::Set(1.0f);
+		for(uint32 o = 0; o < octaves.Count; ++o)
+		{
+			F f = L::Set(octaves.Frequency[o]);
+			F n = SimplexLanes<L>(L::Mul(x, f), L::Mul(y, f), L::SetI(octaves.Seed[o]));
+			F ridge = L::Sub(L::Set(1.0f), L::AndBits(n, L::SetI(0x7FFFFFFFu)));
+			ridge = L::Mul(ridge, ridge);
+			ridge = L::Mul(ridge, weight);
+			weight = L::Min(L::Mul(ridge, L::Set(2.0f)), L::Set(1.0f));
+			sum = L::Add(sum, L::Mul(ridge, L::Set(octaves.Amplitude[o])));
+		}
+		return L::Mul(L::Sub(L::Mul(sum, L::Set(octaves.Scale)), L::Set(1.0f)), L::Set(desc.Amplitude));
+	}
+
+	void Row(const Octaves& octaves, const Desc& desc, float x0, float dx, float y, uint32 count, float* dst)
+	{
+		uint32 i = 0;
+#if NOISE_AVX2 || NOISE_SSE2
+		using L = SimdLanes;
+		for(; i + L::Width <= count; i += L::Width)
+		{
+			L::F x = L::Add(L::Mul(L::ToFloat(L::Iota(i)), L::Set(dx)), L::Set(x0));
+			L::Store(dst + i, Evaluate<L>(octaves, desc, x, L::Set(y)));
+		}
+#endif
+		for(; i < count; ++i)
+			dst[i] = Evaluate<ScalarLanes>(octaves, desc, (float)i * dx + x0, y);
+	}
+}
+
+float Noise::Simplex(float x, float y, uint32 seed)
+{
+	return SimplexLanes<ScalarLanes>(x, y, seed);
+}
+
+float Noise::Sample(const Desc& desc, float x, float y)
+{
+	return Evaluate<ScalarLanes>(Unpack(desc), desc, x, y);
+}
+
+void Noise::SampleRow(const Desc& desc, float x0, float dx, float y, uint32 count, float* dst)
+{
+	Row(Unpack(desc), desc, x0, dx, y, count, dst);
+}
+
+void Noise::SampleGrid(const Desc& desc, float x0, float dx, uint32 columns, float y0, float dy, uint32 rows,
+	float* dst, ThreadPool& pool)
+{
+	Octaves octaves = Unpack(desc);
+	pool.ParallelFor(rows, 1, [&](uint32 begin, uint32 end)
+	{
+		for(uint32 r = begin; r < end; ++r)
+			Row(octaves, desc, x0, dx, (float)r * dy + y0, columns, dst + (std::size_t)r * columns);
+	});
+}
+
+uint32 Noise::GetBatchWidth()
+{
+#if NOISE_AVX2 || NOISE_SSE2
+	return SimdLanes::Width;
+#else
+	return 1;
+#endif
+}
@@ -0,0 +1,85 @@
+//***************************************************************************************
+// Noise.h
+//
+// Procedural 2D noise for height fields: simplex noise stacked into fBm or ridged
+// multifractal octaves, optionally domain-warped by two more simplex lookups.
+//
+// Sample evaluates one point.  SampleRow evaluates a row of evenly spaced points 8 at a
+// time with AVX2, 4 at a time with SSE2, or one at a time elsewhere; the lanes run the
+// very same float operations as Sample, in the same order, so every path gives the
+// same bits for a point, and SampleGrid, which shares rows out to a thread pool, gives
+// the same grid for any thread count.  (That needs the compiler not to fuse multiplies
+// and adds.  MSVC doesn't unless /fp:contract is given; GCC does whenever FMA is
+// enabled, so the CMake build compiles Noise.cpp with -ffp-contract=off.  Code that
+// checks SampleRow against Sample needs the same, or its x0 + i * dx may be fused.)
+//
+// The gradients come from an integer hash of the lattice point and the seed, so there
+// are no permutation tables to gather from.  Lattice coordinates must stay within
+// +-2^24 after scaling by the frequencies.
+//***************************************************************************************
+
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <cstdint>
+
+namespace Noise
+{
+	using uint32 = std::uint32_t;
+
+	enum class Fractal
+	{
+		Fbm,        // sum of octaves
+		Ridged      // sharp crests where each octave crosses zero, weighted by the one before
+	};
+
+	struct Desc
+	{
+		Fractal Type = Fractal::Fbm;
+		uint32 Seed = 0;
+		uint32 Octaves = 6;
+
+		// Of the first octave, in cycles per unit.
+		float Frequency = 0.01f;
+
+		// Frequency and amplitude factors from one octave to the next.
+		float Lacunarity = 2.0f;
+		float Gain = 0.5f;
+
+		// The result spans roughly [-Amplitude, Amplitude].
+		float Amplitude = 1.0f;
+
+		// Domain warp: each point is first moved by up to WarpDistance units along two
+		// simplex fields of WarpFrequency.  0 turns the warp off.
+		float WarpDistance = 0.0f;
+		float WarpFrequency = 0.005f;
+	};
+
+	///<summary>
+	/// Single-octave 2D simplex noise, in roughly [-1, 1].
+	///</summary>
+	float Simplex(float x, float y, uint32 seed);
+
+	///<summary>
+	/// The fractal described by desc at (x, y).
+	///</summary>
+	float Sample(const Desc& desc, float x, float y);
+
+	///<summary>
+	/// dst[i] = Sample(desc, x0 + i * dx, y) for i in [0, count), bit for bit.
+	///</summary>
+	void SampleRow(const Desc& desc, float x0, float dx, float y, uint32 count, float* dst);
+
+	///<summary>
+	/// A rows x columns grid, row r at y0 + r * dy, rows split across the pool:
+	/// dst[r * columns + c] = Sample(desc, x0 + c * dx, y0 + r * dy).
+	///</summary>
+	void SampleGrid(const Desc& desc, float x0, float dx, uint32 columns, float y0, float dy, uint32 rows,
+		float* dst, ThreadPool& pool);
+
+	///<summary>
+	/// Points SampleRow evaluates at once: 8, 4 or 1.
+	///</summary>
+	uint32 GetBatchWidth();
+}
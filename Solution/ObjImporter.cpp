@@ -0,0 +1,670 @@
+//***************************************************************************************
+// ObjImporter.cpp
+//***************************************************************************************
+
+#include "ObjImporter.h"
+#include "MappedFile.h"
+#include "TangentGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace DirectX;
+using namespace ObjImporter;
+
+namespace
+{
+	using int32 = std::int32_t;
+
+	// A face corner: 0-based position, texcoord and normal indices, or Absent.
+	struct Corner
+	{
+		int32 Position;
+		int32 TexC;
+		int32 Normal;
+	};
+
+	const int32 Absent = INT32_MIN;
+
+	bool operator==(const Corner& a, const Corner& b)
+	{
+		return a.Position == b.Position && a.TexC == b.TexC && a.Normal == b.Normal;
+	}
+
+	// What one tokenizer task makes of its stretch of the file.
+	struct Chunk
+	{
+		const char* Begin = nullptr;
+		const char* End = nullptr;
+
+		std::vector<XMFLOAT3> Positions;
+		std::vector<XMFLOAT2> TexCoords;
+		std::vector<XMFLOAT3> Normals;
+
+		// Three per triangle.  A negative index is relative to the chunk's own elements
+		// until the chunk's place in the file is known; RelativeSlots lists those, as
+		// 3 * corner + component.
+		std::vector<Corner> Corners;
+		std::vector<uint32> RelativeSlots;
+
+		uint32 Faces = 0;
+		uint32 MalformedLines = 0;
+
+		// Elements of each kind in the chunks before this one.
+		uint32 PositionBase = 0;
+		uint32 TexCoordBase = 0;
+		uint32 NormalBase = 0;
+		uint32 CornerBase = 0;
+	};
+
+	//
+	// Tokenizing.
+	//
+
+	bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	bool IsDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	const char* SkipSpaces(const char* p, const char* end)
+	{
+		while(p < end && IsSpace(*p))
+			++p;
+		return p;
+	}
+
+	// Exact powers of ten in double precision.
+	const double kPowersOf10[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	// Decimal float.  Up to 19 significant digits are gathered into an integer; when it
+	// is exact in a double and the exponent is within the exact powers of ten, one
+	// multiply or divide gives the correctly rounded value.  Anything else goes to
+	// strtod.
+	bool ParseFloat(const char*& p, const char* end, float& value)
+	{
+		p = SkipSpaces(p, end);
+		const char* start = p;
+
+		bool negative = false;
+		if(p < end && (*p == '-' || *p == '+'))
+			negative = *p++ == '-';
+
+		std::uint64_t mantissa = 0;
+		int digits = 0, exponent = 0;
+		bool any = false;
+
+		for(; p < end && IsDigit(*p); ++p)
+		{
+			any = true;
+			if(digits < 19)
+			{
+				mantissa = mantissa * 10 + (std::uint64_t)(*p - '0');
+				digits += mantissa != 0;
+			}
+			else
+			{
+				++exponent;
+			}
+		}
+		if(p < end && *p == '.')
+		{
+			for(++p; p < end && IsDigit(*p); ++p)
+			{
+				any = true;
+				if(digits < 19)
+				{
+					mantissa = mantissa * 10 + (std::uint64_t)(*p - '0');
+					digits += mantissa != 0;
+					--exponent;
+				}
+			}
+		}
+		if(!any)
+			return false;
+
+		if(p < end && (*p == 'e' || *p == 'E'))
+		{
+			const char* q = p + 1;
+			bool negativeExponent = false;
+			if(q < end && (*q == '-' || *q == '+'))
+				negativeExponent = *q++ == '-';
+			if(q == end || !IsDigit(*q))
+				return false;
+
+			int e = 0;
+			for(; q < end && IsDigit(*q); ++q)
+				e = std::min(e * 10 + (*q - '0'), 100000);
+			exponent += negativeExponent ? -e : e;
+			p = q;
+		}
+
+		if(p < end && !IsSpace(*p))
+			return false;
+
+		double result;
+		if(mantissa == 0)
+		{
+			result = 0.0;
+		}
+		else if(mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22)
+		{
+			result = (double)mantissa;
+			result = exponent < 0 ? result / kPowersOf10[-exponent] : result * kPowersOf10[exponent];
+		}
+		else
+		{
+			std::string token(start, p);
+			result = std::strtod(token.c_str(), nullptr);
+			negative = false;
+		}
+
+		value = (float)(negative ? -result : result);
+		return true;
+	}
+
+	// An OBJ index: non-zero, negative for relative.
+	bool ParseIndex(const char*& p, const char* end, std::int64_t& index)
+	{
+		bool negative = false;
+		if(p < end && *p == '-')
+		{
+			negative = true;
+			++p;
+		}
+		if(p == end || !IsDigit(*p))
+			return false;
+
+		std::int64_t value = 0;
+		for(; p < end && IsDigit(*p); ++p)
+		{
+			value = value * 10 + (*p - '0');
+			if(value > INT32_MAX)
+				return false;
+		}
+
+		index = negative ? -value : value;
+		return value != 0;
+	}
+
+	// Turns an OBJ index into a 0-based one.  A relative index is resolved against the
+	// count parsed so far in this chunk; the chunk's base is added later.
+	int32 ToCorner(std::int64_t index, uint32 count, bool& relative)
+	{
+		relative = index < 0;
+		return (int32)(relative ? (std::int64_t)count + index : index - 1);
+	}
+
+	bool ParseFace(const char* p, const char* end, Chunk& chunk, std::vector<Corner>& corners, std::vector<std::uint8_t>& relative,
+		bool reverseWinding)
+	{
+		corners.clear();
+		relative.clear();
+
+		for(p = SkipSpaces(p, end); p < end; p = SkipSpaces(p, end))
+		{
+			Corner corner = { Absent, Absent, Absent };
+			std::uint8_t flags = 0;
+			bool isRelative;
+			std::int64_t index;
+
+			if(!ParseIndex(p, end, index))
+				return false;
+			corner.Position = ToCorner(index, (uint32)chunk.Positions.size(), isRelative);
+			flags |= isRelative ? 1 : 0;
+
+			if(p < end && *p == '/')
+			{
+				++p;
+				if(p < end && *p != '/')
+				{
+					if(!ParseIndex(p, end, index))
+						return false;
+					corner.TexC = ToCorner(index, (uint32)chunk.TexCoords.size(), isRelative);
+					flags |= isRelative ? 2 : 0;
+				}
+				if(p < end && *p == '/')
+				{
+					++p;
+					if(!ParseIndex(p, end, index))
+						return false;
+					corner.Normal = ToCorner(index, (uint32)chunk.Normals.size(), isRelative);
+					flags |= isRelative ? 4 : 0;
+				}
+			}
+			if(p < end && !IsSpace(*p))
+				return false;
+
+			corners.push_back(corner);
+			relative.push_back(flags);
+		}
+
+		if(corners.size() < 3)
+			return false;
+
+		// Fan the polygon out from its first corner.  Mirroring z turns counter-clockwise
+		// into clockwise only if the corners are taken the other way round too.
+		for(std::size_t k = 2; k < corners.size(); ++k)
+		{
+			const std::size_t fan[3] = { 0, reverseWinding ? k : k - 1, reverseWinding ? k - 1 : k };
+			for(std::size_t c : fan)
+			{
+				uint32 slot = 3 * (uint32)chunk.Corners.size();
+				for(uint32 component = 0; component < 3; ++component)
+				{
+					if(relative[c] & (1 << component))
+						chunk.RelativeSlots.push_back(slot + component);
+				}
+				chunk.Corners.push_back(corners[c]);
+			}
+		}
+		++chunk.Faces;
+		return true;
+	}
+
+	void TokenizeChunk(Chunk& chunk, bool reverseWinding)
+	{
+		std::vector<Corner> corners;
+		std::vector<std::uint8_t> relative;
+
+		const char* p = chunk.Begin;
+		while(p < chunk.End)
+		{
+			const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', (std::size_t)(chunk.End - p)));
+			if(lineEnd == nullptr)
+				lineEnd = chunk.End;
+
+			p = SkipSpaces(p, lineEnd);
+			std::ptrdiff_t length = lineEnd - p;
+			bool ok = true;
+
+			if(length >= 2 && p[0] == 'v' && IsSpace(p[1]))
+			{
+				XMFLOAT3 v;
+				p += 2;
+				ok = ParseFloat(p, lineEnd, v.x) && ParseFloat(p, lineEnd, v.y) && ParseFloat(p, lineEnd, v.z);
+				if(ok)
+					chunk.Positions.push_back(v);
+			}
+			else if(length >= 3 && p[0] == 'v' && p[1] == 't' && IsSpace(p[2]))
+			{
+				// The second and third coordinates are optional.
+				XMFLOAT2 t(0.0f, 0.0f);
+				p += 3;
+				ok = ParseFloat(p, lineEnd, t.x);
+				if(ok && SkipSpaces(p, lineEnd) < lineEnd)
+					ok = ParseFloat(p, lineEnd, t.y);
+				if(ok)
+					chunk.TexCoords.push_back(t);
+			}
+			else if(length >= 3 && p[0] == 'v' && p[1] == 'n' && IsSpace(p[2]))
+			{
+				XMFLOAT3 n;
+				p += 3;
+				ok = ParseFloat(p, lineEnd, n.x) && ParseFloat(p, lineEnd, n.y) && ParseFloat(p, lineEnd, n.z);
+				if(ok)
+					chunk.Normals.push_back(n);
+			}
+			else if(length >= 2 && p[0] == 'f' && IsSpace(p[1]))
+			{
+				ok = ParseFace(p + 2, lineEnd, chunk, corners, relative, reverseWinding);
+			}
+
+			if(!ok)
+				++chunk.MalformedLines;
+
+			p = lineEnd + 1;
+		}
+	}
+
+	//
+	// Welding.
+	//
+
+	uint32 HashCorner(const Corner& c)
+	{
+		std::uint64_t h = (std::uint64_t)(std::uint32_t)c.Position * 0x9E3779B97F4A7C15ull;
+		h ^= (std::uint64_t)(std::uint32_t)c.TexC * 0xC2B2AE3D27D4EB4Full;
+		h ^= (std::uint64_t)(std::uint32_t)c.Normal * 0x165667B19E3779F9ull;
+		h ^= h >> 29;
+		return (uint32)(h ^ (h >> 32));
+	}
+
+	// Open-addressing table of first occurrences for the corners of one shard.
+	class WeldTable
+	{
+	public:
+		explicit WeldTable(uint32 expected)
+		{
+			uint32 capacity = 64;
+			while(capacity < 2 * expected)
+				capacity *= 2;
+			mSlots.assign(capacity, Empty);
+		}
+
+		// The first corner equal to corners[c], which is c itself if it is new.
+		uint32 Insert(const std::vector<Corner>& corners, uint32 c, uint32 hash)
+		{
+			if(2 * (mCount + 1) > mSlots.size())
+				Grow(corners);
+
+			uint32 mask = (uint32)mSlots.size() - 1;
+			for(uint32 slot = hash & mask; ; slot = (slot + 1) & mask)
+			{
+				uint32 entry = mSlots[slot];
+				if(entry == Empty)
+				{
+					mSlots[slot] = c;
+					++mCount;
+					return c;
+				}
+				if(corners[entry] == corners[c])
+					return entry;
+			}
+		}
+
+	private:
+		static constexpr uint32 Empty = ~0u;
+
+		void Grow(const std::vector<Corner>& corners)
+		{
+			std::vector<uint32> old(mSlots.size() * 2, Empty);
+			old.swap(mSlots);
+
+			uint32 mask = (uint32)mSlots.size() - 1;
+			for(uint32 entry : old)
+			{
+				if(entry == Empty)
+					continue;
+
+				uint32 slot = HashCorner(corners[entry]) & mask;
+				while(mSlots[slot] != Empty)
+					slot = (slot + 1) & mask;
+				mSlots[slot] = entry;
+			}
+		}
+
+		std::vector<uint32> mSlots;
+		uint32 mCount = 0;
+	};
+
+	bool InRange(int32 index, uint32 count, bool optional)
+	{
+		return index == Absent ? optional : index >= 0 && (uint32)index < count;
+	}
+
+	// Area-weighted normals for the vertices flagged in missing; the others keep the
+	// normal the file gave them.
+	void ComputeNormals(GeometryGenerator::MeshData& mesh, const std::vector<std::uint8_t>& missing)
+	{
+		for(std::size_t i = 0; i < mesh.Vertices.size(); ++i)
+		{
+			if(missing[i])
+				mesh.Vertices[i].Normal = XMFLOAT3(0.0f, 0.0f, 0.0f);
+		}
+
+		// Unnormalized cross products weight each face by its area.
+		for(std::size_t i = 0; i + 2 < mesh.Indices32.size(); i += 3)
+		{
+			const uint32 corners[3] = { mesh.Indices32[i + 0], mesh.Indices32[i + 1], mesh.Indices32[i + 2] };
+			if(!missing[corners[0]] && !missing[corners[1]] && !missing[corners[2]])
+				continue;
+
+			XMVECTOR p0 = XMLoadFloat3(&mesh.Vertices[corners[0]].Position);
+			XMVECTOR faceNormal = XMVector3Cross(XMLoadFloat3(&mesh.Vertices[corners[1]].Position) - p0,
+				XMLoadFloat3(&mesh.Vertices[corners[2]].Position) - p0);
+
+			for(uint32 vertex : corners)
+			{
+				XMFLOAT3& n = mesh.Vertices[vertex].Normal;
+				if(missing[vertex])
+					XMStoreFloat3(&n, XMLoadFloat3(&n) + faceNormal);
+			}
+		}
+
+		for(std::size_t i = 0; i < mesh.Vertices.size(); ++i)
+		{
+			XMFLOAT3& n = mesh.Vertices[i].Normal;
+			if(missing[i])
+				XMStoreFloat3(&n, XMVector3Normalize(XMLoadFloat3(&n)));
+		}
+	}
+}
+
+bool ObjImporter::Load(const char* path, GeometryGenerator::MeshData& mesh, ThreadPool& pool, const Options& options, Stats* stats)
+{
+	MappedFile file;
+	if(!file.Open(path))
+	{
+		mesh = GeometryGenerator::MeshData();
+		return false;
+	}
+
+	return Parse(reinterpret_cast<const char*>(file.GetData()), (std::size_t)file.GetSize(), mesh, pool, options, stats);
+}
+
+bool ObjImporter::Parse(const char* text, std::size_t size, GeometryGenerator::MeshData& mesh, ThreadPool& pool,
+	const Options& options, Stats* stats)
+{
+	mesh = GeometryGenerator::MeshData();
+
+	// Cut the text into chunks that end just after a newline.
+	std::vector<Chunk> chunks;
+	const char* end = text + size;
+	std::size_t chunkSize = std::max<std::size_t>(options.ChunkSize, 1);
+	for(const char* begin = text; begin < end; )
+	{
+		const char* stop = (std::size_t)(end - begin) > chunkSize ? begin + chunkSize : end;
+		if(stop < end)
+		{
+			const char* newline = static_cast<const char*>(std::memchr(stop, '\n', (std::size_t)(end - stop)));
+			stop = newline != nullptr ? newline + 1 : end;
+		}
+
+		chunks.emplace_back();
+		chunks.back().Begin = begin;
+		chunks.back().End = stop;
+		begin = stop;
+	}
+
+	uint32 chunkCount = (uint32)chunks.size();
+	bool reverseWinding = options.ConvertToLeftHanded;
+	pool.ParallelFor(chunkCount, 1, [&chunks, reverseWinding](uint32 begin, uint32 end)
+	{
+		for(uint32 c = begin; c < end; ++c)
+			TokenizeChunk(chunks[c], reverseWinding);
+	});
+
+	// Place the chunks in the file.
+	std::uint64_t positionCount = 0, texCoordCount = 0, normalCount = 0, cornerCount = 0;
+	uint32 faces = 0, malformed = 0;
+	for(Chunk& chunk : chunks)
+	{
+		chunk.PositionBase = (uint32)positionCount;
+		chunk.TexCoordBase = (uint32)texCoordCount;
+		chunk.NormalBase = (uint32)normalCount;
+		chunk.CornerBase = (uint32)cornerCount;
+		positionCount += chunk.Positions.size();
+		texCoordCount += chunk.TexCoords.size();
+		normalCount += chunk.Normals.size();
+		cornerCount += chunk.Corners.size();
+		faces += chunk.Faces;
+		malformed += chunk.MalformedLines;
+	}
+	if(positionCount > INT32_MAX || texCoordCount > INT32_MAX || normalCount > INT32_MAX || cornerCount > UINT32_MAX / 3)
+		return false;
+
+	// Resolve relative indices, check every index and join the lists.
+	std::vector<XMFLOAT3> positions((std::size_t)positionCount);
+	std::vector<XMFLOAT2> texCoords((std::size_t)texCoordCount);
+	std::vector<XMFLOAT3> normals((std::size_t)normalCount);
+	std::vector<Corner> corners((std::size_t)cornerCount);
+	std::atomic<bool> valid{ true };
+
+	pool.ParallelFor(chunkCount, 1, [&](uint32 begin, uint32 end)
+	{
+		for(uint32 c = begin; c < end; ++c)
+		{
+			Chunk& chunk = chunks[c];
+			const uint32 bases[3] = { chunk.PositionBase, chunk.TexCoordBase, chunk.NormalBase };
+			for(uint32 slot : chunk.RelativeSlots)
+			{
+				Corner& corner = chunk.Corners[slot / 3];
+				int32& index = slot % 3 == 0 ? corner.Position : slot % 3 == 1 ? corner.TexC : corner.Normal;
+				index += (int32)bases[slot % 3];
+			}
+
+			bool ok = true;
+			for(const Corner& corner : chunk.Corners)
+			{
+				ok = ok && InRange(corner.Position, (uint32)positionCount, false) &&
+					InRange(corner.TexC, (uint32)texCoordCount, true) &&
+					InRange(corner.Normal, (uint32)normalCount, true);
+			}
+			if(!ok)
+				valid = false;
+
+			std::copy(chunk.Positions.begin(), chunk.Positions.end(), positions.begin() + chunk.PositionBase);
+			std::copy(chunk.TexCoords.begin(), chunk.TexCoords.end(), texCoords.begin() + chunk.TexCoordBase);
+			std::copy(chunk.Normals.begin(), chunk.Normals.end(), normals.begin() + chunk.NormalBase);
+			std::copy(chunk.Corners.begin(), chunk.Corners.end(), corners.begin() + chunk.CornerBase);
+
+			chunk = Chunk();
+		}
+	});
+	if(!valid)
+		return false;
+
+	// Weld: each shard of the hash space finds the first occurrence of its corners.
+	uint32 count = (uint32)cornerCount;
+	std::vector<uint32> hashes(count);
+	pool.ParallelFor(count, 16384, [&](uint32 begin, uint32 end)
+	{
+		for(uint32 c = begin; c < end; ++c)
+			hashes[c] = HashCorner(corners[c]);
+	});
+
+	uint32 shardBits = 0;
+	while((1u << shardBits) < pool.GetThreadCount())
+		++shardBits;
+	uint32 shardCount = 1u << shardBits;
+
+	std::vector<uint32> firsts(count);
+	pool.ParallelFor(shardCount, 1, [&](uint32 begin, uint32 end)
+	{
+		for(uint32 shard = begin; shard < end; ++shard)
+		{
+			// The low bits pick the table slot, so the shard comes from the high ones.
+			// Most vertices are shared by several corners, so start the table small.
+			WeldTable table(count / shardCount / 4);
+			for(uint32 c = 0; c < count; ++c)
+			{
+				if(shardBits == 0 || hashes[c] >> (32 - shardBits) == shard)
+					firsts[c] = table.Insert(corners, c, hashes[c]);
+			}
+		}
+	});
+
+	// Number the first occurrences in order: count them per block, then a running sum.
+	const uint32 blockSize = 65536;
+	uint32 blockCount = (count + blockSize - 1) / blockSize;
+	std::vector<uint32> blockVertices(blockCount);
+	pool.ParallelFor(blockCount, 1, [&](uint32 begin, uint32 end)
+	{
+		for(uint32 b = begin; b < end; ++b)
+		{
+			uint32 n = 0;
+			for(uint32 c = b * blockSize; c < std::min(count, (b + 1) * blockSize); ++c)
+				n += firsts[c] == c;
+			blockVertices[b] = n;
+		}
+	});
+
+	uint32 vertexCount = 0;
+	for(uint32& n : blockVertices)
+	{
+		uint32 blockStart = vertexCount;
+		vertexCount += n;
+		n = blockStart;
+	}
+
+	// The index of a first occurrence is final once its block is numbered; the others
+	// look theirs up afterwards.
+	mesh.Vertices.resize(vertexCount);
+	mesh.Indices32.resize(count);
+	std::vector<std::uint8_t> missingNormals(vertexCount);
+	float zSign = options.ConvertToLeftHanded ? -1.0f : 1.0f;
+	pool.ParallelFor(blockCount, 1, [&](uint32 begin, uint32 end)
+	{
+		for(uint32 b = begin; b < end; ++b)
+		{
+			uint32 vertex = blockVertices[b];
+			for(uint32 c = b * blockSize; c < std::min(count, (b + 1) * blockSize); ++c)
+			{
+				if(firsts[c] != c)
+					continue;
+
+				const Corner& corner = corners[c];
+				GeometryGenerator::Vertex& v = mesh.Vertices[vertex];
+
+				XMFLOAT3 p = positions[corner.Position];
+				v.Position = XMFLOAT3(p.x, p.y, p.z * zSign);
+
+				XMFLOAT3 n = corner.Normal != Absent ? normals[corner.Normal] : XMFLOAT3(0.0f, 0.0f, 0.0f);
+				v.Normal = XMFLOAT3(n.x, n.y, n.z * zSign);
+				missingNormals[vertex] = corner.Normal == Absent;
+
+				XMFLOAT2 t = corner.TexC != Absent ? texCoords[corner.TexC] : XMFLOAT2(0.0f, 0.0f);
+				v.TexC = XMFLOAT2(t.x, options.ConvertToLeftHanded ? 1.0f - t.y : t.y);
+
+				v.TangentU = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+				mesh.Indices32[c] = vertex++;
+			}
+		}
+	});
+
+	pool.ParallelFor(count, 16384, [&](uint32 begin, uint32 end)
+	{
+		for(uint32 c = begin; c < end; ++c)
+		{
+			if(firsts[c] != c)
+				mesh.Indices32[c] = mesh.Indices32[firsts[c]];
+		}
+	});
+
+	// Vertices are welded by their normal index too, so a vertex from a face without
+	// normals never shares one from a face with them, even in a file that mixes both.
+	if(options.ComputeMissingNormals && std::find(missingNormals.begin(), missingNormals.end(), 1) != missingNormals.end())
+		ComputeNormals(mesh, missingNormals);
+	if(texCoordCount != 0 && options.ComputeTangents)
+		TangentGenerator::Generate(mesh, pool);
+
+	if(stats != nullptr)
+	{
+		stats->FileBytes = size;
+		stats->Positions = (uint32)positionCount;
+		stats->TexCoords = (uint32)texCoordCount;
+		stats->Normals = (uint32)normalCount;
+		stats->Faces = faces;
+		stats->Triangles = count / 3;
+		stats->Vertices = vertexCount;
+		stats->MalformedLines = malformed;
+		stats->Chunks = chunkCount;
+	}
+	return true;
+}
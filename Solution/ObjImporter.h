@@ -0,0 +1,78 @@
+//***************************************************************************************
+// ObjImporter.h
+//
+// Loads Wavefront OBJ meshes into a GeometryGenerator::MeshData, so artist meshes can
+// go through the same packers and buffers as the generated shapes.
+//
+// The file is mapped and cut into chunks at line boundaries, and the chunks are
+// tokenized on the thread pool, each into its own position, texture coordinate,
+// normal and triangle lists; numbers are read by a hand-written parser rather than
+// strtod.  The lists are then joined and every distinct position/texcoord/normal
+// triplet the faces use becomes one vertex, welded through hash tables that are
+// sharded across the pool.  Vertices come out in the order the faces first use them,
+// so the result does not depend on the thread count.
+//
+// Supported: v, vt, vn and f records with positive or negative (relative) indices in
+// any of the v, v/vt, v//vn and v/vt/vn forms; polygons are fanned into triangles.
+// Groups, objects, materials, smoothing groups and other records are ignored, and
+// v, vt, vn or f records that don't parse are skipped and counted.  TangentU comes
+// from TangentGenerator when the file has texture coordinates and is zero otherwise.
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+#include "ThreadPool.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ObjImporter
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	struct Options
+	{
+		// OBJ is right-handed with counter-clockwise front faces.  Negating z, flipping v
+		// and reversing each triangle give the left-handed, clockwise convention of the
+		// apps.
+		bool ConvertToLeftHanded = true;
+
+		// Area-weighted normals for the vertices of faces that give none, whether or
+		// not other faces in the file have vn records.
+		bool ComputeMissingNormals = true;
+
+		// Tangents from the texture coordinates; OBJ has no record for them.
+		bool ComputeTangents = true;
+
+		// Bytes of text per tokenizer task.
+		uint32 ChunkSize = 1 << 20;
+	};
+
+	struct Stats
+	{
+		uint64 FileBytes = 0;
+		uint32 Positions = 0;
+		uint32 TexCoords = 0;
+		uint32 Normals = 0;
+		uint32 Faces = 0;
+		uint32 Triangles = 0;
+		uint32 Vertices = 0;         // after welding
+		uint32 MalformedLines = 0;
+		uint32 Chunks = 0;
+	};
+
+	///<summary>
+	/// Maps and parses an OBJ file.  Returns false if the file can't be opened or a face
+	/// refers to an element that doesn't exist; mesh is left empty then.
+	///</summary>
+	bool Load(const char* path, GeometryGenerator::MeshData& mesh, ThreadPool& pool,
+		const Options& options = Options(), Stats* stats = nullptr);
+
+	///<summary>
+	/// Parses OBJ text already in memory.
+	///</summary>
+	bool Parse(const char* text, std::size_t size, GeometryGenerator::MeshData& mesh, ThreadPool& pool,
+		const Options& options = Options(), Stats* stats = nullptr);
+}
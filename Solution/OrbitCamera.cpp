@@ -0,0 +1,147 @@
+//***************************************************************************************
+// OrbitCamera.cpp
+//***************************************************************************************
+
+#include "OrbitCamera.h"
+
+#include <cmath>
+
+using namespace DirectX;
+
+OrbitCamera::OrbitCamera()
+{
+	Update();
+}
+
+void OrbitCamera::SetOrbit(float theta, float phi, float radius)
+{
+	if(theta == mTheta && phi == mPhi && radius == mRadius)
+		return;
+
+	mTheta = theta;
+	mPhi = phi;
+	mRadius = radius;
+	mViewDirty = true;
+}
+
+void OrbitCamera::SetTarget(const XMFLOAT3& target)
+{
+	if(target.x == mTarget.x && target.y == mTarget.y && target.z == mTarget.z)
+		return;
+
+	mTarget = target;
+	mViewDirty = true;
+}
+
+void OrbitCamera::SetLens(float fovY, float aspect, float zn, float zf)
+{
+	if(fovY == mFovY && aspect == mAspect && zn == mNearZ && zf == mFarZ)
+		return;
+
+	mFovY = fovY;
+	mAspect = aspect;
+	mNearZ = zn;
+	mFarZ = zf;
+	mProjDirty = true;
+}
+
+bool OrbitCamera::Update()
+{
+	if(!mViewDirty && !mProjDirty)
+		return false;
+
+	if(mViewDirty)
+		UpdateView();
+	if(mProjDirty)
+		UpdateProj();
+
+	XMMATRIX view = XMLoadFloat4x4(&mView);
+	XMMATRIX proj = XMLoadFloat4x4(&mProj);
+	XMMATRIX invView = XMLoadFloat4x4(&mInvView);
+	XMMATRIX invProj = XMLoadFloat4x4(&mInvProj);
+
+	XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+	XMStoreFloat4x4(&mViewProj, viewProj);
+	XMStoreFloat4x4(&mInvViewProj, XMMatrixMultiply(invProj, invView));
+
+	// Gribb/Hartmann: with row vectors, clip = p * M, so the planes come from the
+	// columns of the view-projection matrix.  D3D clip space has 0 <= z <= w.
+	XMMATRIX columns = XMMatrixTranspose(viewProj);
+	XMVECTOR planes[PlaneCount] =
+	{
+		XMVectorAdd(columns.r[3], columns.r[0]),
+		XMVectorSubtract(columns.r[3], columns.r[0]),
+		XMVectorAdd(columns.r[3], columns.r[1]),
+		XMVectorSubtract(columns.r[3], columns.r[1]),
+		columns.r[2],
+		XMVectorSubtract(columns.r[3], columns.r[2]),
+	};
+	for(int i = 0; i < PlaneCount; ++i)
+		XMStoreFloat4(&mFrustumPlanes[i], XMPlaneNormalize(planes[i]));
+
+	mViewDirty = false;
+	mProjDirty = false;
+	++mVersion;
+
+	return true;
+}
+
+void OrbitCamera::UpdateView()
+{
+	// Convert Spherical to Cartesian coordinates.  The offset from the target is
+	// already unit length before the radius is applied, so it is minus the look axis.
+	float sinPhi = std::sin(mPhi);
+	XMVECTOR offset = XMVectorSet(sinPhi * std::cos(mTheta), std::cos(mPhi), sinPhi * std::sin(mTheta), 0.0f);
+	XMVECTOR target = XMLoadFloat3(&mTarget);
+	XMVECTOR pos = XMVectorMultiplyAdd(XMVectorReplicate(mRadius), offset, target);
+	XMStoreFloat3(&mPosition, pos);
+
+	// Same basis as XMMatrixLookAtLH with a +y up vector.
+	XMVECTOR look = XMVectorNegate(offset);
+	XMVECTOR right = XMVector3Normalize(XMVector3Cross(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), look));
+	XMVECTOR up = XMVector3Cross(look, right);
+
+	// The view matrix is rigid: its inverse is the transposed rotation followed by
+	// the eye position, and the view translation is -dot(eye, axis).
+	XMMATRIX rotation;
+	rotation.r[0] = XMVectorSelect(g_XMZero, right, g_XMSelect1110);
+	rotation.r[1] = XMVectorSelect(g_XMZero, up, g_XMSelect1110);
+	rotation.r[2] = XMVectorSelect(g_XMZero, look, g_XMSelect1110);
+	rotation.r[3] = g_XMIdentityR3;
+
+	XMVECTOR negPos = XMVectorNegate(pos);
+	XMMATRIX view = XMMatrixTranspose(rotation);
+	view.r[3] = XMVectorSet(
+		XMVectorGetX(XMVector3Dot(right, negPos)),
+		XMVectorGetX(XMVector3Dot(up, negPos)),
+		XMVectorGetX(XMVector3Dot(look, negPos)),
+		1.0f);
+
+	XMMATRIX invView = rotation;
+	invView.r[3] = XMVectorSetW(pos, 1.0f);
+
+	XMStoreFloat4x4(&mView, view);
+	XMStoreFloat4x4(&mInvView, invView);
+}
+
+void OrbitCamera::UpdateProj()
+{
+	XMMATRIX proj = XMMatrixPerspectiveFovLH(mFovY, mAspect, mNearZ, mFarZ);
+	XMStoreFloat4x4(&mProj, proj);
+
+	// The projection only has four interesting terms:
+	//   [ a 0 0 0 ]                  [ 1/a   0    0     0  ]
+	//   [ 0 b 0 0 ]  whose inverse   [  0   1/b   0     0  ]
+	//   [ 0 0 c 1 ]  is              [  0    0    0    1/d ]
+	//   [ 0 0 d 0 ]                  [  0    0    1   -c/d ]
+	float a = mProj._11;
+	float b = mProj._22;
+	float c = mProj._33;
+	float d = mProj._43;
+
+	mInvProj = XMFLOAT4X4(
+		1.0f / a, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f / b, 0.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f / d,
+		0.0f, 0.0f, 1.0f, -c / d);
+}
@@ -0,0 +1,102 @@
+//***************************************************************************************
+// OrbitCamera.h
+//
+// Camera that orbits a target point, given in spherical coordinates like the Week4
+// demos.  The view, projection, their product, the three inverses and the world-space
+// frustum planes are cached and only recomputed by Update() after an input changed.
+// The inverses are built in closed form from the rigid view basis and the perspective
+// lens parameters instead of with general 4x4 inverses.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <DirectXMath.h>
+
+class OrbitCamera
+{
+public:
+
+	using uint32 = std::uint32_t;
+
+	// Frustum plane order returned by GetFrustumPlanes().
+	enum FrustumPlane { PlaneLeft = 0, PlaneRight, PlaneBottom, PlaneTop, PlaneNear, PlaneFar, PlaneCount };
+
+	OrbitCamera();
+
+	///<summary>
+	/// Places the eye at radius from the target, theta around the y-axis and phi down
+	/// from it.  Setting the same values again does not invalidate anything.
+	///</summary>
+	void SetOrbit(float theta, float phi, float radius);
+	void SetTarget(const DirectX::XMFLOAT3& target);
+
+	///<summary>
+	/// Left-handed perspective projection, as XMMatrixPerspectiveFovLH.
+	///</summary>
+	void SetLens(float fovY, float aspect, float zn, float zf);
+
+	///<summary>
+	/// Recomputes whatever derived data is out of date.  Returns true if anything
+	/// changed, in which case GetVersion() has also advanced.
+	///</summary>
+	bool Update();
+
+	///<summary>
+	/// Bumped by every Update() that changes the cached data.  Callers that build
+	/// their own data from the camera (pass constants, culling results) can store the
+	/// version and skip the work while it stays the same.
+	///</summary>
+	uint32 GetVersion()const { return mVersion; }
+
+	float GetTheta()const { return mTheta; }
+	float GetPhi()const { return mPhi; }
+	float GetRadius()const { return mRadius; }
+	float GetNearZ()const { return mNearZ; }
+	float GetFarZ()const { return mFarZ; }
+
+	const DirectX::XMFLOAT3& GetPosition()const { return mPosition; }
+	const DirectX::XMFLOAT4X4& GetView()const { return mView; }
+	const DirectX::XMFLOAT4X4& GetInvView()const { return mInvView; }
+	const DirectX::XMFLOAT4X4& GetProj()const { return mProj; }
+	const DirectX::XMFLOAT4X4& GetInvProj()const { return mInvProj; }
+	const DirectX::XMFLOAT4X4& GetViewProj()const { return mViewProj; }
+	const DirectX::XMFLOAT4X4& GetInvViewProj()const { return mInvViewProj; }
+
+	///<summary>
+	/// World-space planes (a, b, c, d), normalized so ax + by + cz + d is the signed
+	/// distance to the plane, positive on the inside.
+	///</summary>
+	const DirectX::XMFLOAT4* GetFrustumPlanes()const { return mFrustumPlanes; }
+
+private:
+	void UpdateView();
+	void UpdateProj();
+
+private:
+
+	// Inputs.
+	DirectX::XMFLOAT3 mTarget = { 0.0f, 0.0f, 0.0f };
+	float mTheta = 1.5f * DirectX::XM_PI;
+	float mPhi = 0.2f * DirectX::XM_PI;
+	float mRadius = 15.0f;
+
+	float mFovY = 0.25f * DirectX::XM_PI;
+	float mAspect = 1.0f;
+	float mNearZ = 1.0f;
+	float mFarZ = 1000.0f;
+
+	bool mViewDirty = true;
+	bool mProjDirty = true;
+	uint32 mVersion = 0;
+
+	// Derived data.
+	DirectX::XMFLOAT3 mPosition = { 0.0f, 0.0f, 0.0f };
+	DirectX::XMFLOAT4X4 mView;
+	DirectX::XMFLOAT4X4 mInvView;
+	DirectX::XMFLOAT4X4 mProj;
+	DirectX::XMFLOAT4X4 mInvProj;
+	DirectX::XMFLOAT4X4 mViewProj;
+	DirectX::XMFLOAT4X4 mInvViewProj;
+	DirectX::XMFLOAT4 mFrustumPlanes[PlaneCount];
+};
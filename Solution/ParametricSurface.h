@@ -0,0 +1,794 @@
+//***************************************************************************************
+// ParametricSurface.h
+//
+// One tessellator for every shape that is a map of the unit square: a surface functor
+// gives the position and the partial derivatives dP/du and dP/dv, and the tessellator
+// samples it on a (uSegments + 1) x (vSegments + 1) grid and derives the rest: the
+// normal dP/du x dP/dv, the tangent dP/du and the texture coordinates (u, v).  Output
+// goes through a ShapeWriter vertex writer, so a position-and-color writer compiles the
+// normal and tangent work out, and the functor is a template argument, so each surface
+// gets its own inlined loop.
+//
+// Each row evaluates four values of u at once in DirectXMath vectors (structure of
+// arrays: one vector per coordinate), and rows are shared out to a ThreadPool when one
+// is given.  Every vertex and index is written to its own slot, so the output does not
+// depend on the thread count.
+//
+// A surface functor provides:
+//     static constexpr bool HasNormal = ...;  // Evaluate fills Patch::Normal itself
+//     uint32 GetPinch() const;                // Pinch bits: rows that collapse to a point
+//     struct Row;                             // whatever depends on v alone
+//     Row GetRow(float v) const;
+//     void Evaluate(const Row& row, DirectX::FXMVECTOR u, Patch& patch) const;
+//
+// u runs around the shape and v from top to bottom, oriented so that dP/du x dP/dv
+// points outwards; the triangles then face outwards like GeometryGenerator's.  A pinched
+// row (a pole or an apex) has its normal and tangent taken just inside the row, where
+// they are defined, and the degenerate half of each quad next to it is left out.
+//
+// Sphere, Cylinder (and cone), Disk, Torus, Superellipsoid and Supertoroid are provided;
+// AppendCylinder and AppendCone close the side with disks like ShapeWriter's versions.
+// Update and its cylinder and cone versions rewrite an appended surface's vertices in
+// place for new parameters, like ShapeWriter::Update*.
+//***************************************************************************************
+
+#pragma once
+
+#include "ShapeWriter.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <DirectXMath.h>
+#include <vector>
+
+namespace ParametricSurface
+{
+	using uint32 = std::uint32_t;
+	using GeneratedVertex = GeometryGenerator::Vertex;
+
+	enum Pinch : uint32
+	{
+		PinchVMin = 1,      // the v = 0 row is a single point
+		PinchVMax = 2       // the v = 1 row is a single point
+	};
+
+	// Four points of a surface: x, y and z of each vector in a register of its own.
+	struct Patch
+	{
+		DirectX::XMVECTOR Position[3];
+		DirectX::XMVECTOR Du[3];
+		DirectX::XMVECTOR Dv[3];
+		DirectX::XMVECTOR Normal[3];    // only read if the surface HasNormal
+	};
+
+	namespace Detail
+	{
+		// Fraction of a row the normal and tangent of a pinched row are taken inside it.
+		const float PinchOffset = 1e-3f;
+
+		// Derivatives of |x|^e stay finite for e < 1 by keeping |x| off zero.
+		const float MinPowBase = 1e-6f;
+
+		// sgn(x) |x|^e, the superquadric power.
+		inline float SignedPow(float x, float e)
+		{
+			float magnitude = std::pow(std::fabs(x), e);
+			return x < 0.0f ? -magnitude : magnitude;
+		}
+
+		inline DirectX::XMVECTOR SignedPow(DirectX::FXMVECTOR x, float e)
+		{
+			using namespace DirectX;
+			XMVECTOR magnitude = XMVectorPow(XMVectorAbs(x), XMVectorReplicate(e));
+			return XMVectorSelect(magnitude, XMVectorNegate(magnitude), XMVectorLess(x, XMVectorZero()));
+		}
+
+		// d/dx sgn(x) |x|^e = e |x|^(e - 1).
+		inline float SignedPowSlope(float x, float e)
+		{
+			return e * std::pow(std::max(std::fabs(x), MinPowBase), e - 1.0f);
+		}
+
+		inline DirectX::XMVECTOR SignedPowSlope(DirectX::FXMVECTOR x, float e)
+		{
+			using namespace DirectX;
+			XMVECTOR base = XMVectorMax(XMVectorAbs(x), XMVectorReplicate(MinPowBase));
+			return XMVectorScale(XMVectorPow(base, XMVectorReplicate(e - 1.0f)), e);
+		}
+
+		// The normal's sgn(x) |x|^(2 - e), kept finite past e = 2 by keeping |x| off zero;
+		// 0 stays 0, so the cusps of star shapes get the normal of their axis.
+		inline float NormalPow(float x, float e)
+		{
+			float magnitude = std::pow(std::max(std::fabs(x), MinPowBase), 2.0f - e);
+			return x < 0.0f ? -magnitude : x > 0.0f ? magnitude : 0.0f;
+		}
+
+		inline DirectX::XMVECTOR NormalPow(DirectX::FXMVECTOR x, float e)
+		{
+			using namespace DirectX;
+			XMVECTOR base = XMVectorMax(XMVectorAbs(x), XMVectorReplicate(MinPowBase));
+			XMVECTOR magnitude = XMVectorPow(base, XMVectorReplicate(2.0f - e));
+			magnitude = XMVectorSelect(magnitude, XMVectorZero(), XMVectorEqual(x, XMVectorZero()));
+			return XMVectorSelect(magnitude, XMVectorNegate(magnitude), XMVectorLess(x, XMVectorZero()));
+		}
+
+		inline void Cross(const DirectX::XMVECTOR* a, const DirectX::XMVECTOR* b, DirectX::XMVECTOR* c)
+		{
+			using namespace DirectX;
+			c[0] = XMVectorSubtract(XMVectorMultiply(a[1], b[2]), XMVectorMultiply(a[2], b[1]));
+			c[1] = XMVectorSubtract(XMVectorMultiply(a[2], b[0]), XMVectorMultiply(a[0], b[2]));
+			c[2] = XMVectorSubtract(XMVectorMultiply(a[0], b[1]), XMVectorMultiply(a[1], b[0]));
+		}
+
+		inline DirectX::XMVECTOR LengthSq(const DirectX::XMVECTOR* a)
+		{
+			using namespace DirectX;
+			return XMVectorMultiplyAdd(a[2], a[2], XMVectorMultiplyAdd(a[1], a[1], XMVectorMultiply(a[0], a[0])));
+		}
+
+		inline void Normalize(DirectX::XMVECTOR* a)
+		{
+			using namespace DirectX;
+			XMVECTOR scale = XMVectorReciprocalSqrt(LengthSq(a));
+			a[0] = XMVectorMultiply(a[0], scale);
+			a[1] = XMVectorMultiply(a[1], scale);
+			a[2] = XMVectorMultiply(a[2], scale);
+		}
+
+		// One row of vertices, four at a time.
+		template<typename Writer, typename Surface>
+		void WriteRow(typename Writer::VertexType* vertices, const Writer& writer, const Surface& surface,
+			uint32 row, uint32 uSegments, uint32 vSegments, uint32 pinch)
+		{
+			using namespace DirectX;
+			constexpr bool needsFrame = ShapeWriter::Detail::Needs<Writer>(ShapeWriter::Normal) ||
+				ShapeWriter::Detail::Needs<Writer>(ShapeWriter::TangentU);
+
+			float v = (float)row / vSegments;
+			typename Surface::Row rowTerms = surface.GetRow(v);
+
+			// Where the normal and tangent come from.
+			bool pinched = false;
+			float frameV = v;
+			if(row == 0 && (pinch & PinchVMin) != 0)
+			{
+				pinched = true;
+				frameV = PinchOffset / vSegments;
+			}
+			else if(row == vSegments && (pinch & PinchVMax) != 0)
+			{
+				pinched = true;
+				frameV = 1.0f - PinchOffset / vSegments;
+			}
+			typename Surface::Row frameTerms = pinched ? surface.GetRow(frameV) : rowTerms;
+
+			const XMVECTOR laneOffsets = XMVectorSet(0.0f, 1.0f, 2.0f, 3.0f);
+			const XMVECTOR segments = XMVectorReplicate((float)uSegments);
+			for(uint32 j = 0; j <= uSegments; j += 4)
+			{
+				// Dividing keeps the last u exactly 1.
+				XMVECTOR u = XMVectorDivide(XMVectorAdd(XMVectorReplicate((float)j), laneOffsets), segments);
+
+				Patch patch;
+				surface.Evaluate(rowTerms, u, patch);
+
+				XMVECTOR normal[3] = {}, tangent[3] = {};
+				if constexpr(needsFrame)
+				{
+					Patch framePatch;
+					const Patch* frame = &patch;
+					if(pinched)
+					{
+						surface.Evaluate(frameTerms, u, framePatch);
+						frame = &framePatch;
+					}
+
+					if constexpr(Surface::HasNormal)
+					{
+						normal[0] = frame->Normal[0];
+						normal[1] = frame->Normal[1];
+						normal[2] = frame->Normal[2];
+					}
+					else
+					{
+						Cross(frame->Du, frame->Dv, normal);
+					}
+					Normalize(normal);
+
+					// dP/du vanishes where a superquadric goes flat; the part of dP/du
+					// across dP/dv, dP/dv x n, points the same way.
+					XMVECTOR across[3];
+					Cross(frame->Dv, normal, across);
+					XMVECTOR flat = XMVectorLessOrEqual(LengthSq(frame->Du), XMVectorScale(LengthSq(frame->Dv), 1e-12f));
+					for(int c = 0; c < 3; ++c)
+						tangent[c] = XMVectorSelect(frame->Du[c], across[c], flat);
+					Normalize(tangent);
+				}
+
+				float lanes[10][4];
+				for(int c = 0; c < 3; ++c)
+				{
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(lanes[c]), patch.Position[c]);
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(lanes[3 + c]), normal[c]);
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(lanes[6 + c]), tangent[c]);
+				}
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(lanes[9]), u);
+
+				uint32 count = std::min(4u, uSegments + 1 - j);
+				for(uint32 l = 0; l < count; ++l)
+				{
+					writer(vertices[j + l], GeneratedVertex(
+						lanes[0][l], lanes[1][l], lanes[2][l],
+						lanes[3][l], lanes[4][l], lanes[5][l],
+						lanes[6][l], lanes[7][l], lanes[8][l],
+						lanes[9][l], v));
+				}
+			}
+		}
+
+		inline uint32 GetRowIndexOffset(uint32 row, uint32 uSegments, uint32 pinch)
+		{
+			return 6 * uSegments * row - ((pinch & PinchVMin) != 0 && row > 0 ? 3 * uSegments : 0);
+		}
+
+		// The quads between a row and the next, as in ShapeWriter::WriteSphere.
+		template<typename Index>
+		void WriteQuads(Index* indices, uint32 row, uint32 uSegments, uint32 vSegments, uint32 pinch, uint32 baseVertex)
+		{
+			bool skipFirst = row == 0 && (pinch & PinchVMin) != 0;
+			bool skipSecond = row == vSegments - 1 && (pinch & PinchVMax) != 0;
+			uint32 rowLength = uSegments + 1;
+
+			uint32 n = GetRowIndexOffset(row, uSegments, pinch);
+			for(uint32 j = 0; j < uSegments; ++j)
+			{
+				uint32 a = baseVertex + row * rowLength + j;
+				uint32 b = a + 1;
+				uint32 c = a + rowLength;
+				uint32 d = c + 1;
+				if(!skipFirst)
+				{
+					indices[n++] = static_cast<Index>(a);
+					indices[n++] = static_cast<Index>(b);
+					indices[n++] = static_cast<Index>(c);
+				}
+				if(!skipSecond)
+				{
+					indices[n++] = static_cast<Index>(c);
+					indices[n++] = static_cast<Index>(b);
+					indices[n++] = static_cast<Index>(d);
+				}
+			}
+		}
+	}
+
+	//
+	// Surfaces.
+	//
+
+	///<summary>
+	/// Sphere of the given radius; u is the longitude from +x towards +z, v the polar
+	/// angle from +y, as in CreateSphere.
+	///</summary>
+	struct Sphere
+	{
+		static constexpr bool HasNormal = false;
+
+		float Radius = 1.0f;
+
+		struct Row
+		{
+			float SinPhi;
+			float CosPhi;
+		};
+
+		uint32 GetPinch()const { return PinchVMin | PinchVMax; }
+
+		Row GetRow(float v)const
+		{
+			float phi = DirectX::XM_PI * v;
+			return Row{ std::sin(phi), std::cos(phi) };
+		}
+
+		void Evaluate(const Row& row, DirectX::FXMVECTOR u, Patch& patch)const
+		{
+			using namespace DirectX;
+			XMVECTOR sinTheta, cosTheta;
+			XMVectorSinCos(&sinTheta, &cosTheta, XMVectorScale(u, XM_2PI));
+
+			float ringRadius = Radius * row.SinPhi;
+			patch.Position[0] = XMVectorScale(cosTheta, ringRadius);
+			patch.Position[1] = XMVectorReplicate(Radius * row.CosPhi);
+			patch.Position[2] = XMVectorScale(sinTheta, ringRadius);
+
+			patch.Du[0] = XMVectorScale(sinTheta, -XM_2PI * ringRadius);
+			patch.Du[1] = XMVectorZero();
+			patch.Du[2] = XMVectorScale(cosTheta, XM_2PI * ringRadius);
+
+			float dRing = XM_PI * Radius * row.CosPhi;
+			patch.Dv[0] = XMVectorScale(cosTheta, dRing);
+			patch.Dv[1] = XMVectorReplicate(-XM_PI * Radius * row.SinPhi);
+			patch.Dv[2] = XMVectorScale(sinTheta, dRing);
+		}
+	};
+
+	///<summary>
+	/// Side of a cylinder or, with a zero radius, a cone, along the y-axis and centered
+	/// on the origin; v runs from the top down, as in CreateCylinder.
+	///</summary>
+	struct Cylinder
+	{
+		static constexpr bool HasNormal = false;
+
+		float BottomRadius = 1.0f;
+		float TopRadius = 1.0f;
+		float Height = 1.0f;
+
+		struct Row
+		{
+			float Radius;
+			float Y;
+		};
+
+		uint32 GetPinch()const
+		{
+			return (TopRadius == 0.0f ? PinchVMin : 0u) | (BottomRadius == 0.0f ? PinchVMax : 0u);
+		}
+
+		Row GetRow(float v)const
+		{
+			return Row{ TopRadius + (BottomRadius - TopRadius) * v, 0.5f * Height - Height * v };
+		}
+
+		void Evaluate(const Row& row, DirectX::FXMVECTOR u, Patch& patch)const
+		{
+			using namespace DirectX;
+			XMVECTOR sinTheta, cosTheta;
+			XMVectorSinCos(&sinTheta, &cosTheta, XMVectorScale(u, XM_2PI));
+
+			patch.Position[0] = XMVectorScale(cosTheta, row.Radius);
+			patch.Position[1] = XMVectorReplicate(row.Y);
+			patch.Position[2] = XMVectorScale(sinTheta, row.Radius);
+
+			patch.Du[0] = XMVectorScale(sinTheta, -XM_2PI * row.Radius);
+			patch.Du[1] = XMVectorZero();
+			patch.Du[2] = XMVectorScale(cosTheta, XM_2PI * row.Radius);
+
+			float dr = BottomRadius - TopRadius;
+			patch.Dv[0] = XMVectorScale(cosTheta, dr);
+			patch.Dv[1] = XMVectorReplicate(-Height);
+			patch.Dv[2] = XMVectorScale(sinTheta, dr);
+		}
+	};
+
+	///<summary>
+	/// Disk of the given radius in the plane y = Y, facing +y if Up and -y otherwise.  v
+	/// runs from the center out when facing up and from the rim in when facing down.
+	///</summary>
+	struct Disk
+	{
+		static constexpr bool HasNormal = false;
+
+		float Radius = 1.0f;
+		float Y = 0.0f;
+		bool Up = true;
+
+		struct Row
+		{
+			float Radius;
+		};
+
+		uint32 GetPinch()const { return Up ? PinchVMin : PinchVMax; }
+
+		Row GetRow(float v)const
+		{
+			return Row{ Radius * (Up ? v : 1.0f - v) };
+		}
+
+		void Evaluate(const Row& row, DirectX::FXMVECTOR u, Patch& patch)const
+		{
+			using namespace DirectX;
+			XMVECTOR sinTheta, cosTheta;
+			XMVectorSinCos(&sinTheta, &cosTheta, XMVectorScale(u, XM_2PI));
+
+			patch.Position[0] = XMVectorScale(cosTheta, row.Radius);
+			patch.Position[1] = XMVectorReplicate(Y);
+			patch.Position[2] = XMVectorScale(sinTheta, row.Radius);
+
+			patch.Du[0] = XMVectorScale(sinTheta, -XM_2PI * row.Radius);
+			patch.Du[1] = XMVectorZero();
+			patch.Du[2] = XMVectorScale(cosTheta, XM_2PI * row.Radius);
+
+			float dr = Up ? Radius : -Radius;
+			patch.Dv[0] = XMVectorScale(cosTheta, dr);
+			patch.Dv[1] = XMVectorZero();
+			patch.Dv[2] = XMVectorScale(sinTheta, dr);
+		}
+	};
+
+	///<summary>
+	/// Torus around the y-axis: a tube of MinorRadius around a circle of MajorRadius.  u
+	/// goes around the y-axis and v around the tube, starting from its outer equator.
+	///</summary>
+	struct Torus
+	{
+		static constexpr bool HasNormal = false;
+
+		float MajorRadius = 1.0f;
+		float MinorRadius = 0.25f;
+
+		struct Row
+		{
+			float SinPhi;
+			float CosPhi;
+		};
+
+		uint32 GetPinch()const { return 0; }
+
+		Row GetRow(float v)const
+		{
+			float phi = DirectX::XM_2PI * v;
+			return Row{ std::sin(phi), std::cos(phi) };
+		}
+
+		void Evaluate(const Row& row, DirectX::FXMVECTOR u, Patch& patch)const
+		{
+			using namespace DirectX;
+			XMVECTOR sinTheta, cosTheta;
+			XMVectorSinCos(&sinTheta, &cosTheta, XMVectorScale(u, XM_2PI));
+
+			float ringRadius = MajorRadius + MinorRadius * row.CosPhi;
+			patch.Position[0] = XMVectorScale(cosTheta, ringRadius);
+			patch.Position[1] = XMVectorReplicate(-MinorRadius * row.SinPhi);
+			patch.Position[2] = XMVectorScale(sinTheta, ringRadius);
+
+			patch.Du[0] = XMVectorScale(sinTheta, -XM_2PI * ringRadius);
+			patch.Du[1] = XMVectorZero();
+			patch.Du[2] = XMVectorScale(cosTheta, XM_2PI * ringRadius);
+
+			float dRing = -XM_2PI * MinorRadius * row.SinPhi;
+			patch.Dv[0] = XMVectorScale(cosTheta, dRing);
+			patch.Dv[1] = XMVectorReplicate(-XM_2PI * MinorRadius * row.CosPhi);
+			patch.Dv[2] = XMVectorScale(sinTheta, dRing);
+		}
+	};
+
+	///<summary>
+	/// Barr's superellipsoid: the sphere with sin and cos raised to signed powers,
+	/// Vertical across the latitudes and Horizontal around the y-axis, scaled by Radii.
+	/// Exponents above 0: 1 gives the ellipsoid, towards 0 a box, 2 an octahedron, and
+	/// past 2 a star.
+	/// Normals are the analytic ones, which stay defined at the creases.
+	///</summary>
+	struct Superellipsoid
+	{
+		static constexpr bool HasNormal = true;
+
+		DirectX::XMFLOAT3 Radii = DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f);
+		float Vertical = 1.0f;
+		float Horizontal = 1.0f;
+
+		struct Row
+		{
+			float Ring;         // sgn(sin phi) |sin phi|^e and so on
+			float Y;
+			float DRing;
+			float DY;
+			float NormalRing;
+			float NormalY;
+		};
+
+		uint32 GetPinch()const { return PinchVMin | PinchVMax; }
+
+		Row GetRow(float v)const
+		{
+			using namespace Detail;
+			float phi = DirectX::XM_PI * v;
+			float s = std::sin(phi), c = std::cos(phi);
+			return Row{
+				SignedPow(s, Vertical),
+				SignedPow(c, Vertical),
+				DirectX::XM_PI * SignedPowSlope(s, Vertical) * c,
+				-DirectX::XM_PI * SignedPowSlope(c, Vertical) * s,
+				NormalPow(s, Vertical),
+				NormalPow(c, Vertical) };
+		}
+
+		void Evaluate(const Row& row, DirectX::FXMVECTOR u, Patch& patch)const
+		{
+			using namespace DirectX;
+			XMVECTOR s, c;
+			XMVectorSinCos(&s, &c, XMVectorScale(u, XM_2PI));
+
+			XMVECTOR powC = Detail::SignedPow(c, Horizontal);
+			XMVECTOR powS = Detail::SignedPow(s, Horizontal);
+			XMVECTOR dPowC = XMVectorMultiply(Detail::SignedPowSlope(c, Horizontal), XMVectorScale(s, -XM_2PI));
+			XMVECTOR dPowS = XMVectorMultiply(Detail::SignedPowSlope(s, Horizontal), XMVectorScale(c, XM_2PI));
+
+			patch.Position[0] = XMVectorScale(powC, Radii.x * row.Ring);
+			patch.Position[1] = XMVectorReplicate(Radii.y * row.Y);
+			patch.Position[2] = XMVectorScale(powS, Radii.z * row.Ring);
+
+			patch.Du[0] = XMVectorScale(dPowC, Radii.x * row.Ring);
+			patch.Du[1] = XMVectorZero();
+			patch.Du[2] = XMVectorScale(dPowS, Radii.z * row.Ring);
+
+			patch.Dv[0] = XMVectorScale(powC, Radii.x * row.DRing);
+			patch.Dv[1] = XMVectorReplicate(Radii.y * row.DY);
+			patch.Dv[2] = XMVectorScale(powS, Radii.z * row.DRing);
+
+			patch.Normal[0] = XMVectorScale(Detail::NormalPow(c, Horizontal), row.NormalRing / Radii.x);
+			patch.Normal[1] = XMVectorReplicate(row.NormalY / Radii.y);
+			patch.Normal[2] = XMVectorScale(Detail::NormalPow(s, Horizontal), row.NormalRing / Radii.z);
+		}
+	};
+
+	///<summary>
+	/// Barr's supertoroid: Torus with the tube's and the ring's sin and cos raised to
+	/// signed powers, Vertical around the tube and Horizontal around the y-axis.
+	///</summary>
+	struct Supertoroid
+	{
+		static constexpr bool HasNormal = true;
+
+		float MajorRadius = 1.0f;
+		float MinorRadius = 0.25f;
+		float Vertical = 1.0f;
+		float Horizontal = 1.0f;
+
+		struct Row
+		{
+			float Ring;
+			float Y;
+			float DRing;
+			float DY;
+			float NormalRing;
+			float NormalY;
+		};
+
+		uint32 GetPinch()const { return 0; }
+
+		Row GetRow(float v)const
+		{
+			using namespace Detail;
+			float phi = DirectX::XM_2PI * v;
+			float s = std::sin(phi), c = std::cos(phi);
+			return Row{
+				MajorRadius + MinorRadius * SignedPow(c, Vertical),
+				-MinorRadius * SignedPow(s, Vertical),
+				-DirectX::XM_2PI * MinorRadius * SignedPowSlope(c, Vertical) * s,
+				-DirectX::XM_2PI * MinorRadius * SignedPowSlope(s, Vertical) * c,
+				NormalPow(c, Vertical),
+				-NormalPow(s, Vertical) };
+		}
+
+		void Evaluate(const Row& row, DirectX::FXMVECTOR u, Patch& patch)const
+		{
+			using namespace DirectX;
+			XMVECTOR s, c;
+			XMVectorSinCos(&s, &c, XMVectorScale(u, XM_2PI));
+
+			XMVECTOR powC = Detail::SignedPow(c, Horizontal);
+			XMVECTOR powS = Detail::SignedPow(s, Horizontal);
+			XMVECTOR dPowC = XMVectorMultiply(Detail::SignedPowSlope(c, Horizontal), XMVectorScale(s, -XM_2PI));
+			XMVECTOR dPowS = XMVectorMultiply(Detail::SignedPowSlope(s, Horizontal), XMVectorScale(c, XM_2PI));
+
+			patch.Position[0] = XMVectorScale(powC, row.Ring);
+			patch.Position[1] = XMVectorReplicate(row.Y);
+			patch.Position[2] = XMVectorScale(powS, row.Ring);
+
+			patch.Du[0] = XMVectorScale(dPowC, row.Ring);
+			patch.Du[1] = XMVectorZero();
+			patch.Du[2] = XMVectorScale(dPowS, row.Ring);
+
+			patch.Dv[0] = XMVectorScale(powC, row.DRing);
+			patch.Dv[1] = XMVectorReplicate(row.DY);
+			patch.Dv[2] = XMVectorScale(powS, row.DRing);
+
+			patch.Normal[0] = XMVectorScale(Detail::NormalPow(c, Horizontal), row.NormalRing);
+			patch.Normal[1] = XMVectorReplicate(row.NormalY);
+			patch.Normal[2] = XMVectorScale(Detail::NormalPow(s, Horizontal), row.NormalRing);
+		}
+	};
+
+	//
+	// Tessellation.
+	//
+
+	template<typename Surface>
+	ShapeWriter::Counts GetCounts(const Surface& surface, uint32 uSegments, uint32 vSegments)
+	{
+		uint32 pinch = surface.GetPinch();
+		uint32 pinchedRows = ((pinch & PinchVMin) != 0 ? 1 : 0) + ((pinch & PinchVMax) != 0 ? 1 : 0);
+		return ShapeWriter::Counts{ (uSegments + 1) * (vSegments + 1), 6 * uSegments * vSegments - 3 * uSegments * pinchedRows };
+	}
+
+	///<summary>
+	/// Tessellates the surface into GetCounts(surface, uSegments, vSegments) vertices and
+	/// indices, rows in parallel if a pool is given.  baseVertex is added to every index,
+	/// for several surfaces in one buffer.  uSegments >= 1 and vSegments >= 2 if both
+	/// ends are pinched, 1 otherwise.
+	///</summary>
+	template<typename Writer, typename Index, typename Surface>
+	void Write(typename Writer::VertexType* vertices, Index* indices, const Writer& writer, const Surface& surface,
+		uint32 uSegments, uint32 vSegments, ThreadPool* pool = nullptr, uint32 baseVertex = 0)
+	{
+		uint32 pinch = surface.GetPinch();
+		auto rows = [&](uint32 begin, uint32 end)
+		{
+			for(uint32 row = begin; row < end; ++row)
+			{
+				Detail::WriteRow(vertices + row * (uSegments + 1), writer, surface, row, uSegments, vSegments, pinch);
+				if constexpr(ShapeWriter::Detail::WritesIndices<Index>())
+				{
+					if(row < vSegments)
+						Detail::WriteQuads(indices, row, uSegments, vSegments, pinch, baseVertex);
+				}
+			}
+		};
+
+		if(pool != nullptr)
+			pool->ParallelFor(vSegments + 1, std::max(1u, 4096 / (uSegments + 1)), rows);
+		else
+			rows(0, vSegments + 1);
+	}
+
+	template<typename Surface>
+	ShapeWriter::Topology GetTopology(const Surface& surface, uint32 uSegments, uint32 vSegments)
+	{
+		return ShapeWriter::Topology{ ShapeWriter::SurfaceTopology, { uSegments, vSegments, surface.GetPinch() } };
+	}
+
+	template<typename Writer, typename Index, typename Surface>
+	ShapeWriter::Range Append(std::vector<typename Writer::VertexType>& vertices, std::vector<Index>& indices, const Writer& writer,
+		const Surface& surface, uint32 uSegments, uint32 vSegments, ThreadPool* pool = nullptr)
+	{
+		ShapeWriter::Topology topology = GetTopology(surface, uSegments, vSegments);
+		return ShapeWriter::Detail::Append(vertices, indices, GetCounts(surface, uSegments, vSegments), topology, [&](auto* v, Index* i)
+		{
+			Write(v, i, writer, surface, uSegments, vSegments, pool);
+		});
+	}
+
+	///<summary>
+	/// Rewrites the vertices of range, which Append filled with the same segment counts
+	/// and pinched rows, for the surface's new parameters; see ShapeWriter::UpdateSphere.
+	/// A parameter that pinches a row or unpinches one (a radius going to or from 0)
+	/// changes the indices, so the update is refused.  The indices are left alone.
+	///</summary>
+	template<typename Writer, typename Surface>
+	ShapeWriter::DirtyRange Update(typename Writer::VertexType* vertices, const ShapeWriter::Range& range, const Writer& writer,
+		const Surface& surface, uint32 uSegments, uint32 vSegments, ThreadPool* pool = nullptr)
+	{
+		ShapeWriter::Topology topology = GetTopology(surface, uSegments, vSegments);
+		return ShapeWriter::Detail::Update(vertices, range, GetCounts(surface, uSegments, vSegments), topology, [&](auto* v)
+		{
+			Write<Writer, ShapeWriter::Detail::KeepIndices>(v, nullptr, writer, surface, uSegments, vSegments, pool);
+		});
+	}
+
+	namespace Detail
+	{
+		// The side of a closed cylinder or cone followed by its disks.
+		inline ShapeWriter::Counts GetClosedCounts(const Cylinder& side, uint32 diskCount, uint32 sliceCount, uint32 stackCount)
+		{
+			ShapeWriter::Counts sideCounts = GetCounts(side, sliceCount, stackCount);
+			ShapeWriter::Counts diskCounts = GetCounts(Disk{}, sliceCount, 1);
+			return { sideCounts.VertexCount + diskCount * diskCounts.VertexCount, sideCounts.IndexCount + diskCount * diskCounts.IndexCount };
+		}
+
+		inline ShapeWriter::Topology GetClosedTopology(uint32 shape, const Cylinder& side, uint32 sliceCount, uint32 stackCount)
+		{
+			return ShapeWriter::Topology{ shape, { sliceCount, stackCount, side.GetPinch() } };
+		}
+	}
+
+	///<summary>
+	/// A cylinder with both ends closed, like ShapeWriter::WriteCylinder: the side in
+	/// stackCount rows, then the top and the bottom disks, one ring each.  A radius of 0
+	/// closes that end of the side in a point and leaves its disk degenerate.
+	///</summary>
+	template<typename Writer, typename Index>
+	void WriteCylinder(typename Writer::VertexType* vertices, Index* indices, const Writer& writer,
+		float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, ThreadPool* pool = nullptr)
+	{
+		Cylinder side{ bottomRadius, topRadius, height };
+		Disk top{ topRadius, 0.5f * height, true };
+		Disk bottom{ bottomRadius, -0.5f * height, false };
+
+		ShapeWriter::Counts sideCounts = GetCounts(side, sliceCount, stackCount);
+		ShapeWriter::Counts capCounts = GetCounts(top, sliceCount, 1);
+		Index* topIndices = nullptr;
+		Index* bottomIndices = nullptr;
+		if constexpr(ShapeWriter::Detail::WritesIndices<Index>())
+		{
+			topIndices = indices + sideCounts.IndexCount;
+			bottomIndices = topIndices + capCounts.IndexCount;
+		}
+
+		Write(vertices, indices, writer, side, sliceCount, stackCount, pool);
+		Write(vertices + sideCounts.VertexCount, topIndices, writer, top, sliceCount, 1, nullptr, sideCounts.VertexCount);
+		Write(vertices + sideCounts.VertexCount + capCounts.VertexCount, bottomIndices, writer, bottom, sliceCount, 1, nullptr,
+			sideCounts.VertexCount + capCounts.VertexCount);
+	}
+
+	///<summary>
+	/// A closed cone along the y-axis, centered on the origin like ShapeWriter::WriteCone's:
+	/// apex at +height/2, base disk of the given radius at -height/2.
+	///</summary>
+	template<typename Writer, typename Index>
+	void WriteCone(typename Writer::VertexType* vertices, Index* indices, const Writer& writer,
+		float radius, float height, uint32 sliceCount, uint32 stackCount, ThreadPool* pool = nullptr)
+	{
+		Cylinder side{ radius, 0.0f, height };
+		Disk bottom{ radius, -0.5f * height, false };
+
+		ShapeWriter::Counts sideCounts = GetCounts(side, sliceCount, stackCount);
+		Index* bottomIndices = nullptr;
+		if constexpr(ShapeWriter::Detail::WritesIndices<Index>())
+			bottomIndices = indices + sideCounts.IndexCount;
+
+		Write(vertices, indices, writer, side, sliceCount, stackCount, pool);
+		Write(vertices + sideCounts.VertexCount, bottomIndices, writer, bottom, sliceCount, 1, nullptr, sideCounts.VertexCount);
+	}
+
+	template<typename Writer, typename Index>
+	ShapeWriter::Range AppendCylinder(std::vector<typename Writer::VertexType>& vertices, std::vector<Index>& indices, const Writer& writer,
+		float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, ThreadPool* pool = nullptr)
+	{
+		Cylinder side{ bottomRadius, topRadius, height };
+		ShapeWriter::Counts counts = Detail::GetClosedCounts(side, 2, sliceCount, stackCount);
+		ShapeWriter::Topology topology = Detail::GetClosedTopology(ShapeWriter::SurfaceCylinderTopology, side, sliceCount, stackCount);
+		return ShapeWriter::Detail::Append(vertices, indices, counts, topology, [&](auto* v, Index* i)
+		{
+			WriteCylinder(v, i, writer, bottomRadius, topRadius, height, sliceCount, stackCount, pool);
+		});
+	}
+
+	template<typename Writer, typename Index>
+	ShapeWriter::Range AppendCone(std::vector<typename Writer::VertexType>& vertices, std::vector<Index>& indices, const Writer& writer,
+		float radius, float height, uint32 sliceCount, uint32 stackCount, ThreadPool* pool = nullptr)
+	{
+		Cylinder side{ radius, 0.0f, height };
+		ShapeWriter::Counts counts = Detail::GetClosedCounts(side, 1, sliceCount, stackCount);
+		ShapeWriter::Topology topology = Detail::GetClosedTopology(ShapeWriter::SurfaceConeTopology, side, sliceCount, stackCount);
+		return ShapeWriter::Detail::Append(vertices, indices, counts, topology, [&](auto* v, Index* i)
+		{
+			WriteCone(v, i, writer, radius, height, sliceCount, stackCount, pool);
+		});
+	}
+
+	///<summary>
+	/// UpdateCylinder and UpdateCone refuse, like Update, whenever the slice or stack
+	/// count differs from range's or a radius goes to or from 0.
+	///</summary>
+	template<typename Writer>
+	ShapeWriter::DirtyRange UpdateCylinder(typename Writer::VertexType* vertices, const ShapeWriter::Range& range, const Writer& writer,
+		float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, ThreadPool* pool = nullptr)
+	{
+		Cylinder side{ bottomRadius, topRadius, height };
+		ShapeWriter::Counts counts = Detail::GetClosedCounts(side, 2, sliceCount, stackCount);
+		ShapeWriter::Topology topology = Detail::GetClosedTopology(ShapeWriter::SurfaceCylinderTopology, side, sliceCount, stackCount);
+		return ShapeWriter::Detail::Update(vertices, range, counts, topology, [&](auto* v)
+		{
+			WriteCylinder<Writer, ShapeWriter::Detail::KeepIndices>(v, nullptr, writer, bottomRadius, topRadius, height,
+				sliceCount, stackCount, pool);
+		});
+	}
+
+	template<typename Writer>
+	ShapeWriter::DirtyRange UpdateCone(typename Writer::VertexType* vertices, const ShapeWriter::Range& range, const Writer& writer,
+		float radius, float height, uint32 sliceCount, uint32 stackCount, ThreadPool* pool = nullptr)
+	{
+		Cylinder side{ radius, 0.0f, height };
+		ShapeWriter::Counts counts = Detail::GetClosedCounts(side, 1, sliceCount, stackCount);
+		ShapeWriter::Topology topology = Detail::GetClosedTopology(ShapeWriter::SurfaceConeTopology, side, sliceCount, stackCount);
+		return ShapeWriter::Detail::Update(vertices, range, counts, topology, [&](auto* v)
+		{
+			WriteCone<Writer, ShapeWriter::Detail::KeepIndices>(v, nullptr, writer, radius, height, sliceCount, stackCount, pool);
+		});
+	}
+}
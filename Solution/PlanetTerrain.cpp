@@ -0,0 +1,601 @@
+//***************************************************************************************
+// PlanetTerrain.cpp
+//***************************************************************************************
+
+#include "PlanetTerrain.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <tuple>
+#include <utility>
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	// Face f lies on the cube side FaceSign[f] along axis FaceAxis[f]; its u and v run
+	// along FaceU[f] and FaceV[f], always towards +, with u x v pointing out of the
+	// cube.  Since u and v never run backwards, a cube point on an edge has the same
+	// lattice coordinates seen from either face.
+	const int FaceAxis[6] = { 0, 0, 1, 1, 2, 2 };
+	const float FaceSign[6] = { 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f };
+	const int FaceU[6] = { 1, 2, 2, 0, 0, 1 };
+	const int FaceV[6] = { 2, 1, 0, 2, 1, 0 };
+
+	const uint32 MaxLevelLimit = 20;
+
+	uint64 MakeKey(uint32 face, uint32 level, uint32 x, uint32 y)
+	{
+		return (uint64)face << 53 | (uint64)level << 48 | (uint64)x << 24 | y;
+	}
+
+	void DecodeKey(uint64 key, uint32& face, uint32& level, uint32& x, uint32& y)
+	{
+		face = (uint32)(key >> 53);
+		level = (uint32)(key >> 48) & 31;
+		x = (uint32)(key >> 24) & 0xFFFFFF;
+		y = (uint32)key & 0xFFFFFF;
+	}
+
+	// Lattice coordinate k of R steps across a face, in [-1, 1].  Exact in double, so the
+	// float is the same whichever node or face computes it.
+	float LatticeCoordinate(uint64 k, uint64 r)
+	{
+		return (float)((2.0 * (double)k - (double)r) / (double)r);
+	}
+
+	XMFLOAT3 FacePoint(uint32 face, float s, float t)
+	{
+		float c[3];
+		c[FaceAxis[face]] = FaceSign[face];
+		c[FaceU[face]] = s;
+		c[FaceV[face]] = t;
+		return XMFLOAT3(c[0], c[1], c[2]);
+	}
+
+	XMFLOAT3 Scale(const XMFLOAT3& a, float s) { return XMFLOAT3(a.x * s, a.y * s, a.z * s); }
+	XMFLOAT3 Sub(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.x - b.x, a.y - b.y, a.z - b.z); }
+	float Length(const XMFLOAT3& a) { return std::sqrt(a.x * a.x + a.y * a.y + a.z * a.z); }
+
+	XMFLOAT3 Normalized(const XMFLOAT3& a)
+	{
+		float length = Length(a);
+		return length > 0.0f ? Scale(a, 1.0f / length) : a;
+	}
+}
+
+PlanetTerrain::PlanetTerrain(ThreadPool& pool, const Desc& desc)
+	: mPool(pool), mDesc(desc)
+{
+	mDesc.GridSize = std::max(2u, std::min(254u, mDesc.GridSize & ~1u));
+	mDesc.MaxLevel = std::min(mDesc.MaxLevel, MaxLevelLimit);
+	mMeshBytes = (uint64)GetNodeVertexCount() * sizeof(GeometryGenerator::Vertex);
+	BuildIndices();
+
+	for(uint32 face = 0; face < 6; ++face)
+	{
+		uint64 key = MakeKey(face, 0, 0, 0);
+		GenerateMesh(key, mCache[key].Vertices);
+		mResidentBytes += mMeshBytes;
+		++mStats.Generated;
+	}
+}
+
+PlanetTerrain::~PlanetTerrain()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mMeshFinished.wait(lock, [this]() { return mOutstanding == 0; });
+}
+
+XMFLOAT3 PlanetTerrain::CubeToSphere(float x, float y, float z)
+{
+	float x2 = x * x, y2 = y * y, z2 = z * z;
+	return XMFLOAT3(
+		x * std::sqrt(std::max(0.0f, 1.0f - y2 * 0.5f - z2 * 0.5f + y2 * z2 / 3.0f)),
+		y * std::sqrt(std::max(0.0f, 1.0f - z2 * 0.5f - x2 * 0.5f + z2 * x2 / 3.0f)),
+		z * std::sqrt(std::max(0.0f, 1.0f - x2 * 0.5f - y2 * 0.5f + x2 * y2 / 3.0f)));
+}
+
+void PlanetTerrain::GenerateMesh(uint64 key, std::vector<GeometryGenerator::Vertex>& vertices)const
+{
+	uint32 face, level, x, y;
+	DecodeKey(key, face, level, x, y);
+
+	const uint32 n = mDesc.GridSize;
+	const uint32 shift = mDesc.MaxLevel - level;
+	const uint64 r = (uint64)n << mDesc.MaxLevel;
+	const float radius = mDesc.Radius;
+
+	XMFLOAT3 axisU(FaceU[face] == 0 ? 1.0f : 0.0f, FaceU[face] == 1 ? 1.0f : 0.0f, FaceU[face] == 2 ? 1.0f : 0.0f);
+	XMFLOAT3 axisV(FaceV[face] == 0 ? 1.0f : 0.0f, FaceV[face] == 1 ? 1.0f : 0.0f, FaceV[face] == 2 ? 1.0f : 0.0f);
+
+	// Half a vertex spacing of this node, as an angle, for the central differences.
+	const float step = 1.0f / (float)((uint64)n << level);
+
+	auto surface = [&](const XMFLOAT3& direction)
+	{
+		float height = mDesc.Height ? mDesc.Height(direction) : 0.0f;
+		return Scale(direction, radius + height);
+	};
+	auto offset = [](const XMFLOAT3& direction, const XMFLOAT3& axis, float amount)
+	{
+		// Along the axis, within the tangent plane, back onto the unit sphere.
+		float d = direction.x * axis.x + direction.y * axis.y + direction.z * axis.z;
+		XMFLOAT3 tangent = Normalized(Sub(axis, Scale(direction, d)));
+		return Normalized(XMFLOAT3(direction.x + tangent.x * amount, direction.y + tangent.y * amount, direction.z + tangent.z * amount));
+	};
+
+	vertices.resize((n + 1) * (n + 1));
+	for(uint32 j = 0; j <= n; ++j)
+	{
+		float t = LatticeCoordinate(((uint64)y * n + j) << shift, r);
+		for(uint32 i = 0; i <= n; ++i)
+		{
+			float s = LatticeCoordinate(((uint64)x * n + i) << shift, r);
+			XMFLOAT3 cube = FacePoint(face, s, t);
+			XMFLOAT3 direction = CubeToSphere(cube.x, cube.y, cube.z);
+
+			GeometryGenerator::Vertex& v = vertices[j * (n + 1) + i];
+			v.Position = surface(direction);
+			v.TexC = XMFLOAT2((s + 1.0f) * 0.5f, (t + 1.0f) * 0.5f);
+
+			XMFLOAT3 du = Sub(surface(offset(direction, axisU, step)), surface(offset(direction, axisU, -step)));
+			XMFLOAT3 dv = Sub(surface(offset(direction, axisV, step)), surface(offset(direction, axisV, -step)));
+			XMFLOAT3 normal(du.y * dv.z - du.z * dv.y, du.z * dv.x - du.x * dv.z, du.x * dv.y - du.y * dv.x);
+			v.Normal = Normalized(normal);
+			v.TangentU = Normalized(du);
+		}
+	}
+}
+
+void PlanetTerrain::BuildIndices()
+{
+	const int n = (int)mDesc.GridSize;
+	auto index = [n](int i, int j) { return (uint16)(j * (n + 1) + i); };
+
+	for(uint32 mask = 0; mask < 16; ++mask)
+	{
+		std::vector<uint16>& indices = mIndices[mask];
+
+		// Triangles wind like (i, j), (i + 1, j), (i, j + 1): u x v points outwards,
+		// which is clockwise seen from outside in the left-handed apps.
+		auto emit = [&](int ai, int aj, int bi, int bj, int ci, int cj)
+		{
+			if((bi - ai) * (cj - aj) - (bj - aj) * (ci - ai) < 0)
+			{
+				std::swap(bi, ci);
+				std::swap(bj, cj);
+			}
+			indices.push_back(index(ai, aj));
+			indices.push_back(index(bi, bj));
+			indices.push_back(index(ci, cj));
+		};
+
+		for(int j = 1; j < n - 1; ++j)
+		{
+			for(int i = 1; i < n - 1; ++i)
+			{
+				emit(i, j, i + 1, j, i, j + 1);
+				emit(i + 1, j, i + 1, j + 1, i, j + 1);
+			}
+		}
+
+		// Each side is a strip between its border row and the first inner row, zipped
+		// together along the side.  A stitched border keeps only its even vertices.
+		for(int side = 0; side < 4; ++side)
+		{
+			bool stitched = (mask >> side & 1) != 0;
+			int borderStep = stitched ? 2 : 1;
+
+			// (i, j) of position p along the side, on the border (depth 0) or inside it.
+			auto point = [side, n](int p, int depth, int& i, int& j)
+			{
+				switch(side)
+				{
+				case 0: i = depth; j = p; break;            // u = 0
+				case 1: i = n - depth; j = p; break;        // u = 1
+				case 2: i = p; j = depth; break;            // v = 0
+				default: i = p; j = n - depth; break;       // v = 1
+				}
+			};
+
+			int outer = 0, inner = 1;
+			while(outer < n || inner < n - 1)
+			{
+				bool advanceOuter = inner == n - 1 || (outer < n && outer + borderStep <= inner + 1);
+				int ai, aj, bi, bj, ci, cj;
+				if(advanceOuter)
+				{
+					point(outer, 0, ai, aj);
+					point(outer + borderStep, 0, bi, bj);
+					point(inner, 1, ci, cj);
+					outer += borderStep;
+				}
+				else
+				{
+					point(outer, 0, ai, aj);
+					point(inner + 1, 1, bi, bj);
+					point(inner, 1, ci, cj);
+					++inner;
+				}
+				emit(ai, aj, bi, bj, ci, cj);
+			}
+		}
+	}
+}
+
+uint32 PlanetTerrain::AddNode(uint32 face, uint32 level, uint32 x, uint32 y)
+{
+	Node node;
+	node.Key = MakeKey(face, level, x, y);
+	node.Face = face;
+	node.Level = level;
+	node.X = x;
+	node.Y = y;
+	node.Parent = -1;
+	node.FirstChild = -1;
+	node.InDrawTree = false;
+	node.DrawSplit = false;
+
+	// A sphere around the undisplaced patch from its center to its farthest corner,
+	// grown by the largest height.
+	float size = 2.0f / (float)(1u << level);
+	float s0 = -1.0f + x * size, t0 = -1.0f + y * size;
+	XMFLOAT3 c = FacePoint(face, s0 + size * 0.5f, t0 + size * 0.5f);
+	XMFLOAT3 center = Scale(CubeToSphere(c.x, c.y, c.z), mDesc.Radius);
+	float radius = 0.0f;
+	for(int corner = 0; corner < 4; ++corner)
+	{
+		XMFLOAT3 p = FacePoint(face, s0 + (corner & 1) * size, t0 + (corner >> 1) * size);
+		radius = std::max(radius, Length(Sub(Scale(CubeToSphere(p.x, p.y, p.z), mDesc.Radius), center)));
+	}
+	node.Bounds = XMFLOAT4(center.x, center.y, center.z, radius + mDesc.MaxHeight);
+
+	node.Visible = true;
+	for(int k = 0; k < 6 && mHasPlanes; ++k)
+	{
+		const XMFLOAT4& plane = mPlanes[k];
+		if(plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -node.Bounds.w)
+			node.Visible = false;
+	}
+
+	mNodes.push_back(node);
+	return (uint32)mNodes.size() - 1;
+}
+
+void PlanetTerrain::Split(uint32 node)
+{
+	uint32 face = mNodes[node].Face, level = mNodes[node].Level, x = mNodes[node].X, y = mNodes[node].Y;
+	uint32 first = (uint32)mNodes.size();
+	for(uint32 child = 0; child < 4; ++child)
+	{
+		uint32 added = AddNode(face, level + 1, x * 2 + (child & 1), y * 2 + (child >> 1));
+		mNodes[added].Parent = (int)node;
+	}
+	mNodes[node].FirstChild = (int)first;
+}
+
+void PlanetTerrain::Collapse(uint32 node)
+{
+	Node& n = mNodes[node];
+	if(!n.DrawSplit)
+		return;
+
+	n.DrawSplit = false;
+	for(uint32 child = 0; child < 4; ++child)
+	{
+		uint32 c = (uint32)n.FirstChild + child;
+		Collapse(c);
+		mNodes[c].InDrawTree = false;
+	}
+}
+
+bool PlanetTerrain::WantsSplit(const Node& node)const
+{
+	if(node.Level >= mDesc.MaxLevel || (mHasPlanes && !node.Visible))
+		return false;
+
+	XMFLOAT3 toEye = Sub(mEye, XMFLOAT3(node.Bounds.x, node.Bounds.y, node.Bounds.z));
+	float distance = std::max(0.0f, Length(toEye) - node.Bounds.w);
+	float width = mDesc.Radius * XM_PIDIV2 / (float)(1u << node.Level);
+	return distance < mDesc.SplitDistance * width;
+}
+
+uint32 PlanetTerrain::FindLeaf(uint32 face, double s, double t, bool drawn)const
+{
+	// The six roots are the first nodes.
+	uint32 node = face;
+	for(;;)
+	{
+		const Node& n = mNodes[node];
+		if(drawn ? !n.DrawSplit : n.FirstChild < 0)
+			return node;
+
+		double cells = (double)(1u << (n.Level + 1));
+		uint32 dx = (s + 1.0) * 0.5 * cells >= n.X * 2 + 1 ? 1 : 0;
+		uint32 dy = (t + 1.0) * 0.5 * cells >= n.Y * 2 + 1 ? 1 : 0;
+		node = (uint32)n.FirstChild + dy * 2 + dx;
+	}
+}
+
+uint32 PlanetTerrain::FindNeighbour(const Node& node, uint32 edge, bool drawn)const
+{
+	// A point a quarter of the finest node beyond the middle of the edge, which may lie
+	// past the face; then the face it is on is the one whose axis dominates.
+	double size = 2.0 / (double)(1u << node.Level);
+	double delta = 0.5 / (double)(1u << mDesc.MaxLevel);
+	double s = -1.0 + (node.X + 0.5) * size;
+	double t = -1.0 + (node.Y + 0.5) * size;
+	switch(edge)
+	{
+	case 0: s -= size * 0.5 + delta; break;
+	case 1: s += size * 0.5 + delta; break;
+	case 2: t -= size * 0.5 + delta; break;
+	default: t += size * 0.5 + delta; break;
+	}
+
+	double c[3];
+	c[FaceAxis[node.Face]] = FaceSign[node.Face];
+	c[FaceU[node.Face]] = s;
+	c[FaceV[node.Face]] = t;
+
+	int axis = 0;
+	for(int k = 1; k < 3; ++k)
+	{
+		if(std::fabs(c[k]) > std::fabs(c[axis]))
+			axis = k;
+	}
+	uint32 face = (uint32)(axis * 2 + (c[axis] < 0.0 ? 1 : 0));
+	double scale = 1.0 / std::fabs(c[axis]);
+	return FindLeaf(face, c[FaceU[face]] * scale, c[FaceV[face]] * scale, drawn);
+}
+
+bool PlanetTerrain::IsResident(uint64 key)
+{
+	auto found = mCache.find(key);
+	if(found == mCache.end())
+		return false;
+	found->second.LastUsed = mFrame;
+	return true;
+}
+
+void PlanetTerrain::BalanceSelection()
+{
+	// Split any leaf that is two or more levels coarser than a neighbouring leaf.  Only
+	// ever splitting, this settles within MaxLevel passes.
+	bool changed = true;
+	while(changed)
+	{
+		changed = false;
+		for(uint32 i = 0; i < (uint32)mNodes.size(); ++i)
+		{
+			if(mNodes[i].FirstChild >= 0 || mNodes[i].Level < 2)
+				continue;
+			for(uint32 edge = 0; edge < 4; ++edge)
+			{
+				uint32 neighbour = FindNeighbour(mNodes[i], edge, false);
+				if(mNodes[neighbour].Level + 1 < mNodes[i].Level)
+				{
+					Split(neighbour);
+					changed = true;
+				}
+			}
+		}
+	}
+}
+
+void PlanetTerrain::BuildDrawTree(uint32 node)
+{
+	mNodes[node].InDrawTree = true;
+	if(mNodes[node].FirstChild < 0)
+		return;
+
+	uint32 first = (uint32)mNodes[node].FirstChild;
+	bool resident = true;
+	for(uint32 child = 0; child < 4; ++child)
+		resident = IsResident(mNodes[first + child].Key) && resident;
+
+	mNodes[node].DrawSplit = resident;
+	if(resident)
+	{
+		for(uint32 child = 0; child < 4; ++child)
+			BuildDrawTree(first + child);
+	}
+}
+
+void PlanetTerrain::BalanceDrawTree()
+{
+	// The other way round from the selection: a drawn leaf two levels finer than its
+	// neighbour goes back to its parent, which is resident because its own parent
+	// split.  Only ever collapsing, this settles too.
+	bool changed = true;
+	while(changed)
+	{
+		changed = false;
+		for(uint32 i = 0; i < (uint32)mNodes.size(); ++i)
+		{
+			const Node& n = mNodes[i];
+			if(!n.InDrawTree || n.DrawSplit || n.Level < 2)
+				continue;
+			for(uint32 edge = 0; edge < 4; ++edge)
+			{
+				uint32 neighbour = FindNeighbour(mNodes[i], edge, true);
+				if(mNodes[neighbour].Level + 1 < mNodes[i].Level)
+				{
+					Collapse((uint32)mNodes[i].Parent);
+					changed = true;
+					break;
+				}
+			}
+		}
+	}
+}
+
+void PlanetTerrain::CollectDrawNodes()
+{
+	mDrawNodes.clear();
+	mStats.SelectedNodes = 0;
+	mStats.MissingNodes = 0;
+	for(uint32 i = 0; i < (uint32)mNodes.size(); ++i)
+	{
+		const Node& n = mNodes[i];
+		if(n.FirstChild < 0)
+		{
+			++mStats.SelectedNodes;
+			mStats.MissingNodes += n.InDrawTree ? 0 : 1;
+		}
+		if(!n.InDrawTree || n.DrawSplit || (mHasPlanes && !n.Visible))
+			continue;
+
+		DrawNode draw;
+		draw.Key = n.Key;
+		draw.Face = n.Face;
+		draw.Level = n.Level;
+		draw.Vertices = mCache[n.Key].Vertices.data();
+		draw.StitchMask = 0;
+		draw.Bounds = n.Bounds;
+		for(uint32 edge = 0; edge < 4; ++edge)
+		{
+			if(mNodes[FindNeighbour(n, edge, true)].Level < n.Level)
+				draw.StitchMask |= 1u << edge;
+		}
+		mDrawNodes.push_back(draw);
+	}
+	mStats.DrawNodes = (uint32)mDrawNodes.size();
+}
+
+void PlanetTerrain::TakeFinished()
+{
+	std::vector<Finished> finished;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		finished.swap(mFinished);
+	}
+
+	for(Finished& mesh : finished)
+	{
+		mInFlight.erase(mesh.Key);
+		CachedMesh& cached = mCache[mesh.Key];
+		cached.Vertices = std::move(mesh.Vertices);
+		cached.LastUsed = mFrame;
+		mResidentBytes += mMeshBytes;
+		++mStats.Generated;
+	}
+}
+
+void PlanetTerrain::Dispatch()
+{
+	// Everything in the selection has to be resident before the deepest leaves can be
+	// drawn, coarse levels first, nearest first within a level: sorted by (level,
+	// distance, node).
+	std::vector<std::tuple<uint32, float, uint32>> wanted;
+	for(uint32 i = 0; i < (uint32)mNodes.size(); ++i)
+	{
+		const Node& n = mNodes[i];
+		if(IsResident(n.Key) || mInFlight.count(n.Key) != 0)
+			continue;
+		float distance = Length(Sub(mEye, XMFLOAT3(n.Bounds.x, n.Bounds.y, n.Bounds.z)));
+		wanted.push_back(std::make_tuple(n.Level, distance, i));
+	}
+	std::sort(wanted.begin(), wanted.end());
+
+	uint32 maxInFlight = mDesc.MaxInFlight != 0 ? mDesc.MaxInFlight : 2 * mPool.GetThreadCount();
+	for(const auto& w : wanted)
+	{
+		if(mInFlight.size() >= maxInFlight)
+			break;
+
+		// Make room by dropping the meshes that went unused longest, never ones this
+		// frame needs.
+		while(mResidentBytes + (mInFlight.size() + 1) * mMeshBytes > mDesc.MemoryBudget)
+		{
+			auto oldest = mCache.end();
+			for(auto it = mCache.begin(); it != mCache.end(); ++it)
+			{
+				if(it->second.LastUsed < mFrame && (oldest == mCache.end() || it->second.LastUsed < oldest->second.LastUsed))
+					oldest = it;
+			}
+			if(oldest == mCache.end())
+				break;
+			mCache.erase(oldest);
+			mResidentBytes -= mMeshBytes;
+			++mStats.Evicted;
+		}
+		if(mResidentBytes + (mInFlight.size() + 1) * mMeshBytes > mDesc.MemoryBudget)
+			break;
+
+		uint64 key = mNodes[std::get<2>(w)].Key;
+		mInFlight.insert(key);
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			++mOutstanding;
+		}
+		mPool.Submit([this, key]()
+		{
+			Finished mesh;
+			mesh.Key = key;
+			GenerateMesh(key, mesh.Vertices);
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			mFinished.push_back(std::move(mesh));
+			--mOutstanding;
+			mMeshFinished.notify_all();
+		});
+	}
+}
+
+void PlanetTerrain::Update(const XMFLOAT3& eye, const XMFLOAT4* planes)
+{
+	++mFrame;
+	TakeFinished();
+
+	mEye = eye;
+	mHasPlanes = planes != nullptr;
+	for(int k = 0; k < 6 && mHasPlanes; ++k)
+		mPlanes[k] = planes[k];
+
+	mNodes.clear();
+	for(uint32 face = 0; face < 6; ++face)
+		AddNode(face, 0, 0, 0);
+	for(uint32 i = 0; i < (uint32)mNodes.size(); ++i)
+	{
+		if(WantsSplit(mNodes[i]))
+			Split(i);
+	}
+	BalanceSelection();
+
+	for(uint32 face = 0; face < 6; ++face)
+	{
+		IsResident(mNodes[face].Key);
+		BuildDrawTree(face);
+	}
+	BalanceDrawTree();
+	CollectDrawNodes();
+	Dispatch();
+
+	mStats.ResidentMeshes = (uint32)mCache.size();
+	mStats.ResidentBytes = mResidentBytes;
+	mStats.InFlight = (uint32)mInFlight.size();
+}
+
+void PlanetTerrain::Finish()
+{
+	XMFLOAT3 eye = mEye;
+	XMFLOAT4 planes[6];
+	std::copy(mPlanes, mPlanes + 6, planes);
+	bool hasPlanes = mHasPlanes;
+
+	for(;;)
+	{
+		Update(eye, hasPlanes ? planes : nullptr);
+		if(mInFlight.empty())
+			return;
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		mMeshFinished.wait(lock, [this]() { return !mFinished.empty(); });
+	}
+}
@@ -0,0 +1,213 @@
+//***************************************************************************************
+// PlanetTerrain.h
+//
+// Planet-sized terrain: a cube whose six faces are CreateGrid-like patches, mapped onto
+// a sphere and displaced by a height function.  Each face is the root of a quadtree;
+// every node is an (N+1) x (N+1) grid of vertices covering its quarter of the parent.
+//
+// Update selects the nodes for a viewpoint.  A node splits when the eye is within
+// SplitDistance node widths of its bounds (and, given frustum planes, when it can be
+// seen), and the selection is refined until neighbouring leaves differ by at most one
+// level, across cube faces as well.  Node meshes are generated on the thread pool and
+// kept in a cache under a memory budget, least recently used first out.  What gets
+// drawn is the selection cut back to the nodes whose meshes are resident, rebalanced,
+// so a frame never waits for generation and never shows a hole.
+//
+// Cracks: the cube-to-sphere mapping is evaluated on an integer lattice shared by all
+// levels and faces, so a vertex on a node edge has bit-identical coordinates in every
+// node that has it.  Where a leaf borders a coarser one, its index buffer skips every
+// other vertex along that edge (one of 16 shared stitching index buffers), so both
+// sides use the same triangle edges.
+//
+// Vertices are GeometryGenerator::Vertex: the displaced position, a normal from central
+// differences of the height function, the face's u direction as the tangent, and the
+// position on the cube face, in [0, 1], as texture coordinates.
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+#include "ThreadPool.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class PlanetTerrain
+{
+public:
+
+	using uint16 = std::uint16_t;
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	// Height above the sphere along a unit direction.  Called from worker threads.
+	using HeightFunction = std::function<float(const DirectX::XMFLOAT3& direction)>;
+
+	struct Desc
+	{
+		float Radius = 1000.0f;
+		HeightFunction Height;
+
+		// Bound on |Height|, used for the node bounds.
+		float MaxHeight = 0.0f;
+
+		// Cells along each node edge; even, at most 254.
+		uint32 GridSize = 32;
+
+		// Deepest quadtree level; at most 20.
+		uint32 MaxLevel = 12;
+
+		// A node splits when the eye is closer to its bounds than this many node widths.
+		float SplitDistance = 2.0f;
+
+		// Bytes of cached node vertices, including meshes being generated.  The six
+		// face roots are always kept.
+		uint64 MemoryBudget = 64ull << 20;
+
+		// Node meshes generated at once; 0 for two per pool thread.
+		uint32 MaxInFlight = 0;
+	};
+
+	// Stitching bits: the node edge borders a coarser node.
+	enum Edge : uint32
+	{
+		EdgeUMin = 1,
+		EdgeUMax = 2,
+		EdgeVMin = 4,
+		EdgeVMax = 8
+	};
+
+	struct DrawNode
+	{
+		uint64 Key;
+		uint32 Face;
+		uint32 Level;
+
+		// GetNodeVertexCount() vertices, valid until the next Update.
+		const GeometryGenerator::Vertex* Vertices;
+
+		// Which GetIndices() variant to draw with.
+		uint32 StitchMask;
+
+		// Bounding sphere: center xyz, radius w.
+		DirectX::XMFLOAT4 Bounds;
+	};
+
+	struct Stats
+	{
+		uint32 SelectedNodes = 0;      // leaves of the selection
+		uint32 DrawNodes = 0;          // leaves drawn this frame (after frustum culling)
+		uint32 MissingNodes = 0;       // selected leaves drawn coarser for now
+		uint32 ResidentMeshes = 0;
+		uint32 InFlight = 0;
+		uint64 ResidentBytes = 0;
+		uint64 Generated = 0;          // totals since construction
+		uint64 Evicted = 0;
+	};
+
+	///<summary>
+	/// Generates the six face roots before returning.  pool must outlive the terrain.
+	///</summary>
+	PlanetTerrain(ThreadPool& pool, const Desc& desc);
+	PlanetTerrain(const PlanetTerrain& rhs) = delete;
+	PlanetTerrain& operator=(const PlanetTerrain& rhs) = delete;
+	~PlanetTerrain();
+
+	///<summary>
+	/// Takes in finished meshes, selects the nodes for eye and queues the missing ones
+	/// for generation without waiting for them.  planes are six inward-facing, normalized
+	/// frustum planes (such as OrbitCamera::GetFrustumPlanes), or nullptr to keep every
+	/// node; nodes outside the frustum are neither refined nor drawn.
+	///</summary>
+	void Update(const DirectX::XMFLOAT3& eye, const DirectX::XMFLOAT4* planes = nullptr);
+
+	///<summary>
+	/// Repeats Update for the same view until every selected node is drawn at its own
+	/// level, or the memory budget stops generation.
+	///</summary>
+	void Finish();
+
+	const std::vector<DrawNode>& GetDrawNodes()const { return mDrawNodes; }
+	const Stats& GetStats()const { return mStats; }
+
+	uint32 GetNodeVertexCount()const { return (mDesc.GridSize + 1) * (mDesc.GridSize + 1); }
+	const std::vector<uint16>& GetIndices(uint32 stitchMask)const { return mIndices[stitchMask]; }
+
+	///<summary>
+	/// The unit direction of a point on the cube [-1, 1]^3, spread so that equal steps on
+	/// a face cover nearly equal areas of the sphere.
+	///</summary>
+	static DirectX::XMFLOAT3 CubeToSphere(float x, float y, float z);
+
+private:
+	struct Node
+	{
+		uint64 Key;
+		uint32 Face;
+		uint32 Level;
+		uint32 X;
+		uint32 Y;
+		int Parent;
+		int FirstChild;         // of the selection; -1 for a leaf
+		bool InDrawTree;
+		bool DrawSplit;         // the drawn tree uses the children
+		bool Visible;
+		DirectX::XMFLOAT4 Bounds;
+	};
+
+	struct CachedMesh
+	{
+		std::vector<GeometryGenerator::Vertex> Vertices;
+		uint64 LastUsed = 0;
+	};
+
+	struct Finished
+	{
+		uint64 Key;
+		std::vector<GeometryGenerator::Vertex> Vertices;
+	};
+
+	uint32 AddNode(uint32 face, uint32 level, uint32 x, uint32 y);
+	void Split(uint32 node);
+	void Collapse(uint32 node);
+	bool WantsSplit(const Node& node)const;
+	uint32 FindLeaf(uint32 face, double s, double t, bool drawn)const;
+	uint32 FindNeighbour(const Node& node, uint32 edge, bool drawn)const;
+	bool IsResident(uint64 key);
+	void BuildDrawTree(uint32 node);
+	void BalanceSelection();
+	void BalanceDrawTree();
+	void CollectDrawNodes();
+	void Dispatch();
+	void TakeFinished();
+	void GenerateMesh(uint64 key, std::vector<GeometryGenerator::Vertex>& vertices)const;
+	void BuildIndices();
+
+	ThreadPool& mPool;
+	Desc mDesc;
+	uint64 mMeshBytes = 0;
+	std::vector<uint16> mIndices[16];
+
+	// Main thread only.
+	std::unordered_map<uint64, CachedMesh> mCache;
+	std::vector<Node> mNodes;
+	std::vector<DrawNode> mDrawNodes;
+	DirectX::XMFLOAT3 mEye = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+	DirectX::XMFLOAT4 mPlanes[6];
+	bool mHasPlanes = false;
+	uint64 mFrame = 0;
+	uint64 mResidentBytes = 0;
+	std::unordered_set<uint64> mInFlight;
+	Stats mStats;
+
+	// Shared with the workers.
+	std::mutex mMutex;
+	std::condition_variable mMeshFinished;
+	std::vector<Finished> mFinished;
+	uint32 mOutstanding = 0;
+};
@@ -0,0 +1,103 @@
+//***************************************************************************************
+// PolyhedronTables.cpp
+//***************************************************************************************
+
+#include "PolyhedronTables.h"
+
+#include <cassert>
+
+using namespace DirectX;
+
+namespace PolyhedronTables
+{
+	namespace
+	{
+		// Evaluated by the compiler; only the finished tables end up in the binary.
+		constexpr auto kBox0 = Box();
+		constexpr auto kBox1 = Subdivide(kBox0);
+		constexpr auto kBox2 = Subdivide(kBox1);
+
+		constexpr auto kWedge0 = Wedge();
+		constexpr auto kWedge1 = Subdivide(kWedge0);
+		constexpr auto kWedge2 = Subdivide(kWedge1);
+
+		constexpr auto kPyramid0 = Pyramid();
+		constexpr auto kPyramid1 = Subdivide(kPyramid0);
+		constexpr auto kPyramid2 = Subdivide(kPyramid1);
+
+		constexpr auto kDiamond0 = Diamond();
+		constexpr auto kDiamond1 = Subdivide(kDiamond0);
+		constexpr auto kDiamond2 = Subdivide(kDiamond1);
+
+		constexpr auto kTriPrism0 = TriPrism();
+		constexpr auto kTriPrism1 = Subdivide(kTriPrism0);
+		constexpr auto kTriPrism2 = Subdivide(kTriPrism1);
+
+		template<typename T>
+		constexpr TableView View(const T& table)
+		{
+			return { table.Vertices, T::GetVertexCount(), table.Indices, T::GetIndexCount() };
+		}
+
+		const TableView kTables[(int)Shape::Count][MaxTableLevel + 1] =
+		{
+			{ View(kBox0), View(kBox1), View(kBox2) },
+			{ View(kWedge0), View(kWedge1), View(kWedge2) },
+			{ View(kPyramid0), View(kPyramid1), View(kPyramid2) },
+			{ View(kDiamond0), View(kDiamond1), View(kDiamond2) },
+			{ View(kTriPrism0), View(kTriPrism1), View(kTriPrism2) },
+		};
+	}
+
+	TableView GetTable(Shape shape, uint32 level)
+	{
+		assert(shape < Shape::Count && level <= MaxTableLevel);
+		return kTables[(int)shape][level];
+	}
+
+	void ScaleVertices(const UnitVertex* src, uint32 count, float width, float height, float depth,
+		GeometryGenerator::Vertex* dst)
+	{
+		// A vertex is 11 floats with the position first, so four vertices are exactly
+		// eleven 16-byte blocks and the per-block scale factors repeat every four.
+		XMVECTOR scale[11];
+		{
+			float s[44];
+			for(int i = 0; i < 44; ++i)
+				s[i] = 1.0f;
+			for(int v = 0; v < 4; ++v)
+			{
+				s[v * 11 + 0] = width;
+				s[v * 11 + 1] = height;
+				s[v * 11 + 2] = depth;
+			}
+			for(int i = 0; i < 11; ++i)
+				scale[i] = XMLoadFloat4((const XMFLOAT4*)&s[i * 4]);
+		}
+
+		const float* in = src[0].Position;
+		float* out = &dst[0].Position.x;
+
+		uint32 quads = count / 4;
+		for(uint32 q = 0; q < quads; ++q)
+		{
+			for(int i = 0; i < 11; ++i)
+			{
+				XMVECTOR v = XMLoadFloat4((const XMFLOAT4*)(in + i * 4));
+				XMStoreFloat4((XMFLOAT4*)(out + i * 4), XMVectorMultiply(v, scale[i]));
+			}
+			in += 44;
+			out += 44;
+		}
+
+		for(uint32 v = quads * 4; v < count; ++v)
+		{
+			const UnitVertex& u = src[v];
+			GeometryGenerator::Vertex& d = dst[v];
+			d.Position = XMFLOAT3(u.Position[0] * width, u.Position[1] * height, u.Position[2] * depth);
+			d.Normal = XMFLOAT3(u.Normal[0], u.Normal[1], u.Normal[2]);
+			d.TangentU = XMFLOAT3(u.TangentU[0], u.TangentU[1], u.TangentU[2]);
+			d.TexC = XMFLOAT2(u.TexC[0], u.TexC[1]);
+		}
+	}
+}
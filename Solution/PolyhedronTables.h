@@ -0,0 +1,351 @@
+//***************************************************************************************
+// PolyhedronTables.h
+//
+// Vertex and index tables of the fixed-topology GeometryGenerator shapes (box, wedge,
+// pyramid, diamond and tri-prism), built at compile time for a unit-size shape and
+// for the first few subdivision levels.  Every position of these shapes is linear in
+// width, height and depth, and subdivision only takes midpoints, so a shape of any
+// size is its unit table scaled per axis.  Normals, tangents and texture coordinates
+// do not depend on the size.
+//
+// Level 0 scaled is bit for bit what the runtime builders gave.  Subdivided levels are
+// not: they take midpoints before scaling rather than after, and the constexpr tables
+// normalize in double, so they agree with runtime subdivision to within 2 ulps of the
+// shape's size for positions and of 1 for the other attributes (PolyhedronTablesTest).
+//
+// At runtime ScaleVertices is the only work: one SIMD multiply per 16 bytes of vertex
+// data, written into memory the caller provides.
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PolyhedronTables
+{
+	using uint32 = std::uint32_t;
+
+	enum class Shape
+	{
+		Box,
+		Wedge,
+		Pyramid,
+		Diamond,
+		TriPrism,
+		Count
+	};
+
+	// Subdivision levels that have a precomputed table.  Deeper levels start from the
+	// deepest table and subdivide at runtime.
+	const uint32 MaxTableLevel = 2;
+
+	// Same memory layout as GeometryGenerator::Vertex, but constexpr-constructible.
+	struct UnitVertex
+	{
+		float Position[3];
+		float Normal[3];
+		float TangentU[3];
+		float TexC[2];
+	};
+
+	static_assert(sizeof(UnitVertex) == sizeof(GeometryGenerator::Vertex), "UnitVertex must match GeometryGenerator::Vertex");
+	static_assert(offsetof(UnitVertex, Normal) == offsetof(GeometryGenerator::Vertex, Normal), "UnitVertex must match GeometryGenerator::Vertex");
+	static_assert(offsetof(UnitVertex, TexC) == offsetof(GeometryGenerator::Vertex, TexC), "UnitVertex must match GeometryGenerator::Vertex");
+
+	template<std::size_t VertexCount, std::size_t IndexCount>
+	struct Table
+	{
+		UnitVertex Vertices[VertexCount] = {};
+		uint32 Indices[IndexCount] = {};
+
+		static constexpr uint32 GetVertexCount() { return (uint32)VertexCount; }
+		static constexpr uint32 GetIndexCount() { return (uint32)IndexCount; }
+	};
+
+	namespace Detail
+	{
+		// Newton's method from above, which decreases until it converges.
+		constexpr double Sqrt(double x)
+		{
+			double r = x > 1.0 ? x : 1.0;
+			for(int i = 0; i < 64; ++i)
+			{
+				double next = 0.5 * (r + x / r);
+				if(next >= r)
+					break;
+				r = next;
+			}
+			return r;
+		}
+
+		constexpr void Normalized(const float* a, const float* b, float* out)
+		{
+			double v[3] = { 0.5 * ((double)a[0] + b[0]), 0.5 * ((double)a[1] + b[1]), 0.5 * ((double)a[2] + b[2]) };
+			double lengthSq = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+
+			// Opposite vectors average to zero, which XMVector3Normalize leaves as zero.
+			double scale = lengthSq > 0.0 ? 1.0 / Sqrt(lengthSq) : 0.0;
+			for(int i = 0; i < 3; ++i)
+				out[i] = (float)(v[i] * scale);
+		}
+
+		// Same as GeometryGenerator::MidPoint.
+		constexpr UnitVertex MidPoint(const UnitVertex& v0, const UnitVertex& v1)
+		{
+			UnitVertex m = {};
+			for(int i = 0; i < 3; ++i)
+				m.Position[i] = 0.5f * (v0.Position[i] + v1.Position[i]);
+			Normalized(v0.Normal, v1.Normal, m.Normal);
+			Normalized(v0.TangentU, v1.TangentU, m.TangentU);
+			for(int i = 0; i < 2; ++i)
+				m.TexC[i] = 0.5f * (v0.TexC[i] + v1.TexC[i]);
+			return m;
+		}
+
+		constexpr UnitVertex V(float px, float py, float pz, float nx, float ny, float nz,
+			float tx, float ty, float tz, float u, float v)
+		{
+			return { { px, py, pz }, { nx, ny, nz }, { tx, ty, tz }, { u, v } };
+		}
+	}
+
+	///<summary>
+	/// One level of GeometryGenerator::Subdivide: every triangle becomes six vertices
+	/// and four triangles, in the same order.
+	///</summary>
+	template<std::size_t VertexCount, std::size_t IndexCount>
+	constexpr Table<IndexCount * 2, IndexCount * 4> Subdivide(const Table<VertexCount, IndexCount>& in)
+	{
+		Table<IndexCount * 2, IndexCount * 4> out;
+		for(std::size_t t = 0; t < IndexCount / 3; ++t)
+		{
+			const UnitVertex& v0 = in.Vertices[in.Indices[t * 3 + 0]];
+			const UnitVertex& v1 = in.Vertices[in.Indices[t * 3 + 1]];
+			const UnitVertex& v2 = in.Vertices[in.Indices[t * 3 + 2]];
+
+			UnitVertex* v = &out.Vertices[t * 6];
+			v[0] = v0;
+			v[1] = v1;
+			v[2] = v2;
+			v[3] = Detail::MidPoint(v0, v1);
+			v[4] = Detail::MidPoint(v1, v2);
+			v[5] = Detail::MidPoint(v0, v2);
+
+			const uint32 pattern[12] = { 0, 3, 5, 3, 4, 5, 5, 4, 2, 3, 1, 4 };
+			for(std::size_t i = 0; i < 12; ++i)
+				out.Indices[t * 12 + i] = (uint32)(t * 6) + pattern[i];
+		}
+		return out;
+	}
+
+	// Unit-size (width = height = depth = 1) level 0 shapes.  Scaled, they are the
+	// runtime builders' level 0 shapes bit for bit.
+
+	constexpr Table<24, 36> Box()
+	{
+		using Detail::V;
+		const float h = 0.5f;
+		return {
+			{
+				V(-h, -h, -h, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+				V(-h, +h, -h, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+				V(+h, +h, -h, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+				V(+h, -h, -h, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+
+				V(-h, -h, +h, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(+h, -h, +h, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+				V(+h, +h, +h, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+				V(-h, +h, +h, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+
+				V(-h, +h, -h, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+				V(-h, +h, +h, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+				V(+h, +h, +h, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+				V(+h, +h, -h, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+
+				V(-h, -h, -h, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(+h, -h, -h, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+				V(+h, -h, +h, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+				V(-h, -h, +h, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+
+				V(-h, -h, +h, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f),
+				V(-h, +h, +h, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f),
+				V(-h, +h, -h, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f),
+				V(-h, -h, -h, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f),
+
+				V(+h, -h, -h, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f),
+				V(+h, +h, -h, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f),
+				V(+h, +h, +h, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f),
+				V(+h, -h, +h, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f),
+			},
+			{
+				0, 1, 2, 0, 2, 3,
+				4, 5, 6, 4, 6, 7,
+				8, 9, 10, 8, 10, 11,
+				12, 13, 14, 12, 14, 15,
+				16, 17, 18, 16, 18, 19,
+				20, 21, 22, 20, 22, 23,
+			}
+		};
+	}
+
+	// The wedge and the tri-prism share their topology; the tri-prism is twice as wide.
+	constexpr Table<18, 24> Wedge(float halfWidth = 0.5f)
+	{
+		using Detail::V;
+		const float w = halfWidth;
+		const float h = 0.5f;
+		return {
+			{
+				V(-w, -h, -h, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+				V(-w, +h, +h, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+				V(+w, +h, +h, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+				V(+w, -h, -h, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+
+				V(-w, -h, +h, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(+w, -h, +h, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+				V(+w, +h, +h, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+				V(-w, +h, +h, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+
+				V(-w, -h, -h, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(+w, -h, -h, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+				V(+w, -h, +h, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+				V(-w, -h, +h, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+
+				V(-w, -h, +h, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f),
+				V(-w, +h, +h, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f),
+				V(-w, -h, -h, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f),
+
+				V(+w, -h, -h, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f),
+				V(+w, +h, +h, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f),
+				V(+w, -h, +h, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f),
+			},
+			{
+				0, 1, 2, 0, 2, 3,
+				4, 5, 6, 4, 6, 7,
+				8, 9, 10, 8, 10, 11,
+				12, 13, 14,
+				15, 16, 17,
+			}
+		};
+	}
+
+	constexpr Table<18, 24> TriPrism()
+	{
+		return Wedge(1.0f);
+	}
+
+	constexpr Table<16, 18> Pyramid()
+	{
+		using Detail::V;
+		const float h = 0.5f;
+		return {
+			{
+				V(0.0f, +h, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(-h, -h, -h, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+				V(+h, -h, -h, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+
+				V(0.0f, +h, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(+h, -h, +h, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+				V(-h, -h, +h, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+
+				V(0.0f, +h, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(-h, -h, +h, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f),
+				V(-h, -h, -h, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f),
+
+				V(0.0f, +h, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(+h, -h, -h, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f),
+				V(+h, -h, +h, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f),
+
+				V(-h, -h, -h, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(+h, -h, -h, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+				V(+h, -h, +h, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+				V(-h, -h, +h, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+			},
+			{
+				0, 2, 1,
+				2, 3, 4,
+				4, 6, 5,
+				6, 8, 7,
+				5, 1, 2, 2, 4, 5,
+			}
+		};
+	}
+
+	constexpr Table<24, 24> Diamond()
+	{
+		using Detail::V;
+		const float h = 0.5f;
+		const float b = -1.0f;
+		return {
+			{
+				V(0.0f, +h, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(-h, -h, -h, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+				V(+h, -h, -h, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+
+				V(0.0f, +h, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(+h, -h, +h, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+				V(-h, -h, +h, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+
+				V(0.0f, +h, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(-h, -h, +h, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f),
+				V(-h, -h, -h, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f),
+
+				V(0.0f, +h, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(+h, -h, -h, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f),
+				V(+h, -h, +h, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f),
+
+				V(0.0f, b, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(-h, -h, -h, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+				V(+h, -h, -h, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+
+				V(0.0f, b, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(+h, -h, +h, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+				V(-h, -h, +h, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+
+				V(0.0f, b, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(-h, -h, +h, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f),
+				V(-h, -h, -h, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f),
+
+				V(0.0f, b, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				V(+h, -h, -h, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f),
+				V(+h, -h, +h, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f),
+			},
+			{
+				0, 2, 1,
+				2, 3, 4,
+				4, 6, 5,
+				6, 8, 7,
+				8, 12, 7,
+				12, 10, 11,
+				12, 13, 14,
+				7, 12, 11,
+			}
+		};
+	}
+
+	// A table picked at runtime.
+	struct TableView
+	{
+		const UnitVertex* Vertices = nullptr;
+		uint32 VertexCount = 0;
+		const uint32* Indices = nullptr;
+		uint32 IndexCount = 0;
+	};
+
+	///<summary>
+	/// The precomputed table of shape at the given subdivision level (at most
+	/// MaxTableLevel).
+	///</summary>
+	TableView GetTable(Shape shape, uint32 level);
+
+	///<summary>
+	/// Writes count vertices of a unit table into dst with the positions scaled by
+	/// (width, height, depth).  dst may be any caller-owned memory of count vertices,
+	/// e.g. MeshData::Vertices or a mapped upload buffer.
+	///</summary>
+	void ScaleVertices(const UnitVertex* src, uint32 count, float width, float height, float depth,
+		GeometryGenerator::Vertex* dst);
+}
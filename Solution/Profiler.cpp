@@ -0,0 +1,171 @@
+//***************************************************************************************
+// Profiler.cpp
+//***************************************************************************************
+
+#include "Profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILER_HAS_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_HAS_RDTSC 1
+#else
+#define PROFILER_HAS_RDTSC 0
+#endif
+
+namespace Profiler
+{
+	namespace
+	{
+		struct Event
+		{
+			const char* Name;
+			uint64 Start;
+			uint64 End;
+		};
+
+		// Written only by its own thread.  Count is published with release semantics
+		// so the exporter sees complete events.
+		struct ThreadBuffer
+		{
+			std::vector<Event> Events = std::vector<Event>(RingCapacity);
+			std::atomic<uint64> Count{ 0 };
+			std::uint32_t ThreadId = 0;
+			std::string Name;
+		};
+
+		// Buffers outlive their threads, so events of finished workers still export.
+		struct Registry
+		{
+			std::mutex Mutex;
+			std::vector<std::unique_ptr<ThreadBuffer>> Buffers;
+
+			// Reference points for converting ticks to microseconds.
+			uint64 StartTicks;
+			std::chrono::steady_clock::time_point StartTime;
+
+			Registry();
+		};
+
+		uint64 ReadTicks()
+		{
+#if PROFILER_HAS_RDTSC
+			return __rdtsc();
+#else
+			return (uint64)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+		}
+
+		Registry::Registry()
+			: StartTicks(ReadTicks()), StartTime(std::chrono::steady_clock::now())
+		{
+		}
+
+		Registry& GetRegistry()
+		{
+			static Registry registry;
+			return registry;
+		}
+
+		ThreadBuffer& GetThreadBuffer()
+		{
+			thread_local ThreadBuffer* buffer = nullptr;
+			if(buffer == nullptr)
+			{
+				Registry& registry = GetRegistry();
+				std::lock_guard<std::mutex> lock(registry.Mutex);
+
+				registry.Buffers.push_back(std::make_unique<ThreadBuffer>());
+				buffer = registry.Buffers.back().get();
+				buffer->ThreadId = (std::uint32_t)registry.Buffers.size();
+			}
+			return *buffer;
+		}
+
+		void WriteEscaped(std::FILE* file, const char* text)
+		{
+			for(; *text != '\0'; ++text)
+			{
+				if(*text == '"' || *text == '\\')
+					std::fputc('\\', file);
+				std::fputc(*text, file);
+			}
+		}
+	}
+
+	uint64 Now()
+	{
+		return ReadTicks();
+	}
+
+	void Record(const char* name, uint64 start, uint64 end)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+		uint64 count = buffer.Count.load(std::memory_order_relaxed);
+		buffer.Events[count % RingCapacity] = { name, start, end };
+		buffer.Count.store(count + 1, std::memory_order_release);
+	}
+
+	void SetThreadName(const char* name)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+		std::lock_guard<std::mutex> lock(GetRegistry().Mutex);
+		buffer.Name = name;
+	}
+
+	bool WriteChromeTrace(const char* path)
+	{
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.Mutex);
+
+		// Calibrate ticks against the steady clock over the whole recording.
+		uint64 ticks = ReadTicks() - registry.StartTicks;
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - registry.StartTime).count();
+		double usPerTick = ticks > 0 ? seconds * 1e6 / (double)ticks : 0.0;
+
+		std::FILE* file = std::fopen(path, "w");
+		if(file == nullptr)
+			return false;
+
+		std::fprintf(file, "{\"traceEvents\":[\n");
+		bool first = true;
+		for(const auto& buffer : registry.Buffers)
+		{
+			if(!buffer->Name.empty())
+			{
+				std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"",
+					first ? "" : ",\n", buffer->ThreadId);
+				WriteEscaped(file, buffer->Name.c_str());
+				std::fprintf(file, "\"}}");
+				first = false;
+			}
+
+			uint64 count = buffer->Count.load(std::memory_order_acquire);
+			uint64 begin = count > RingCapacity ? count - RingCapacity : 0;
+			for(uint64 i = begin; i < count; ++i)
+			{
+				const Event& e = buffer->Events[i % RingCapacity];
+				// Zones can start just before the registry is created, so keep the sign.
+				double ts = (double)(std::int64_t)(e.Start - registry.StartTicks) * usPerTick;
+				double dur = (double)(e.End - e.Start) * usPerTick;
+
+				std::fprintf(file, "%s{\"name\":\"", first ? "" : ",\n");
+				WriteEscaped(file, e.Name);
+				std::fprintf(file, "\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", buffer->ThreadId, ts, dur);
+				first = false;
+			}
+		}
+		std::fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+		return std::fclose(file) == 0;
+	}
+}
@@ -0,0 +1,74 @@
+//***************************************************************************************
+// Profiler.h
+//
+// Lightweight scoped-zone CPU profiler.  PROFILE_SCOPE("Name") records the start and
+// end timestamp of the enclosing scope into a ring buffer owned by the calling thread,
+// so recording takes no locks and, once the ring is full, keeps the most recent
+// events.  Timestamps come from rdtsc where available.  WriteChromeTrace() exports
+// everything recorded as Chrome trace JSON (chrome://tracing, Perfetto).
+//
+// Build with PROFILER_ENABLED=0 to compile every PROFILE_SCOPE away.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+#include <cstdint>
+
+namespace Profiler
+{
+	using uint64 = std::uint64_t;
+
+	// Events kept per thread before the oldest are overwritten.
+	const std::uint32_t RingCapacity = 1 << 16;
+
+	///<summary>
+	/// Current timestamp in profiler ticks.
+	///</summary>
+	uint64 Now();
+
+	///<summary>
+	/// Records one completed zone for the calling thread.  name must outlive the
+	/// profiler; string literals are the intended use.
+	///</summary>
+	void Record(const char* name, uint64 start, uint64 end);
+
+	///<summary>
+	/// Names the calling thread in exported traces.
+	///</summary>
+	void SetThreadName(const char* name);
+
+	///<summary>
+	/// Writes the recorded events of every thread to path as Chrome trace JSON.  Call
+	/// it while the profiled threads are idle, e.g. between frames or at shutdown.
+	/// Returns false if the file can't be written.
+	///</summary>
+	bool WriteChromeTrace(const char* path);
+
+	// Records the lifetime of the enclosing scope.
+	class Scope
+	{
+	public:
+		explicit Scope(const char* name) : mName(name), mStart(Now()) {}
+		~Scope() { Record(mName, mStart, Now()); }
+
+		Scope(const Scope& rhs) = delete;
+		Scope& operator=(const Scope& rhs) = delete;
+
+	private:
+		const char* mName;
+		uint64 mStart;
+	};
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILER_ENABLED
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
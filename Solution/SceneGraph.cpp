@@ -0,0 +1,235 @@
+//***************************************************************************************
+// SceneGraph.cpp
+//***************************************************************************************
+
+#include "SceneGraph.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+using namespace DirectX;
+
+SceneGraph::NodeHandle SceneGraph::CreateNode(NodeHandle parent, const XMFLOAT4X4& local)
+{
+	return CreateNode(parent, XMLoadFloat4x4(&local));
+}
+
+SceneGraph::NodeHandle XM_CALLCONV SceneGraph::CreateNode(NodeHandle parent, FXMMATRIX local)
+{
+	uint32 parentSlot = InvalidNode;
+	uint32 depth = 0;
+	if(parent != InvalidNode)
+	{
+		assert(parent < mHandleToSlot.size());
+		parentSlot = mHandleToSlot[parent];
+		depth = mDepth[parentSlot] + 1;
+	}
+
+	NodeHandle handle = (NodeHandle)mHandleToSlot.size();
+	uint32 slot = (uint32)mSlotToHandle.size();
+
+	// Appending keeps the slots depth sorted unless the new node is shallower than
+	// the deepest level; in that case the arrays are re-sorted by the next Update().
+	if(!mOrderDirty)
+	{
+		if(mLevelStart.empty())
+			mLevelStart = { 0, 1 };
+		else if(depth + 1 == GetDepthCount())
+			mLevelStart.back()++;
+		else if(depth == GetDepthCount())
+			mLevelStart.push_back(mLevelStart.back() + 1);
+		else
+			mOrderDirty = true;
+	}
+
+	mLocal.emplace_back();
+	mWorld.emplace_back();
+	XMStoreFloat4x4A(&mLocal.back(), local);
+	XMStoreFloat4x4A(&mWorld.back(), local);
+	mParent.push_back(parentSlot);
+	mDepth.push_back(depth);
+	mDirty.push_back(0);
+	mChangedStamp.push_back(0);
+
+	mHandleToSlot.push_back(slot);
+	mSlotToHandle.push_back(handle);
+
+	SetLocal(handle, local);
+
+	return handle;
+}
+
+void SceneGraph::SetLocal(NodeHandle node, const XMFLOAT4X4& local)
+{
+	SetLocal(node, XMLoadFloat4x4(&local));
+}
+
+void XM_CALLCONV SceneGraph::SetLocal(NodeHandle node, FXMMATRIX local)
+{
+	uint32 slot = mHandleToSlot[node];
+	XMStoreFloat4x4A(&mLocal[slot], local);
+
+	if(!mDirty[slot])
+	{
+		mDirty[slot] = 1;
+
+		uint32 depth = mDepth[slot];
+		if(mDirtyCount == 0)
+		{
+			mMinDirtyDepth = depth;
+			mMaxDirtyDepth = depth;
+		}
+		else
+		{
+			mMinDirtyDepth = std::min(mMinDirtyDepth, depth);
+			mMaxDirtyDepth = std::max(mMaxDirtyDepth, depth);
+		}
+		++mDirtyCount;
+	}
+}
+
+const XMFLOAT4X4& SceneGraph::GetLocal(NodeHandle node)const
+{
+	return mLocal[mHandleToSlot[node]];
+}
+
+const XMFLOAT4X4& SceneGraph::GetWorld(NodeHandle node)const
+{
+	return mWorld[mHandleToSlot[node]];
+}
+
+bool SceneGraph::WorldChanged(NodeHandle node)const
+{
+	return mUpdateStamp != 0 && mChangedStamp[mHandleToSlot[node]] == mUpdateStamp;
+}
+
+SceneGraph::uint32 SceneGraph::Update(ThreadPool* pool)
+{
+	if(mOrderDirty)
+		SortByDepth();
+
+	++mUpdateStamp;
+
+	if(mDirtyCount == 0)
+		return 0;
+
+	// Levels above the shallowest dirty node cannot change.  Below the deepest dirty
+	// node a level only changes if its parent level did, so stop at the first quiet one.
+	const uint32 kBatchSize = 2048;
+	uint32 recomputed = 0;
+	uint32 depthCount = GetDepthCount();
+	for(uint32 depth = mMinDirtyDepth; depth < depthCount; ++depth)
+	{
+		uint32 levelBegin = mLevelStart[depth];
+		uint32 levelEnd = mLevelStart[depth + 1];
+		uint32 levelRecomputed = 0;
+
+		if(pool != nullptr && levelEnd - levelBegin >= 2 * kBatchSize)
+		{
+			std::atomic<uint32> counter{ 0 };
+			pool->ParallelFor(levelEnd - levelBegin, kBatchSize, [&](uint32 begin, uint32 end)
+			{
+				uint32 n = UpdateRange(levelBegin + begin, levelBegin + end);
+				counter.fetch_add(n, std::memory_order_relaxed);
+			});
+			levelRecomputed = counter.load();
+		}
+		else
+		{
+			levelRecomputed = UpdateRange(levelBegin, levelEnd);
+		}
+
+		recomputed += levelRecomputed;
+
+		if(levelRecomputed == 0 && depth >= mMaxDirtyDepth)
+			break;
+	}
+
+	mDirtyCount = 0;
+
+	return recomputed;
+}
+
+SceneGraph::uint32 SceneGraph::UpdateRange(uint32 begin, uint32 end)
+{
+	uint32 recomputed = 0;
+	for(uint32 i = begin; i < end; ++i)
+	{
+		uint32 parent = mParent[i];
+		bool parentChanged = parent != InvalidNode && mChangedStamp[parent] == mUpdateStamp;
+
+		if(!mDirty[i] && !parentChanged)
+			continue;
+
+		XMMATRIX local = XMLoadFloat4x4A(&mLocal[i]);
+		if(parent == InvalidNode)
+		{
+			XMStoreFloat4x4A(&mWorld[i], local);
+		}
+		else
+		{
+			XMMATRIX parentWorld = XMLoadFloat4x4A(&mWorld[parent]);
+			XMStoreFloat4x4A(&mWorld[i], XMMatrixMultiply(local, parentWorld));
+		}
+
+		mDirty[i] = 0;
+		mChangedStamp[i] = mUpdateStamp;
+		++recomputed;
+	}
+
+	return recomputed;
+}
+
+void SceneGraph::SortByDepth()
+{
+	uint32 nodeCount = GetNodeCount();
+
+	uint32 depthCount = 0;
+	for(uint32 depth : mDepth)
+		depthCount = std::max(depthCount, depth + 1);
+
+	// Counting sort by depth.  It is stable, so siblings keep their creation order.
+	mLevelStart.assign(depthCount + 1, 0);
+	for(uint32 depth : mDepth)
+		mLevelStart[depth + 1]++;
+	for(uint32 d = 0; d < depthCount; ++d)
+		mLevelStart[d + 1] += mLevelStart[d];
+
+	std::vector<uint32> cursor(mLevelStart.begin(), mLevelStart.end() - 1);
+	std::vector<uint32> newSlot(nodeCount);
+	for(uint32 i = 0; i < nodeCount; ++i)
+		newSlot[i] = cursor[mDepth[i]]++;
+
+	std::vector<XMFLOAT4X4A> local(nodeCount);
+	std::vector<XMFLOAT4X4A> world(nodeCount);
+	std::vector<uint32> parent(nodeCount);
+	std::vector<uint32> depth(nodeCount);
+	std::vector<std::uint8_t> dirty(nodeCount);
+	std::vector<uint32> changedStamp(nodeCount);
+	std::vector<NodeHandle> slotToHandle(nodeCount);
+
+	for(uint32 i = 0; i < nodeCount; ++i)
+	{
+		uint32 s = newSlot[i];
+		local[s] = mLocal[i];
+		world[s] = mWorld[i];
+		parent[s] = mParent[i] == InvalidNode ? InvalidNode : newSlot[mParent[i]];
+		depth[s] = mDepth[i];
+		dirty[s] = mDirty[i];
+		changedStamp[s] = mChangedStamp[i];
+		slotToHandle[s] = mSlotToHandle[i];
+		mHandleToSlot[mSlotToHandle[i]] = s;
+	}
+
+	mLocal.swap(local);
+	mWorld.swap(world);
+	mParent.swap(parent);
+	mDepth.swap(depth);
+	mDirty.swap(dirty);
+	mChangedStamp.swap(changedStamp);
+	mSlotToHandle.swap(slotToHandle);
+
+	mOrderDirty = false;
+}
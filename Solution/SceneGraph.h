@@ -0,0 +1,89 @@
+//***************************************************************************************
+// SceneGraph.h
+//
+// Parent/child transform hierarchy stored as flat arrays sorted by depth, so every
+// parent is updated before its children and each depth level can be updated in
+// parallel.  Local transforms are marked dirty when they change and Update() only
+// recomputes the world matrices of dirty nodes and their descendants.
+//
+// Matrices follow the DirectXMath row-vector convention: World = Local * ParentWorld.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <DirectXMath.h>
+#include <vector>
+
+class ThreadPool;
+
+class SceneGraph
+{
+public:
+
+	using uint32 = std::uint32_t;
+	using NodeHandle = std::uint32_t;
+
+	static const NodeHandle InvalidNode = 0xffffffff;
+
+	///<summary>
+	/// Adds a node below parent (or a root node if parent is InvalidNode).  The node
+	/// starts dirty so its world matrix is computed by the next Update().
+	///</summary>
+	NodeHandle CreateNode(NodeHandle parent, const DirectX::XMFLOAT4X4& local);
+	NodeHandle XM_CALLCONV CreateNode(NodeHandle parent, DirectX::FXMMATRIX local);
+
+	///<summary>
+	/// Replaces the local transform and marks the node's subtree for recomputation.
+	///</summary>
+	void SetLocal(NodeHandle node, const DirectX::XMFLOAT4X4& local);
+	void XM_CALLCONV SetLocal(NodeHandle node, DirectX::FXMMATRIX local);
+
+	const DirectX::XMFLOAT4X4& GetLocal(NodeHandle node)const;
+	const DirectX::XMFLOAT4X4& GetWorld(NodeHandle node)const;
+
+	///<summary>
+	/// True if the node's world matrix was recomputed by the most recent Update().
+	///</summary>
+	bool WorldChanged(NodeHandle node)const;
+
+	uint32 GetNodeCount()const { return (uint32)mSlotToHandle.size(); }
+	uint32 GetDepthCount()const { return mLevelStart.empty() ? 0 : (uint32)mLevelStart.size() - 1; }
+
+	///<summary>
+	/// Propagates dirty local transforms down the hierarchy one depth level at a time.
+	/// Levels are split across the pool's threads when one is given.  Returns the
+	/// number of world matrices that were recomputed.
+	///</summary>
+	uint32 Update(ThreadPool* pool = nullptr);
+
+private:
+	void SortByDepth();
+	uint32 UpdateRange(uint32 begin, uint32 end);
+
+private:
+
+	// Per-slot data.  Slots are ordered by depth; handles stay stable when the
+	// slots are re-sorted after nodes are added out of depth order.
+	std::vector<DirectX::XMFLOAT4X4A> mLocal;
+	std::vector<DirectX::XMFLOAT4X4A> mWorld;
+	std::vector<uint32> mParent;
+	std::vector<uint32> mDepth;
+	std::vector<std::uint8_t> mDirty;
+
+	// Update() stamp of the last recomputation, so "changed this update" does not
+	// need a per-frame clear of every node.
+	std::vector<uint32> mChangedStamp;
+
+	std::vector<uint32> mHandleToSlot;
+	std::vector<NodeHandle> mSlotToHandle;
+
+	// Slots of depth d are [mLevelStart[d], mLevelStart[d+1]).
+	std::vector<uint32> mLevelStart;
+
+	uint32 mUpdateStamp = 0;
+	uint32 mDirtyCount = 0;
+	uint32 mMinDirtyDepth = 0;
+	uint32 mMaxDirtyDepth = 0;
+	bool mOrderDirty = false;
+};
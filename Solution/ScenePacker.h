@@ -0,0 +1,222 @@
+//***************************************************************************************
+// ScenePacker.h
+//
+// Lays many ShapeWriter shapes out in one vertex buffer and one index buffer, then
+// writes them all straight into memory the caller provides, such as a mapped upload
+// buffer.  Shapes are added first, which only records their sizes, so the caller knows
+// the total byte sizes before it maps anything; Write then generates every shape at
+// its offset.  Nothing is staged in between.
+//
+// Write only ever stores, front to back, and never reads the destination back, which
+// is what write-combined upload memory wants.  The bounds of each shape are tracked as
+// its vertices are generated for the same reason.
+//***************************************************************************************
+
+#pragma once
+
+#include "ShapeWriter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+template<typename Writer, typename Index>
+class ScenePacker
+{
+public:
+
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+	using VertexType = typename Writer::VertexType;
+
+	struct Entry
+	{
+		ShapeWriter::Range Range;
+
+		// Axis-aligned bounds of the positions; valid after Write.
+		DirectX::XMFLOAT3 BoundsMin = DirectX::XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+		DirectX::XMFLOAT3 BoundsMax = DirectX::XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	};
+
+	uint32 AddBox(const Writer& writer, float width, float height, float depth, uint32 numSubdivisions)
+	{
+		return Add(ShapeWriter::GetBoxCounts(numSubdivisions), [=](VertexType* v, Index* i, Entry& entry)
+		{
+			ShapeWriter::WriteBox(v, i, BoundsWriter{ writer, entry }, width, height, depth, numSubdivisions);
+		});
+	}
+
+	uint32 AddWedge(const Writer& writer, float width, float height, float depth, uint32 numSubdivisions)
+	{
+		return Add(ShapeWriter::GetWedgeCounts(numSubdivisions), [=](VertexType* v, Index* i, Entry& entry)
+		{
+			ShapeWriter::WriteWedge(v, i, BoundsWriter{ writer, entry }, width, height, depth, numSubdivisions);
+		});
+	}
+
+	uint32 AddPyramid(const Writer& writer, float width, float height, float depth, uint32 numSubdivisions)
+	{
+		return Add(ShapeWriter::GetPyramidCounts(numSubdivisions), [=](VertexType* v, Index* i, Entry& entry)
+		{
+			ShapeWriter::WritePyramid(v, i, BoundsWriter{ writer, entry }, width, height, depth, numSubdivisions);
+		});
+	}
+
+	uint32 AddDiamond(const Writer& writer, float width, float height, float depth, uint32 numSubdivisions)
+	{
+		return Add(ShapeWriter::GetDiamondCounts(numSubdivisions), [=](VertexType* v, Index* i, Entry& entry)
+		{
+			ShapeWriter::WriteDiamond(v, i, BoundsWriter{ writer, entry }, width, height, depth, numSubdivisions);
+		});
+	}
+
+	uint32 AddTriPrism(const Writer& writer, float width, float height, float depth, uint32 numSubdivisions)
+	{
+		return Add(ShapeWriter::GetTriPrismCounts(numSubdivisions), [=](VertexType* v, Index* i, Entry& entry)
+		{
+			ShapeWriter::WriteTriPrism(v, i, BoundsWriter{ writer, entry }, width, height, depth, numSubdivisions);
+		});
+	}
+
+	uint32 AddSphere(const Writer& writer, float radius, uint32 sliceCount, uint32 stackCount)
+	{
+		return Add(ShapeWriter::GetSphereCounts(sliceCount, stackCount), [=](VertexType* v, Index* i, Entry& entry)
+		{
+			ShapeWriter::WriteSphere(v, i, BoundsWriter{ writer, entry }, radius, sliceCount, stackCount);
+		});
+	}
+
+	uint32 AddCylinder(const Writer& writer, float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount)
+	{
+		return Add(ShapeWriter::GetCylinderCounts(sliceCount, stackCount), [=](VertexType* v, Index* i, Entry& entry)
+		{
+			ShapeWriter::WriteCylinder(v, i, BoundsWriter{ writer, entry }, bottomRadius, topRadius, height, sliceCount, stackCount);
+		});
+	}
+
+	uint32 AddCone(const Writer& writer, float radius, float topRadius, float bottomRadius, float height, uint32 sliceCount, uint32 stackCount)
+	{
+		return Add(ShapeWriter::GetConeCounts(sliceCount, stackCount), [=](VertexType* v, Index* i, Entry& entry)
+		{
+			ShapeWriter::WriteCone(v, i, BoundsWriter{ writer, entry }, radius, topRadius, bottomRadius, height, sliceCount, stackCount);
+		});
+	}
+
+	uint32 AddGrid(const Writer& writer, float width, float depth, uint32 m, uint32 n)
+	{
+		return Add(ShapeWriter::GetGridCounts(m, n), [=](VertexType* v, Index* i, Entry& entry)
+		{
+			ShapeWriter::WriteGrid(v, i, BoundsWriter{ writer, entry }, width, depth, m, n);
+		});
+	}
+
+	///<summary>
+	/// Adds an existing mesh.  The source data is read when Write runs, so it must stay
+	/// valid until then; a MappedMesh that stays open is the intended source.
+	///</summary>
+	template<typename SourceIndex>
+	uint32 AddMesh(const Writer& writer, const ShapeWriter::GeneratedVertex* vertices, uint32 vertexCount,
+		const SourceIndex* indices, uint32 indexCount)
+	{
+		return Add({ vertexCount, indexCount }, [=](VertexType* v, Index* i, Entry& entry)
+		{
+			ShapeWriter::WriteMesh(v, i, BoundsWriter{ writer, entry }, vertices, vertexCount, indices, indexCount);
+		});
+	}
+
+	///<summary>
+	/// Adds a shape that write produces itself, for loaders with their own vertex
+	/// sources.  write(vertices, indices, writer) is called by Write with room for
+	/// counts and must pass every vertex through writer, a Writer-like functor that also
+	/// tracks the bounds.  Anything write captures must stay valid until then.
+	///</summary>
+	template<typename Fn>
+	uint32 AddCustom(const Writer& writer, ShapeWriter::Counts counts, Fn write)
+	{
+		return Add(counts, [=](VertexType* v, Index* i, Entry& entry)
+		{
+			write(v, i, BoundsWriter{ writer, entry });
+		});
+	}
+
+	uint32 GetEntryCount()const { return (uint32)mEntries.size(); }
+	const Entry& GetEntry(uint32 entry)const { return mEntries[entry]; }
+
+	uint32 GetVertexCount()const { return mVertexCount; }
+	uint32 GetIndexCount()const { return mIndexCount; }
+	// 64-bit, since a scene whose counts fit in 32 bits can still pass 4 GiB.
+	uint64 GetVertexByteSize()const { return (uint64)mVertexCount * sizeof(VertexType); }
+	uint64 GetIndexByteSize()const { return (uint64)mIndexCount * sizeof(Index); }
+
+	///<summary>
+	/// Generates every added shape into vertices and indices, which must hold at least
+	/// GetVertexCount() and GetIndexCount() elements.
+	///</summary>
+	void Write(VertexType* vertices, uint32 vertexCapacity, Index* indices, uint32 indexCapacity)
+	{
+		assert(vertexCapacity >= mVertexCount && indexCapacity >= mIndexCount);
+		(void)vertexCapacity;
+		(void)indexCapacity;
+
+		for(uint32 e = 0; e < (uint32)mEntries.size(); ++e)
+			WriteEntry(e, vertices + mEntries[e].Range.BaseVertex, indices + mEntries[e].Range.StartIndex);
+	}
+
+	///<summary>
+	/// Generates one shape into vertices and indices, which must hold the entry's
+	/// Range.VertexCount and Range.IndexCount elements.  Indices are relative to the
+	/// shape's first vertex.  Different entries may be written from different threads
+	/// at once.
+	///</summary>
+	void WriteEntry(uint32 entry, VertexType* vertices, Index* indices)
+	{
+		mWriteFns[entry](vertices, indices, mEntries[entry]);
+	}
+
+private:
+	// Forwards to the shape's writer and grows the entry's bounds on the way through.
+	struct BoundsWriter
+	{
+		using VertexType = typename Writer::VertexType;
+		static const uint32 Attributes = Writer::Attributes | ShapeWriter::Position;
+
+		const Writer& Inner;
+		Entry& Bounds;
+
+		void operator()(VertexType& dst, const ShapeWriter::GeneratedVertex& src) const
+		{
+			const DirectX::XMFLOAT3& p = src.Position;
+			Bounds.BoundsMin = DirectX::XMFLOAT3(std::min(Bounds.BoundsMin.x, p.x), std::min(Bounds.BoundsMin.y, p.y), std::min(Bounds.BoundsMin.z, p.z));
+			Bounds.BoundsMax = DirectX::XMFLOAT3(std::max(Bounds.BoundsMax.x, p.x), std::max(Bounds.BoundsMax.y, p.y), std::max(Bounds.BoundsMax.z, p.z));
+			Inner(dst, src);
+		}
+	};
+
+	using WriteFn = std::function<void(VertexType*, Index*, Entry&)>;
+
+	uint32 Add(ShapeWriter::Counts counts, WriteFn write)
+	{
+		Entry entry;
+		entry.Range.BaseVertex = mVertexCount;
+		entry.Range.VertexCount = counts.VertexCount;
+		entry.Range.StartIndex = mIndexCount;
+		entry.Range.IndexCount = counts.IndexCount;
+
+		// Ranges are 32-bit, so the totals must stay within a uint32.
+		assert((uint64)mVertexCount + counts.VertexCount <= UINT32_MAX && (uint64)mIndexCount + counts.IndexCount <= UINT32_MAX);
+		mVertexCount += counts.VertexCount;
+		mIndexCount += counts.IndexCount;
+
+		mEntries.push_back(entry);
+		mWriteFns.push_back(std::move(write));
+		return (uint32)mEntries.size() - 1;
+	}
+
+	std::vector<Entry> mEntries;
+	std::vector<WriteFn> mWriteFns;
+	uint32 mVertexCount = 0;
+	uint32 mIndexCount = 0;
+};
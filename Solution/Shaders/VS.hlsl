@@ -27,6 +27,22 @@ cbuffer cbPass : register(b1)
 	float gDeltaTime;
 };
 
+// Compact transforms for animated objects (see AnimatedTransform.h).  They are
+// rewritten every frame, so they live in a structured buffer instead of a cbuffer.
+struct AnimatedTransform
+{
+	float3 Position;
+	float  Scale;
+	float4 Rotation;
+};
+
+StructuredBuffer<AnimatedTransform> gAnimatedTransforms : register(t0);
+
+cbuffer cbAnimatedObject : register(b2)
+{
+	uint gAnimatedIndex;
+};
+
 struct VertexIn
 {
 	float3 PosL  : POSITION;
@@ -53,3 +69,42 @@ VertexOut VS(VertexIn vin)
 
 	return vout;
 }
+
+// Rebuilds the world matrix from a unit quaternion, a uniform scale and a translation,
+// in the same row-vector layout as gWorld.
+float4x4 AnimatedWorld(AnimatedTransform t)
+{
+	float4 q = t.Rotation;
+	float3 q2 = q.xyz * 2.0f;
+	float xx = q.x * q2.x, yy = q.y * q2.y, zz = q.z * q2.z;
+	float xy = q.x * q2.y, xz = q.x * q2.z, yz = q.y * q2.z;
+	float wx = q.w * q2.x, wy = q.w * q2.y, wz = q.w * q2.z;
+
+	float3x3 r = float3x3(
+		1.0f - (yy + zz), xy + wz, xz - wy,
+		xy - wz, 1.0f - (xx + zz), yz + wx,
+		xz + wy, yz - wx, 1.0f - (xx + yy));
+	r *= t.Scale;
+
+	return float4x4(
+		float4(r[0], 0.0f),
+		float4(r[1], 0.0f),
+		float4(r[2], 0.0f),
+		float4(t.Position, 1.0f));
+}
+
+VertexOut VSAnimated(VertexIn vin)
+{
+	VertexOut vout;
+
+	float4x4 world = AnimatedWorld(gAnimatedTransforms[gAnimatedIndex]);
+
+	// Transform to homogeneous clip space.
+	float4 posW = mul(float4(vin.PosL, 1.0f), world);
+	vout.PosH = mul(posW, gViewProj);
+
+	// Just pass vertex color into the pixel shader.
+	vout.Color = vin.Color;
+
+	return vout;
+}
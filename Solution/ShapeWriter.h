@@ -0,0 +1,1003 @@
+//***************************************************************************************
+// ShapeWriter.h
+//
+// The GeometryGenerator shapes, emitted straight into a consumer's vertex layout.  Each
+// shape is generated one vertex at a time and handed to a vertex writer, a small policy
+// that converts it into the consumer's vertex in place, so there is no intermediate
+// GeometryGenerator::Vertex buffer and no second copy pass.  A writer declares which
+// attributes it reads and the generators compile out the rest; a position-and-color
+// writer never evaluates a normal, tangent or texture coordinate.
+//
+// A vertex writer provides:
+//     using VertexType = ...;                  // the vertex it writes
+//     static const uint32 Attributes = ...;    // Attribute bits operator() reads
+//     void operator()(VertexType& dst, const GeometryGenerator::Vertex& src) const;
+//
+// Get*Counts gives the size of a shape up front.  Write* fills caller-owned vertex and
+// index memory of exactly that size; Append* grows a pair of vectors and returns where
+// the shape landed, for building one concatenated vertex/index buffer.  Indices are
+// local to the shape (they start at zero), as with MeshData.
+//
+// The output matches the corresponding GeometryGenerator::Create* call vertex for
+// vertex; those are implemented on top of these.  The subdivided box, wedge, pyramid,
+// diamond and tri-prism come from PolyhedronTables and so are within 2 ulps of what
+// subdividing at runtime gives, not bit for bit; see PolyhedronTables.h.
+//
+// Update* is for a shape whose continuous parameters (radius, height, width...) change
+// while its topology parameters (slices, stacks, subdivisions) stay: it rewrites the
+// vertices of the Range the shape was appended to in place, leaves the indices alone,
+// and returns the bytes of the vertex buffer that changed, for a partial upload.  The
+// Range carries the Topology Append* built it with, and an update with any other shape
+// or topology parameters writes nothing, even where the vertex count would fit.
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+#include "PolyhedronTables.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <DirectXMath.h>
+#include <type_traits>
+#include <vector>
+
+namespace ShapeWriter
+{
+	using uint32 = std::uint32_t;
+	using GeneratedVertex = GeometryGenerator::Vertex;
+
+	enum Attribute : uint32
+	{
+		Position = 1 << 0,
+		Normal = 1 << 1,
+		TangentU = 1 << 2,
+		TexC = 1 << 3,
+		AllAttributes = Position | Normal | TangentU | TexC
+	};
+
+	///<summary>
+	/// Writes GeometryGenerator::Vertex unchanged; what MeshData is built with.
+	///</summary>
+	struct GeneratorVertexWriter
+	{
+		using VertexType = GeneratedVertex;
+		static const uint32 Attributes = AllAttributes;
+
+		void operator()(VertexType& dst, const GeneratedVertex& src) const
+		{
+			dst = src;
+		}
+	};
+
+	///<summary>
+	/// Writes the position and one color for the whole shape, into any vertex with Pos
+	/// and Color members (the Week4 apps' Vertex).
+	///</summary>
+	template<typename VertexT>
+	struct PositionColorWriter
+	{
+		using VertexType = VertexT;
+		static const uint32 Attributes = Position;
+
+		DirectX::XMFLOAT4 Color;
+
+		void operator()(VertexType& dst, const GeneratedVertex& src) const
+		{
+			dst.Pos = src.Position;
+			dst.Color = Color;
+		}
+	};
+
+	struct Counts
+	{
+		uint32 VertexCount = 0;
+		uint32 IndexCount = 0;
+	};
+
+	// Topology::Shape values.  The Surface ones are ParametricSurface's.
+	enum TopologyShape : uint32
+	{
+		UnknownTopology = 0,
+		BoxTopology,
+		WedgeTopology,
+		PyramidTopology,
+		DiamondTopology,
+		TriPrismTopology,
+		SphereTopology,
+		CylinderTopology,
+		ConeTopology,
+		GridTopology,
+		SurfaceTopology,
+		SurfaceCylinderTopology,
+		SurfaceConeTopology
+	};
+
+	// What fixes the layout of a shape's vertices and indices: the shape, and its
+	// subdivision count, slice and stack counts or grid size (plus, for parametric
+	// surfaces, which rows are pinched).
+	struct Topology
+	{
+		uint32 Shape = UnknownTopology;
+		uint32 Params[3] = {};
+
+		bool operator==(const Topology& rhs)const
+		{
+			return Shape == rhs.Shape && Params[0] == rhs.Params[0] && Params[1] == rhs.Params[1] && Params[2] == rhs.Params[2];
+		}
+	};
+
+	// Where an appended shape landed in the concatenated buffers.  Append* records the
+	// shape's Topology; a Range made any other way has UnknownTopology and can't be
+	// updated in place.
+	struct Range
+	{
+		uint32 BaseVertex = 0;
+		uint32 VertexCount = 0;
+		uint32 StartIndex = 0;
+		uint32 IndexCount = 0;
+		Topology Shape;
+	};
+
+	// Bytes of a vertex buffer an Update* rewrote; Size is 0 if it wrote nothing.
+	struct DirtyRange
+	{
+		std::uint64_t Offset = 0;
+		std::uint64_t Size = 0;
+	};
+
+	namespace Detail
+	{
+		// The Index type of an update: every index write is compiled out, and the index
+		// pointer passed is null.
+		struct KeepIndices;
+
+		template<typename Index>
+		constexpr bool WritesIndices()
+		{
+			return !std::is_same<Index, KeepIndices>::value;
+		}
+
+		template<typename Writer>
+		constexpr bool Needs(uint32 attribute)
+		{
+			return (Writer::Attributes & attribute) != 0;
+		}
+
+		// Same arithmetic as GeometryGenerator::MidPoint, limited to what the writer reads.
+		template<typename Writer>
+		GeneratedVertex MidPoint(const GeneratedVertex& v0, const GeneratedVertex& v1)
+		{
+			using namespace DirectX;
+
+			GeneratedVertex v;
+			if constexpr(Needs<Writer>(Position))
+				XMStoreFloat3(&v.Position, 0.5f * (XMLoadFloat3(&v0.Position) + XMLoadFloat3(&v1.Position)));
+			if constexpr(Needs<Writer>(Normal))
+				XMStoreFloat3(&v.Normal, XMVector3Normalize(0.5f * (XMLoadFloat3(&v0.Normal) + XMLoadFloat3(&v1.Normal))));
+			if constexpr(Needs<Writer>(TangentU))
+				XMStoreFloat3(&v.TangentU, XMVector3Normalize(0.5f * (XMLoadFloat3(&v0.TangentU) + XMLoadFloat3(&v1.TangentU))));
+			if constexpr(Needs<Writer>(TexC))
+				XMStoreFloat2(&v.TexC, 0.5f * (XMLoadFloat2(&v0.TexC) + XMLoadFloat2(&v1.TexC)));
+			return v;
+		}
+
+		template<typename Writer>
+		GeneratedVertex Scaled(const PolyhedronTables::UnitVertex& u, float width, float height, float depth)
+		{
+			GeneratedVertex v;
+			if constexpr(Needs<Writer>(Position))
+				v.Position = DirectX::XMFLOAT3(u.Position[0] * width, u.Position[1] * height, u.Position[2] * depth);
+			if constexpr(Needs<Writer>(Normal))
+				v.Normal = DirectX::XMFLOAT3(u.Normal[0], u.Normal[1], u.Normal[2]);
+			if constexpr(Needs<Writer>(TangentU))
+				v.TangentU = DirectX::XMFLOAT3(u.TangentU[0], u.TangentU[1], u.TangentU[2]);
+			if constexpr(Needs<Writer>(TexC))
+				v.TexC = DirectX::XMFLOAT2(u.TexC[0], u.TexC[1]);
+			return v;
+		}
+
+		// Subdivides one triangle the given number of levels and writes the last level the
+		// way GeometryGenerator::Subdivide lays it out.  Depth-first over the four children
+		// in Subdivide's triangle order visits the final triangles in the same order a
+		// level-by-level Subdivide produces them.
+		template<typename Writer, typename Index>
+		void WriteSubdivided(const GeneratedVertex& v0, const GeneratedVertex& v1, const GeneratedVertex& v2,
+			uint32 levels, const Writer& writer, typename Writer::VertexType*& vertices, Index*& indices, uint32& base)
+		{
+			GeneratedVertex m0 = MidPoint<Writer>(v0, v1);
+			GeneratedVertex m1 = MidPoint<Writer>(v1, v2);
+			GeneratedVertex m2 = MidPoint<Writer>(v0, v2);
+
+			if(levels > 1)
+			{
+				WriteSubdivided(v0, m0, m2, levels - 1, writer, vertices, indices, base);
+				WriteSubdivided(m0, m1, m2, levels - 1, writer, vertices, indices, base);
+				WriteSubdivided(m2, m1, v2, levels - 1, writer, vertices, indices, base);
+				WriteSubdivided(m0, v1, m1, levels - 1, writer, vertices, indices, base);
+				return;
+			}
+
+			writer(vertices[0], v0);
+			writer(vertices[1], v1);
+			writer(vertices[2], v2);
+			writer(vertices[3], m0);
+			writer(vertices[4], m1);
+			writer(vertices[5], m2);
+
+			if constexpr(WritesIndices<Index>())
+			{
+				const uint32 pattern[12] = { 0, 3, 5, 3, 4, 5, 5, 4, 2, 3, 1, 4 };
+				for(uint32 i = 0; i < 12; ++i)
+					indices[i] = static_cast<Index>(base + pattern[i]);
+				indices += 12;
+			}
+
+			vertices += 6;
+			base += 6;
+		}
+
+		inline uint32 ClampSubdivisions(uint32 numSubdivisions)
+		{
+			// Put a cap on the number of subdivisions.
+			return std::min<uint32>(numSubdivisions, 6u);
+		}
+
+		inline Counts GetPolyhedronCounts(PolyhedronTables::Shape shape, uint32 numSubdivisions)
+		{
+			numSubdivisions = ClampSubdivisions(numSubdivisions);
+			uint32 tableLevel = std::min(numSubdivisions, PolyhedronTables::MaxTableLevel);
+			PolyhedronTables::TableView table = PolyhedronTables::GetTable(shape, tableLevel);
+			if(numSubdivisions == tableLevel)
+				return { table.VertexCount, table.IndexCount };
+
+			// Triangles going into the last subdivision; each becomes 6 vertices and 12 indices.
+			uint32 triangles = (table.IndexCount / 3) << (2 * (numSubdivisions - tableLevel - 1));
+			return { triangles * 6, triangles * 12 };
+		}
+
+		// The fixed-topology shapes start from the deepest PolyhedronTables level that fits;
+		// only the levels past it are subdivided here.  Level 0 is exact; deeper levels
+		// are within the tables' 2 ulps of runtime subdivision.
+		template<typename Writer, typename Index>
+		void WritePolyhedron(PolyhedronTables::Shape shape, typename Writer::VertexType* vertices, Index* indices,
+			const Writer& writer, float width, float height, float depth, uint32 numSubdivisions)
+		{
+			numSubdivisions = ClampSubdivisions(numSubdivisions);
+			uint32 tableLevel = std::min(numSubdivisions, PolyhedronTables::MaxTableLevel);
+			PolyhedronTables::TableView table = PolyhedronTables::GetTable(shape, tableLevel);
+
+			if(numSubdivisions == tableLevel)
+			{
+				if constexpr(std::is_same<Writer, GeneratorVertexWriter>::value)
+					PolyhedronTables::ScaleVertices(table.Vertices, table.VertexCount, width, height, depth, vertices);
+				else
+				{
+					for(uint32 i = 0; i < table.VertexCount; ++i)
+						writer(vertices[i], Scaled<Writer>(table.Vertices[i], width, height, depth));
+				}
+
+				if constexpr(WritesIndices<Index>())
+				{
+					for(uint32 i = 0; i < table.IndexCount; ++i)
+						indices[i] = static_cast<Index>(table.Indices[i]);
+				}
+				return;
+			}
+
+			uint32 base = 0;
+			for(uint32 t = 0; t < table.IndexCount; t += 3)
+			{
+				WriteSubdivided(
+					Scaled<Writer>(table.Vertices[table.Indices[t + 0]], width, height, depth),
+					Scaled<Writer>(table.Vertices[table.Indices[t + 1]], width, height, depth),
+					Scaled<Writer>(table.Vertices[table.Indices[t + 2]], width, height, depth),
+					numSubdivisions - tableLevel, writer, vertices, indices, base);
+			}
+		}
+
+		// Grows the vectors by counts and lets write fill the new tail.
+		template<typename Vertex, typename Index, typename WriteFn>
+		Range Append(std::vector<Vertex>& vertices, std::vector<Index>& indices, Counts counts, const Topology& topology,
+			const WriteFn& write)
+		{
+			Range range;
+			range.BaseVertex = (uint32)vertices.size();
+			range.VertexCount = counts.VertexCount;
+			range.StartIndex = (uint32)indices.size();
+			range.IndexCount = counts.IndexCount;
+			range.Shape = topology;
+
+			vertices.resize(vertices.size() + counts.VertexCount);
+			indices.resize(indices.size() + counts.IndexCount);
+			write(vertices.data() + range.BaseVertex, indices.data() + range.StartIndex);
+			return range;
+		}
+
+		// Lets write refill the range's vertices if the range holds this very topology.
+		template<typename Vertex, typename WriteFn>
+		DirtyRange Update(Vertex* vertices, const Range& range, Counts counts, const Topology& topology, const WriteFn& write)
+		{
+			if(range.Shape.Shape == UnknownTopology || !(range.Shape == topology) ||
+				counts.VertexCount != range.VertexCount || counts.IndexCount != range.IndexCount)
+				return DirtyRange();
+
+			write(vertices + range.BaseVertex);
+			return DirtyRange{ (std::uint64_t)range.BaseVertex * sizeof(Vertex), (std::uint64_t)range.VertexCount * sizeof(Vertex) };
+		}
+	}
+
+	//
+	// Sizes.
+	//
+
+	inline Counts GetBoxCounts(uint32 numSubdivisions)
+	{
+		return Detail::GetPolyhedronCounts(PolyhedronTables::Shape::Box, numSubdivisions);
+	}
+
+	inline Counts GetWedgeCounts(uint32 numSubdivisions)
+	{
+		return Detail::GetPolyhedronCounts(PolyhedronTables::Shape::Wedge, numSubdivisions);
+	}
+
+	inline Counts GetPyramidCounts(uint32 numSubdivisions)
+	{
+		return Detail::GetPolyhedronCounts(PolyhedronTables::Shape::Pyramid, numSubdivisions);
+	}
+
+	inline Counts GetDiamondCounts(uint32 numSubdivisions)
+	{
+		return Detail::GetPolyhedronCounts(PolyhedronTables::Shape::Diamond, numSubdivisions);
+	}
+
+	inline Counts GetTriPrismCounts(uint32 numSubdivisions)
+	{
+		return Detail::GetPolyhedronCounts(PolyhedronTables::Shape::TriPrism, numSubdivisions);
+	}
+
+	inline Counts GetSphereCounts(uint32 sliceCount, uint32 stackCount)
+	{
+		// Two poles and stackCount-1 rings; a fan at each pole and quads in between.
+		return { 2 + (stackCount - 1) * (sliceCount + 1), 6 * sliceCount + 6 * sliceCount * (stackCount - 2) };
+	}
+
+	inline Counts GetCylinderCounts(uint32 sliceCount, uint32 stackCount)
+	{
+		// stackCount+1 side rings, then two caps of a ring plus a center vertex.
+		return { (stackCount + 1) * (sliceCount + 1) + 2 * (sliceCount + 2), 6 * sliceCount * stackCount + 6 * sliceCount };
+	}
+
+	inline Counts GetConeCounts(uint32 sliceCount, uint32 stackCount)
+	{
+		// stackCount+1 side rings and the bottom cap.
+		return { (stackCount + 1) * (sliceCount + 1) + sliceCount + 2, 6 * sliceCount * stackCount + 3 * sliceCount };
+	}
+
+	inline Counts GetGridCounts(uint32 m, uint32 n)
+	{
+		return { m * n, (m - 1) * (n - 1) * 6 };
+	}
+
+	//
+	// Generation into caller-owned memory of exactly Get*Counts elements.
+	//
+
+	template<typename Writer, typename Index>
+	void WriteBox(typename Writer::VertexType* vertices, Index* indices, const Writer& writer,
+		float width, float height, float depth, uint32 numSubdivisions)
+	{
+		Detail::WritePolyhedron(PolyhedronTables::Shape::Box, vertices, indices, writer, width, height, depth, numSubdivisions);
+	}
+
+	template<typename Writer, typename Index>
+	void WriteWedge(typename Writer::VertexType* vertices, Index* indices, const Writer& writer,
+		float width, float height, float depth, uint32 numSubdivisions)
+	{
+		Detail::WritePolyhedron(PolyhedronTables::Shape::Wedge, vertices, indices, writer, width, height, depth, numSubdivisions);
+	}
+
+	template<typename Writer, typename Index>
+	void WritePyramid(typename Writer::VertexType* vertices, Index* indices, const Writer& writer,
+		float width, float height, float depth, uint32 numSubdivisions)
+	{
+		Detail::WritePolyhedron(PolyhedronTables::Shape::Pyramid, vertices, indices, writer, width, height, depth, numSubdivisions);
+	}
+
+	template<typename Writer, typename Index>
+	void WriteDiamond(typename Writer::VertexType* vertices, Index* indices, const Writer& writer,
+		float width, float height, float depth, uint32 numSubdivisions)
+	{
+		Detail::WritePolyhedron(PolyhedronTables::Shape::Diamond, vertices, indices, writer, width, height, depth, numSubdivisions);
+	}
+
+	template<typename Writer, typename Index>
+	void WriteTriPrism(typename Writer::VertexType* vertices, Index* indices, const Writer& writer,
+		float width, float height, float depth, uint32 numSubdivisions)
+	{
+		Detail::WritePolyhedron(PolyhedronTables::Shape::TriPrism, vertices, indices, writer, width, height, depth, numSubdivisions);
+	}
+
+	template<typename Writer, typename Index>
+	void WriteSphere(typename Writer::VertexType* vertices, Index* indices, const Writer& writer,
+		float radius, uint32 sliceCount, uint32 stackCount)
+	{
+		using namespace DirectX;
+
+		uint32 k = 0;
+
+		// Poles: note that there will be texture coordinate distortion as there is
+		// not a unique point on the texture map to assign to the pole when mapping
+		// a rectangular texture onto a sphere.
+		writer(vertices[k++], GeneratedVertex(0.0f, +radius, 0.0f, 0.0f, +1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f));
+
+		float phiStep = XM_PI / stackCount;
+		float thetaStep = 2.0f * XM_PI / sliceCount;
+
+		// Compute vertices for each stack ring (do not count the poles as rings).
+		for(uint32 i = 1; i <= stackCount - 1; ++i)
+		{
+			float phi = i * phiStep;
+			float sinPhi = sinf(phi);
+			float cosPhi = cosf(phi);
+
+			// Vertices of ring.
+			for(uint32 j = 0; j <= sliceCount; ++j)
+			{
+				float theta = j * thetaStep;
+				float sinTheta = sinf(theta);
+				float cosTheta = cosf(theta);
+
+				GeneratedVertex v;
+
+				// spherical to cartesian
+				v.Position.x = radius * sinPhi * cosTheta;
+				v.Position.y = radius * cosPhi;
+				v.Position.z = radius * sinPhi * sinTheta;
+
+				if constexpr(Detail::Needs<Writer>(TangentU))
+				{
+					// Partial derivative of P with respect to theta
+					XMFLOAT3 tangent(-radius * sinPhi * sinTheta, 0.0f, +radius * sinPhi * cosTheta);
+					XMStoreFloat3(&v.TangentU, XMVector3Normalize(XMLoadFloat3(&tangent)));
+				}
+
+				if constexpr(Detail::Needs<Writer>(Normal))
+					XMStoreFloat3(&v.Normal, XMVector3Normalize(XMLoadFloat3(&v.Position)));
+
+				if constexpr(Detail::Needs<Writer>(TexC))
+				{
+					v.TexC.x = theta / XM_2PI;
+					v.TexC.y = phi / XM_PI;
+				}
+
+				writer(vertices[k++], v);
+			}
+		}
+
+		writer(vertices[k++], GeneratedVertex(0.0f, -radius, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f));
+
+		if constexpr(Detail::WritesIndices<Index>())
+		{
+			uint32 n = 0;
+
+			// The top stack connects the top pole to the first ring.
+			for(uint32 i = 1; i <= sliceCount; ++i)
+			{
+				indices[n++] = static_cast<Index>(0);
+				indices[n++] = static_cast<Index>(i + 1);
+				indices[n++] = static_cast<Index>(i);
+			}
+
+			// Inner stacks, offset past the top pole vertex.
+			uint32 baseIndex = 1;
+			uint32 ringVertexCount = sliceCount + 1;
+			for(uint32 i = 0; i < stackCount - 2; ++i)
+			{
+				for(uint32 j = 0; j < sliceCount; ++j)
+				{
+					indices[n++] = static_cast<Index>(baseIndex + i * ringVertexCount + j);
+					indices[n++] = static_cast<Index>(baseIndex + i * ringVertexCount + j + 1);
+					indices[n++] = static_cast<Index>(baseIndex + (i + 1) * ringVertexCount + j);
+
+					indices[n++] = static_cast<Index>(baseIndex + (i + 1) * ringVertexCount + j);
+					indices[n++] = static_cast<Index>(baseIndex + i * ringVertexCount + j + 1);
+					indices[n++] = static_cast<Index>(baseIndex + (i + 1) * ringVertexCount + j + 1);
+				}
+			}
+
+			// The bottom stack connects the bottom pole (written last) to the last ring.
+			uint32 southPoleIndex = k - 1;
+			baseIndex = southPoleIndex - ringVertexCount;
+			for(uint32 i = 0; i < sliceCount; ++i)
+			{
+				indices[n++] = static_cast<Index>(southPoleIndex);
+				indices[n++] = static_cast<Index>(baseIndex + i);
+				indices[n++] = static_cast<Index>(baseIndex + i + 1);
+			}
+		}
+	}
+
+	namespace Detail
+	{
+		// A cylinder or cone cap: a ring of radius at height y plus a center vertex, with
+		// normal (0, ny, 0).  The top cap (ny > 0) winds the other way from the bottom.
+		template<typename Writer, typename Index>
+		void WriteCap(typename Writer::VertexType* vertices, Index* indices, uint32& k, uint32& n,
+			const Writer& writer, float radius, float y, float ny, float height, uint32 sliceCount)
+		{
+			using namespace DirectX;
+
+			uint32 baseIndex = k;
+			float dTheta = 2.0f * XM_PI / sliceCount;
+
+			// Duplicate cap ring vertices because the texture coordinates and normals differ.
+			for(uint32 i = 0; i <= sliceCount; ++i)
+			{
+				float x = radius * cosf(i * dTheta);
+				float z = radius * sinf(i * dTheta);
+
+				// Scale down by the height to try and make top cap texture coord area
+				// proportional to base.
+				float u = 0.0f;
+				float v = 0.0f;
+				if constexpr(Needs<Writer>(TexC))
+				{
+					u = x / height + 0.5f;
+					v = z / height + 0.5f;
+				}
+
+				writer(vertices[k++], GeneratedVertex(x, y, z, 0.0f, ny, 0.0f, 1.0f, 0.0f, 0.0f, u, v));
+			}
+
+			// Cap center vertex.
+			writer(vertices[k++], GeneratedVertex(0.0f, y, 0.0f, 0.0f, ny, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f));
+			uint32 centerIndex = k - 1;
+
+			if constexpr(WritesIndices<Index>())
+			{
+				bool top = ny > 0.0f;
+				for(uint32 i = 0; i < sliceCount; ++i)
+				{
+					indices[n++] = static_cast<Index>(centerIndex);
+					indices[n++] = static_cast<Index>(baseIndex + (top ? i + 1 : i));
+					indices[n++] = static_cast<Index>(baseIndex + (top ? i : i + 1));
+				}
+			}
+		}
+
+		// Two triangles per quad between consecutive rings of ringVertexCount vertices.
+		template<typename Index>
+		void WriteRingIndices(Index* indices, uint32& n, uint32 ringVertexCount, uint32 sliceCount, uint32 stackCount)
+		{
+			for(uint32 i = 0; i < stackCount; ++i)
+			{
+				for(uint32 j = 0; j < sliceCount; ++j)
+				{
+					indices[n++] = static_cast<Index>(i * ringVertexCount + j);
+					indices[n++] = static_cast<Index>((i + 1) * ringVertexCount + j);
+					indices[n++] = static_cast<Index>((i + 1) * ringVertexCount + j + 1);
+
+					indices[n++] = static_cast<Index>(i * ringVertexCount + j);
+					indices[n++] = static_cast<Index>((i + 1) * ringVertexCount + j + 1);
+					indices[n++] = static_cast<Index>(i * ringVertexCount + j + 1);
+				}
+			}
+		}
+	}
+
+	template<typename Writer, typename Index>
+	void WriteCylinder(typename Writer::VertexType* vertices, Index* indices, const Writer& writer,
+		float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount)
+	{
+		using namespace DirectX;
+
+		float stackHeight = height / stackCount;
+
+		// Amount to increment radius as we move up each stack level from bottom to top.
+		float radiusStep = (topRadius - bottomRadius) / stackCount;
+
+		uint32 ringCount = stackCount + 1;
+		uint32 k = 0;
+
+		// Compute vertices for each stack ring starting at the bottom and moving up.
+		for(uint32 i = 0; i < ringCount; ++i)
+		{
+			float y = -0.5f * height + i * stackHeight;
+			float r = bottomRadius + i * radiusStep;
+
+			// vertices of ring
+			float dTheta = 2.0f * XM_PI / sliceCount;
+			for(uint32 j = 0; j <= sliceCount; ++j)
+			{
+				GeneratedVertex vertex;
+
+				float c = cosf(j * dTheta);
+				float s = sinf(j * dTheta);
+
+				vertex.Position = XMFLOAT3(r * c, y, r * s);
+
+				if constexpr(Detail::Needs<Writer>(TexC))
+				{
+					vertex.TexC.x = (float)j / sliceCount;
+					vertex.TexC.y = 1.0f - (float)i / stackCount;
+				}
+
+				// Cylinder can be parameterized as follows, where we introduce v
+				// parameter that goes in the same direction as the v tex-coord
+				// so that the bitangent goes in the same direction as the v tex-coord.
+				//   Let r0 be the bottom radius and let r1 be the top radius.
+				//   y(v) = h - hv for v in [0,1].
+				//   r(v) = r1 + (r0-r1)v
+				//
+				//   x(t, v) = r(v)*cos(t)
+				//   y(t, v) = h - hv
+				//   z(t, v) = r(v)*sin(t)
+				//
+				//  dx/dt = -r(v)*sin(t)
+				//  dy/dt = 0
+				//  dz/dt = +r(v)*cos(t)
+				//
+				//  dx/dv = (r0-r1)*cos(t)
+				//  dy/dv = -h
+				//  dz/dv = (r0-r1)*sin(t)
+
+				// This is unit length.
+				vertex.TangentU = XMFLOAT3(-s, 0.0f, c);
+
+				if constexpr(Detail::Needs<Writer>(Normal))
+				{
+					float dr = bottomRadius - topRadius;
+					XMFLOAT3 bitangent(dr * c, -height, dr * s);
+
+					XMVECTOR T = XMLoadFloat3(&vertex.TangentU);
+					XMVECTOR B = XMLoadFloat3(&bitangent);
+					XMStoreFloat3(&vertex.Normal, XMVector3Normalize(XMVector3Cross(T, B)));
+				}
+
+				writer(vertices[k++], vertex);
+			}
+		}
+
+		// Add one because we duplicate the first and last vertex per ring
+		// since the texture coordinates are different.
+		uint32 n = 0;
+		if constexpr(Detail::WritesIndices<Index>())
+			Detail::WriteRingIndices(indices, n, sliceCount + 1, sliceCount, stackCount);
+
+		Detail::WriteCap(vertices, indices, k, n, writer, topRadius, 0.5f * height, 1.0f, height, sliceCount);
+		Detail::WriteCap(vertices, indices, k, n, writer, bottomRadius, -0.5f * height, -1.0f, height, sliceCount);
+	}
+
+	// The cone ends in its apex, so it has no top cap and topRadius is unused; it stays
+	// in the signature to match GeometryGenerator::CreateCone.
+	template<typename Writer, typename Index>
+	void WriteCone(typename Writer::VertexType* vertices, Index* indices, const Writer& writer,
+		float radius, float /*topRadius*/, float bottomRadius, float height, uint32 sliceCount, uint32 stackCount)
+	{
+		using namespace DirectX;
+
+		float y = height / 2;
+		float dTheta = XM_2PI / sliceCount;
+		uint32 k = 0;
+
+		for(uint32 j = 0; j <= stackCount; ++j)
+		{
+			float r = radius * (stackCount - j) / stackCount;
+
+			for(uint32 i = 0; i <= sliceCount; ++i)
+			{
+				GeneratedVertex vertex;
+
+				float c = cosf(i * dTheta);
+				float s = sinf(i * dTheta);
+
+				vertex.Position = XMFLOAT3(r * c, -y + j * height / stackCount, r * s);
+				vertex.Normal = XMFLOAT3(c, (radius / height) + 0.5f, s);
+				vertex.TangentU = XMFLOAT3(-s, 0.0f, c);
+
+				if constexpr(Detail::Needs<Writer>(TexC))
+				{
+					vertex.TexC.x = (float)i / sliceCount;
+					vertex.TexC.y = (float)j / stackCount;
+				}
+
+				writer(vertices[k++], vertex);
+			}
+		}
+
+		uint32 n = 0;
+		if constexpr(Detail::WritesIndices<Index>())
+			Detail::WriteRingIndices(indices, n, sliceCount + 1, sliceCount, stackCount);
+
+		Detail::WriteCap(vertices, indices, k, n, writer, bottomRadius, -0.5f * height, -1.0f, height, sliceCount);
+	}
+
+	template<typename Writer, typename Index>
+	void WriteGrid(typename Writer::VertexType* vertices, Index* indices, const Writer& writer,
+		float width, float depth, uint32 m, uint32 n)
+	{
+		using namespace DirectX;
+
+		float halfWidth = 0.5f * width;
+		float halfDepth = 0.5f * depth;
+
+		float dx = width / (n - 1);
+		float dz = depth / (m - 1);
+
+		float du = 1.0f / (n - 1);
+		float dv = 1.0f / (m - 1);
+
+		for(uint32 i = 0; i < m; ++i)
+		{
+			float z = halfDepth - i * dz;
+			for(uint32 j = 0; j < n; ++j)
+			{
+				float x = -halfWidth + j * dx;
+
+				// Stretch texture over grid.
+				writer(vertices[i * n + j], GeneratedVertex(x, 0.0f, z, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, j * du, i * dv));
+			}
+		}
+
+		if constexpr(Detail::WritesIndices<Index>())
+		{
+			// Iterate over each quad and compute indices.
+			uint32 k = 0;
+			for(uint32 i = 0; i < m - 1; ++i)
+			{
+				for(uint32 j = 0; j < n - 1; ++j)
+				{
+					indices[k] = static_cast<Index>(i * n + j);
+					indices[k + 1] = static_cast<Index>(i * n + j + 1);
+					indices[k + 2] = static_cast<Index>((i + 1) * n + j);
+
+					indices[k + 3] = static_cast<Index>((i + 1) * n + j);
+					indices[k + 4] = static_cast<Index>(i * n + j + 1);
+					indices[k + 5] = static_cast<Index>((i + 1) * n + j + 1);
+
+					k += 6; // next quad
+				}
+			}
+		}
+	}
+
+	///<summary>
+	/// Passes an existing mesh, such as one loaded from a mesh file, through the writer.
+	/// The indices are converted to Index as they are copied.
+	///</summary>
+	template<typename Writer, typename Index, typename SourceIndex>
+	void WriteMesh(typename Writer::VertexType* vertices, Index* indices, const Writer& writer,
+		const GeneratedVertex* sourceVertices, uint32 vertexCount, const SourceIndex* sourceIndices, uint32 indexCount)
+	{
+		for(uint32 i = 0; i < vertexCount; ++i)
+			writer(vertices[i], sourceVertices[i]);
+
+		for(uint32 i = 0; i < indexCount; ++i)
+			indices[i] = static_cast<Index>(sourceIndices[i]);
+	}
+
+	//
+	// Generation appended to a pair of vectors.
+	//
+
+	template<typename Writer, typename Index>
+	Range AppendBox(std::vector<typename Writer::VertexType>& vertices, std::vector<Index>& indices, const Writer& writer,
+		float width, float height, float depth, uint32 numSubdivisions)
+	{
+		Topology topology{ BoxTopology, { Detail::ClampSubdivisions(numSubdivisions) } };
+		return Detail::Append(vertices, indices, GetBoxCounts(numSubdivisions), topology, [&](auto* v, Index* i)
+		{
+			WriteBox(v, i, writer, width, height, depth, numSubdivisions);
+		});
+	}
+
+	template<typename Writer, typename Index>
+	Range AppendWedge(std::vector<typename Writer::VertexType>& vertices, std::vector<Index>& indices, const Writer& writer,
+		float width, float height, float depth, uint32 numSubdivisions)
+	{
+		Topology topology{ WedgeTopology, { Detail::ClampSubdivisions(numSubdivisions) } };
+		return Detail::Append(vertices, indices, GetWedgeCounts(numSubdivisions), topology, [&](auto* v, Index* i)
+		{
+			WriteWedge(v, i, writer, width, height, depth, numSubdivisions);
+		});
+	}
+
+	template<typename Writer, typename Index>
+	Range AppendPyramid(std::vector<typename Writer::VertexType>& vertices, std::vector<Index>& indices, const Writer& writer,
+		float width, float height, float depth, uint32 numSubdivisions)
+	{
+		Topology topology{ PyramidTopology, { Detail::ClampSubdivisions(numSubdivisions) } };
+		return Detail::Append(vertices, indices, GetPyramidCounts(numSubdivisions), topology, [&](auto* v, Index* i)
+		{
+			WritePyramid(v, i, writer, width, height, depth, numSubdivisions);
+		});
+	}
+
+	template<typename Writer, typename Index>
+	Range AppendDiamond(std::vector<typename Writer::VertexType>& vertices, std::vector<Index>& indices, const Writer& writer,
+		float width, float height, float depth, uint32 numSubdivisions)
+	{
+		Topology topology{ DiamondTopology, { Detail::ClampSubdivisions(numSubdivisions) } };
+		return Detail::Append(vertices, indices, GetDiamondCounts(numSubdivisions), topology, [&](auto* v, Index* i)
+		{
+			WriteDiamond(v, i, writer, width, height, depth, numSubdivisions);
+		});
+	}
+
+	template<typename Writer, typename Index>
+	Range AppendTriPrism(std::vector<typename Writer::VertexType>& vertices, std::vector<Index>& indices, const Writer& writer,
+		float width, float height, float depth, uint32 numSubdivisions)
+	{
+		Topology topology{ TriPrismTopology, { Detail::ClampSubdivisions(numSubdivisions) } };
+		return Detail::Append(vertices, indices, GetTriPrismCounts(numSubdivisions), topology, [&](auto* v, Index* i)
+		{
+			WriteTriPrism(v, i, writer, width, height, depth, numSubdivisions);
+		});
+	}
+
+	template<typename Writer, typename Index>
+	Range AppendSphere(std::vector<typename Writer::VertexType>& vertices, std::vector<Index>& indices, const Writer& writer,
+		float radius, uint32 sliceCount, uint32 stackCount)
+	{
+		Topology topology{ SphereTopology, { sliceCount, stackCount } };
+		return Detail::Append(vertices, indices, GetSphereCounts(sliceCount, stackCount), topology, [&](auto* v, Index* i)
+		{
+			WriteSphere(v, i, writer, radius, sliceCount, stackCount);
+		});
+	}
+
+	template<typename Writer, typename Index>
+	Range AppendCylinder(std::vector<typename Writer::VertexType>& vertices, std::vector<Index>& indices, const Writer& writer,
+		float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount)
+	{
+		Topology topology{ CylinderTopology, { sliceCount, stackCount } };
+		return Detail::Append(vertices, indices, GetCylinderCounts(sliceCount, stackCount), topology, [&](auto* v, Index* i)
+		{
+			WriteCylinder(v, i, writer, bottomRadius, topRadius, height, sliceCount, stackCount);
+		});
+	}
+
+	template<typename Writer, typename Index>
+	Range AppendCone(std::vector<typename Writer::VertexType>& vertices, std::vector<Index>& indices, const Writer& writer,
+		float radius, float topRadius, float bottomRadius, float height, uint32 sliceCount, uint32 stackCount)
+	{
+		Topology topology{ ConeTopology, { sliceCount, stackCount } };
+		return Detail::Append(vertices, indices, GetConeCounts(sliceCount, stackCount), topology, [&](auto* v, Index* i)
+		{
+			WriteCone(v, i, writer, radius, topRadius, bottomRadius, height, sliceCount, stackCount);
+		});
+	}
+
+	template<typename Writer, typename Index>
+	Range AppendGrid(std::vector<typename Writer::VertexType>& vertices, std::vector<Index>& indices, const Writer& writer,
+		float width, float depth, uint32 m, uint32 n)
+	{
+		Topology topology{ GridTopology, { m, n } };
+		return Detail::Append(vertices, indices, GetGridCounts(m, n), topology, [&](auto* v, Index* i)
+		{
+			WriteGrid(v, i, writer, width, depth, m, n);
+		});
+	}
+
+	template<typename Writer, typename Index, typename SourceIndex>
+	Range AppendMesh(std::vector<typename Writer::VertexType>& vertices, std::vector<Index>& indices, const Writer& writer,
+		const GeneratedVertex* sourceVertices, uint32 vertexCount, const SourceIndex* sourceIndices, uint32 indexCount)
+	{
+		return Detail::Append(vertices, indices, Counts{ vertexCount, indexCount }, Topology(), [&](auto* v, Index* i)
+		{
+			WriteMesh(v, i, writer, sourceVertices, vertexCount, sourceIndices, indexCount);
+		});
+	}
+
+	//
+	// In-place updates of an appended shape.
+	//
+
+	///<summary>
+	/// Rewrites the vertices of range, which Append* filled with the same shape, for new
+	/// continuous parameters; vertices is the whole buffer range is in.  The shape and
+	/// its topology parameters have to be the ones range was appended with (its Shape):
+	/// otherwise nothing is written and the DirtyRange is empty.  Indices are never
+	/// touched.
+	///</summary>
+	template<typename Writer>
+	DirtyRange UpdateBox(typename Writer::VertexType* vertices, const Range& range, const Writer& writer,
+		float width, float height, float depth, uint32 numSubdivisions)
+	{
+		Topology topology{ BoxTopology, { Detail::ClampSubdivisions(numSubdivisions) } };
+		return Detail::Update(vertices, range, GetBoxCounts(numSubdivisions), topology, [&](auto* v)
+		{
+			WriteBox<Writer, Detail::KeepIndices>(v, nullptr, writer, width, height, depth, numSubdivisions);
+		});
+	}
+
+	template<typename Writer>
+	DirtyRange UpdateWedge(typename Writer::VertexType* vertices, const Range& range, const Writer& writer,
+		float width, float height, float depth, uint32 numSubdivisions)
+	{
+		Topology topology{ WedgeTopology, { Detail::ClampSubdivisions(numSubdivisions) } };
+		return Detail::Update(vertices, range, GetWedgeCounts(numSubdivisions), topology, [&](auto* v)
+		{
+			WriteWedge<Writer, Detail::KeepIndices>(v, nullptr, writer, width, height, depth, numSubdivisions);
+		});
+	}
+
+	template<typename Writer>
+	DirtyRange UpdatePyramid(typename Writer::VertexType* vertices, const Range& range, const Writer& writer,
+		float width, float height, float depth, uint32 numSubdivisions)
+	{
+		Topology topology{ PyramidTopology, { Detail::ClampSubdivisions(numSubdivisions) } };
+		return Detail::Update(vertices, range, GetPyramidCounts(numSubdivisions), topology, [&](auto* v)
+		{
+			WritePyramid<Writer, Detail::KeepIndices>(v, nullptr, writer, width, height, depth, numSubdivisions);
+		});
+	}
+
+	template<typename Writer>
+	DirtyRange UpdateDiamond(typename Writer::VertexType* vertices, const Range& range, const Writer& writer,
+		float width, float height, float depth, uint32 numSubdivisions)
+	{
+		Topology topology{ DiamondTopology, { Detail::ClampSubdivisions(numSubdivisions) } };
+		return Detail::Update(vertices, range, GetDiamondCounts(numSubdivisions), topology, [&](auto* v)
+		{
+			WriteDiamond<Writer, Detail::KeepIndices>(v, nullptr, writer, width, height, depth, numSubdivisions);
+		});
+	}
+
+	template<typename Writer>
+	DirtyRange UpdateTriPrism(typename Writer::VertexType* vertices, const Range& range, const Writer& writer,
+		float width, float height, float depth, uint32 numSubdivisions)
+	{
+		Topology topology{ TriPrismTopology, { Detail::ClampSubdivisions(numSubdivisions) } };
+		return Detail::Update(vertices, range, GetTriPrismCounts(numSubdivisions), topology, [&](auto* v)
+		{
+			WriteTriPrism<Writer, Detail::KeepIndices>(v, nullptr, writer, width, height, depth, numSubdivisions);
+		});
+	}
+
+	template<typename Writer>
+	DirtyRange UpdateSphere(typename Writer::VertexType* vertices, const Range& range, const Writer& writer,
+		float radius, uint32 sliceCount, uint32 stackCount)
+	{
+		Topology topology{ SphereTopology, { sliceCount, stackCount } };
+		return Detail::Update(vertices, range, GetSphereCounts(sliceCount, stackCount), topology, [&](auto* v)
+		{
+			WriteSphere<Writer, Detail::KeepIndices>(v, nullptr, writer, radius, sliceCount, stackCount);
+		});
+	}
+
+	template<typename Writer>
+	DirtyRange UpdateCylinder(typename Writer::VertexType* vertices, const Range& range, const Writer& writer,
+		float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount)
+	{
+		Topology topology{ CylinderTopology, { sliceCount, stackCount } };
+		return Detail::Update(vertices, range, GetCylinderCounts(sliceCount, stackCount), topology, [&](auto* v)
+		{
+			WriteCylinder<Writer, Detail::KeepIndices>(v, nullptr, writer, bottomRadius, topRadius, height, sliceCount, stackCount);
+		});
+	}
+
+	template<typename Writer>
+	DirtyRange UpdateCone(typename Writer::VertexType* vertices, const Range& range, const Writer& writer,
+		float radius, float topRadius, float bottomRadius, float height, uint32 sliceCount, uint32 stackCount)
+	{
+		Topology topology{ ConeTopology, { sliceCount, stackCount } };
+		return Detail::Update(vertices, range, GetConeCounts(sliceCount, stackCount), topology, [&](auto* v)
+		{
+			WriteCone<Writer, Detail::KeepIndices>(v, nullptr, writer, radius, topRadius, bottomRadius, height, sliceCount, stackCount);
+		});
+	}
+
+	template<typename Writer>
+	DirtyRange UpdateGrid(typename Writer::VertexType* vertices, const Range& range, const Writer& writer,
+		float width, float depth, uint32 m, uint32 n)
+	{
+		Topology topology{ GridTopology, { m, n } };
+		return Detail::Update(vertices, range, GetGridCounts(m, n), topology, [&](auto* v)
+		{
+			WriteGrid<Writer, Detail::KeepIndices>(v, nullptr, writer, width, depth, m, n);
+		});
+	}
+}
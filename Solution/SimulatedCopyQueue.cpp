@@ -0,0 +1,104 @@
+//***************************************************************************************
+// SimulatedCopyQueue.cpp
+//***************************************************************************************
+
+#include "SimulatedCopyQueue.h"
+
+#include <chrono>
+#include <cstring>
+
+SimulatedCopyQueue::SimulatedCopyQueue(const void* staging, double bytesPerSecond, double latencySeconds)
+	: mStaging(static_cast<const std::uint8_t*>(staging)), mBytesPerSecond(bytesPerSecond), mLatencySeconds(latencySeconds)
+{
+	mEngine = std::thread(&SimulatedCopyQueue::EngineMain, this);
+}
+
+SimulatedCopyQueue::~SimulatedCopyQueue()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mWork.notify_one();
+	mEngine.join();
+}
+
+CopyQueue::uint64 SimulatedCopyQueue::Submit(const Copy* copies, uint32 count)
+{
+	uint64 fence;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		// Reuse the copy lists of finished batches.
+		Batch batch;
+		if(!mFreeBatches.empty())
+		{
+			batch = std::move(mFreeBatches.back());
+			mFreeBatches.pop_back();
+		}
+
+		fence = mNextFence++;
+		batch.FenceValue = fence;
+		batch.Copies.assign(copies, copies + count);
+		mBatches.push_back(std::move(batch));
+	}
+	mWork.notify_one();
+	return fence;
+}
+
+CopyQueue::uint64 SimulatedCopyQueue::GetCompletedFence()
+{
+	return mCompletedFence.load(std::memory_order_acquire);
+}
+
+void SimulatedCopyQueue::WaitForFence(uint64 value)
+{
+	if(GetCompletedFence() >= value)
+		return;
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	mCompleted.wait(lock, [this, value]() { return GetCompletedFence() >= value; });
+}
+
+void SimulatedCopyQueue::EngineMain()
+{
+	for(;;)
+	{
+		Batch batch;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWork.wait(lock, [this]() { return mStopping || !mBatches.empty(); });
+			if(mBatches.empty())
+				return;
+
+			batch = std::move(mBatches.front());
+			mBatches.pop_front();
+		}
+
+		auto start = std::chrono::steady_clock::now();
+
+		uint64 bytes = 0;
+		for(const Copy& copy : batch.Copies)
+		{
+			std::memcpy(static_cast<std::uint8_t*>(copy.Destination) + copy.DestinationOffset,
+				mStaging + copy.SourceOffset, (std::size_t)copy.Size);
+			bytes += copy.Size;
+		}
+
+		double seconds = mLatencySeconds;
+		if(mBytesPerSecond > 0.0)
+			seconds += (double)bytes / mBytesPerSecond;
+		if(seconds > 0.0)
+			std::this_thread::sleep_until(start + std::chrono::duration<double>(seconds));
+
+		mCopiedBytes.fetch_add(bytes, std::memory_order_release);
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mCompletedFence.store(batch.FenceValue, std::memory_order_release);
+			batch.Copies.clear();
+			mFreeBatches.push_back(std::move(batch));
+		}
+		mCompleted.notify_all();
+	}
+}
@@ -0,0 +1,68 @@
+//***************************************************************************************
+// SimulatedCopyQueue.h
+//
+// A CopyQueue for running StagingUploader without a GPU.  Destinations are plain
+// memory (Copy::Destination is the base address of the destination buffer) and a
+// thread executes the batches in order, memcpy'ing out of the staging buffer and then
+// completing the batch's fence.  An optional bandwidth and per-batch latency make the
+// copies take about as long as a real copy engine would, so the uploader's waits show.
+//***************************************************************************************
+
+#pragma once
+
+#include "StagingUploader.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class SimulatedCopyQueue : public CopyQueue
+{
+public:
+
+	///<summary>
+	/// staging is the staging buffer the copies' SourceOffset refer to.  A
+	/// bytesPerSecond of zero copies as fast as memcpy allows.
+	///</summary>
+	explicit SimulatedCopyQueue(const void* staging, double bytesPerSecond = 0.0, double latencySeconds = 0.0);
+	SimulatedCopyQueue(const SimulatedCopyQueue& rhs) = delete;
+	SimulatedCopyQueue& operator=(const SimulatedCopyQueue& rhs) = delete;
+	~SimulatedCopyQueue();
+
+	uint64 Submit(const Copy* copies, uint32 count)override;
+	uint64 GetCompletedFence()override;
+	void WaitForFence(uint64 value)override;
+
+	///<summary>
+	/// Bytes copied so far.
+	///</summary>
+	uint64 GetCopiedBytes()const { return mCopiedBytes.load(std::memory_order_acquire); }
+
+private:
+	struct Batch
+	{
+		uint64 FenceValue = 0;
+		std::vector<Copy> Copies;
+	};
+
+	void EngineMain();
+
+	const std::uint8_t* mStaging = nullptr;
+	double mBytesPerSecond = 0.0;
+	double mLatencySeconds = 0.0;
+
+	std::mutex mMutex;
+	std::condition_variable mWork;
+	std::condition_variable mCompleted;
+	std::deque<Batch> mBatches;
+	std::vector<Batch> mFreeBatches;
+	uint64 mNextFence = 1;
+	bool mStopping = false;
+
+	std::atomic<uint64> mCompletedFence{ 0 };
+	std::atomic<uint64> mCopiedBytes{ 0 };
+	std::thread mEngine;
+};
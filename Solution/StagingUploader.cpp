@@ -0,0 +1,222 @@
+//***************************************************************************************
+// StagingUploader.cpp
+//***************************************************************************************
+
+#include "StagingUploader.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+StagingRing::StagingRing(uint64 capacity)
+	: mCapacity(capacity)
+{
+	assert(capacity > 0);
+}
+
+bool StagingRing::Allocate(uint64 size, uint64 alignment, uint64& offset)
+{
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && mCapacity % alignment == 0);
+
+	if(size > mCapacity)
+		return false;
+
+	// With nothing in use, start again at the front of the buffer so the whole of it
+	// is available in one piece.
+	if(mHead == mTail)
+	{
+		uint64 start = (mHead + mCapacity - 1) / mCapacity * mCapacity;
+		mHead = mTail = mClosed = start;
+	}
+
+	uint64 begin = (mHead + alignment - 1) & ~(alignment - 1);
+
+	// An allocation never straddles the end of the buffer; skip to the front instead.
+	if(begin % mCapacity + size > mCapacity)
+		begin = (begin / mCapacity + 1) * mCapacity;
+
+	if(begin + size - mTail > mCapacity)
+		return false;
+
+	mHead = begin + size;
+	mPeakUsed = std::max(mPeakUsed, mHead - mTail);
+	offset = begin % mCapacity;
+	return true;
+}
+
+void StagingRing::Close(uint64 fenceValue)
+{
+	if(mHead == mClosed)
+		return;
+
+	mBatches.push_back({ fenceValue, mHead });
+	mClosed = mHead;
+}
+
+void StagingRing::Retire(uint64 completedFence)
+{
+	while(!mBatches.empty() && mBatches.front().FenceValue <= completedFence)
+	{
+		mTail = mBatches.front().End;
+		mBatches.pop_front();
+	}
+}
+
+StagingUploader::StagingUploader(CopyQueue& queue, void* staging, uint64 capacity)
+	: mQueue(queue), mStaging(static_cast<std::uint8_t*>(staging)), mRing(capacity)
+{
+	mStats.Capacity = capacity;
+}
+
+StagingUploader::~StagingUploader()
+{
+	// The copy engine may still be reading the staging buffer.
+	WaitIdle();
+}
+
+void* StagingUploader::Stage(void* destination, uint64 destinationOffset, uint64 size, uint64 alignment)
+{
+	uint64 offset = 0;
+	if(!Reserve(size, alignment, offset))
+		return nullptr;
+
+	Queue(destination, destinationOffset, offset, size);
+	return mStaging + offset;
+}
+
+void StagingUploader::Upload(void* destination, uint64 destinationOffset, const void* data, uint64 size)
+{
+	const std::uint8_t* src = static_cast<const std::uint8_t*>(data);
+
+	// Half the buffer at most, so a piece always fits once the ring has drained.
+	const uint64 maxPiece = std::max<uint64>(mRing.GetCapacity() / 2, 16);
+
+	while(size > 0)
+	{
+		uint64 piece = std::min(size, maxPiece);
+
+		uint64 offset = 0;
+		if(!Reserve(piece, 16, offset))
+		{
+			// The copies queued since the last Flush hold the space; send them off.
+			Flush();
+			bool reserved = Reserve(piece, 16, offset);
+			assert(reserved);
+			(void)reserved;
+		}
+
+		std::memcpy(mStaging + offset, src, piece);
+		Queue(destination, destinationOffset, offset, piece);
+
+		src += piece;
+		destinationOffset += piece;
+		size -= piece;
+	}
+}
+
+StagingUploader::uint64 StagingUploader::Flush()
+{
+	if(mPending.empty())
+		return mLastFence;
+
+	mLastFence = mQueue.Submit(mPending.data(), (uint32)mPending.size());
+	mRing.Close(mLastFence);
+	mPending.clear();
+	++mStats.Batches;
+
+	return mLastFence;
+}
+
+void StagingUploader::WaitIdle()
+{
+	uint64 fence = Flush();
+	if(fence == 0)
+		return;
+
+	mQueue.WaitForFence(fence);
+	mRing.Retire(fence);
+}
+
+void StagingUploader::EndFrame()
+{
+	mRing.Retire(mQueue.GetCompletedFence());
+
+	mStats.FrameBytes = mFrameBytes;
+	mStats.PeakFrameBytes = std::max(mStats.PeakFrameBytes, mFrameBytes);
+	++mStats.Frames;
+	mFrameBytes = 0;
+}
+
+bool StagingUploader::WriteReport(const char* path)const
+{
+	std::FILE* file = std::fopen(path, "w");
+	if(file == nullptr)
+		return false;
+
+	const Stats& s = mStats;
+	std::fprintf(file, "staging capacity    %14llu bytes\n", (unsigned long long)s.Capacity);
+	std::fprintf(file, "peak staging in use %14llu bytes\n", (unsigned long long)s.PeakStagingBytes);
+	std::fprintf(file, "uploaded            %14llu bytes in %u copies, %u batches\n",
+		(unsigned long long)s.TotalBytes, s.Copies, s.Batches);
+	std::fprintf(file, "per frame           %14.0f bytes average, %llu peak over %u frames\n",
+		s.Frames > 0 ? (double)s.TotalBytes / s.Frames : 0.0, (unsigned long long)s.PeakFrameBytes, s.Frames);
+	std::fprintf(file, "stalls              %14u\n", s.Stalls);
+
+	return std::fclose(file) == 0;
+}
+
+bool StagingUploader::Reserve(uint64 size, uint64 alignment, uint64& offset)
+{
+	for(;;)
+	{
+		if(mRing.Allocate(size, alignment, offset))
+		{
+			mStats.PeakStagingBytes = mRing.GetPeakUsedBytes();
+			return true;
+		}
+
+		mRing.Retire(mQueue.GetCompletedFence());
+		if(mRing.Allocate(size, alignment, offset))
+		{
+			mStats.PeakStagingBytes = mRing.GetPeakUsedBytes();
+			return true;
+		}
+
+		// Only the copies not yet submitted are left holding the space.
+		uint64 oldest = mRing.GetOldestFence();
+		if(oldest == 0)
+			return false;
+
+		++mStats.Stalls;
+		mQueue.WaitForFence(oldest);
+		mRing.Retire(oldest);
+	}
+}
+
+void StagingUploader::Queue(void* destination, uint64 destinationOffset, uint64 sourceOffset, uint64 size)
+{
+	mFrameBytes += size;
+	mStats.TotalBytes += size;
+
+	// Back-to-back pieces of the same upload become one copy.
+	if(!mPending.empty())
+	{
+		CopyQueue::Copy& last = mPending.back();
+		if(last.Destination == destination &&
+			last.DestinationOffset + last.Size == destinationOffset &&
+			last.SourceOffset + last.Size == sourceOffset)
+		{
+			last.Size += size;
+			return;
+		}
+	}
+
+	CopyQueue::Copy copy;
+	copy.Destination = destination;
+	copy.DestinationOffset = destinationOffset;
+	copy.SourceOffset = sourceOffset;
+	copy.Size = size;
+	mPending.push_back(copy);
+	++mStats.Copies;
+}
@@ -0,0 +1,201 @@
+//***************************************************************************************
+// StagingUploader.h
+//
+// Batches buffer uploads through one persistently mapped staging buffer used as a
+// ring.  Each upload takes space at the head of the ring, the caller writes (or the
+// uploader copies) the data there, and the copy into the destination buffer is queued.
+// Flush hands every queued copy to the copy engine as one batch and tags the ring space
+// they used with the batch's fence value; that space is reused once the fence has
+// completed, so no per-upload staging resource is created or kept alive.
+//
+// The copy engine sits behind the CopyQueue interface: D3D12CopyQueue records the
+// copies on a D3D12 copy queue, SimulatedCopyQueue copies on a thread for the
+// benchmarks.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+///<summary>
+/// Executes copies out of the staging buffer.  Fence values increase by one per Submit.
+///</summary>
+class CopyQueue
+{
+public:
+
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	struct Copy
+	{
+		void* Destination = nullptr;    // backend-specific buffer, e.g. an ID3D12Resource*
+		uint64 DestinationOffset = 0;
+		uint64 SourceOffset = 0;        // offset in the staging buffer
+		uint64 Size = 0;
+	};
+
+	virtual ~CopyQueue() = default;
+
+	///<summary>
+	/// Queues the copies as one batch and returns the fence value that completes when
+	/// they have all executed.
+	///</summary>
+	virtual uint64 Submit(const Copy* copies, uint32 count) = 0;
+
+	virtual uint64 GetCompletedFence() = 0;
+
+	///<summary>
+	/// Blocks until the fence value has completed.
+	///</summary>
+	virtual void WaitForFence(uint64 value) = 0;
+};
+
+///<summary>
+/// The space bookkeeping of the staging buffer.  Offsets handed out are byte offsets
+/// into the buffer; an allocation never wraps around its end.
+///</summary>
+class StagingRing
+{
+public:
+
+	using uint64 = std::uint64_t;
+
+	explicit StagingRing(uint64 capacity);
+
+	///<summary>
+	/// Takes size bytes aligned to alignment (a power of two).  Returns false, and
+	/// takes nothing, if the space is still in use.
+	///</summary>
+	bool Allocate(uint64 size, uint64 alignment, uint64& offset);
+
+	///<summary>
+	/// Tags everything allocated since the last Close with fenceValue.
+	///</summary>
+	void Close(uint64 fenceValue);
+
+	///<summary>
+	/// Frees the space of every batch whose fence value is at most completedFence.
+	///</summary>
+	void Retire(uint64 completedFence);
+
+	///<summary>
+	/// Fence value of the oldest batch still holding space, or 0 if there is none.
+	///</summary>
+	uint64 GetOldestFence()const { return mBatches.empty() ? 0 : mBatches.front().FenceValue; }
+
+	uint64 GetCapacity()const { return mCapacity; }
+	uint64 GetUsedBytes()const { return mHead - mTail; }
+	uint64 GetPeakUsedBytes()const { return mPeakUsed; }
+
+	///<summary>
+	/// Bytes allocated since the last Close.
+	///</summary>
+	uint64 GetOpenBytes()const { return mHead - mClosed; }
+
+private:
+	struct Batch
+	{
+		uint64 FenceValue;
+		uint64 End;
+	};
+
+	// Head and tail count bytes since the ring was created; the offset in the buffer
+	// is the count modulo the capacity.
+	uint64 mCapacity = 0;
+	uint64 mHead = 0;
+	uint64 mTail = 0;
+	uint64 mClosed = 0;
+	uint64 mPeakUsed = 0;
+	std::deque<Batch> mBatches;
+};
+
+class StagingUploader
+{
+public:
+
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	struct Stats
+	{
+		uint64 Capacity = 0;
+		uint64 TotalBytes = 0;          // bytes uploaded since creation
+		uint64 FrameBytes = 0;          // bytes uploaded in the last finished frame
+		uint64 PeakFrameBytes = 0;
+		uint64 PeakStagingBytes = 0;    // most staging space in use at once
+		uint32 Frames = 0;
+		uint32 Batches = 0;
+		uint32 Copies = 0;
+		uint32 Stalls = 0;              // times an upload waited for the copy engine
+	};
+
+	///<summary>
+	/// staging is the mapped staging buffer of capacity bytes.  It stays mapped, and it
+	/// and queue must outlive the uploader.
+	///</summary>
+	StagingUploader(CopyQueue& queue, void* staging, uint64 capacity);
+	StagingUploader(const StagingUploader& rhs) = delete;
+	StagingUploader& operator=(const StagingUploader& rhs) = delete;
+	~StagingUploader();
+
+	///<summary>
+	/// Queues a copy of size bytes into destination at destinationOffset and returns
+	/// the staging memory to write them to before the next Flush.  Waits for the copy
+	/// engine if earlier batches still hold the space.  Everything staged between two
+	/// Flushes has to fit the staging buffer at once; if it doesn't, nothing is queued
+	/// and nullptr is returned.
+	///</summary>
+	void* Stage(void* destination, uint64 destinationOffset, uint64 size, uint64 alignment = 16);
+
+	///<summary>
+	/// Copies data into the staging buffer and queues its upload.  Data larger than
+	/// the free space goes through in pieces, flushing in between, so memory returned
+	/// by Stage has to be written before calling Upload.
+	///</summary>
+	void Upload(void* destination, uint64 destinationOffset, const void* data, uint64 size);
+
+	///<summary>
+	/// Submits the queued copies as one batch and returns its fence value, or the
+	/// last batch's fence value if nothing was queued.
+	///</summary>
+	uint64 Flush();
+
+	///<summary>
+	/// Flushes and blocks until every upload has executed.
+	///</summary>
+	void WaitIdle();
+
+	///<summary>
+	/// Frees the staging space of completed batches and closes the frame's byte count.
+	/// Call once per frame.
+	///</summary>
+	void EndFrame();
+
+	///<summary>
+	/// Fence value of the last batch the copy engine has finished.
+	///</summary>
+	uint64 GetCompletedFence() { return mQueue.GetCompletedFence(); }
+
+	const Stats& GetStats()const { return mStats; }
+
+	///<summary>
+	/// Writes the stats to path.  Returns false if the file can't be written.
+	///</summary>
+	bool WriteReport(const char* path)const;
+
+private:
+	bool Reserve(uint64 size, uint64 alignment, uint64& offset);
+	void Queue(void* destination, uint64 destinationOffset, uint64 sourceOffset, uint64 size);
+
+	CopyQueue& mQueue;
+	std::uint8_t* mStaging = nullptr;
+	StagingRing mRing;
+
+	std::vector<CopyQueue::Copy> mPending;
+	uint64 mLastFence = 0;
+	uint64 mFrameBytes = 0;
+	Stats mStats;
+};
@@ -0,0 +1,162 @@
+//***************************************************************************************
+// TangentGenerator.cpp
+//***************************************************************************************
+
+#include "TangentGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	// Fewer triangles than this per range aren't worth a partial array of their own.
+	const uint32 MinTrianglesPerRange = 4096;
+
+	// Texture-space area below which a triangle has no usable u direction.
+	const float MinTexCoordArea = 1e-20f;
+
+	XMFLOAT3 Sub(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.x - b.x, a.y - b.y, a.z - b.z); }
+	float Dot(const XMFLOAT3& a, const XMFLOAT3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+	// a minus its component along the unit vector n.
+	XMFLOAT3 RejectFrom(const XMFLOAT3& a, const XMFLOAT3& n)
+	{
+		float d = Dot(a, n);
+		return XMFLOAT3(a.x - n.x * d, a.y - n.y * d, a.z - n.z * d);
+	}
+
+	// a normalized, or left alone if it has no length to speak of.
+	XMFLOAT3 Normalize(const XMFLOAT3& a, bool& valid)
+	{
+		float lengthSq = Dot(a, a);
+		valid = lengthSq > 1e-30f;
+		if(!valid)
+			return a;
+		float s = 1.0f / std::sqrt(lengthSq);
+		return XMFLOAT3(a.x * s, a.y * s, a.z * s);
+	}
+
+	// The triangles of one range and the tangent sums of the vertices they use.
+	struct Partial
+	{
+		uint32 FirstVertex = 0;
+		uint32 LastVertex = 0;
+		std::vector<XMFLOAT3> Sums;
+	};
+
+	void Accumulate(const GeometryGenerator::MeshData& mesh, uint32 firstTriangle, uint32 endTriangle, Partial& partial)
+	{
+		const std::vector<uint32>& indices = mesh.Indices32;
+		if(firstTriangle == endTriangle)
+			return;
+
+		auto bounds = std::minmax_element(indices.begin() + firstTriangle * 3, indices.begin() + endTriangle * 3);
+		partial.FirstVertex = *bounds.first;
+		partial.LastVertex = *bounds.second;
+		partial.Sums.assign(partial.LastVertex - partial.FirstVertex + 1, XMFLOAT3(0.0f, 0.0f, 0.0f));
+
+		for(uint32 t = firstTriangle; t < endTriangle; ++t)
+		{
+			const uint32* corner = &indices[t * 3];
+			const GeometryGenerator::Vertex* v[3] = { &mesh.Vertices[corner[0]], &mesh.Vertices[corner[1]], &mesh.Vertices[corner[2]] };
+
+			// The direction of increasing u across the triangle, scaled by its
+			// texture-space area and flipped for mirrored texture coordinates.
+			XMFLOAT3 d1 = Sub(v[1]->Position, v[0]->Position);
+			XMFLOAT3 d2 = Sub(v[2]->Position, v[0]->Position);
+			float s1 = v[1]->TexC.x - v[0]->TexC.x, t1 = v[1]->TexC.y - v[0]->TexC.y;
+			float s2 = v[2]->TexC.x - v[0]->TexC.x, t2 = v[2]->TexC.y - v[0]->TexC.y;
+			float area = s1 * t2 - t1 * s2;
+			if(std::fabs(area) < MinTexCoordArea)
+				continue;
+
+			float sign = area > 0.0f ? 1.0f : -1.0f;
+			XMFLOAT3 faceTangent((t2 * d1.x - t1 * d2.x) * sign, (t2 * d1.y - t1 * d2.y) * sign, (t2 * d1.z - t1 * d2.z) * sign);
+
+			for(int k = 0; k < 3; ++k)
+			{
+				const XMFLOAT3& n = v[k]->Normal;
+				bool valid;
+				XMFLOAT3 tangent = Normalize(RejectFrom(faceTangent, n), valid);
+				if(!valid)
+					continue;
+
+				// The corner's angle, measured in the plane of its normal.
+				bool valid1, valid2;
+				XMFLOAT3 e1 = Normalize(RejectFrom(Sub(v[(k + 1) % 3]->Position, v[k]->Position), n), valid1);
+				XMFLOAT3 e2 = Normalize(RejectFrom(Sub(v[(k + 2) % 3]->Position, v[k]->Position), n), valid2);
+				if(!valid1 || !valid2)
+					continue;
+				float angle = std::acos(std::min(1.0f, std::max(-1.0f, Dot(e1, e2))));
+
+				XMFLOAT3& sum = partial.Sums[corner[k] - partial.FirstVertex];
+				sum.x += tangent.x * angle;
+				sum.y += tangent.y * angle;
+				sum.z += tangent.z * angle;
+			}
+		}
+	}
+
+	// Any unit vector perpendicular to the unit vector n.
+	XMFLOAT3 AnyPerpendicular(const XMFLOAT3& n)
+	{
+		XMFLOAT3 axis = std::fabs(n.x) < 0.9f ? XMFLOAT3(1.0f, 0.0f, 0.0f) : XMFLOAT3(0.0f, 1.0f, 0.0f);
+		bool valid;
+		XMFLOAT3 tangent = Normalize(RejectFrom(axis, n), valid);
+		return valid ? tangent : axis;
+	}
+}
+
+void TangentGenerator::Generate(GeometryGenerator::MeshData& mesh, ThreadPool& pool)
+{
+	uint32 triangleCount = (uint32)(mesh.Indices32.size() / 3);
+	uint32 vertexCount = (uint32)mesh.Vertices.size();
+
+	uint32 rangeCount = std::max(1u, std::min(pool.GetThreadCount(), triangleCount / MinTrianglesPerRange));
+	std::vector<Partial> partials(rangeCount);
+	pool.ParallelFor(rangeCount, 1, [&](uint32 begin, uint32 end)
+	{
+		for(uint32 r = begin; r < end; ++r)
+		{
+			uint32 first = (uint32)((std::uint64_t)triangleCount * r / rangeCount);
+			uint32 last = (uint32)((std::uint64_t)triangleCount * (r + 1) / rangeCount);
+			Accumulate(mesh, first, last, partials[r]);
+		}
+	});
+
+	// Each vertex adds up the ranges that reached it, always in range order.
+	pool.ParallelFor(vertexCount, 16384, [&](uint32 begin, uint32 end)
+	{
+		std::vector<const Partial*> overlapping;
+		for(const Partial& partial : partials)
+		{
+			if(!partial.Sums.empty() && partial.FirstVertex < end && partial.LastVertex >= begin)
+				overlapping.push_back(&partial);
+		}
+
+		for(uint32 i = begin; i < end; ++i)
+		{
+			XMFLOAT3 sum(0.0f, 0.0f, 0.0f);
+			for(const Partial* partial : overlapping)
+			{
+				if(i < partial->FirstVertex || i > partial->LastVertex)
+					continue;
+				const XMFLOAT3& s = partial->Sums[i - partial->FirstVertex];
+				sum.x += s.x;
+				sum.y += s.y;
+				sum.z += s.z;
+			}
+
+			GeometryGenerator::Vertex& v = mesh.Vertices[i];
+			bool valid;
+			XMFLOAT3 tangent = Normalize(sum, valid);
+			v.TangentU = valid ? tangent : AnyPerpendicular(v.Normal);
+		}
+	});
+}
@@ -0,0 +1,38 @@
+//***************************************************************************************
+// TangentGenerator.h
+//
+// Per-vertex tangents for meshes whose tangents the generators didn't set: imported
+// meshes and height-displaced grids.  The tangent basis follows MikkTSpace, the one
+// normal-map bakers use: every triangle corner contributes the direction of increasing
+// u, taken from the triangle's positions and texture coordinates, projected into the
+// plane of the vertex normal and weighted by the corner's angle, and each vertex's sum
+// is normalized.  Triangles with degenerate texture coordinates contribute nothing,
+// and vertices left without a tangent get one perpendicular to their normal.
+//
+// Unlike MikkTSpace, vertices are never split where the tangent frame is discontinuous
+// (the indices stay as they are), and no bitangent sign is produced since TangentU has
+// no room for one.
+//
+// The triangles are cut into one range per pool thread.  Each range sums its corners
+// into a private array spanning the lowest to the highest vertex index its triangles
+// use, so nothing is shared while accumulating, and the arrays are then added up per
+// vertex in parallel.  Meshes whose index order follows their triangle order (grids,
+// the generators' shapes) keep these spans short, but a range can touch both ends of
+// the vertex buffer, so the arrays take up to threads x vertices x 12 bytes.
+// The sums are formed in the same order for a given thread count; with a different
+// thread count the tangents may differ in the last bits.
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+#include "ThreadPool.h"
+
+namespace TangentGenerator
+{
+	///<summary>
+	/// Overwrites the TangentU of every vertex of a triangle-list mesh.  The normals must
+	/// already be set.
+	///</summary>
+	void Generate(GeometryGenerator::MeshData& mesh, ThreadPool& pool);
+}
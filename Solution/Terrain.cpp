@@ -0,0 +1,61 @@
+//***************************************************************************************
+// Terrain.cpp
+//***************************************************************************************
+
+#include "Terrain.h"
+
+#include <cmath>
+
+using namespace DirectX;
+
+float GetHillsHeight(float x, float z)
+{
+	return 0.3f * (z * std::sin(0.1f * x) + x * std::cos(0.1f * z));
+}
+
+XMFLOAT3 GetHillsNormal(float x, float z)
+{
+	// n = (-df/dx, 1, -df/dz)
+	XMFLOAT3 n(
+		-0.03f * z * std::cos(0.1f * x) - 0.3f * std::cos(0.1f * z),
+		1.0f,
+		-0.3f * std::sin(0.1f * x) + 0.03f * x * std::sin(0.1f * z));
+
+	XMVECTOR unitNormal = XMVector3Normalize(XMLoadFloat3(&n));
+	XMStoreFloat3(&n, unitNormal);
+	return n;
+}
+
+XMFLOAT4 GetHillsColor(float height)
+{
+	if(height < -10.0f)
+		return XMFLOAT4(1.0f, 0.96f, 0.62f, 1.0f);   // Sandy beach color.
+	if(height < 5.0f)
+		return XMFLOAT4(0.48f, 0.77f, 0.46f, 1.0f);  // Light yellow-green.
+	if(height < 12.0f)
+		return XMFLOAT4(0.1f, 0.48f, 0.19f, 1.0f);   // Dark yellow-green.
+	if(height < 20.0f)
+		return XMFLOAT4(0.45f, 0.39f, 0.34f, 1.0f);  // Dark brown.
+	return XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);         // White snow.
+}
+
+Noise::Desc GetLandNoise()
+{
+	Noise::Desc desc;
+	desc.Type = Noise::Fractal::Ridged;
+	desc.Seed = 1;
+	desc.Octaves = 5;
+	desc.Frequency = 0.012f;
+	desc.Amplitude = 24.0f;
+	desc.WarpDistance = 15.0f;
+	desc.WarpFrequency = 0.008f;
+	return desc;
+}
+
+std::vector<float> GetGridHeights(const Noise::Desc& desc, float width, float depth,
+	ShapeWriter::uint32 m, ShapeWriter::uint32 n, ThreadPool& pool)
+{
+	std::vector<float> heights((std::size_t)m * n);
+	Noise::SampleGrid(desc, -0.5f * width, width / (n - 1), n, 0.5f * depth, -depth / (m - 1), m, heights.data(), pool);
+	return heights;
+}
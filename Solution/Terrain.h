@@ -0,0 +1,85 @@
+//***************************************************************************************
+// Terrain.h
+//
+// Height field and height-based coloring of the LandApp hills, and fractal noise as an
+// alternative height source.  Independent of D3D12, so the terrain can be generated and
+// measured outside the Windows app.
+//***************************************************************************************
+
+#pragma once
+
+#include "FrameConstants.h"
+#include "Noise.h"
+#include "ShapeWriter.h"
+#include "ThreadPool.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+///<summary>
+/// f(x,z) = 0.3(z sin(0.1x) + x cos(0.1z)).
+///</summary>
+float GetHillsHeight(float x, float z);
+
+///<summary>
+/// Unit normal of the hills height field at (x, z).
+///</summary>
+DirectX::XMFLOAT3 GetHillsNormal(float x, float z);
+
+///<summary>
+/// Sandy beaches, grassy low hills, brown slopes and snow peaks, by height.
+///</summary>
+DirectX::XMFLOAT4 GetHillsColor(float height);
+
+///<summary>
+/// Vertex writer for ShapeWriter::WriteGrid/AppendGrid: lifts each grid vertex onto the
+/// hills height field and colors it by its height.
+///</summary>
+struct HillsVertexWriter
+{
+	using VertexType = Vertex;
+	static const ShapeWriter::uint32 Attributes = ShapeWriter::Position;
+
+	void operator()(Vertex& dst, const GeometryGenerator::Vertex& src) const
+	{
+		dst.Pos = DirectX::XMFLOAT3(src.Position.x, GetHillsHeight(src.Position.x, src.Position.z), src.Position.z);
+		dst.Color = GetHillsColor(dst.Pos.y);
+	}
+};
+
+///<summary>
+/// Ridged mountains with domain-warped valleys, sized for the 160 x 160 LandApp grid and
+/// spanning the same color bands as the hills.
+///</summary>
+Noise::Desc GetLandNoise();
+
+///<summary>
+/// Noise heights of an m x n grid laid out as ShapeWriter::WriteGrid lays it out: row i
+/// at z = depth/2 - i dz, column j at x = -width/2 + j dx.  Rows are sampled in parallel;
+/// the result does not depend on the pool's size.
+///</summary>
+std::vector<float> GetGridHeights(const Noise::Desc& desc, float width, float depth,
+	ShapeWriter::uint32 m, ShapeWriter::uint32 n, ThreadPool& pool);
+
+///<summary>
+/// Vertex writer for ShapeWriter::WriteGrid/AppendGrid over precomputed heights, one per
+/// grid vertex in GetGridHeights order, found from the vertex's texture coordinates.
+/// Colors by height like HillsVertexWriter.
+///</summary>
+struct HeightMapVertexWriter
+{
+	using VertexType = Vertex;
+	static const ShapeWriter::uint32 Attributes = ShapeWriter::Position | ShapeWriter::TexC;
+
+	const float* Heights;
+	ShapeWriter::uint32 M;
+	ShapeWriter::uint32 N;
+
+	void operator()(Vertex& dst, const GeometryGenerator::Vertex& src) const
+	{
+		ShapeWriter::uint32 i = (ShapeWriter::uint32)(src.TexC.y * (M - 1) + 0.5f);
+		ShapeWriter::uint32 j = (ShapeWriter::uint32)(src.TexC.x * (N - 1) + 0.5f);
+		dst.Pos = DirectX::XMFLOAT3(src.Position.x, Heights[i * N + j], src.Position.z);
+		dst.Color = GetHillsColor(dst.Pos.y);
+	}
+};
@@ -0,0 +1,33 @@
+//***************************************************************************************
+// Checks.h
+//
+// What the test executables share: a check returns nullptr when it passes and what went
+// wrong when it doesn't, and RunChecks prints a line per check and gives main its exit
+// code, non-zero when any check failed.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+
+struct Check
+{
+	const char* Name;
+	const char* (*Run)();
+};
+
+template<std::size_t N>
+int RunChecks(const Check (&checks)[N])
+{
+	std::size_t failed = 0;
+	for(const Check& check : checks)
+	{
+		const char* error = check.Run();
+		std::printf("%-36s %s\n", check.Name, error == nullptr ? "ok" : error);
+		failed += error != nullptr;
+	}
+
+	std::printf("%s\n", failed == 0 ? "PASS" : "FAIL");
+	return failed == 0 ? 0 : 1;
+}
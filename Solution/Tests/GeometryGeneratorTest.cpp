@@ -0,0 +1,138 @@
+//***************************************************************************************
+// GeometryGeneratorTest.cpp
+//
+// CreateGeodesicSphere at frequencies from 1 up past the geosphere's: the mesh has to
+// be closed (every edge used once each way, so the vertices shared along icosahedron
+// edges were stitched), have the vertex and triangle counts of a frequency f geodesic
+// sphere with no duplicates, keep its vertices on the sphere and its triangles facing
+// out, match CreateGeosphere's triangle count at powers of two, and come out the same
+// on every pool size.
+//***************************************************************************************
+
+#include "Checks.h"
+
+#include "../GeometryGenerator.h"
+#include "../ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <utility>
+
+using namespace DirectX;
+
+namespace
+{
+	using MeshData = GeometryGenerator::MeshData;
+	using uint32 = GeometryGenerator::uint32;
+
+	const float kRadius = 0.5f;
+	const uint32 kFrequencies[] = { 1, 2, 3, 5, 7, 8, 16, 33, 64 };
+
+	// Every edge used once each way, so the shared edge vertices were stitched.
+	bool IsClosed(const MeshData& mesh)
+	{
+		std::map<std::pair<uint32, uint32>, int> edges;
+		for(std::size_t i = 0; i + 2 < mesh.Indices32.size(); i += 3)
+		{
+			for(int k = 0; k < 3; ++k)
+			{
+				uint32 a = mesh.Indices32[i + k], b = mesh.Indices32[i + (k + 1) % 3];
+				edges[std::make_pair(std::min(a, b), std::max(a, b))] += a < b ? 1 : -1;
+			}
+		}
+		for(const auto& edge : edges)
+		{
+			if(edge.second != 0)
+				return false;
+		}
+		return edges.size() * 2 == mesh.Indices32.size();
+	}
+
+	bool FacesOut(const MeshData& mesh)
+	{
+		for(std::size_t i = 0; i + 2 < mesh.Indices32.size(); i += 3)
+		{
+			XMVECTOR p0 = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[i]].Position);
+			XMVECTOR p1 = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[i + 1]].Position);
+			XMVECTOR p2 = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[i + 2]].Position);
+			if(XMVectorGetX(XMVector3Dot(XMVector3Cross(p1 - p0, p2 - p0), p0 + p1 + p2)) <= 0.0f)
+				return false;
+		}
+		return true;
+	}
+
+	bool OnSphere(const MeshData& mesh)
+	{
+		for(const GeometryGenerator::Vertex& v : mesh.Vertices)
+		{
+			float length = XMVectorGetX(XMVector3Length(XMLoadFloat3(&v.Position)));
+			if(std::fabs(length - kRadius) > 1e-5f)
+				return false;
+		}
+		return true;
+	}
+
+	const char* CheckGeodesicSphere()
+	{
+		GeometryGenerator geoGen;
+		ThreadPool pool(4);
+		for(uint32 f : kFrequencies)
+		{
+			MeshData mesh = geoGen.CreateGeodesicSphere(kRadius, f, pool);
+
+			// 20 f^2 triangles, and by Euler 10 f^2 + 2 vertices.
+			if(mesh.Indices32.size() != 60 * f * f || mesh.Vertices.size() != 10 * f * f + 2)
+				return "wrong vertex or triangle count";
+			if(!IsClosed(mesh))
+				return "not closed";
+			if(!OnSphere(mesh))
+				return "vertex off the sphere";
+			if(!FacesOut(mesh))
+				return "triangle facing in";
+		}
+		return nullptr;
+	}
+
+	const char* CheckGeosphereCounts()
+	{
+		GeometryGenerator geoGen;
+		ThreadPool pool(4);
+		for(uint32 n = 0; n <= 4; ++n)
+		{
+			MeshData geosphere = geoGen.CreateGeosphere(kRadius, n);
+			MeshData geodesic = geoGen.CreateGeodesicSphere(kRadius, 1u << n, pool);
+			if(geodesic.Indices32.size() != geosphere.Indices32.size())
+				return "triangle count differs from CreateGeosphere";
+		}
+		return nullptr;
+	}
+
+	const char* CheckThreadCounts()
+	{
+		GeometryGenerator geoGen;
+		ThreadPool single(1);
+		MeshData expected = geoGen.CreateGeodesicSphere(kRadius, 33, single);
+		for(uint32 threads : { 0u, 2u, 5u })
+		{
+			ThreadPool pool(threads);
+			MeshData mesh = geoGen.CreateGeodesicSphere(kRadius, 33, pool);
+			if(mesh.Indices32 != expected.Indices32 || mesh.Vertices.size() != expected.Vertices.size() ||
+				std::memcmp(mesh.Vertices.data(), expected.Vertices.data(), mesh.Vertices.size() * sizeof(GeometryGenerator::Vertex)) != 0)
+				return "result depends on the thread count";
+		}
+		return nullptr;
+	}
+}
+
+int main()
+{
+	const Check checks[] =
+	{
+		{ "geodesic sphere closed and counted", CheckGeodesicSphere },
+		{ "geosphere triangle counts", CheckGeosphereCounts },
+		{ "pool sizes", CheckThreadCounts },
+	};
+	return RunChecks(checks);
+}
@@ -0,0 +1,296 @@
+//***************************************************************************************
+// GlbFileTest.cpp
+//
+// GlbFile on binary glTF files written here from a GeometryGenerator grid, stored the
+// way glTF has it: right-handed and counter-clockwise, so z and every triangle are
+// mirrored.  The views have to show the data as stored, and CopyTo and WritePrimitive
+// have to give the grid back, winding included, with 32-bit, 16-bit and no indices;
+// without the conversion they have to keep what was stored.  Files that are truncated,
+// not glTF, have accessors reaching outside their buffer or indices past the vertices
+// have to be refused.
+//***************************************************************************************
+
+#include "Checks.h"
+
+#include "../FrameConstants.h"
+#include "../GlbFile.h"
+#include "../ScenePacker.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	using ColorWriter = ShapeWriter::PositionColorWriter<Vertex>;
+	using Packer = ScenePacker<ColorWriter, std::uint32_t>;
+	using uint32 = std::uint32_t;
+
+	const ColorWriter kWriter{ DirectX::XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f) };
+	const char* const kPath = "GlbFileTest.glb";
+
+	struct Source
+	{
+		GeometryGenerator::MeshData Grid;
+		std::vector<uint32> Indices;         // as stored: each grid triangle reversed
+	};
+
+	Source MakeSource()
+	{
+		GeometryGenerator geoGen;
+		Source source;
+		source.Grid = geoGen.CreateGrid(16.0f, 12.0f, 21, 17);
+		source.Indices = source.Grid.Indices32;
+		for(std::size_t i = 0; i + 2 < source.Indices.size(); i += 3)
+			std::swap(source.Indices[i + 1], source.Indices[i + 2]);
+		return source;
+	}
+
+	void Append(std::vector<std::uint8_t>& out, const void* data, std::size_t size)
+	{
+		const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+		out.insert(out.end(), bytes, bytes + size);
+	}
+
+	void AppendUint32(std::vector<std::uint8_t>& out, uint32 value)
+	{
+		Append(out, &value, sizeof(value));
+	}
+
+	bool WriteFile(const std::vector<std::uint8_t>& bytes)
+	{
+		std::FILE* f = std::fopen(kPath, "wb");
+		if(f == nullptr)
+			return false;
+		bool written = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+		return std::fclose(f) == 0 && written;
+	}
+
+	// The GLB bytes of one primitive holding vertices as given and, unless indexType is
+	// 0, indices of that component type.  byteLengthSlack makes the buffer claim more
+	// bytes than the BIN chunk has.
+	std::vector<std::uint8_t> BuildGlb(const std::vector<GeometryGenerator::Vertex>& vertices, const std::vector<uint32>& indices,
+		uint32 indexType, uint32 mode = Gltf::TrianglesMode, std::size_t byteLengthSlack = 0)
+	{
+		uint32 n = (uint32)vertices.size();
+
+		std::vector<std::uint8_t> bin;
+		for(const GeometryGenerator::Vertex& v : vertices)
+			Append(bin, &v.Position, 12);
+		for(const GeometryGenerator::Vertex& v : vertices)
+			Append(bin, &v.Normal, 12);
+		for(const GeometryGenerator::Vertex& v : vertices)
+		{
+			float tangent[4] = { v.TangentU.x, v.TangentU.y, v.TangentU.z, 1.0f };
+			Append(bin, tangent, sizeof(tangent));
+		}
+		for(const GeometryGenerator::Vertex& v : vertices)
+			Append(bin, &v.TexC, 8);
+		for(uint32 index : indices)
+		{
+			if(indexType == Gltf::UnsignedShort)
+			{
+				std::uint16_t narrow = (std::uint16_t)index;
+				Append(bin, &narrow, sizeof(narrow));
+			}
+			else if(indexType == Gltf::UnsignedInt)
+				Append(bin, &index, sizeof(index));
+		}
+
+		int viewCount = indexType != 0 ? 5 : 4;
+		std::size_t offsets[] = { 0, 12 * (std::size_t)n, 24 * (std::size_t)n, 40 * (std::size_t)n, 48 * (std::size_t)n, bin.size() };
+		const char* types[] = { "VEC3", "VEC3", "VEC4", "VEC2", "SCALAR" };
+
+		std::string json = "{\"asset\":{\"version\":\"2.0\"},"
+			"\"meshes\":[{\"name\":\"grid\",\"primitives\":[{\"attributes\":"
+			"{\"POSITION\":0,\"NORMAL\":1,\"TANGENT\":2,\"TEXCOORD_0\":3}" +
+			std::string(indexType != 0 ? ",\"indices\":4" : "") + ",\"mode\":" + std::to_string(mode) + "}]}],"
+			"\"buffers\":[{\"byteLength\":" + std::to_string(bin.size() + byteLengthSlack) + "}],\"bufferViews\":[";
+		for(int k = 0; k < viewCount; ++k)
+		{
+			json += (k ? ",{" : "{") + std::string("\"buffer\":0,\"byteOffset\":") + std::to_string(offsets[k]) +
+				",\"byteLength\":" + std::to_string(offsets[k + 1] - offsets[k] + (k == viewCount - 1 ? byteLengthSlack : 0)) + "}";
+		}
+		json += "],\"accessors\":[";
+		for(int k = 0; k < viewCount; ++k)
+		{
+			json += (k ? ",{" : "{") + std::string("\"bufferView\":") + std::to_string(k) + ",\"componentType\":" +
+				std::to_string(k == 4 ? indexType : Gltf::Float) + ",\"count\":" +
+				std::to_string(k == 4 ? (uint32)indices.size() + (uint32)byteLengthSlack / 2 : n) + ",\"type\":\"" + types[k] + "\"}";
+		}
+		json += "]}";
+		while(json.size() % 4 != 0)
+			json += ' ';
+		while(bin.size() % 4 != 0)
+			bin.push_back(0);
+
+		std::vector<std::uint8_t> out;
+		AppendUint32(out, 0x46546C67);
+		AppendUint32(out, 2);
+		AppendUint32(out, (uint32)(12 + 8 + json.size() + 8 + bin.size()));
+		AppendUint32(out, (uint32)json.size());
+		AppendUint32(out, 0x4E4F534A);
+		Append(out, json.data(), json.size());
+		AppendUint32(out, (uint32)bin.size());
+		AppendUint32(out, 0x004E4942);
+		Append(out, bin.data(), bin.size());
+		return out;
+	}
+
+	// The grid's vertices with z mirrored, as glTF stores them.
+	std::vector<GeometryGenerator::Vertex> RightHanded(std::vector<GeometryGenerator::Vertex> vertices)
+	{
+		for(GeometryGenerator::Vertex& v : vertices)
+		{
+			v.Position.z = -v.Position.z;
+			v.Normal.z = -v.Normal.z;
+			v.TangentU.z = -v.TangentU.z;
+		}
+		return vertices;
+	}
+
+	bool SameVertices(const std::vector<GeometryGenerator::Vertex>& a, const std::vector<GeometryGenerator::Vertex>& b)
+	{
+		return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(GeometryGenerator::Vertex)) == 0;
+	}
+
+	// Views, CopyTo both ways and the packer path for a file with indexType indices.
+	const char* CheckIndexed(uint32 indexType)
+	{
+		Source source = MakeSource();
+		std::vector<GeometryGenerator::Vertex> stored = RightHanded(source.Grid.Vertices);
+
+		GlbFile file;
+		if(!WriteFile(BuildGlb(stored, source.Indices, indexType)) || !file.Open(kPath) || file.FindMesh("grid") != 0)
+			return "could not write and open the file";
+		const Gltf::Primitive& primitive = file.GetMesh(0).Primitives[0];
+
+		const char* error = nullptr;
+		GeometryGenerator::MeshData mesh;
+		Gltf::AccessorView<DirectX::XMFLOAT3> positions;
+		if(!GlbFile::GetView(primitive.Position, positions) || positions.GetArray() == nullptr ||
+			std::memcmp(&positions[1], &stored[1].Position, sizeof(DirectX::XMFLOAT3)) != 0)
+			error = "position view does not show the stored data";
+		else if(!GlbFile::CopyTo(primitive, mesh, false) || mesh.Indices32 != source.Indices || !SameVertices(mesh.Vertices, stored))
+			error = "unconverted copy differs from what was stored";
+		else if(!GlbFile::CopyTo(primitive, mesh) || mesh.Indices32 != source.Grid.Indices32 || !SameVertices(mesh.Vertices, source.Grid.Vertices))
+			error = "converted copy is not the grid";
+		else
+		{
+			// WritePrimitive into the packer, and into 16-bit indices.
+			Packer packer, reference;
+			packer.AddCustom(kWriter, { primitive.GetVertexCount(), primitive.GetIndexCount() },
+				[&primitive](Vertex* v, uint32* i, const auto& writer) { GlbFile::WritePrimitive(primitive, v, i, writer); });
+			reference.AddMesh(kWriter, source.Grid.Vertices.data(), (uint32)source.Grid.Vertices.size(),
+				source.Grid.Indices32.data(), (uint32)source.Grid.Indices32.size());
+
+			std::vector<Vertex> packedVertices(packer.GetVertexCount()), referenceVertices(reference.GetVertexCount());
+			std::vector<uint32> packedIndices(packer.GetIndexCount()), referenceIndices(reference.GetIndexCount());
+			packer.Write(packedVertices.data(), packer.GetVertexCount(), packedIndices.data(), packer.GetIndexCount());
+			reference.Write(referenceVertices.data(), reference.GetVertexCount(), referenceIndices.data(), reference.GetIndexCount());
+
+			std::vector<std::uint16_t> narrow(primitive.GetIndexCount());
+			std::vector<GeometryGenerator::Vertex> vertices(primitive.GetVertexCount());
+			GlbFile::WritePrimitive(primitive, vertices.data(), narrow.data(), ShapeWriter::GeneratorVertexWriter());
+
+			if(packedIndices != referenceIndices ||
+				std::memcmp(packedVertices.data(), referenceVertices.data(), packedVertices.size() * sizeof(Vertex)) != 0)
+				error = "packed primitive differs from the packed grid";
+			else if(!std::equal(narrow.begin(), narrow.end(), source.Grid.Indices32.begin()))
+				error = "16-bit WritePrimitive is not the grid's winding";
+		}
+
+		file.Close();
+		std::remove(kPath);
+		return error;
+	}
+
+	const char* CheckIndices32()
+	{
+		return CheckIndexed(Gltf::UnsignedInt);
+	}
+
+	const char* CheckIndices16()
+	{
+		return CheckIndexed(Gltf::UnsignedShort);
+	}
+
+	// A non-indexed triangle list numbers its corners, and converting reverses them too.
+	const char* CheckNonIndexed()
+	{
+		Source source = MakeSource();
+		std::vector<GeometryGenerator::Vertex> corners;
+		for(uint32 index : source.Indices)
+			corners.push_back(source.Grid.Vertices[index]);
+		std::vector<GeometryGenerator::Vertex> stored = RightHanded(corners);
+
+		GlbFile file;
+		if(!WriteFile(BuildGlb(stored, {}, 0)) || !file.Open(kPath))
+			return "could not write and open the file";
+
+		GeometryGenerator::MeshData mesh;
+		bool copied = GlbFile::CopyTo(file.GetMesh(0).Primitives[0], mesh);
+		file.Close();
+		std::remove(kPath);
+		if(!copied || mesh.Indices32.size() != source.Grid.Indices32.size())
+			return "could not copy the primitive";
+
+		for(std::size_t i = 0; i < mesh.Indices32.size(); ++i)
+		{
+			if(std::memcmp(&mesh.Vertices[mesh.Indices32[i]], &source.Grid.Vertices[source.Grid.Indices32[i]], sizeof(GeometryGenerator::Vertex)) != 0)
+				return "converted corners are not the grid's";
+		}
+		return nullptr;
+	}
+
+	const char* CheckRefusals()
+	{
+		Source source = MakeSource();
+		std::vector<GeometryGenerator::Vertex> stored = RightHanded(source.Grid.Vertices);
+		std::vector<std::uint8_t> valid = BuildGlb(stored, source.Indices, Gltf::UnsignedInt);
+
+		GlbFile file;
+		GeometryGenerator::MeshData mesh;
+		if(!WriteFile(BuildGlb(stored, source.Indices, Gltf::UnsignedInt, 1)) || !file.Open(kPath))
+			return "could not write and open a line primitive";
+		if(GlbFile::CopyTo(file.GetMesh(0).Primitives[0], mesh))
+			return "copied a primitive that is not a triangle list";
+		file.Close();
+
+		std::vector<uint32> pastEnd = source.Indices;
+		pastEnd[pastEnd.size() / 2] = (uint32)stored.size();
+
+		const char* error = nullptr;
+		std::vector<std::uint8_t> truncated(valid.begin(), valid.end() - 4);
+		std::vector<std::uint8_t> notGltf = valid;
+		notGltf[0] = 'x';
+		if(WriteFile(truncated) && file.Open(kPath))
+			error = "opened a truncated file";
+		else if(WriteFile(notGltf) && file.Open(kPath))
+			error = "opened a file that is not glTF";
+		else if(WriteFile(BuildGlb(stored, source.Indices, Gltf::UnsignedInt, Gltf::TrianglesMode, 64)) && file.Open(kPath))
+			error = "opened an accessor reaching outside the buffer";
+		else if(WriteFile(BuildGlb(stored, pastEnd, Gltf::UnsignedShort)) && file.Open(kPath))
+			error = "opened an index past the vertices";
+
+		file.Close();
+		std::remove(kPath);
+		return error;
+	}
+}
+
+int main()
+{
+	const Check checks[] =
+	{
+		{ "32-bit indices", CheckIndices32 },
+		{ "16-bit indices", CheckIndices16 },
+		{ "no indices", CheckNonIndexed },
+		{ "refuses bad files", CheckRefusals },
+	};
+	return RunChecks(checks);
+}
@@ -0,0 +1,197 @@
+//***************************************************************************************
+// MeshCodecTest.cpp
+//
+// MeshCodec round trips: the generated shapes through Compress and back, indices and
+// quantized vertices exactly and the dequantized vertices to quantization precision,
+// plus streams the generators never make: random indices and records, block-sized and
+// odd counts, every supported stride and 16-bit indices.  Truncated streams, too small
+// destinations and unsupported strides have to fail rather than misdecode.
+//***************************************************************************************
+
+#include "Checks.h"
+
+#include "../MeshCodec.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	using uint8 = std::uint8_t;
+	using uint16 = std::uint16_t;
+	using uint32 = std::uint32_t;
+
+	// Counts around the 48-index and 16-vertex blocks.
+	const uint32 kCounts[] = { 0, 1, 2, 15, 16, 17, 47, 48, 49, 96, 1000, 4099 };
+
+	std::vector<GeometryGenerator::MeshData> MakeShapes()
+	{
+		GeometryGenerator geoGen;
+
+		std::vector<GeometryGenerator::MeshData> shapes;
+		shapes.push_back(geoGen.CreateBox(1.0f, 1.0f, 1.0f, 3));
+		shapes.push_back(geoGen.CreateSphere(0.5f, 40, 40));
+		shapes.push_back(geoGen.CreateGeosphere(0.5f, 4));
+		shapes.push_back(geoGen.CreateGrid(160.0f, 160.0f, 65, 65));
+		shapes.push_back(geoGen.CreateCylinder(0.5f, 0.4f, 3.0f, 40, 40));
+		return shapes;
+	}
+
+	bool Near(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b, float tolerance)
+	{
+		return std::fabs(a.x - b.x) <= tolerance && std::fabs(a.y - b.y) <= tolerance && std::fabs(a.z - b.z) <= tolerance;
+	}
+
+	// Directions come back unit length whatever length they had, so only unit ones (the
+	// geosphere's pole tangents are zero) can be compared.
+	bool SameDirection(const DirectX::XMFLOAT3& source, const DirectX::XMFLOAT3& restored)
+	{
+		float lengthSq = source.x * source.x + source.y * source.y + source.z * source.z;
+		return std::fabs(lengthSq - 1.0f) > 1e-3f || Near(source, restored, 1e-3f);
+	}
+
+	const char* CheckShapes()
+	{
+		for(const GeometryGenerator::MeshData& mesh : MakeShapes())
+		{
+			MeshCodec::CompressedMesh compressed;
+			MeshCodec::Compress(mesh, compressed);
+
+			uint32 vertexCount = compressed.VertexCount;
+			std::vector<MeshCodec::QuantizedVertex> quantized(vertexCount), decoded(vertexCount);
+			MeshCodec::Quantize(quantized.data(), mesh.Vertices.data(), vertexCount, compressed.Quantization);
+
+			std::vector<uint32> indices(compressed.IndexCount);
+			if(!MeshCodec::DecodeVertices(decoded.data(), vertexCount, sizeof(MeshCodec::QuantizedVertex),
+					compressed.Vertices.data(), compressed.Vertices.size()) ||
+				!MeshCodec::DecodeIndices(indices.data(), compressed.IndexCount, compressed.Indices.data(), compressed.Indices.size()))
+				return "could not decode a compressed shape";
+			if(indices != mesh.Indices32)
+				return "shape indices differ";
+			if(std::memcmp(decoded.data(), quantized.data(), vertexCount * sizeof(MeshCodec::QuantizedVertex)) != 0)
+				return "quantized shape vertices differ";
+
+			GeometryGenerator::MeshData restored;
+			if(!MeshCodec::Decompress(compressed, restored) || restored.Indices32 != mesh.Indices32 ||
+				restored.Vertices.size() != mesh.Vertices.size())
+				return "Decompress failed";
+
+			// Within a 16-bit step of the bounds, and octahedral 16-bit directions.
+			const MeshCodec::Quantization& q = compressed.Quantization;
+			float positionTolerance = std::fmax(q.PositionScale[0], std::fmax(q.PositionScale[1], q.PositionScale[2]));
+			float texCTolerance = std::fmax(q.TexCScale[0], q.TexCScale[1]) + 1e-6f;
+			for(std::size_t i = 0; i < mesh.Vertices.size(); ++i)
+			{
+				const GeometryGenerator::Vertex& a = mesh.Vertices[i];
+				const GeometryGenerator::Vertex& b = restored.Vertices[i];
+				if(!Near(a.Position, b.Position, positionTolerance))
+					return "dequantized position out of tolerance";
+				if(!SameDirection(a.Normal, b.Normal) || !SameDirection(a.TangentU, b.TangentU))
+					return "dequantized direction out of tolerance";
+				if(std::fabs(a.TexC.x - b.TexC.x) > texCTolerance || std::fabs(a.TexC.y - b.TexC.y) > texCTolerance)
+					return "dequantized texture coordinate out of tolerance";
+			}
+		}
+		return nullptr;
+	}
+
+	template<typename Index>
+	const char* RoundTripIndices(const std::vector<Index>& indices)
+	{
+		uint32 count = (uint32)indices.size();
+		std::vector<uint8> encoded(MeshCodec::GetIndexBufferBound(count));
+		std::size_t size = MeshCodec::EncodeIndices(encoded.data(), encoded.size(), indices.data(), count);
+		if(size == 0 || size > encoded.size())
+			return "index encoding failed";
+
+		std::vector<Index> decoded(count);
+		if(!MeshCodec::DecodeIndices(decoded.data(), count, encoded.data(), size) || decoded != indices)
+			return "indices differ";
+		if(size > 0 && MeshCodec::DecodeIndices(decoded.data(), count, encoded.data(), size - 1))
+			return "decoded a truncated index stream";
+		if(count > 0 && MeshCodec::EncodeIndices(encoded.data(), size - 1, indices.data(), count) != 0)
+			return "encoded into too small a buffer";
+		return nullptr;
+	}
+
+	const char* CheckIndices()
+	{
+		std::mt19937 rng(7);
+		for(uint32 count : kCounts)
+		{
+			// Random over the whole range, small random steps, and 16-bit.
+			std::vector<uint32> wide(count), walk(count);
+			std::vector<uint16> narrow(count);
+			uint32 at = 1000;
+			for(uint32 i = 0; i < count; ++i)
+			{
+				wide[i] = (uint32)rng();
+				at += (uint32)(rng() % 9) - 4;
+				walk[i] = at;
+				narrow[i] = (uint16)rng();
+			}
+
+			for(const char* error : { RoundTripIndices(wide), RoundTripIndices(walk), RoundTripIndices(narrow) })
+			{
+				if(error != nullptr)
+					return error;
+			}
+		}
+
+		// An index above 65535 does not decode into 16 bits.
+		std::vector<uint32> large = { 0, 1, 70000 };
+		std::vector<uint8> encoded(MeshCodec::GetIndexBufferBound(3));
+		std::size_t size = MeshCodec::EncodeIndices(encoded.data(), encoded.size(), large.data(), 3);
+		uint16 narrow[3];
+		if(size == 0 || MeshCodec::DecodeIndices(narrow, 3, encoded.data(), size))
+			return "decoded 70000 into a 16-bit index";
+		return nullptr;
+	}
+
+	const char* CheckVertices()
+	{
+		std::mt19937 rng(11);
+		for(uint32 stride = 4; stride <= MeshCodec::MaxVertexStride; stride += stride < 32 ? 4 : 28)
+		{
+			for(uint32 count : kCounts)
+			{
+				// Half the records random, half drifting slowly, so every plane width shows.
+				std::vector<uint8> records((std::size_t)count * stride);
+				for(std::size_t b = 0; b < records.size(); ++b)
+					records[b] = b < records.size() / 2 ? (uint8)rng() : (uint8)(b / stride + (b % stride) * 3);
+
+				std::vector<uint8> encoded(MeshCodec::GetVertexBufferBound(count, stride));
+				std::size_t size = MeshCodec::EncodeVertices(encoded.data(), encoded.size(), records.data(), count, stride);
+				if(size == 0 || size > encoded.size())
+					return "vertex encoding failed";
+
+				std::vector<uint8> decoded(records.size());
+				if(!MeshCodec::DecodeVertices(decoded.data(), count, stride, encoded.data(), size) || decoded != records)
+					return "vertex records differ";
+				if(MeshCodec::DecodeVertices(decoded.data(), count, stride, encoded.data(), size - 1))
+					return "decoded a truncated vertex stream";
+			}
+		}
+
+		uint8 record[MeshCodec::MaxVertexStride + 4] = {};
+		std::vector<uint8> encoded(MeshCodec::GetVertexBufferBound(1, MeshCodec::MaxVertexStride + 4));
+		if(MeshCodec::EncodeVertices(encoded.data(), encoded.size(), record, 1, 6) != 0 ||
+			MeshCodec::EncodeVertices(encoded.data(), encoded.size(), record, 1, MeshCodec::MaxVertexStride + 4) != 0)
+			return "encoded an unsupported stride";
+		return nullptr;
+	}
+}
+
+int main()
+{
+	const Check checks[] =
+	{
+		{ "generated shapes", CheckShapes },
+		{ "index streams", CheckIndices },
+		{ "vertex streams", CheckVertices },
+	};
+	return RunChecks(checks);
+}
@@ -0,0 +1,299 @@
+//***************************************************************************************
+// MeshFileTest.cpp
+//
+// Mesh files written from generated shapes and mapped back: every submesh has to come
+// back byte for byte with 16- and with 32-bit indices, packing from the mapping has to
+// give what packing the generated meshes gives, the packer's byte sizes have to hold
+// past 4 GiB, and files that are truncated, of
+// another major version, with an index past the vertices or not mesh files at all have
+// to be refused.
+//***************************************************************************************
+
+#include "Checks.h"
+
+#include "../FrameConstants.h"
+#include "../MeshFile.h"
+#include "../ScenePacker.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	using ColorWriter = ShapeWriter::PositionColorWriter<Vertex>;
+	using Packer = ScenePacker<ColorWriter, std::uint32_t>;
+	using uint32 = std::uint32_t;
+
+	const char* const kShapeNames[] = { "sphere", "geosphere", "grid", "cylinder" };
+	const uint32 kShapeCount = 4;
+	const char* const kPath = "MeshFileTest.msh";
+
+	const ColorWriter kWriter{ DirectX::XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f) };
+
+	// A grid of gridSide x gridSide vertices; more than 256 per side needs 32-bit indices.
+	std::vector<GeometryGenerator::MeshData> Generate(uint32 gridSide)
+	{
+		GeometryGenerator geoGen;
+
+		std::vector<GeometryGenerator::MeshData> meshes;
+		meshes.push_back(geoGen.CreateSphere(0.5f, 20, 20));
+		meshes.push_back(geoGen.CreateGeosphere(0.5f, 3));
+		meshes.push_back(geoGen.CreateGrid(75.0f, 75.0f, gridSide, gridSide));
+		meshes.push_back(geoGen.CreateCylinder(0.5f, 0.4f, 3.0f, 20, 20));
+		return meshes;
+	}
+
+	// One file with a submesh per shape, with indexSize-byte indices.
+	bool WriteScene(const std::vector<GeometryGenerator::MeshData>& meshes, uint32 indexSize)
+	{
+		std::vector<GeometryGenerator::Vertex> vertices;
+		std::vector<uint32> indices;
+		std::vector<MeshFile::SubmeshDesc> submeshes;
+		for(uint32 s = 0; s < kShapeCount; ++s)
+		{
+			MeshFile::SubmeshDesc desc;
+			desc.Name = kShapeNames[s];
+			desc.Range.BaseVertex = (uint32)vertices.size();
+			desc.Range.VertexCount = (uint32)meshes[s].Vertices.size();
+			desc.Range.StartIndex = (uint32)indices.size();
+			desc.Range.IndexCount = (uint32)meshes[s].Indices32.size();
+			submeshes.push_back(desc);
+
+			vertices.insert(vertices.end(), meshes[s].Vertices.begin(), meshes[s].Vertices.end());
+			indices.insert(indices.end(), meshes[s].Indices32.begin(), meshes[s].Indices32.end());
+		}
+
+		if(indexSize == 2)
+		{
+			std::vector<std::uint16_t> indices16(indices.begin(), indices.end());
+			return MeshFile::Write(kPath, vertices.data(), (uint32)vertices.size(), indices16.data(), 2, (uint32)indices16.size(),
+				submeshes.data(), kShapeCount);
+		}
+		return MeshFile::Write(kPath, vertices.data(), (uint32)vertices.size(), indices.data(), 4, (uint32)indices.size(),
+			submeshes.data(), kShapeCount);
+	}
+
+	template<typename Index>
+	bool SameIndices(const Index* indices, const std::vector<uint32>& expected)
+	{
+		for(std::size_t i = 0; i < expected.size(); ++i)
+		{
+			if(indices[i] != expected[i])
+				return false;
+		}
+		return true;
+	}
+
+	bool Inside(const DirectX::XMFLOAT3& p, const float boundsMin[3], const float boundsMax[3])
+	{
+		return p.x >= boundsMin[0] && p.y >= boundsMin[1] && p.z >= boundsMin[2] &&
+			p.x <= boundsMax[0] && p.y <= boundsMax[1] && p.z <= boundsMax[2];
+	}
+
+	const char* CompareSubmeshes(const MappedMesh& file, const std::vector<GeometryGenerator::MeshData>& meshes)
+	{
+		if(file.GetSubmeshCount() != kShapeCount || file.FindSubmesh("torus") != kShapeCount)
+			return "wrong submesh count";
+
+		for(uint32 s = 0; s < kShapeCount; ++s)
+		{
+			const GeometryGenerator::MeshData& mesh = meshes[s];
+			uint32 submesh = file.FindSubmesh(kShapeNames[s]);
+			if(submesh == kShapeCount)
+				return "submesh not found by name";
+
+			ShapeWriter::Range range = file.GetRange(submesh);
+			if(range.VertexCount != mesh.Vertices.size() || range.IndexCount != mesh.Indices32.size())
+				return "submesh counts differ";
+			if(std::memcmp(file.GetVertices() + range.BaseVertex, mesh.Vertices.data(), mesh.Vertices.size() * sizeof(GeometryGenerator::Vertex)) != 0)
+				return "submesh vertices differ";
+
+			bool same = file.GetIndexSize() == 2 ?
+				SameIndices(file.GetIndices16() + range.StartIndex, mesh.Indices32) :
+				SameIndices(file.GetIndices32() + range.StartIndex, mesh.Indices32);
+			if(!same)
+				return "submesh indices differ";
+
+			const MeshFile::Submesh& record = file.GetSubmesh(submesh);
+			for(const GeometryGenerator::Vertex& v : mesh.Vertices)
+			{
+				if(!Inside(v.Position, record.BoundsMin, record.BoundsMax) ||
+					!Inside(v.Position, file.GetHeader().BoundsMin, file.GetHeader().BoundsMax))
+					return "vertex outside the recorded bounds";
+			}
+		}
+		return nullptr;
+	}
+
+	// ScenePacker from the mapping against ScenePacker from the generated meshes.
+	const char* ComparePacked(const MappedMesh& file, const std::vector<GeometryGenerator::MeshData>& meshes)
+	{
+		Packer generated, mapped;
+		for(const GeometryGenerator::MeshData& mesh : meshes)
+			generated.AddMesh(kWriter, mesh.Vertices.data(), (uint32)mesh.Vertices.size(), mesh.Indices32.data(), (uint32)mesh.Indices32.size());
+		for(uint32 s = 0; s < file.GetSubmeshCount(); ++s)
+		{
+			ShapeWriter::Range range = file.GetRange(s);
+			const GeometryGenerator::Vertex* vertices = file.GetVertices() + range.BaseVertex;
+			if(file.GetIndexSize() == 2)
+				mapped.AddMesh(kWriter, vertices, range.VertexCount, file.GetIndices16() + range.StartIndex, range.IndexCount);
+			else
+				mapped.AddMesh(kWriter, vertices, range.VertexCount, file.GetIndices32() + range.StartIndex, range.IndexCount);
+		}
+
+		if(generated.GetVertexCount() != mapped.GetVertexCount() || generated.GetIndexCount() != mapped.GetIndexCount())
+			return "packed counts differ";
+
+		std::vector<Vertex> generatedVertices(generated.GetVertexCount()), mappedVertices(mapped.GetVertexCount());
+		std::vector<uint32> generatedIndices(generated.GetIndexCount()), mappedIndices(mapped.GetIndexCount());
+		generated.Write(generatedVertices.data(), generated.GetVertexCount(), generatedIndices.data(), generated.GetIndexCount());
+		mapped.Write(mappedVertices.data(), mapped.GetVertexCount(), mappedIndices.data(), mapped.GetIndexCount());
+		if(generatedIndices != mappedIndices ||
+			std::memcmp(generatedVertices.data(), mappedVertices.data(), generatedVertices.size() * sizeof(Vertex)) != 0)
+			return "packed output differs";
+		return nullptr;
+	}
+
+	const char* CheckRoundTrip(uint32 gridSide, uint32 indexSize)
+	{
+		std::vector<GeometryGenerator::MeshData> meshes = Generate(gridSide);
+
+		MappedMesh file;
+		if(!WriteScene(meshes, indexSize) || !file.Open(kPath))
+			return "could not write and open the file";
+
+		const char* error = file.GetIndexSize() != indexSize ? "wrong index size" : CompareSubmeshes(file, meshes);
+		if(error == nullptr)
+			error = ComparePacked(file, meshes);
+
+		file.Close();
+		std::remove(kPath);
+		return error;
+	}
+
+	const char* CheckRoundTrip16()
+	{
+		return CheckRoundTrip(60, 2);
+	}
+
+	const char* CheckRoundTrip32()
+	{
+		return CheckRoundTrip(300, 4);
+	}
+
+	const char* CheckSingleMesh()
+	{
+		GeometryGenerator geoGen;
+		GeometryGenerator::MeshData sphere = geoGen.CreateSphere(1.0f, 12, 8);
+		GeometryGenerator::MeshData copy;
+		MappedMesh file;
+		if(!MeshFile::Write(kPath, sphere, "a name longer than twenty-three characters") || !file.Open(kPath))
+			return "could not write and open the file";
+
+		file.CopyTo(copy);
+		bool same = file.GetIndexSize() == 2 && copy.Indices32 == sphere.Indices32 && copy.Vertices.size() == sphere.Vertices.size() &&
+			std::memcmp(copy.Vertices.data(), sphere.Vertices.data(), sphere.Vertices.size() * sizeof(GeometryGenerator::Vertex)) == 0;
+		bool truncated = std::strlen(file.GetSubmesh(0).Name) == MeshFile::MaxNameLength;
+
+		file.Close();
+		std::remove(kPath);
+		if(!same)
+			return "CopyTo differs from the mesh written";
+		return truncated ? nullptr : "long name not cut to MaxNameLength";
+	}
+
+	// Adding only records counts, so a grid far too big to write still gives its sizes:
+	// 676 million vertices and about 4.06 billion indices, each over 4 GiB in bytes.
+	const char* CheckLargeByteSizes()
+	{
+		const std::uint64_t side = 26000;
+		Packer packer;
+		packer.AddGrid(kWriter, 1.0f, 1.0f, (uint32)side, (uint32)side);
+		if(packer.GetVertexByteSize() != side * side * sizeof(Vertex) ||
+			packer.GetIndexByteSize() != (side - 1) * (side - 1) * 6 * sizeof(std::uint32_t))
+			return "byte sizes wrapped at 4 GiB";
+		return nullptr;
+	}
+
+	// Writes a valid file, lets edit spoil its bytes and tries to open it.
+	template<typename EditFn>
+	bool Opens(const EditFn& edit)
+	{
+		GeometryGenerator geoGen;
+		if(!MeshFile::Write(kPath, geoGen.CreateBox(1.0f, 1.0f, 1.0f, 0), "box"))
+			return true;
+
+		std::vector<std::uint8_t> bytes;
+		if(std::FILE* in = std::fopen(kPath, "rb"))
+		{
+			int c;
+			while((c = std::fgetc(in)) != EOF)
+				bytes.push_back((std::uint8_t)c);
+			std::fclose(in);
+		}
+		edit(bytes);
+		if(std::FILE* out = std::fopen(kPath, "wb"))
+		{
+			std::fwrite(bytes.data(), 1, bytes.size(), out);
+			std::fclose(out);
+		}
+
+		MappedMesh file;
+		bool opened = file.Open(kPath);
+		file.Close();
+		std::remove(kPath);
+		return opened;
+	}
+
+	const char* CheckRefusals()
+	{
+		MappedMesh file;
+		if(file.Open("MeshFileTest_missing.msh"))
+			return "opened a missing file";
+		if(!Opens([](std::vector<std::uint8_t>&) {}))
+			return "refused a valid file";
+		if(Opens([](std::vector<std::uint8_t>& bytes) { bytes.resize(bytes.size() - 1); }))
+			return "opened a truncated file";
+		if(Opens([](std::vector<std::uint8_t>& bytes) { bytes[0] ^= 0xff; }))
+			return "opened a file with the wrong magic";
+		if(Opens([](std::vector<std::uint8_t>& bytes) { bytes[offsetof(MeshFile::Header, VersionMajor)] += 1; }))
+			return "opened another major version";
+		if(!Opens([](std::vector<std::uint8_t>& bytes) { bytes[offsetof(MeshFile::Header, VersionMinor)] += 1; }))
+			return "refused a newer minor version";
+
+		// The box's indices are 16-bit, and its last vertex is used.
+		if(Opens([](std::vector<std::uint8_t>& bytes)
+			{
+				MeshFile::Header h;
+				std::memcpy(&h, bytes.data(), sizeof(h));
+				std::uint16_t pastEnd = (std::uint16_t)h.VertexCount;
+				std::memcpy(&bytes[(std::size_t)h.IndexOffset], &pastEnd, sizeof(pastEnd));
+			}))
+			return "opened a file with an index past the vertices";
+		if(Opens([](std::vector<std::uint8_t>& bytes)
+			{
+				MeshFile::Header h;
+				std::memcpy(&h, bytes.data(), sizeof(h));
+				uint32 fewer = h.VertexCount - 1;
+				std::memcpy(&bytes[(std::size_t)h.SubmeshOffset + offsetof(MeshFile::Submesh, VertexCount)], &fewer, sizeof(fewer));
+			}))
+			return "opened a file with an index past its submesh's vertices";
+		return nullptr;
+	}
+}
+
+int main()
+{
+	const Check checks[] =
+	{
+		{ "round trip, 16-bit indices", CheckRoundTrip16 },
+		{ "round trip, 32-bit indices", CheckRoundTrip32 },
+		{ "single mesh and CopyTo", CheckSingleMesh },
+		{ "packed byte sizes past 4 GiB", CheckLargeByteSizes },
+		{ "refuses damaged files", CheckRefusals },
+	};
+	return RunChecks(checks);
+}
@@ -0,0 +1,125 @@
+//***************************************************************************************
+// NoiseTest.cpp
+//
+// Noise's rows and grids against Sample, bit for bit, for 6-octave fBm, ridged
+// multifractal and domain-warped fBm: SampleRow at every length around the batch width
+// (so the SIMD batches and the scalar tail both show) and SampleGrid on pools of
+// several sizes.  Tests/CMakeLists.txt builds this once per SampleRow path, scalar,
+// SSE2 and AVX2, each with its own Noise.cpp; Sample is the same scalar code in all of
+// them, so every path and thread count agreeing with it is every path agreeing with
+// every other.  Like Noise.cpp, this is compiled without fused multiply-adds, or the
+// x0 + i * dx below would not be the coordinate SampleRow sampled.
+//***************************************************************************************
+
+#include "Checks.h"
+
+#include "../Noise.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	const float kSpacing = 0.37f;
+	const float kX0 = -90.0f;
+	const float kY0 = 40.0f;
+
+	// Exit code ctest takes as skipped (SKIP_RETURN_CODE in Tests/CMakeLists.txt).
+	const int kSkipped = 77;
+
+	Noise::Desc MakeDesc(uint32 kind)
+	{
+		Noise::Desc desc;
+		desc.Type = kind == 1 ? Noise::Fractal::Ridged : Noise::Fractal::Fbm;
+		desc.Seed = 7;
+		desc.Octaves = 6;
+		desc.Frequency = 0.004f;
+		desc.Amplitude = 100.0f;
+		desc.WarpDistance = kind == 2 ? 40.0f : 0.0f;
+		return desc;
+	}
+
+	bool SameBits(float a, float b)
+	{
+		return std::memcmp(&a, &b, sizeof(float)) == 0;
+	}
+
+	// NOISE_TEST_WIDTH is the batch width of the path this copy was built for, so a
+	// path that quietly fell back to another is caught.
+	const char* CheckPath()
+	{
+#if defined(NOISE_TEST_WIDTH)
+		if(Noise::GetBatchWidth() != NOISE_TEST_WIDTH)
+			return "built for another SampleRow path";
+#endif
+		return nullptr;
+	}
+
+	const char* CheckRows()
+	{
+		std::vector<float> row(1000);
+		for(uint32 kind = 0; kind < 3; ++kind)
+		{
+			Noise::Desc desc = MakeDesc(kind);
+			for(uint32 count = 0; count <= 1000; count += count < 19 ? 1 : 327)
+			{
+				float y = (float)count * -kSpacing + kY0;
+				Noise::SampleRow(desc, kX0, kSpacing, y, count, row.data());
+				for(uint32 i = 0; i < count; ++i)
+				{
+					if(!SameBits(row[i], Noise::Sample(desc, (float)i * kSpacing + kX0, y)))
+						return "SampleRow differs from Sample";
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	const char* CheckGrids()
+	{
+		const uint32 columns = 523, rows = 131;
+		std::vector<float> grid(columns * rows);
+		for(uint32 kind = 0; kind < 3; ++kind)
+		{
+			Noise::Desc desc = MakeDesc(kind);
+			for(uint32 threads : { 1u, 2u, 3u, 8u })
+			{
+				ThreadPool pool(threads);
+				Noise::SampleGrid(desc, kX0, kSpacing, columns, kY0, -kSpacing, rows, grid.data(), pool);
+				for(uint32 r = 0; r < rows; ++r)
+				{
+					for(uint32 c = 0; c < columns; ++c)
+					{
+						float expected = Noise::Sample(desc, (float)c * kSpacing + kX0, (float)r * -kSpacing + kY0);
+						if(!SameBits(grid[r * columns + c], expected))
+							return "SampleGrid differs from Sample";
+					}
+				}
+			}
+		}
+		return nullptr;
+	}
+}
+
+int main()
+{
+#if defined(__AVX2__) && defined(__GNUC__)
+	if(!__builtin_cpu_supports("avx2"))
+	{
+		std::printf("no AVX2 on this CPU; skipped\n");
+		return kSkipped;
+	}
+#endif
+
+	const Check checks[] =
+	{
+		{ "SampleRow path", CheckPath },
+		{ "rows against Sample", CheckRows },
+		{ "grids on 1 to 8 threads", CheckGrids },
+	};
+	return RunChecks(checks);
+}
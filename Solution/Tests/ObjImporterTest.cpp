@@ -0,0 +1,258 @@
+//***************************************************************************************
+// ObjImporterTest.cpp
+//
+// ObjImporter::Parse on OBJ text written here.  A GeometryGenerator grid written the
+// way a right-handed tool would have it (z, v and the winding mirrored) has to come
+// back as the grid, corner for corner, whatever the chunk size and thread count.  Small
+// files cover fans, relative indices, the v, v/vt and v//vn forms, computed normals,
+// also in files where only some faces have them, malformed lines and faces that refer
+// to missing elements.
+//***************************************************************************************
+
+#include "Checks.h"
+
+#include "../ObjImporter.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	bool Near(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+	{
+		return std::fabs(a.x - b.x) <= 1e-4f && std::fabs(a.y - b.y) <= 1e-4f && std::fabs(a.z - b.z) <= 1e-4f;
+	}
+
+	bool Parse(const std::string& text, GeometryGenerator::MeshData& mesh, const ObjImporter::Options& options = ObjImporter::Options(),
+		ObjImporter::Stats* stats = nullptr, uint32 threads = 1)
+	{
+		ThreadPool pool(threads);
+		return ObjImporter::Parse(text.data(), text.size(), mesh, pool, options, stats);
+	}
+
+	// The grid as a right-handed, counter-clockwise OBJ with v/vt/vn faces.
+	std::string WriteGrid(const GeometryGenerator::MeshData& grid)
+	{
+		std::string text = "o grid\n";
+		char line[160];
+		for(const GeometryGenerator::Vertex& v : grid.Vertices)
+		{
+			std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n",
+				v.Position.x, v.Position.y, -v.Position.z, v.TexC.x, 1.0f - v.TexC.y, v.Normal.x, v.Normal.y, -v.Normal.z);
+			text += line;
+		}
+		for(std::size_t i = 0; i + 2 < grid.Indices32.size(); i += 3)
+		{
+			uint32 a = grid.Indices32[i] + 1, b = grid.Indices32[i + 2] + 1, c = grid.Indices32[i + 1] + 1;
+			std::snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c);
+			text += line;
+		}
+		return text;
+	}
+
+	// Corner by corner, so a triangle that comes back the other way round fails.
+	bool MatchesGrid(const GeometryGenerator::MeshData& mesh, const GeometryGenerator::MeshData& grid)
+	{
+		if(mesh.Vertices.size() != grid.Vertices.size() || mesh.Indices32.size() != grid.Indices32.size())
+			return false;
+
+		for(std::size_t i = 0; i < grid.Indices32.size(); ++i)
+		{
+			const GeometryGenerator::Vertex& v = mesh.Vertices[mesh.Indices32[i]];
+			const GeometryGenerator::Vertex& w = grid.Vertices[grid.Indices32[i]];
+			if(!Near(v.Position, w.Position) || !Near(v.Normal, w.Normal) ||
+				std::fabs(v.TexC.x - w.TexC.x) > 1e-4f || std::fabs(v.TexC.y - w.TexC.y) > 1e-4f)
+				return false;
+		}
+		return true;
+	}
+
+	const char* CheckGrid()
+	{
+		GeometryGenerator geoGen;
+		GeometryGenerator::MeshData grid = geoGen.CreateGrid(16.0f, 12.0f, 41, 31);
+		std::string text = WriteGrid(grid);
+
+		GeometryGenerator::MeshData first;
+		for(uint32 chunkSize : { 1u << 20, 4096u, 97u })
+		{
+			for(uint32 threads : { 1u, 4u })
+			{
+				ObjImporter::Options options;
+				options.ChunkSize = chunkSize;
+				ObjImporter::Stats stats;
+				GeometryGenerator::MeshData mesh;
+				if(!Parse(text, mesh, options, &stats, threads) || stats.MalformedLines != 0)
+					return "could not parse the grid";
+				if(!MatchesGrid(mesh, grid))
+					return "grid does not come back corner for corner";
+
+				if(first.Vertices.empty())
+					first = mesh;
+				else if(mesh.Indices32 != first.Indices32 ||
+					std::memcmp(mesh.Vertices.data(), first.Vertices.data(), mesh.Vertices.size() * sizeof(GeometryGenerator::Vertex)) != 0)
+					return "result depends on the chunk size or thread count";
+			}
+		}
+		return nullptr;
+	}
+
+	// A quad and a pentagon facing +z in the file, fanned from their first corner.
+	const char* CheckFans()
+	{
+		const std::string text =
+			"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+			"f 1 2 3 4\n"
+			"v 2 0 0\nv 3 0 0\nv 3 1 0\nv 2.5 2 0\nv 2 1 0\n"
+			"f -5 -4 -3 -2 -1\n";
+
+		GeometryGenerator::MeshData converted, asStored;
+		ObjImporter::Options options;
+		options.ConvertToLeftHanded = false;
+		if(!Parse(text, converted) || !Parse(text, asStored, options))
+			return "could not parse the polygons";
+
+		const std::vector<uint32> fans = { 0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7, 4, 7, 8 };
+		const std::vector<uint32> reversed = { 0, 2, 1, 0, 3, 2, 4, 6, 5, 4, 7, 6, 4, 8, 7 };
+		if(asStored.Indices32 != fans)
+			return "polygons not fanned from their first corner";
+		if(converted.Vertices.size() != 9)
+			return "wrong vertex count";
+
+		// Converting reverses each triangle, so the first-use order of the corners
+		// changes; compare positions instead of indices.
+		for(std::size_t i = 0; i < fans.size(); ++i)
+		{
+			const DirectX::XMFLOAT3& p = converted.Vertices[converted.Indices32[i]].Position;
+			const DirectX::XMFLOAT3& q = asStored.Vertices[reversed[i]].Position;
+			if(!Near(p, DirectX::XMFLOAT3(q.x, q.y, -q.z)))
+				return "converted polygons not reversed";
+		}
+
+		// Computed normals face the viewer in both conventions: +z as stored, and -z
+		// once z is mirrored.
+		for(const GeometryGenerator::Vertex& v : asStored.Vertices)
+		{
+			if(!Near(v.Normal, DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f)))
+				return "computed normal wrong as stored";
+		}
+		for(const GeometryGenerator::Vertex& v : converted.Vertices)
+		{
+			if(!Near(v.Normal, DirectX::XMFLOAT3(0.0f, 0.0f, -1.0f)))
+				return "computed normal wrong after converting";
+		}
+		return nullptr;
+	}
+
+	// The v, v/vt, v//vn and v/vt/vn forms, and vertices welded by all three indices.
+	const char* CheckForms()
+	{
+		const std::string text =
+			"v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+			"vt 0.25 0.75\n"
+			"vn 0 0 1\n"
+			"f 1 2 3\n"
+			"f 1/1 2/1 3/1\n"
+			"f 1//1 2//1 3//1\n"
+			"f 1/1/1 2/1/1 3/1/1\n"
+			"f -3/-1/-1 -2/-1/-1 -1/-1/-1\n";
+
+		ObjImporter::Options options;
+		options.ConvertToLeftHanded = false;
+		ObjImporter::Stats stats;
+		GeometryGenerator::MeshData mesh;
+		if(!Parse(text, mesh, options, &stats) || stats.Faces != 5 || stats.Triangles != 5 || stats.MalformedLines != 0)
+			return "could not parse the forms";
+
+		// Four distinct texcoord/normal combinations of the three positions.
+		if(mesh.Vertices.size() != 12 || mesh.Indices32.size() != 15)
+			return "wrong weld";
+		for(uint32 c = 0; c < 3; ++c)
+		{
+			if(mesh.Indices32[12 + c] != mesh.Indices32[9 + c])
+				return "relative indices not resolved to the same vertex";
+		}
+
+		const GeometryGenerator::Vertex& textured = mesh.Vertices[mesh.Indices32[9]];
+		if(std::fabs(textured.TexC.x - 0.25f) > 1e-6f || std::fabs(textured.TexC.y - 0.75f) > 1e-6f)
+			return "texture coordinate not read";
+		return nullptr;
+	}
+
+	// A face with a normal that is not its face normal and one without: the first keeps
+	// the file's, the second gets a computed one, unless that is turned off.
+	const char* CheckMixedNormals()
+	{
+		const std::string text =
+			"v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\n"
+			"vn 1 0 0\n"
+			"f 1//1 2//1 3//1\n"
+			"f 2 4 3\n";
+
+		ObjImporter::Options options;
+		options.ConvertToLeftHanded = false;
+		GeometryGenerator::MeshData computed, uncomputed;
+		if(!Parse(text, computed, options))
+			return "could not parse the mixed file";
+		options.ComputeMissingNormals = false;
+		if(!Parse(text, uncomputed, options))
+			return "could not parse the mixed file";
+		if(computed.Vertices.size() != 6 || computed.Indices32.size() != 6)
+			return "wrong weld";
+
+		for(std::size_t i = 0; i < 6; ++i)
+		{
+			const DirectX::XMFLOAT3& n = computed.Vertices[computed.Indices32[i]].Normal;
+			const DirectX::XMFLOAT3& m = uncomputed.Vertices[uncomputed.Indices32[i]].Normal;
+			if(i < 3 && (!Near(n, DirectX::XMFLOAT3(1.0f, 0.0f, 0.0f)) || !Near(m, n)))
+				return "normal from the file not kept";
+			if(i >= 3 && !Near(n, DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f)))
+				return "normal of a face without one not computed";
+			if(i >= 3 && !Near(m, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f)))
+				return "normal computed although turned off";
+		}
+		return nullptr;
+	}
+
+	const char* CheckErrors()
+	{
+		ObjImporter::Stats stats;
+		GeometryGenerator::MeshData mesh;
+		const std::string malformed =
+			"v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 x 0\n"
+			"vn 0 0\n"
+			"f 1 2\n"
+			"f 1 2 3 junk\n"
+			"f 1 2 3\n"
+			"g group\nusemtl stone\ns 1\n";
+		if(!Parse(malformed, mesh, ObjImporter::Options(), &stats) || stats.MalformedLines != 4 || stats.Triangles != 1)
+			return "malformed lines not skipped and counted";
+
+		if(Parse("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n", mesh) || !mesh.Vertices.empty() || !mesh.Indices32.empty())
+			return "face with a missing position accepted";
+		if(Parse("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1//1 2//1 3//1\n", mesh))
+			return "face with a missing normal accepted";
+		if(Parse("v 0 0 0\nv 1 0 0\nf -3 -2 -1\n", mesh))
+			return "relative index before the first position accepted";
+		return nullptr;
+	}
+}
+
+int main()
+{
+	const Check checks[] =
+	{
+		{ "right-handed grid", CheckGrid },
+		{ "polygon fans and winding", CheckFans },
+		{ "index forms and welding", CheckForms },
+		{ "normals in a file that mixes faces with and without", CheckMixedNormals },
+		{ "malformed lines and bad indices", CheckErrors },
+	};
+	return RunChecks(checks);
+}
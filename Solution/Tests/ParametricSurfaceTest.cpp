@@ -0,0 +1,223 @@
+//***************************************************************************************
+// ParametricSurfaceTest.cpp
+//
+// ParametricSurface against the hand-written builders it replaces.  Every shape has to
+// come out with unit normals and tangents and every triangle facing the way its vertex
+// normals point; rows shared out to pools of several sizes have to give the output of
+// one thread, byte for byte; and the sphere, the cylinder side and the torus have to
+// put their vertices where CreateSphere, CreateCylinder and the loop CreateTorus used to
+// be do, to float precision.  Segment counts that are not multiples of four cover the
+// last, partly filled vector of each row.
+//***************************************************************************************
+
+#include "Checks.h"
+
+#include "../GeometryGenerator.h"
+#include "../ParametricSurface.h"
+#include "../ThreadPool.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using MeshData = GeometryGenerator::MeshData;
+
+	enum Shape { ShapeSphere, ShapeCylinder, ShapeCone, ShapeTorus, ShapeSuperellipsoid, ShapeCount };
+
+	const float kRadius = 2.0f;
+	const float kHeight = 3.0f;
+	const float kTubeRadius = 0.5f;
+	const float kTolerance = 1e-4f;
+	const uint32 kSegments[] = { 3, 4, 33, 64 };
+
+	// What CreateTorus was before ParametricSurface, uncommented, without the tangents
+	// (its p x n was not the direction of u, and vanished on the outer equator).
+	MeshData CreateHandTorus(float outerRadius, float innerRadius, uint32 sliceCount, uint32 stackCount)
+	{
+		MeshData meshData;
+
+		float thetaStep = 2.0f * XM_PI / sliceCount;
+		float phiStep = 2.0f * XM_PI / stackCount;
+
+		for(uint32 i = 0; i <= stackCount; ++i)
+		{
+			float phi = i * phiStep;
+			for(uint32 j = 0; j <= sliceCount; ++j)
+			{
+				float theta = j * thetaStep;
+
+				GeometryGenerator::Vertex v;
+				v.Position.x = (outerRadius + innerRadius * cosf(phi)) * cosf(theta);
+				v.Position.y = innerRadius * sinf(phi);
+				v.Position.z = (outerRadius + innerRadius * cosf(phi)) * sinf(theta);
+
+				v.Normal.x = cosf(phi) * cosf(theta);
+				v.Normal.y = sinf(phi);
+				v.Normal.z = cosf(phi) * sinf(theta);
+
+				meshData.Vertices.push_back(v);
+			}
+		}
+		return meshData;
+	}
+
+	MeshData BuildHand(Shape shape, uint32 n)
+	{
+		GeometryGenerator geoGen;
+		switch(shape)
+		{
+		case ShapeSphere: return geoGen.CreateSphere(kRadius, n, n);
+		case ShapeCylinder: return geoGen.CreateCylinder(kRadius, 0.5f * kRadius, kHeight, n, n);
+		default: return CreateHandTorus(kRadius, kTubeRadius, n, n);
+		}
+	}
+
+	MeshData BuildParametric(Shape shape, uint32 n, ThreadPool* pool)
+	{
+		MeshData mesh;
+		ShapeWriter::GeneratorVertexWriter writer;
+		switch(shape)
+		{
+		case ShapeSphere:
+			ParametricSurface::Append(mesh.Vertices, mesh.Indices32, writer, ParametricSurface::Sphere{ kRadius }, n, n, pool);
+			break;
+		case ShapeCylinder:
+			ParametricSurface::AppendCylinder(mesh.Vertices, mesh.Indices32, writer, kRadius, 0.5f * kRadius, kHeight, n, n, pool);
+			break;
+		case ShapeCone:
+			ParametricSurface::AppendCone(mesh.Vertices, mesh.Indices32, writer, kRadius, kHeight, n, n, pool);
+			break;
+		case ShapeTorus:
+			ParametricSurface::Append(mesh.Vertices, mesh.Indices32, writer, ParametricSurface::Torus{ kRadius, kTubeRadius }, n, n, pool);
+			break;
+		default:
+		{
+			ParametricSurface::Superellipsoid box{ XMFLOAT3(kRadius, 0.5f * kHeight, kRadius), 0.3f, 0.3f };
+			ParametricSurface::Append(mesh.Vertices, mesh.Indices32, writer, box, n, n, pool);
+			break;
+		}
+		}
+		return mesh;
+	}
+
+	bool Near(const XMFLOAT3& a, const XMFLOAT3& b, float tolerance)
+	{
+		return std::fabs(a.x - b.x) <= tolerance && std::fabs(a.y - b.y) <= tolerance && std::fabs(a.z - b.z) <= tolerance;
+	}
+
+	float Dot(const XMFLOAT3& a, const XMFLOAT3& b)
+	{
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	// Unit normals, and each triangle on the side its vertex normals are on.
+	bool FacesOutward(const MeshData& mesh)
+	{
+		for(const GeometryGenerator::Vertex& v : mesh.Vertices)
+		{
+			if(!(std::fabs(Dot(v.Normal, v.Normal) - 1.0f) < 1e-3f) || !(std::fabs(Dot(v.TangentU, v.TangentU) - 1.0f) < 1e-3f))
+				return false;
+		}
+
+		for(std::size_t t = 0; t < mesh.Indices32.size(); t += 3)
+		{
+			const GeometryGenerator::Vertex& a = mesh.Vertices[mesh.Indices32[t]];
+			const GeometryGenerator::Vertex& b = mesh.Vertices[mesh.Indices32[t + 1]];
+			const GeometryGenerator::Vertex& c = mesh.Vertices[mesh.Indices32[t + 2]];
+			XMFLOAT3 e1(b.Position.x - a.Position.x, b.Position.y - a.Position.y, b.Position.z - a.Position.z);
+			XMFLOAT3 e2(c.Position.x - a.Position.x, c.Position.y - a.Position.y, c.Position.z - a.Position.z);
+			XMFLOAT3 face(e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x);
+			XMFLOAT3 normal(a.Normal.x + b.Normal.x + c.Normal.x, a.Normal.y + b.Normal.y + c.Normal.y, a.Normal.z + b.Normal.z + c.Normal.z);
+			if(Dot(face, normal) <= 0.0f)
+				return false;
+		}
+		return true;
+	}
+
+	// The rings both sphere meshes have: the hand-written one keeps a single vertex per
+	// pole, the parametric one a ring.  The cylinder sides run in opposite directions,
+	// and so do the tori's tubes (the parametric one starts down the tube, the loop up
+	// it); the loop's torus had no usable tangents to compare.
+	bool MatchesHand(Shape shape, uint32 n, const MeshData& hand, const MeshData& parametric)
+	{
+		uint32 ring = n + 1;
+		uint32 firstRow = shape == ShapeTorus ? 0 : 1;
+		uint32 endRow = shape == ShapeTorus ? n + 1 : n;
+		for(uint32 i = firstRow; i < endRow; ++i)
+		{
+			for(uint32 j = 0; j <= n; ++j)
+			{
+				const GeometryGenerator::Vertex& p = parametric.Vertices[i * ring + j];
+				const GeometryGenerator::Vertex& h = shape == ShapeSphere ?
+					hand.Vertices[1 + (i - 1) * ring + j] : hand.Vertices[(n - i) * ring + j];
+				if(!Near(h.Position, p.Position, kTolerance * kRadius) || !Near(h.Normal, p.Normal, kTolerance))
+					return false;
+				if(shape != ShapeTorus && !Near(h.TangentU, p.TangentU, kTolerance))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	const char* CheckWinding()
+	{
+		for(uint32 shape = 0; shape < ShapeCount; ++shape)
+		{
+			for(uint32 n : kSegments)
+			{
+				if(!FacesOutward(BuildParametric((Shape)shape, n, nullptr)))
+					return "triangles or normals face the wrong way";
+			}
+		}
+		return nullptr;
+	}
+
+	const char* CheckPools()
+	{
+		for(uint32 shape = 0; shape < ShapeCount; ++shape)
+		{
+			for(uint32 n : kSegments)
+			{
+				MeshData serial = BuildParametric((Shape)shape, n, nullptr);
+				for(uint32 threads : { 1u, 3u, 8u })
+				{
+					ThreadPool pool(threads);
+					MeshData parallel = BuildParametric((Shape)shape, n, &pool);
+					if(serial.Indices32 != parallel.Indices32 || serial.Vertices.size() != parallel.Vertices.size() ||
+						std::memcmp(serial.Vertices.data(), parallel.Vertices.data(), serial.Vertices.size() * sizeof(GeometryGenerator::Vertex)) != 0)
+						return "pool output differs from one thread";
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	const char* CheckHandWritten()
+	{
+		for(Shape shape : { ShapeSphere, ShapeCylinder, ShapeTorus })
+		{
+			for(uint32 n : kSegments)
+			{
+				if(!MatchesHand(shape, n, BuildHand(shape, n), BuildParametric(shape, n, nullptr)))
+					return "parametric mesh differs from the hand-written one";
+			}
+		}
+		return nullptr;
+	}
+}
+
+int main()
+{
+	const Check checks[] =
+	{
+		{ "winding and unit normals", CheckWinding },
+		{ "pools against one thread", CheckPools },
+		{ "sphere, cylinder, torus vs hand", CheckHandWritten },
+	};
+	return RunChecks(checks);
+}
@@ -0,0 +1,203 @@
+//***************************************************************************************
+// PlanetTerrainTest.cpp
+//
+// PlanetTerrain along a camera path spiralling in from two radii out to 300 m above the
+// ground, without frustum culling.  At every checked frame the drawn nodes have to
+// cover the sphere without cracks or T-junctions (every triangle edge, by its exact end
+// positions, used once each way) and with every triangle facing out, both while meshes
+// are still being generated and once they are all in; the cache has to stay within its
+// budget, also when the budget is what stops refinement; and the result must not depend
+// on the thread count.
+//***************************************************************************************
+
+#include "Checks.h"
+
+#include "../OrbitCamera.h"
+#include "../PlanetTerrain.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	const float kRadius = 6000.0f;
+	const float kMaxHeight = 60.0f;
+	const uint32 kPathFrames = 64;
+	const uint32 kFrameStep = 9;
+
+	float Height(const XMFLOAT3& d)
+	{
+		float h = std::sin(d.x * 23.0f + d.y * 7.0f) * std::cos(d.z * 17.0f - d.x * 5.0f) * 0.6f
+			+ std::sin(d.y * 61.0f + d.z * 41.0f) * 0.3f
+			+ std::sin(d.z * 173.0f + d.x * 131.0f) * 0.1f;
+		return h * kMaxHeight;
+	}
+
+	PlanetTerrain::Desc MakeDesc(uint64 budgetMB)
+	{
+		PlanetTerrain::Desc desc;
+		desc.Radius = kRadius;
+		desc.Height = Height;
+		desc.MaxHeight = kMaxHeight;
+		desc.GridSize = 32;
+		desc.MaxLevel = 10;
+		desc.MemoryBudget = budgetMB << 20;
+		return desc;
+	}
+
+	// Frame f of the path: altitude falls geometrically from 2 radii to 300 m while the
+	// camera goes a third of the way round.
+	XMFLOAT3 GetEye(uint32 frame)
+	{
+		float t = (float)frame / (float)(kPathFrames - 1);
+		float altitude = 2.0f * kRadius * std::pow(300.0f / (2.0f * kRadius), t);
+
+		OrbitCamera camera;
+		camera.SetOrbit(0.3f + t * XM_2PI / 3.0f, 0.4f * XM_PI + t * 0.2f, kRadius + altitude);
+		camera.SetLens(0.25f * XM_PI, 16.0f / 9.0f, 1.0f, 4.0f * kRadius);
+		camera.Update();
+		return camera.GetPosition();
+	}
+
+	struct PositionKey
+	{
+		float P[3];
+		bool operator==(const PositionKey& rhs)const { return std::memcmp(P, rhs.P, sizeof(P)) == 0; }
+	};
+
+	struct EdgeKey
+	{
+		PositionKey A;
+		PositionKey B;
+		bool operator==(const EdgeKey& rhs)const { return A == rhs.A && B == rhs.B; }
+	};
+
+	struct EdgeHash
+	{
+		std::size_t operator()(const EdgeKey& e)const
+		{
+			uint32 bits[6];
+			std::memcpy(bits, &e, sizeof(bits));
+			std::size_t h = 0;
+			for(uint32 b : bits)
+				h = h * 0x9E3779B1u + b;
+			return h;
+		}
+	};
+
+	// nullptr if the drawn nodes close up into an outward-facing surface.
+	const char* CheckSurface(const PlanetTerrain& terrain)
+	{
+		std::unordered_map<EdgeKey, int, EdgeHash> edges;
+		for(const PlanetTerrain::DrawNode& node : terrain.GetDrawNodes())
+		{
+			const std::vector<PlanetTerrain::uint16>& indices = terrain.GetIndices(node.StitchMask);
+			for(std::size_t i = 0; i < indices.size(); i += 3)
+			{
+				XMVECTOR p0 = XMLoadFloat3(&node.Vertices[indices[i]].Position);
+				XMVECTOR p1 = XMLoadFloat3(&node.Vertices[indices[i + 1]].Position);
+				XMVECTOR p2 = XMLoadFloat3(&node.Vertices[indices[i + 2]].Position);
+				XMVECTOR faceNormal = XMVector3Cross(p1 - p0, p2 - p0);
+				if(XMVectorGetX(XMVector3Dot(faceNormal, p0 + p1 + p2)) <= 0.0f)
+					return "triangle facing into the planet";
+
+				for(int k = 0; k < 3; ++k)
+				{
+					const XMFLOAT3& a = node.Vertices[indices[i + k]].Position;
+					const XMFLOAT3& b = node.Vertices[indices[i + (k + 1) % 3]].Position;
+					EdgeKey edge = { { { a.x, a.y, a.z } }, { { b.x, b.y, b.z } } };
+					EdgeKey reverse = { edge.B, edge.A };
+					++edges[edge];
+					--edges[reverse];
+				}
+			}
+		}
+
+		// Each edge one way cancels the same edge the other way.
+		for(const auto& edge : edges)
+		{
+			if(edge.second != 0)
+				return "cracks or T-junctions";
+		}
+		return nullptr;
+	}
+
+	const char* FlyPath(uint32 threads, uint64 budgetMB, bool expectComplete)
+	{
+		ThreadPool pool(threads);
+		PlanetTerrain::Desc desc = MakeDesc(budgetMB);
+		PlanetTerrain terrain(pool, desc);
+
+		for(uint32 frame = 0; frame < kPathFrames; frame += kFrameStep)
+		{
+			// Partly generated, then complete as far as the budget allows.
+			terrain.Update(GetEye(frame));
+			if(const char* error = CheckSurface(terrain))
+				return error;
+			terrain.Finish();
+			if(const char* error = CheckSurface(terrain))
+				return error;
+
+			const PlanetTerrain::Stats& stats = terrain.GetStats();
+			if(expectComplete && stats.MissingNodes != 0)
+				return "terrain not fully generated";
+			if(stats.ResidentBytes > desc.MemoryBudget)
+				return "cache over budget";
+		}
+		if(!expectComplete && terrain.GetStats().MissingNodes == 0)
+			return "budget too large to limit anything";
+		return nullptr;
+	}
+
+	const char* CheckPath()
+	{
+		return FlyPath(0, 256, true);
+	}
+
+	const char* CheckSmallBudget()
+	{
+		return FlyPath(0, 2, false);
+	}
+
+	// The finished frame at the end of the path with one worker and with four.
+	const char* CheckThreadCounts()
+	{
+		ThreadPool one(1), four(4);
+		PlanetTerrain a(one, MakeDesc(256)), b(four, MakeDesc(256));
+		XMFLOAT3 eye = GetEye(kPathFrames - 1);
+		a.Update(eye);
+		a.Finish();
+		b.Update(eye);
+		b.Finish();
+
+		const std::vector<PlanetTerrain::DrawNode>& nodesA = a.GetDrawNodes();
+		const std::vector<PlanetTerrain::DrawNode>& nodesB = b.GetDrawNodes();
+		if(nodesA.size() != nodesB.size())
+			return "different node counts";
+		for(std::size_t n = 0; n < nodesA.size(); ++n)
+		{
+			if(nodesA[n].Key != nodesB[n].Key || nodesA[n].StitchMask != nodesB[n].StitchMask ||
+				std::memcmp(nodesA[n].Vertices, nodesB[n].Vertices, a.GetNodeVertexCount() * sizeof(GeometryGenerator::Vertex)) != 0)
+				return "different nodes or meshes";
+		}
+		return nullptr;
+	}
+}
+
+int main()
+{
+	const Check checks[] =
+	{
+		{ "camera path", CheckPath },
+		{ "camera path, 2 MB budget", CheckSmallBudget },
+		{ "one thread and four", CheckThreadCounts },
+	};
+	return RunChecks(checks);
+}
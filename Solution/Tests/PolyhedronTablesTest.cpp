@@ -0,0 +1,315 @@
+//***************************************************************************************
+// PolyhedronTablesTest.cpp
+//
+// The box, wedge, pyramid, diamond and tri-prism from the precomputed tables against
+// the runtime builders they replaced: the original level 0 vertices, scaled by half the
+// size, subdivided with GeometryGenerator::Subdivide.  Indices have to be the same at
+// every level and so do the vertices at level 0, bit for bit.  Above level 0 the tables
+// take midpoints of the unit shape and scale afterwards, and normalize in double, so
+// positions may differ by up to 2 ulps of the shape's size and normals, tangents and
+// texture coordinates by up to 2 ulps of 1 (kMaxUlps).  Writers that only take positions
+// scale the tables with scalar code, and have to match ScaleVertices bit for bit; so
+// does ScaleVertices itself for every count from 0 to 13, which mixes its four-vertex
+// blocks with the remainder, without writing past the count.
+//***************************************************************************************
+
+#include "Checks.h"
+
+#include "../FrameConstants.h"
+#include "../GeometryGenerator.h"
+#include "../ShapeWriter.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	using MeshData = GeometryGenerator::MeshData;
+	using Vertex = GeometryGenerator::Vertex;
+	using Shape = PolyhedronTables::Shape;
+	using uint32 = std::uint32_t;
+
+	const uint32 kMaxLevel = 4;
+	const float kMaxUlps = 2.0f;
+
+	struct Size
+	{
+		float Width, Height, Depth;
+	};
+
+	const Size kSizes[] =
+	{
+		{ 1.0f, 1.0f, 1.0f },
+		{ 2.0f, 3.0f, 0.5f },
+		{ 0.37f, 5.9f, 12.3f },
+		{ 100.0f, 0.01f, 7.0f },
+	};
+
+	// The level 0 shapes as GeometryGenerator built them before the tables.
+	MeshData BaselineBox(float w2, float h2, float d2)
+	{
+		MeshData mesh;
+		mesh.Vertices =
+		{
+			Vertex(-w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+			Vertex(-w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+			Vertex(+w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+			Vertex(+w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+			Vertex(-w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+			Vertex(+w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+			Vertex(+w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+			Vertex(-w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+			Vertex(-w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+			Vertex(-w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+			Vertex(+w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+			Vertex(+w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+			Vertex(-w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+			Vertex(+w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+			Vertex(+w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+			Vertex(-w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+			Vertex(-w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f),
+			Vertex(-w2, +h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f),
+			Vertex(-w2, +h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f),
+			Vertex(-w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f),
+			Vertex(+w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f),
+			Vertex(+w2, +h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f),
+			Vertex(+w2, +h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f),
+			Vertex(+w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f),
+		};
+		mesh.Indices32 =
+		{
+			0, 1, 2, 0, 2, 3,
+			4, 5, 6, 4, 6, 7,
+			8, 9, 10, 8, 10, 11,
+			12, 13, 14, 12, 14, 15,
+			16, 17, 18, 16, 18, 19,
+			20, 21, 22, 20, 22, 23,
+		};
+		return mesh;
+	}
+
+	// The wedge; the tri-prism is the same with w2 doubled.
+	MeshData BaselineWedge(float w2, float h2, float d2)
+	{
+		MeshData mesh;
+		mesh.Vertices =
+		{
+			Vertex(-w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+			Vertex(-w2, +h2, +d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+			Vertex(+w2, +h2, +d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+			Vertex(+w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+			Vertex(-w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+			Vertex(+w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+			Vertex(+w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+			Vertex(-w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+			Vertex(-w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+			Vertex(+w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+			Vertex(+w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+			Vertex(-w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+			Vertex(-w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f),
+			Vertex(-w2, +h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f),
+			Vertex(-w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f),
+			Vertex(+w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f),
+			Vertex(+w2, +h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f),
+			Vertex(+w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f),
+		};
+		mesh.Indices32 =
+		{
+			0, 1, 2, 0, 2, 3,
+			4, 5, 6, 4, 6, 7,
+			8, 9, 10, 8, 10, 11,
+			12, 13, 14,
+			15, 16, 17,
+		};
+		return mesh;
+	}
+
+	// The pyramid, and with bottom apex the diamond, whose lower half repeats the upper
+	// half's side vertices below an apex at -2 h2.
+	MeshData BaselinePyramid(float w2, float h2, float d2, bool diamond)
+	{
+		MeshData mesh;
+		mesh.Vertices =
+		{
+			Vertex(0.0f, +h2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+			Vertex(-w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+			Vertex(+w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+			Vertex(0.0f, +h2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+			Vertex(+w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+			Vertex(-w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+			Vertex(0.0f, +h2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+			Vertex(-w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f),
+			Vertex(-w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f),
+			Vertex(0.0f, +h2, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+			Vertex(+w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f),
+			Vertex(+w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f),
+		};
+
+		if(!diamond)
+		{
+			mesh.Vertices.insert(mesh.Vertices.end(),
+			{
+				Vertex(-w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+				Vertex(+w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+				Vertex(+w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+				Vertex(-w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+			});
+			mesh.Indices32 = { 0, 2, 1, 2, 3, 4, 4, 6, 5, 6, 8, 7, 5, 1, 2, 2, 4, 5 };
+			return mesh;
+		}
+
+		for(uint32 i = 0; i < 12; ++i)
+		{
+			Vertex v = mesh.Vertices[i];
+			if(i % 3 == 0)
+				v.Position.y = -h2 * 2;
+			mesh.Vertices.push_back(v);
+		}
+		mesh.Indices32 = { 0, 2, 1, 2, 3, 4, 4, 6, 5, 6, 8, 7, 8, 12, 7, 12, 10, 11, 12, 13, 14, 7, 12, 11 };
+		return mesh;
+	}
+
+	MeshData Baseline(Shape shape, const Size& size, uint32 level)
+	{
+		float w2 = 0.5f * size.Width;
+		float h2 = 0.5f * size.Height;
+		float d2 = 0.5f * size.Depth;
+
+		MeshData mesh;
+		switch(shape)
+		{
+		case Shape::Box: mesh = BaselineBox(w2, h2, d2); break;
+		case Shape::Wedge: mesh = BaselineWedge(w2, h2, d2); break;
+		case Shape::Pyramid: mesh = BaselinePyramid(w2, h2, d2, false); break;
+		case Shape::Diamond: mesh = BaselinePyramid(w2, h2, d2, true); break;
+		default: mesh = BaselineWedge(w2 * 2, h2, d2); break;
+		}
+
+		GeometryGenerator geoGen;
+		for(uint32 i = 0; i < level; ++i)
+			geoGen.Subdivide(mesh);
+		return mesh;
+	}
+
+	MeshData Create(Shape shape, const Size& size, uint32 level)
+	{
+		GeometryGenerator geoGen;
+		switch(shape)
+		{
+		case Shape::Box: return geoGen.CreateBox(size.Width, size.Height, size.Depth, level);
+		case Shape::Wedge: return geoGen.CreateWedge(size.Width, size.Height, size.Depth, level);
+		case Shape::Pyramid: return geoGen.CreatePyramid(size.Width, size.Height, size.Depth, level);
+		case Shape::Diamond: return geoGen.CreateDiamond(size.Width, size.Height, size.Depth, level);
+		default: return geoGen.CreateTriPrism(size.Width, size.Height, size.Depth, level);
+		}
+	}
+
+	// The positions through PositionColorWriter, which takes the scalar Scaled path.
+	std::vector<::Vertex> WritePositions(Shape shape, const Size& size, uint32 level)
+	{
+		using ColorWriter = ShapeWriter::PositionColorWriter<::Vertex>;
+		ShapeWriter::Counts counts = ShapeWriter::Detail::GetPolyhedronCounts(shape, level);
+		std::vector<::Vertex> vertices(counts.VertexCount);
+		std::vector<uint32> indices(counts.IndexCount);
+		ShapeWriter::Detail::WritePolyhedron(shape, vertices.data(), indices.data(),
+			ColorWriter{ XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f) }, size.Width, size.Height, size.Depth, level);
+		return vertices;
+	}
+
+	// Largest difference of the n floats in a and b in ulps of scale.
+	float MaxUlps(const float* a, const float* b, int n, float scale)
+	{
+		float worst = 0.0f;
+		for(int i = 0; i < n; ++i)
+			worst = std::max(worst, std::fabs(a[i] - b[i]) / (scale * FLT_EPSILON));
+		return worst;
+	}
+
+	const char* CheckShape(Shape shape)
+	{
+		for(const Size& size : kSizes)
+		{
+			float extent = std::max(size.Width, std::max(size.Height, size.Depth));
+			for(uint32 level = 0; level <= kMaxLevel; ++level)
+			{
+				MeshData baseline = Baseline(shape, size, level);
+				MeshData mesh = Create(shape, size, level);
+				if(mesh.Indices32 != baseline.Indices32 || mesh.Vertices.size() != baseline.Vertices.size())
+					return "indices differ from the runtime builder's";
+
+				if(level == 0 && std::memcmp(mesh.Vertices.data(), baseline.Vertices.data(), mesh.Vertices.size() * sizeof(Vertex)) != 0)
+					return "level 0 vertices differ from the runtime builder's";
+
+				for(std::size_t i = 0; i < mesh.Vertices.size(); ++i)
+				{
+					const Vertex& v = mesh.Vertices[i];
+					const Vertex& b = baseline.Vertices[i];
+					if(MaxUlps(&v.Position.x, &b.Position.x, 3, extent) > kMaxUlps)
+						return "positions differ by more than kMaxUlps of the size";
+					if(MaxUlps(&v.Normal.x, &b.Normal.x, 3, 1.0f) > kMaxUlps ||
+						MaxUlps(&v.TangentU.x, &b.TangentU.x, 3, 1.0f) > kMaxUlps ||
+						MaxUlps(&v.TexC.x, &b.TexC.x, 2, 1.0f) > kMaxUlps)
+						return "normals, tangents or texture coordinates differ by more than kMaxUlps";
+				}
+
+				std::vector<::Vertex> positions = WritePositions(shape, size, level);
+				for(std::size_t i = 0; i < positions.size(); ++i)
+				{
+					if(std::memcmp(&positions[i].Pos, &mesh.Vertices[i].Position, sizeof(XMFLOAT3)) != 0)
+						return "scalar-scaled positions differ from ScaleVertices";
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	const char* CheckScaleVertices()
+	{
+		const float width = 0.37f, height = 5.9f, depth = 12.3f;
+		PolyhedronTables::TableView table = PolyhedronTables::GetTable(Shape::Diamond, PolyhedronTables::MaxTableLevel);
+
+		for(uint32 count = 0; count <= 13; ++count)
+		{
+			Vertex guard(7.0f, 7.0f, 7.0f, 7.0f, 7.0f, 7.0f, 7.0f, 7.0f, 7.0f, 7.0f, 7.0f);
+			std::vector<Vertex> scaled(count + 1, guard);
+			PolyhedronTables::ScaleVertices(table.Vertices + 1, count, width, height, depth, scaled.data());
+
+			for(uint32 i = 0; i < count; ++i)
+			{
+				const PolyhedronTables::UnitVertex& u = table.Vertices[1 + i];
+				Vertex expected(u.Position[0] * width, u.Position[1] * height, u.Position[2] * depth,
+					u.Normal[0], u.Normal[1], u.Normal[2], u.TangentU[0], u.TangentU[1], u.TangentU[2], u.TexC[0], u.TexC[1]);
+				if(std::memcmp(&scaled[i], &expected, sizeof(Vertex)) != 0)
+					return "ScaleVertices differs from scaling one vertex at a time";
+			}
+			if(std::memcmp(&scaled[count], &guard, sizeof(Vertex)) != 0)
+				return "ScaleVertices wrote past the count";
+		}
+		return nullptr;
+	}
+
+	const char* CheckBox() { return CheckShape(Shape::Box); }
+	const char* CheckWedge() { return CheckShape(Shape::Wedge); }
+	const char* CheckPyramid() { return CheckShape(Shape::Pyramid); }
+	const char* CheckDiamond() { return CheckShape(Shape::Diamond); }
+	const char* CheckTriPrism() { return CheckShape(Shape::TriPrism); }
+}
+
+int main()
+{
+	const Check checks[] =
+	{
+		{ "box", CheckBox },
+		{ "wedge", CheckWedge },
+		{ "pyramid", CheckPyramid },
+		{ "diamond", CheckDiamond },
+		{ "tri-prism", CheckTriPrism },
+		{ "ScaleVertices", CheckScaleVertices },
+	};
+	return RunChecks(checks);
+}
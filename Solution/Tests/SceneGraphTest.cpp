@@ -0,0 +1,235 @@
+//***************************************************************************************
+// SceneGraphTest.cpp
+//
+// SceneGraph::Update on a four-level hierarchy with more than 4096 nodes on each level
+// below the roots, so the pool splits every level.  After the first update and after
+// each round of moving a random subset, every world matrix has to be what a naive
+// Local * ParentWorld walk over all nodes gives, bit for bit, and exactly the moved
+// nodes and their descendants have to be reported changed, single threaded and on a
+// pool, also when a level between two moved nodes has nothing to recompute.  Nodes
+// added after an update, including ones shallower than the deepest level that make the
+// graph re-sort, have to come out the same way.
+//***************************************************************************************
+
+#include "Checks.h"
+
+#include "../SceneGraph.h"
+#include "../ThreadPool.h"
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using NodeHandle = SceneGraph::NodeHandle;
+
+	const uint32 kRootCount = 64;
+	const uint32 kLevelSize = 6000;    // above the 4096 at which Update splits a level
+	const uint32 kLevelCount = 4;
+	const uint32 kRounds = 4;
+
+	// The graph and what the naive walk needs: each node's parent, and which nodes were
+	// given a local transform since the last update.  Handles are numbered in creation
+	// order, so every parent's handle is below its children's.
+	struct Scene
+	{
+		SceneGraph Graph;
+		std::vector<NodeHandle> Parents;
+		std::vector<std::uint8_t> Touched;
+		std::mt19937 Rng{ 7 };
+
+		XMMATRIX RandomLocal()
+		{
+			std::uniform_real_distribution<float> offset(-10.0f, 10.0f);
+			std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+			std::uniform_real_distribution<float> scale(0.8f, 1.2f);
+			return XMMatrixScaling(scale(Rng), scale(Rng), scale(Rng)) * XMMatrixRotationX(angle(Rng)) *
+				XMMatrixRotationY(angle(Rng)) * XMMatrixTranslation(offset(Rng), offset(Rng), offset(Rng));
+		}
+
+		NodeHandle Add(NodeHandle parent)
+		{
+			NodeHandle node = Graph.CreateNode(parent, RandomLocal());
+			Parents.push_back(parent);
+			Touched.push_back(1);
+			return node;
+		}
+
+		void Move(NodeHandle node)
+		{
+			Graph.SetLocal(node, RandomLocal());
+			Touched[node] = 1;
+		}
+
+		// Adds count nodes below random parents from level.
+		std::vector<NodeHandle> AddLevel(const std::vector<NodeHandle>& level, uint32 count)
+		{
+			std::uniform_int_distribution<std::size_t> pick(0, level.size() - 1);
+			std::vector<NodeHandle> added;
+			for(uint32 i = 0; i < count; ++i)
+				added.push_back(Add(level[pick(Rng)]));
+			return added;
+		}
+
+		// Moves about one node in a hundred, and one root with its whole subtree.
+		void MoveSome()
+		{
+			std::uniform_int_distribution<uint32> pick(0, (uint32)Parents.size() - 1);
+			for(uint32 i = 0; i < (uint32)Parents.size() / 100; ++i)
+				Move(pick(Rng));
+			Move(pick(Rng) % kRootCount);
+		}
+
+		// Moves a first-level node without children and a leaf, so the level between
+		// them has nothing to recompute and Update must not stop there.
+		bool MoveAcrossQuietLevel()
+		{
+			std::vector<std::uint8_t> hasChildren(Parents.size());
+			for(NodeHandle parent : Parents)
+			{
+				if(parent != SceneGraph::InvalidNode)
+					hasChildren[parent] = 1;
+			}
+
+			for(NodeHandle node = kRootCount; node < kRootCount + kLevelSize; ++node)
+			{
+				if(!hasChildren[node])
+				{
+					Move(node);
+					Move((NodeHandle)Parents.size() - 1);
+					return true;
+				}
+			}
+			return false;
+		}
+	};
+
+	Scene MakeScene()
+	{
+		Scene scene;
+		std::vector<NodeHandle> level;
+		for(uint32 i = 0; i < kRootCount; ++i)
+			level.push_back(scene.Add(SceneGraph::InvalidNode));
+		for(uint32 depth = 1; depth < kLevelCount; ++depth)
+			level = scene.AddLevel(level, kLevelSize);
+		return scene;
+	}
+
+	// Recomputes every world matrix from the locals and compares it, and which nodes
+	// changed, with what Update left.
+	const char* Verify(Scene& scene, uint32 recomputed)
+	{
+		uint32 nodeCount = (uint32)scene.Parents.size();
+		std::vector<XMFLOAT4X4> world(nodeCount);
+		std::vector<std::uint8_t> changed(nodeCount);
+		uint32 changedCount = 0;
+		const char* error = nullptr;
+
+		for(NodeHandle node = 0; node < nodeCount && error == nullptr; ++node)
+		{
+			NodeHandle parent = scene.Parents[node];
+			XMMATRIX local = XMLoadFloat4x4(&scene.Graph.GetLocal(node));
+			if(parent == SceneGraph::InvalidNode)
+				XMStoreFloat4x4(&world[node], local);
+			else
+				XMStoreFloat4x4(&world[node], XMMatrixMultiply(local, XMLoadFloat4x4(&world[parent])));
+
+			changed[node] = scene.Touched[node] || (parent != SceneGraph::InvalidNode && changed[parent]);
+			changedCount += changed[node];
+
+			if(std::memcmp(&world[node], &scene.Graph.GetWorld(node), sizeof(XMFLOAT4X4)) != 0)
+				error = "world matrix differs from the full recompute";
+			else if(scene.Graph.WorldChanged(node) != (changed[node] != 0))
+				error = "WorldChanged is not the moved nodes and their descendants";
+		}
+
+		if(error == nullptr && recomputed != changedCount)
+			error = "Update did not recompute exactly the changed nodes";
+		if(error == nullptr && scene.Graph.GetNodeCount() != nodeCount)
+			error = "node count differs from the nodes created";
+
+		scene.Touched.assign(nodeCount, 0);
+		return error;
+	}
+
+	// The first update, then rounds of moving some nodes, against the full recompute.
+	const char* CheckMoves(ThreadPool* pool)
+	{
+		Scene scene = MakeScene();
+		if(scene.Graph.GetDepthCount() != kLevelCount)
+			return "hierarchy does not have the levels it was built with";
+
+		if(const char* error = Verify(scene, scene.Graph.Update(pool)))
+			return error;
+
+		for(uint32 round = 0; round < kRounds; ++round)
+		{
+			scene.MoveSome();
+			if(const char* error = Verify(scene, scene.Graph.Update(pool)))
+				return error;
+		}
+
+		if(!scene.MoveAcrossQuietLevel())
+			return "no first-level node without children";
+		return Verify(scene, scene.Graph.Update(pool));
+	}
+
+	const char* CheckMovesSingleThread()
+	{
+		return CheckMoves(nullptr);
+	}
+
+	const char* CheckMovesPool()
+	{
+		ThreadPool pool(4);
+		return CheckMoves(&pool);
+	}
+
+	// Nodes created after an update: new roots and nodes below the first level come
+	// before the deepest level, so the slots are re-sorted, and a level below the
+	// leaves adds a depth.  An update with nothing moved recomputes nothing.
+	const char* CheckAddedNodes()
+	{
+		ThreadPool pool(4);
+		Scene scene = MakeScene();
+		if(const char* error = Verify(scene, scene.Graph.Update(&pool)))
+			return error;
+
+		std::vector<NodeHandle> roots;
+		for(uint32 i = 0; i < 8; ++i)
+			roots.push_back(scene.Add(SceneGraph::InvalidNode));
+		std::vector<NodeHandle> level = scene.AddLevel(roots, kLevelSize);
+		scene.AddLevel(level, 100);
+
+		std::vector<NodeHandle> leaves;
+		for(NodeHandle node = kRootCount + (kLevelCount - 2) * kLevelSize; node < kRootCount + (kLevelCount - 1) * kLevelSize; ++node)
+			leaves.push_back(node);
+		scene.AddLevel(leaves, kLevelSize);
+		scene.MoveSome();
+
+		if(const char* error = Verify(scene, scene.Graph.Update(&pool)))
+			return error;
+		if(scene.Graph.GetDepthCount() != kLevelCount + 1)
+			return "a level below the leaves did not add a depth";
+
+		if(const char* error = Verify(scene, scene.Graph.Update(&pool)))
+			return error;
+		return nullptr;
+	}
+}
+
+int main()
+{
+	const Check checks[] =
+	{
+		{ "moves, one thread", CheckMovesSingleThread },
+		{ "moves, thread pool", CheckMovesPool },
+		{ "nodes added after update", CheckAddedNodes },
+	};
+	return RunChecks(checks);
+}
@@ -0,0 +1,240 @@
+//***************************************************************************************
+// ShapeUpdateTest.cpp
+//
+// In-place shape updates on a scene of 64 spheres, capped cylinders, grids and
+// parametric tori in one vertex and one index buffer.  Updating every shape to new
+// radii, heights and widths has to give, byte for byte, the vertices of the scene
+// regenerated with those parameters, leave the indices as they were and report each
+// shape's vertices as the dirty range; uploading just those ranges frame after frame
+// has to keep a destination buffer equal to the CPU copy.  An update whose shape,
+// slice or stack counts, pinched rows or vertex count are not the ones its range was
+// appended with has to write nothing, even where the vertex count agrees.
+//***************************************************************************************
+
+#include "Checks.h"
+
+#include "../ParametricSurface.h"
+#include "../ShapeWriter.h"
+#include "../SimulatedCopyQueue.h"
+#include "../StagingUploader.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+	using Vertex = GeometryGenerator::Vertex;
+
+	const uint32 kShapeCount = 64;
+	const uint64 kRingBytes = 16 * 1024 * 1024;
+	const float kTimeStep = 1.0f / 60.0f;
+
+	// One animated scene in one concatenated vertex and index buffer.
+	struct Scene
+	{
+		uint32 Slices = 0;
+		std::vector<Vertex> Vertices;
+		std::vector<uint32> Indices;
+		std::vector<ShapeWriter::Range> Ranges;
+
+		explicit Scene(uint32 slices)
+			: Slices(slices)
+		{
+		}
+
+		// Shape i's size at time t.
+		static float GetScale(uint32 shape, float t)
+		{
+			return 1.0f + 0.25f * std::sin(2.0f * t + 0.37f * shape);
+		}
+
+		void Build(float t)
+		{
+			Vertices.clear();
+			Indices.clear();
+			Ranges.clear();
+
+			ShapeWriter::GeneratorVertexWriter writer;
+			for(uint32 shape = 0; shape < kShapeCount; ++shape)
+			{
+				float s = GetScale(shape, t);
+				switch(shape % 4)
+				{
+				case 0:
+					Ranges.push_back(ShapeWriter::AppendSphere(Vertices, Indices, writer, s, Slices, Slices / 2));
+					break;
+				case 1:
+					Ranges.push_back(ShapeWriter::AppendCylinder(Vertices, Indices, writer, s, 0.5f * s, 2.0f / s, Slices, Slices / 4));
+					break;
+				case 2:
+					Ranges.push_back(ShapeWriter::AppendGrid(Vertices, Indices, writer, 4.0f * s, 4.0f, Slices / 2, Slices / 2));
+					break;
+				default:
+					Ranges.push_back(ParametricSurface::Append(Vertices, Indices, writer,
+						ParametricSurface::Torus{ s, 0.25f * s }, Slices, Slices / 2));
+					break;
+				}
+			}
+		}
+
+		ShapeWriter::DirtyRange Update(uint32 shape, float t, uint32 slices)
+		{
+			ShapeWriter::GeneratorVertexWriter writer;
+			const ShapeWriter::Range& range = Ranges[shape];
+			float s = GetScale(shape, t);
+			switch(shape % 4)
+			{
+			case 0:
+				return ShapeWriter::UpdateSphere(Vertices.data(), range, writer, s, slices, slices / 2);
+			case 1:
+				return ShapeWriter::UpdateCylinder(Vertices.data(), range, writer, s, 0.5f * s, 2.0f / s, slices, slices / 4);
+			case 2:
+				return ShapeWriter::UpdateGrid(Vertices.data(), range, writer, 4.0f * s, 4.0f, slices / 2, slices / 2);
+			default:
+				return ParametricSurface::Update(Vertices.data(), range, writer,
+					ParametricSurface::Torus{ s, 0.25f * s }, slices, slices / 2);
+			}
+		}
+	};
+
+	// Runs update, which has to be refused, and checks it left the vertices alone.
+	template<typename UpdateFn>
+	bool Refused(std::vector<Vertex>& vertices, const UpdateFn& update)
+	{
+		std::vector<Vertex> before = vertices;
+		return update().Size == 0 &&
+			std::memcmp(before.data(), vertices.data(), vertices.size() * sizeof(Vertex)) == 0;
+	}
+
+	// Topologies with the same vertex count but other indices, and ranges of another
+	// size or made by hand, which an update has to refuse rather than rewrite.
+	const char* CheckRefusals()
+	{
+		ShapeWriter::GeneratorVertexWriter writer;
+		std::vector<Vertex> vertices;
+		std::vector<uint32> indices;
+
+		ShapeWriter::Range sphere = ShapeWriter::AppendSphere(vertices, indices, writer, 1.0f, 3, 5);
+		ShapeWriter::Range grid = ShapeWriter::AppendGrid(vertices, indices, writer, 1.0f, 1.0f, 4, 6);
+		ShapeWriter::Range cylinder = ParametricSurface::AppendCylinder(vertices, indices, writer, 1.0f, 0.5f, 1.0f, 8, 4);
+		ShapeWriter::Range torus = ParametricSurface::Append(vertices, indices, writer, ParametricSurface::Torus{ 1.0f, 0.25f }, 8, 4);
+		Vertex* v = vertices.data();
+
+		if(ShapeWriter::GetSphereCounts(7, 3).VertexCount != sphere.VertexCount)
+			return "sphere counts changed; pick other refusal cases";
+		if(!Refused(vertices, [&]() { return ShapeWriter::UpdateSphere(v, sphere, writer, 2.0f, 7, 3); }))
+			return "sphere update accepted other slices and stacks";
+		if(!Refused(vertices, [&]() { return ShapeWriter::UpdateSphere(v, sphere, writer, 2.0f, 4, 5); }))
+			return "sphere update accepted another vertex count";
+		if(!Refused(vertices, [&]() { return ShapeWriter::UpdateGrid(v, grid, writer, 2.0f, 2.0f, 6, 4); }))
+			return "grid update accepted a transposed grid";
+		if(!Refused(vertices, [&]() { return ShapeWriter::UpdateSphere(v, grid, writer, 1.0f, 4, 6); }))
+			return "sphere update accepted a grid's range";
+		if(!Refused(vertices, [&]() { return ParametricSurface::UpdateCylinder(v, cylinder, writer, 1.0f, 0.0f, 1.0f, 8, 4); }))
+			return "cylinder update accepted a radius going to 0";
+		if(!Refused(vertices, [&]() { return ParametricSurface::Update(v, torus, writer, ParametricSurface::Sphere{ 1.0f }, 8, 4); }))
+			return "surface update accepted pinched rows the range does not have";
+
+		// Same counts, but no Topology to vouch for them.
+		ShapeWriter::Range handMade;
+		handMade.BaseVertex = sphere.BaseVertex;
+		handMade.VertexCount = sphere.VertexCount;
+		handMade.StartIndex = sphere.StartIndex;
+		handMade.IndexCount = sphere.IndexCount;
+		if(!Refused(vertices, [&]() { return ShapeWriter::UpdateSphere(v, handMade, writer, 2.0f, 3, 5); }))
+			return "update accepted a range without a topology";
+
+		if(ParametricSurface::UpdateCylinder(v, cylinder, writer, 2.0f, 0.25f, 3.0f, 8, 4).Size == 0)
+			return "cylinder update refused new radii";
+		return nullptr;
+	}
+
+	const char* CheckInPlace(uint32 slices)
+	{
+		Scene updated(slices);
+		updated.Build(0.0f);
+		std::vector<uint32> indices = updated.Indices;
+
+		const float t = 1.3f;
+		for(uint32 shape = 0; shape < kShapeCount; ++shape)
+		{
+			const ShapeWriter::Range& range = updated.Ranges[shape];
+			ShapeWriter::DirtyRange dirty = updated.Update(shape, t, slices);
+			if(dirty.Offset != range.BaseVertex * sizeof(Vertex) || dirty.Size != range.VertexCount * sizeof(Vertex))
+				return "dirty range is not the shape's vertices";
+			if(updated.Update(shape, t, slices + 2).Size != 0)
+				return "update with a different slice count wrote vertices";
+		}
+
+		Scene rebuilt(slices);
+		rebuilt.Build(t);
+		if(updated.Indices != indices || rebuilt.Indices != indices)
+			return "indices changed";
+		if(updated.Vertices.size() != rebuilt.Vertices.size() ||
+			std::memcmp(updated.Vertices.data(), rebuilt.Vertices.data(), rebuilt.Vertices.size() * sizeof(Vertex)) != 0)
+			return "updated vertices differ from regenerated ones";
+		return nullptr;
+	}
+
+	const char* CheckInPlace32()
+	{
+		return CheckInPlace(32);
+	}
+
+	const char* CheckInPlace128()
+	{
+		return CheckInPlace(128);
+	}
+
+	// Ten frames of updates with only the dirty ranges uploaded, after the whole scene once.
+	const char* CheckUploads()
+	{
+		Scene scene(32);
+		scene.Build(0.0f);
+
+		std::vector<Vertex> vertexBuffer(scene.Vertices.size());
+		std::vector<uint32> indexBuffer(scene.Indices.size());
+		std::unique_ptr<std::uint8_t[]> staging(new std::uint8_t[(std::size_t)kRingBytes]);
+		SimulatedCopyQueue queue(staging.get());
+		{
+			StagingUploader uploader(queue, staging.get(), kRingBytes);
+			uploader.Upload(vertexBuffer.data(), 0, scene.Vertices.data(), scene.Vertices.size() * sizeof(Vertex));
+			uploader.Upload(indexBuffer.data(), 0, scene.Indices.data(), scene.Indices.size() * sizeof(uint32));
+
+			const std::uint8_t* source = reinterpret_cast<const std::uint8_t*>(scene.Vertices.data());
+			for(uint32 frame = 1; frame <= 10; ++frame)
+			{
+				for(uint32 shape = 0; shape < kShapeCount; ++shape)
+				{
+					ShapeWriter::DirtyRange dirty = scene.Update(shape, frame * kTimeStep, 32);
+					uploader.Upload(vertexBuffer.data(), dirty.Offset, source + dirty.Offset, dirty.Size);
+				}
+				uploader.Flush();
+				uploader.EndFrame();
+			}
+			uploader.WaitIdle();
+		}
+
+		if(std::memcmp(vertexBuffer.data(), scene.Vertices.data(), vertexBuffer.size() * sizeof(Vertex)) != 0 ||
+			indexBuffer != scene.Indices)
+			return "destination does not match source";
+		return nullptr;
+	}
+}
+
+int main()
+{
+	const Check checks[] =
+	{
+		{ "mismatched updates refused", CheckRefusals },
+		{ "in place, 32 slices", CheckInPlace32 },
+		{ "in place, 128 slices", CheckInPlace128 },
+		{ "dirty range uploads", CheckUploads },
+	};
+	return RunChecks(checks);
+}
@@ -0,0 +1,201 @@
+//***************************************************************************************
+// StagingUploaderTest.cpp
+//
+// StagingRing's space bookkeeping, and StagingUploader over a SimulatedCopyQueue: every
+// destination has to end up holding what was uploaded, whether the ring holds a frame,
+// has to wait for the copy engine part way through one, or takes an upload bigger than
+// itself in pieces.
+//***************************************************************************************
+
+#include "Checks.h"
+
+#include "../SimulatedCopyQueue.h"
+#include "../StagingUploader.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	std::vector<std::uint8_t> Pattern(std::size_t size, uint32 seed)
+	{
+		std::vector<std::uint8_t> bytes(size);
+		for(std::size_t b = 0; b < size; ++b)
+			bytes[b] = (std::uint8_t)(b * 31 + seed * 7 + (b >> 8));
+		return bytes;
+	}
+
+	const char* CheckRing()
+	{
+		StagingRing ring(256);
+		uint64 offset = 0;
+
+		if(ring.Allocate(257, 16, offset))
+			return "took more than the capacity";
+		if(!ring.Allocate(100, 16, offset) || offset != 0)
+			return "first allocation not at the front";
+		if(!ring.Allocate(100, 16, offset) || offset != 112)
+			return "second allocation not aligned after the first";
+
+		// 100 more would straddle the end, and the front is still in use.
+		if(ring.Allocate(100, 16, offset))
+			return "allocated over space in use";
+
+		ring.Close(1);
+		ring.Retire(0);
+		if(ring.Allocate(100, 16, offset))
+			return "space freed before its fence completed";
+
+		ring.Retire(1);
+		if(ring.GetUsedBytes() != 0 || !ring.Allocate(256, 16, offset) || offset != 0)
+			return "a drained ring does not start again at the front";
+		if(ring.GetPeakUsedBytes() != 256)
+			return "wrong peak";
+		return nullptr;
+	}
+
+	const char* CheckFences()
+	{
+		std::vector<std::uint8_t> staging = Pattern(1024, 1);
+		std::vector<std::uint8_t> destination(1024, 0);
+		SimulatedCopyQueue queue(staging.data());
+
+		CopyQueue::Copy copy;
+		copy.Destination = destination.data();
+		uint64 fence = 0;
+		for(uint32 b = 0; b < 4; ++b)
+		{
+			copy.DestinationOffset = copy.SourceOffset = b * 256;
+			copy.Size = 256;
+			if(queue.Submit(&copy, 1) != ++fence)
+				return "fence values do not go up by one per batch";
+		}
+
+		queue.WaitForFence(fence);
+		if(queue.GetCompletedFence() < fence)
+			return "wait returned before the fence completed";
+		if(queue.GetCopiedBytes() != 1024 || destination != staging)
+			return "copies not executed";
+		return nullptr;
+	}
+
+	// Frames of 24 meshes of 8 KB through a 64 KB ring with a slow copy engine, so
+	// uploads wait for it.  Each source is changed right after its Upload, which must
+	// not reach the destination.
+	const char* CheckFrames()
+	{
+		const uint32 meshCount = 24;
+		const std::size_t meshBytes = 8 * 1024;
+		const uint64 ringBytes = 64 * 1024;
+		const uint32 frames = 8;
+
+		std::unique_ptr<std::uint8_t[]> staging(new std::uint8_t[(std::size_t)ringBytes]);
+		SimulatedCopyQueue queue(staging.get(), 256.0 * 1024 * 1024);
+
+		std::vector<std::vector<std::uint8_t>> destinations(meshCount, std::vector<std::uint8_t>(meshBytes, 0));
+		std::vector<std::vector<std::uint8_t>> expected(meshCount);
+
+		StagingUploader::Stats stats;
+		{
+			StagingUploader uploader(queue, staging.get(), ringBytes);
+			for(uint32 frame = 0; frame < frames; ++frame)
+			{
+				for(uint32 m = 0; m < meshCount; ++m)
+				{
+					std::vector<std::uint8_t> source = Pattern(meshBytes, frame * meshCount + m);
+					uploader.Upload(destinations[m].data(), 0, source.data(), meshBytes);
+					expected[m] = source;
+					std::memset(source.data(), 0xcd, meshBytes);
+				}
+				uploader.Flush();
+				uploader.EndFrame();
+			}
+			uploader.WaitIdle();
+			stats = uploader.GetStats();
+		}
+
+		if(destinations != expected)
+			return "destination does not match the last upload";
+		if(stats.TotalBytes != (uint64)frames * meshCount * meshBytes || stats.Frames != frames)
+			return "wrong byte or frame count";
+		if(stats.PeakStagingBytes > ringBytes)
+			return "staging in use beyond the capacity";
+		if(stats.Stalls == 0)
+			return "a frame larger than the ring never waited";
+		return nullptr;
+	}
+
+	// One upload of five rings and a bit, at an offset into its destination.
+	const char* CheckLargeUpload()
+	{
+		const uint64 ringBytes = 4096;
+		const std::size_t size = 5 * 4096 + 3;
+
+		std::unique_ptr<std::uint8_t[]> staging(new std::uint8_t[(std::size_t)ringBytes]);
+		SimulatedCopyQueue queue(staging.get());
+
+		std::vector<std::uint8_t> source = Pattern(size, 3);
+		std::vector<std::uint8_t> destination(size + 10, 0xab);
+		{
+			StagingUploader uploader(queue, staging.get(), ringBytes);
+			uploader.Upload(destination.data(), 5, source.data(), size);
+			uploader.WaitIdle();
+		}
+
+		if(std::memcmp(destination.data() + 5, source.data(), size) != 0)
+			return "pieces do not add up to the upload";
+		for(std::size_t b : { std::size_t(0), std::size_t(4), size + 5, size + 9 })
+		{
+			if(destination[b] != 0xab)
+				return "wrote outside the destination range";
+		}
+		return nullptr;
+	}
+
+	const char* CheckStage()
+	{
+		const uint64 ringBytes = 4096;
+		std::unique_ptr<std::uint8_t[]> staging(new std::uint8_t[(std::size_t)ringBytes]);
+		SimulatedCopyQueue queue(staging.get());
+
+		std::vector<std::uint8_t> source = Pattern(1000, 4);
+		std::vector<std::uint8_t> destination(1000, 0);
+		{
+			StagingUploader uploader(queue, staging.get(), ringBytes);
+			if(uploader.Stage(destination.data(), 0, ringBytes + 1) != nullptr || uploader.GetStats().Copies != 0)
+				return "staged more than the buffer holds";
+
+			uploader.Upload(destination.data(), 0, source.data(), 10);
+			void* memory = uploader.Stage(destination.data(), 10, 990, 256);
+			if(memory == nullptr)
+				return "could not stage";
+			if((static_cast<std::uint8_t*>(memory) - staging.get()) % 256 != 0)
+				return "staged memory not aligned";
+
+			std::memcpy(memory, source.data() + 10, 990);
+			uploader.WaitIdle();
+		}
+
+		if(destination != source)
+			return "staged data not copied";
+		return nullptr;
+	}
+}
+
+int main()
+{
+	const Check checks[] =
+	{
+		{ "ring allocation and retirement", CheckRing },
+		{ "copy queue fences", CheckFences },
+		{ "frames larger than the ring", CheckFrames },
+		{ "upload larger than the ring", CheckLargeUpload },
+		{ "stage and write in place", CheckStage },
+	};
+	return RunChecks(checks);
+}
@@ -0,0 +1,128 @@
+//***************************************************************************************
+// TangentGeneratorTest.cpp
+//
+// TangentGenerator::Generate on the LandApp hills, a grid lifted onto the height field
+// with the height field's normals: every tangent has to be within a few degrees of the
+// height field's own u direction (the flat triangles of the grid bend it by up to 3),
+// and pools of several sizes have to agree with a single thread to rounding.  Triangles
+// with degenerate texture coordinates still leave unit tangents perpendicular to the
+// normals.
+//***************************************************************************************
+
+#include "Checks.h"
+
+#include "../TangentGenerator.h"
+#include "../Terrain.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+	using uint32 = std::uint32_t;
+
+	const float kGridSize = 160.0f;
+	const float kMinCosine = 0.996f;    // 5 degrees
+
+	// 512 x 512 quads, enough triangles for a range per thread in every pool below.
+	GeometryGenerator::MeshData MakeHills()
+	{
+		GeometryGenerator geoGen;
+		GeometryGenerator::MeshData grid = geoGen.CreateGrid(kGridSize, kGridSize, 513, 513);
+		for(GeometryGenerator::Vertex& v : grid.Vertices)
+		{
+			v.Position.y = GetHillsHeight(v.Position.x, v.Position.z);
+			v.Normal = GetHillsNormal(v.Position.x, v.Position.z);
+			v.TangentU = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+		}
+		return grid;
+	}
+
+	// The grid's u runs along +x, so the surface tangent is (1, df/dx, 0).
+	bool MatchesHeightField(const GeometryGenerator::MeshData& mesh)
+	{
+		for(const GeometryGenerator::Vertex& v : mesh.Vertices)
+		{
+			float slope = -v.Normal.x / v.Normal.y;
+			float length = std::sqrt(1.0f + slope * slope);
+			float cosine = (v.TangentU.x + v.TangentU.y * slope) / length;
+			if(cosine < kMinCosine)
+				return false;
+		}
+		return true;
+	}
+
+	bool SameTangents(const GeometryGenerator::MeshData& a, const GeometryGenerator::MeshData& b)
+	{
+		for(std::size_t i = 0; i < a.Vertices.size(); ++i)
+		{
+			const DirectX::XMFLOAT3& s = a.Vertices[i].TangentU;
+			const DirectX::XMFLOAT3& t = b.Vertices[i].TangentU;
+			if(std::fabs(s.x - t.x) > 1e-5f || std::fabs(s.y - t.y) > 1e-5f || std::fabs(s.z - t.z) > 1e-5f)
+				return false;
+		}
+		return true;
+	}
+
+	bool UnitAndPerpendicular(const GeometryGenerator::Vertex& v)
+	{
+		const DirectX::XMFLOAT3& t = v.TangentU;
+		const DirectX::XMFLOAT3& n = v.Normal;
+		float lengthSq = t.x * t.x + t.y * t.y + t.z * t.z;
+		return std::fabs(lengthSq - 1.0f) <= 1e-4f && std::fabs(t.x * n.x + t.y * n.y + t.z * n.z) <= 1e-4f;
+	}
+
+	const char* CheckHills()
+	{
+		GeometryGenerator::MeshData serial = MakeHills();
+		ThreadPool single(1);
+		TangentGenerator::Generate(serial, single);
+		if(!MatchesHeightField(serial))
+			return "tangents do not follow the height field";
+
+		for(uint32 threads : { 2u, 4u, 7u })
+		{
+			GeometryGenerator::MeshData mesh = MakeHills();
+			ThreadPool pool(threads);
+			TangentGenerator::Generate(mesh, pool);
+			if(!SameTangents(mesh, serial))
+				return "pool and single thread disagree";
+		}
+		return nullptr;
+	}
+
+	// A quad whose texture coordinates collapse to a point, and a vertex no triangle uses.
+	const char* CheckDegenerate()
+	{
+		GeometryGenerator::MeshData mesh;
+		mesh.Vertices.resize(5);
+		const DirectX::XMFLOAT3 positions[] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 0, -1 }, { 0, 0, -1 }, { 5, 5, 5 } };
+		for(uint32 i = 0; i < 5; ++i)
+		{
+			mesh.Vertices[i].Position = positions[i];
+			mesh.Vertices[i].Normal = DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f);
+			mesh.Vertices[i].TexC = DirectX::XMFLOAT2(0.5f, 0.5f);
+		}
+		mesh.Vertices[4].Normal = DirectX::XMFLOAT3(0.6f, 0.0f, 0.8f);
+		mesh.Indices32 = { 0, 1, 2, 0, 2, 3 };
+
+		ThreadPool pool(1);
+		TangentGenerator::Generate(mesh, pool);
+		for(const GeometryGenerator::Vertex& v : mesh.Vertices)
+		{
+			if(!UnitAndPerpendicular(v))
+				return "tangent not a unit vector perpendicular to the normal";
+		}
+		return nullptr;
+	}
+}
+
+int main()
+{
+	const Check checks[] =
+	{
+		{ "hills, pools of 1 to 7 threads", CheckHills },
+		{ "degenerate and unused vertices", CheckDegenerate },
+	};
+	return RunChecks(checks);
+}
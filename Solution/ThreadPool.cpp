@@ -0,0 +1,187 @@
+//***************************************************************************************
+// ThreadPool.cpp
+//***************************************************************************************
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(uint32 workerCount)
+{
+	if(workerCount == 0)
+	{
+		uint32 hw = std::thread::hardware_concurrency();
+		workerCount = hw > 1 ? hw - 1 : 0;
+	}
+
+	mWorkers.reserve(workerCount);
+	for(uint32 i = 0; i < workerCount; ++i)
+		mWorkers.emplace_back(&ThreadPool::WorkerMain, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mWake.notify_all();
+
+	for(auto& worker : mWorkers)
+		worker.join();
+}
+
+void ThreadPool::RunParallelFor(uint32 count, uint32 minBatch, const void* context, BatchFn fn)
+{
+	if(count == 0)
+		return;
+
+	minBatch = std::max<uint32>(minBatch, 1);
+
+	// A few batches per thread keeps the load balanced when batches finish unevenly.
+	uint32 maxBatches = GetThreadCount() * 4;
+	uint32 batchCount = std::min<uint32>((count + minBatch - 1) / minBatch, maxBatches);
+
+	if(mWorkers.empty() || batchCount < 2)
+	{
+		fn(context, 0, count);
+		return;
+	}
+
+	Job job;
+	job.BatchSize = (count + batchCount - 1) / batchCount;
+	job.BatchCount = (count + job.BatchSize - 1) / job.BatchSize;
+	job.Count = count;
+	job.Context = context;
+	job.Fn = fn;
+	job.HelperSlots = std::min<uint32>((uint32)mWorkers.size(), job.BatchCount - 1);
+
+	bool published = false;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if(mOpenJobCount < MaxOpenJobs)
+		{
+			mOpenJobs[mOpenJobCount++] = &job;
+			published = true;
+		}
+	}
+	if(published)
+		mWake.notify_all();
+
+	// The caller works too, so the range completes even if every worker is busy.
+	RunBatches(job);
+
+	{
+		std::unique_lock<std::mutex> lock(job.Mutex);
+		job.Finished.wait(lock, [&job]() { return job.DoneBatches.load(std::memory_order_acquire) == job.BatchCount; });
+	}
+
+	if(published)
+	{
+		// Close the job to late workers, then let the ones inside find no batches left
+		// and leave before the job goes out of scope.
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			auto end = mOpenJobs + mOpenJobCount;
+			auto it = std::find(mOpenJobs, end, &job);
+			if(it != end)
+			{
+				std::copy(it + 1, end, it);
+				--mOpenJobCount;
+			}
+		}
+		while(job.Helpers.load(std::memory_order_acquire) != 0)
+			std::this_thread::yield();
+	}
+}
+
+void ThreadPool::RunBatches(Job& job)
+{
+	for(;;)
+	{
+		uint32 batch = job.NextBatch.fetch_add(1, std::memory_order_relaxed);
+		if(batch >= job.BatchCount)
+			return;
+
+		uint32 begin = batch * job.BatchSize;
+		uint32 end = std::min(begin + job.BatchSize, job.Count);
+		job.Fn(job.Context, begin, end);
+
+		if(job.DoneBatches.fetch_add(1, std::memory_order_acq_rel) + 1 == job.BatchCount)
+		{
+			std::lock_guard<std::mutex> lock(job.Mutex);
+			job.Finished.notify_all();
+		}
+	}
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+	if(mWorkers.empty())
+	{
+		task();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mTasks.push_back(std::move(task));
+		++mActiveTasks;
+	}
+	mWake.notify_one();
+}
+
+void ThreadPool::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mIdle.wait(lock, [this]() { return mActiveTasks == 0; });
+}
+
+void ThreadPool::WorkerMain()
+{
+	for(;;)
+	{
+		Job* job = nullptr;
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWake.wait(lock, [this]() { return mStopping || mOpenJobCount > 0 || !mTasks.empty(); });
+
+			if(mOpenJobCount > 0)
+			{
+				// Join the oldest open range; it leaves the list once it has enough helpers.
+				job = mOpenJobs[0];
+				job->Helpers.fetch_add(1, std::memory_order_relaxed);
+				if(--job->HelperSlots == 0)
+				{
+					std::copy(mOpenJobs + 1, mOpenJobs + mOpenJobCount, mOpenJobs);
+					--mOpenJobCount;
+				}
+			}
+			else if(!mTasks.empty())
+			{
+				task = std::move(mTasks.front());
+				mTasks.pop_front();
+			}
+			else
+			{
+				return;
+			}
+		}
+
+		if(job != nullptr)
+		{
+			RunBatches(*job);
+			job->Helpers.fetch_sub(1, std::memory_order_release);
+			continue;
+		}
+
+		task();
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if(--mActiveTasks == 0)
+				mIdle.notify_all();
+		}
+	}
+}
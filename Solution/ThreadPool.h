@@ -0,0 +1,103 @@
+//***************************************************************************************
+// ThreadPool.h
+//
+// A small fixed-size pool of worker threads.  ParallelFor splits an index range into
+// batches that the workers and the calling thread pull from until the range is done;
+// Submit queues fire-and-forget tasks for background work.  Workers serve waiting
+// ParallelFor ranges before queued tasks.
+//***************************************************************************************
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+
+	using uint32 = std::uint32_t;
+
+	///<summary>
+	/// Creates a pool with the given number of worker threads.  Zero picks one worker
+	/// per hardware thread, minus one for the thread that calls ParallelFor.
+	///</summary>
+	explicit ThreadPool(uint32 workerCount = 0);
+	ThreadPool(const ThreadPool& rhs) = delete;
+	ThreadPool& operator=(const ThreadPool& rhs) = delete;
+	~ThreadPool();
+
+	///<summary>
+	/// Number of threads that execute ParallelFor batches (the workers plus the caller).
+	///</summary>
+	uint32 GetThreadCount()const { return (uint32)mWorkers.size() + 1; }
+
+	///<summary>
+	/// Calls fn(begin, end) over [0, count) in batches of at least minBatch indices and
+	/// returns once every batch has run.  Ranges smaller than two batches run inline.
+	/// fn is called through a reference, so a ParallelFor does not allocate.
+	///</summary>
+	template<typename Fn>
+	void ParallelFor(uint32 count, uint32 minBatch, const Fn& fn)
+	{
+		RunParallelFor(count, minBatch, &fn, [](const void* context, uint32 begin, uint32 end)
+		{
+			(*static_cast<const Fn*>(context))(begin, end);
+		});
+	}
+
+	///<summary>
+	/// Queues a task to run on a worker thread.
+	///</summary>
+	void Submit(std::function<void()> task);
+
+	///<summary>
+	/// Blocks until every submitted task has finished.
+	///</summary>
+	void WaitIdle();
+
+private:
+	using BatchFn = void(*)(const void* context, uint32 begin, uint32 end);
+
+	// A ParallelFor in progress.  It lives on the caller's stack; workers join it
+	// through mOpenJobs and the caller waits for them to leave before returning.
+	struct Job
+	{
+		std::atomic<uint32> NextBatch{ 0 };
+		std::atomic<uint32> DoneBatches{ 0 };
+		std::atomic<uint32> Helpers{ 0 };
+		uint32 HelperSlots = 0;
+		uint32 BatchCount = 0;
+		uint32 BatchSize = 0;
+		uint32 Count = 0;
+		const void* Context = nullptr;
+		BatchFn Fn = nullptr;
+
+		std::mutex Mutex;
+		std::condition_variable Finished;
+	};
+
+	// ParallelFor calls that can still take helpers.  Fixed size so publishing a job
+	// never allocates; when it is full the caller runs the range alone.
+	static const uint32 MaxOpenJobs = 16;
+
+	void RunParallelFor(uint32 count, uint32 minBatch, const void* context, BatchFn fn);
+	static void RunBatches(Job& job);
+	void WorkerMain();
+
+	std::vector<std::thread> mWorkers;
+	std::deque<std::function<void()>> mTasks;
+	std::mutex mMutex;
+	std::condition_variable mWake;
+	std::condition_variable mIdle;
+	Job* mOpenJobs[MaxOpenJobs] = {};
+	uint32 mOpenJobCount = 0;
+	uint32 mActiveTasks = 0;
+	bool mStopping = false;
+};
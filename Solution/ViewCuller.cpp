@@ -0,0 +1,140 @@
+//***************************************************************************************
+// ViewCuller.cpp
+//***************************************************************************************
+
+#include "ViewCuller.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace DirectX;
+
+ViewCuller::uint32 ViewCuller::AddView(const XMFLOAT4* planes)
+{
+	uint32 viewCount = GetViewCount();
+	for(uint32 v = 0; v < viewCount; ++v)
+	{
+		bool same = true;
+		for(uint32 i = 0; i < 6 && same; ++i)
+		{
+			const XMFLOAT4& a = mPlanes[v * 6 + i];
+			same = a.x == planes[i].x && a.y == planes[i].y && a.z == planes[i].z && a.w == planes[i].w;
+		}
+
+		if(same)
+			return v;
+	}
+
+	assert(viewCount < MaxViews);
+
+	mPlanes.insert(mPlanes.end(), planes, planes + 6);
+
+	const int order[8] = { 0, 1, 2, 3, 4, 5, 4, 5 };
+	for(int group = 0; group < 2; ++group)
+	{
+		const XMFLOAT4* p[4];
+		for(int i = 0; i < 4; ++i)
+			p[i] = &planes[order[group * 4 + i]];
+
+		mPlaneSets.emplace_back(p[0]->x, p[1]->x, p[2]->x, p[3]->x);
+		mPlaneSets.emplace_back(p[0]->y, p[1]->y, p[2]->y, p[3]->y);
+		mPlaneSets.emplace_back(p[0]->z, p[1]->z, p[2]->z, p[3]->z);
+		mPlaneSets.emplace_back(p[0]->w, p[1]->w, p[2]->w, p[3]->w);
+	}
+
+	// The lists are only ever grown, so they keep their capacity from frame to frame.
+	if(mVisible.size() <= viewCount)
+		mVisible.resize(viewCount + 1);
+
+	return viewCount;
+}
+
+void ViewCuller::ClearViews()
+{
+	mPlanes.clear();
+	mPlaneSets.clear();
+}
+
+void ViewCuller::Cull(const XMFLOAT4* spheres, uint32 objectCount, ThreadPool* pool)
+{
+	uint32 viewCount = GetViewCount();
+	mMasks.resize(objectCount);
+
+	const uint32 kObjectBatch = 4096;
+	if(pool != nullptr)
+		pool->ParallelFor(objectCount, kObjectBatch, [&](uint32 begin, uint32 end) { CullRange(spheres, begin, end); });
+	else
+		CullRange(spheres, 0, objectCount);
+
+	// One view per task; each scans the masks for its own bit.
+	auto buildLists = [&](uint32 begin, uint32 end)
+	{
+		for(uint32 v = begin; v < end; ++v)
+		{
+			std::vector<uint32>& visible = mVisible[v];
+			visible.clear();
+
+			uint32 bit = 1u << v;
+			for(uint32 i = 0; i < objectCount; ++i)
+			{
+				if(mMasks[i] & bit)
+					visible.push_back(i);
+			}
+		}
+	};
+
+	if(pool != nullptr && objectCount >= kObjectBatch)
+		pool->ParallelFor(viewCount, 1, buildLists);
+	else
+		buildLists(0, viewCount);
+}
+
+void ViewCuller::CullRange(const XMFLOAT4* spheres, uint32 begin, uint32 end)
+{
+	uint32 viewCount = GetViewCount();
+	const XMFLOAT4A* planeSets = mPlaneSets.data();
+
+	for(uint32 i = begin; i < end; ++i)
+	{
+		XMVECTOR sphere = XMLoadFloat4(&spheres[i]);
+		XMVECTOR cx = XMVectorSplatX(sphere);
+		XMVECTOR cy = XMVectorSplatY(sphere);
+		XMVECTOR cz = XMVectorSplatZ(sphere);
+		XMVECTOR negRadius = XMVectorNegate(XMVectorSplatW(sphere));
+
+		uint32 mask = 0;
+		for(uint32 v = 0; v < viewCount; ++v)
+		{
+			const XMFLOAT4A* p = &planeSets[v * 8];
+
+			// Signed distance from the center to four planes at a time.
+			XMVECTOR d0 = XMVectorMultiplyAdd(cz, XMLoadFloat4A(&p[2]),
+				XMVectorMultiplyAdd(cy, XMLoadFloat4A(&p[1]),
+				XMVectorMultiplyAdd(cx, XMLoadFloat4A(&p[0]), XMLoadFloat4A(&p[3]))));
+			XMVECTOR d1 = XMVectorMultiplyAdd(cz, XMLoadFloat4A(&p[6]),
+				XMVectorMultiplyAdd(cy, XMLoadFloat4A(&p[5]),
+				XMVectorMultiplyAdd(cx, XMLoadFloat4A(&p[4]), XMLoadFloat4A(&p[7]))));
+
+			// Outside if the sphere is entirely behind any plane.
+			XMVECTOR outside = XMVectorOrInt(XMVectorLess(d0, negRadius), XMVectorLess(d1, negRadius));
+			if(XMVector4EqualInt(outside, XMVectorFalseInt()))
+				mask |= 1u << v;
+		}
+
+		mMasks[i] = mask;
+	}
+}
+
+XMFLOAT4 XM_CALLCONV TransformBoundingSphere(const XMFLOAT4& sphere, FXMMATRIX world)
+{
+	XMVECTOR center = XMVector3Transform(XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&sphere)), world);
+
+	XMVECTOR scaleSq = XMVectorMax(XMVector3LengthSq(world.r[0]),
+		XMVectorMax(XMVector3LengthSq(world.r[1]), XMVector3LengthSq(world.r[2])));
+	float radius = sphere.w * XMVectorGetX(XMVectorSqrt(scaleSq));
+
+	XMFLOAT4 result;
+	XMStoreFloat4(&result, XMVectorSetW(center, radius));
+	return result;
+}
@@ -0,0 +1,81 @@
+//***************************************************************************************
+// ViewCuller.h
+//
+// Frustum culling for several views at once.  Every render pass registers the frustum
+// it draws with; passes that use the same frustum get the same view and share its
+// results.  Cull() reads each object's bounding sphere once and tests it against all
+// views, producing a visibility bitmask per object and a visible list per view.
+// Objects are split across the thread pool, then the per-view lists are built in
+// parallel.
+//
+// Only identical frusta (all six planes bit-for-bit equal, as when one camera feeds a
+// depth prepass and a color pass) share a view.  Frusta that merely overlap, such as
+// split-screen panes or shadow cascades, are separate views and each is tested in full;
+// what they share is the single pass over the objects.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <DirectXMath.h>
+#include <vector>
+
+class ThreadPool;
+
+class ViewCuller
+{
+public:
+
+	using uint32 = std::uint32_t;
+
+	// One bit per view in the visibility masks.
+	static const uint32 MaxViews = 32;
+
+	///<summary>
+	/// Registers a frustum given as six inward-facing, normalized planes (such as
+	/// OrbitCamera::GetFrustumPlanes) and returns its view index.  A frustum exactly
+	/// equal to one that is already registered returns the existing index.
+	///</summary>
+	uint32 AddView(const DirectX::XMFLOAT4* planes);
+
+	///<summary>
+	/// Forgets every view.  Call before registering the views of a new frame.
+	///</summary>
+	void ClearViews();
+
+	uint32 GetViewCount()const { return (uint32)mPlanes.size() / 6; }
+
+	///<summary>
+	/// Tests world-space bounding spheres (center xyz, radius w) against every view.
+	///</summary>
+	void Cull(const DirectX::XMFLOAT4* spheres, uint32 objectCount, ThreadPool* pool = nullptr);
+
+	bool IsVisible(uint32 object, uint32 view)const { return (mMasks[object] >> view) & 1; }
+	uint32 GetMask(uint32 object)const { return mMasks[object]; }
+
+	///<summary>
+	/// Indices of the objects that passed view's frustum in the last Cull(), ascending.
+	///</summary>
+	const std::vector<uint32>& GetVisible(uint32 view)const { return mVisible[view]; }
+
+private:
+	void CullRange(const DirectX::XMFLOAT4* spheres, uint32 begin, uint32 end);
+
+private:
+
+	// The planes as registered, six per view, for matching shared frusta.
+	std::vector<DirectX::XMFLOAT4> mPlanes;
+
+	// The same planes transposed to SIMD-friendly form, eight vectors per view: the
+	// x, y, z and d components of planes 0-3, then of planes 4, 5, 4, 5.
+	std::vector<DirectX::XMFLOAT4A> mPlaneSets;
+
+	std::vector<uint32> mMasks;
+	std::vector<std::vector<uint32>> mVisible;
+};
+
+///<summary>
+/// Transforms a local bounding sphere by world.  The radius is scaled by the largest
+/// axis scale, so the result stays conservative under non-uniform scaling.
+///</summary>
+DirectX::XMFLOAT4 XM_CALLCONV TransformBoundingSphere(const DirectX::XMFLOAT4& sphere, DirectX::FXMMATRIX world);
@@ -7,6 +7,7 @@
  *
  *   Controls:
  *   Hold down '1' key to view scene in wireframe mode.
+ *   Hold down '2' key to split the screen with an overhead view.
  *   Hold the left mouse button down and move the mouse to rotate.
  *   Hold the right mouse button down and move the mouse to zoom in and out.
  *
@@ -17,8 +18,19 @@
 #include "../../Common/d3dApp.h"
 #include "../../Common/MathHelper.h"
 #include "../../Common/UploadBuffer.h"
-#include "../../Common/GeometryGenerator.h"
+#include "AllocationTracker.h"
+#include "CopyLedger.h"
+#include "D3D12CopyQueue.h"
 #include "FrameResource.h"
+#include "GeometryStreamer.h"
+#include "NameRegistry.h"
+#include "OrbitCamera.h"
+#include "Profiler.h"
+#include "SceneGraph.h"
+#include "ScenePacker.h"
+#include "StagingUploader.h"
+#include "ThreadPool.h"
+#include "ViewCuller.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -26,6 +38,9 @@ using namespace DirectX::PackedVector;
 
 const int gNumFrameResources = 3;
 
+// Number of PassConstants slots in each frame resource.
+const int gMaxPassCount = 4;
+
 // Lightweight structure stores parameters to draw a shape.  This will
 // vary from app-to-app.
 struct RenderItem
@@ -37,6 +52,10 @@ struct RenderItem
 	// and scale of the object in the world.
 	XMFLOAT4X4 World = MathHelper::Identity4x4();
 
+	// Scene graph node that owns the world matrix.  World is refreshed from the node
+	// whenever the node (or one of its parents) moves.
+	SceneGraph::NodeHandle Node = SceneGraph::InvalidNode;
+
 	// Dirty flag indicating the object data has changed and we need to update the constant buffer.
 	// Because we have an object cbuffer for each FrameResource, we have to apply the
 	// update to each FrameResource.  Thus, when we modify obect data we should set 
@@ -46,8 +65,21 @@ struct RenderItem
 	// Index into GPU constant buffer corresponding to the ObjectCB for this render item.
 	UINT ObjCBIndex = -1;
 
+	// Bounding box of the mesh in local space, used for culling.
+	BoundingBox Bounds;
+
+	// Index into the frame resource's animated transform buffer, or -1 if the item is
+	// drawn with the world matrix in its ObjectCB.  Animated items are re-packed every
+	// frame and don't use NumFramesDirty.
+	UINT AnimatedIndex = -1;
+
 	MeshGeometry* Geo = nullptr;
 
+	// Streamed mesh the item draws.  The item is skipped until the mesh is resident,
+	// which OnShapeResident records in Drawable.
+	GeometryStreamer::Handle GeometryRequest = GeometryStreamer::InvalidHandle;
+	bool Drawable = true;
+
 	// Primitive topology.
 	D3D12_PRIMITIVE_TOPOLOGY PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 
@@ -57,6 +89,23 @@ struct RenderItem
 	int BaseVertexLocation = 0;
 };
 
+// A render pass draws the scene from one camera into one viewport.  Each pass has its
+// own PassConstants slot, and passes whose frusta match share one culling view.
+struct RenderPass
+{
+	OrbitCamera Camera;
+	D3D12_VIEWPORT Viewport;
+	D3D12_RECT ScissorRect;
+
+	PassConstants Constants;
+
+	// Camera version the matrices in Constants were built from.
+	OrbitCamera::uint32 ConstantsVersion = 0;
+
+	// View index in the ViewCuller for this frame.
+	UINT CullView = 0;
+};
+
 class ShapesApp : public D3DApp
 {
 public:
@@ -79,13 +128,18 @@ private:
 	void OnKeyboardInput(const GameTimer& gt);
 	void UpdateCamera(const GameTimer& gt);
 	void UpdateObjectCBs(const GameTimer& gt);
-	void UpdateMainPassCB(const GameTimer& gt);
+	void UpdatePassCBs(const GameTimer& gt);
+	void UpdateAnimatedTransforms(const GameTimer& gt);
+	void UpdateVisibility();
+	void LayoutPasses();
 
 	void BuildDescriptorHeaps();
 	void BuildConstantBufferViews();
 	void BuildRootSignature();
 	void BuildShadersAndInputLayout();
 	void BuildShapeGeometry();
+	void OnShapeResident(UINT entry, const char* name);
+	ComPtr<ID3D12Resource> CreateGpuBuffer(UINT64 byteSize);
 	void BuildPSOs();
 	void BuildFrameResources();
 	void BuildRenderItems();
@@ -102,28 +156,70 @@ private:
 
 	ComPtr<ID3D12DescriptorHeap> mSrvDescriptorHeap = nullptr;
 
-	std::unordered_map<std::string, std::unique_ptr<MeshGeometry>> mGeometries;
-	std::unordered_map<std::string, ComPtr<ID3DBlob>> mShaders;
-	std::unordered_map<std::string, ComPtr<ID3D12PipelineState>> mPSOs;
+	NamedTable<std::unique_ptr<MeshGeometry>> mGeometries;
+
+	// Whether MeshGeometry keeps VertexBufferCPU/IndexBufferCPU.  Nothing reads them
+	// here, so by default they are not kept.
+	bool mRetainCpuGeometry = false;
+	CopyLedger mGeometryCopies;
+
+	// Geometry uploads go through one persistently mapped staging ring on the copy
+	// queue; staging space is reused as the copy fence completes.
+	static constexpr UINT64 StagingByteSize = 4 * 1024 * 1024;
+	std::unique_ptr<D3D12CopyQueue> mCopyQueue;
+	std::unique_ptr<StagingUploader> mUploader;
+
+	// The shapes are generated on the thread pool after Initialize returns and drawn
+	// as they become resident.  The packer holds their layout in shapeGeo.
+	using ShapePacker = ScenePacker<ShapeWriter::PositionColorWriter<Vertex>, std::uint16_t>;
+	static constexpr UINT64 UploadBytesPerFrame = 1024 * 1024;
+	ShapePacker mShapePacker;
+	std::unique_ptr<GeometryStreamer> mGeometryStreamer;
+	NamedTable<GeometryStreamer::Handle> mShapeRequests;
+
+	NamedTable<ComPtr<ID3DBlob>> mShaders;
+	NamedTable<ComPtr<ID3D12PipelineState>> mPSOs;
+
+	// PSO handles resolved once in BuildPSOs, so Draw indexes mPSOs instead of
+	// hashing names every frame.
+	NameRegistry::Handle mOpaquePSO = NameRegistry::InvalidHandle;
+	NameRegistry::Handle mOpaqueWireframePSO = NameRegistry::InvalidHandle;
+	NameRegistry::Handle mAnimatedPSO = NameRegistry::InvalidHandle;
+	NameRegistry::Handle mAnimatedWireframePSO = NameRegistry::InvalidHandle;
 
 	std::vector<D3D12_INPUT_ELEMENT_DESC> mInputLayout;
 
 	// List of all the render items.
 	std::vector<std::unique_ptr<RenderItem>> mAllRitems;
 
-	// Render items divided by PSO.
-	std::vector<RenderItem*> mOpaqueRitems;
+	// The animated render items, indexed by AnimatedIndex.  What is drawn each pass
+	// comes from the culler's visible list, split by PSO in Draw.
+	std::vector<RenderItem*> mAnimatedRitems;
+
+	// Per-frame state of the animated render items, indexed by AnimatedIndex.
+	std::vector<XMFLOAT3> mAnimatedPositions;
+	std::vector<float> mAnimatedScales;
+	std::vector<XMFLOAT4> mAnimatedRotations;
+
+	// Transform hierarchy of the render items.
+	SceneGraph mSceneGraph;
+	ThreadPool mThreadPool;
 
-	PassConstants mMainPassCB;
+	// Pass 0 is the main view; split-screen adds an overhead view as pass 1.
+	RenderPass mPasses[gMaxPassCount];
+	UINT mPassCount = 1;
+	bool mSplitScreen = false;
+
+	// World-space bounding spheres indexed by ObjCBIndex, and the per-view results.
+	std::vector<XMFLOAT4> mObjectBounds;
+	ViewCuller mCuller;
+	std::vector<RenderItem*> mVisibleRitems;
+	std::vector<RenderItem*> mVisibleAnimatedRitems;
 
 	UINT mPassCbvOffset = 0;
 
 	bool mIsWireframe = false;
 
-	XMFLOAT3 mEyePos = { 0.0f, 0.0f, 0.0f };
-	XMFLOAT4X4 mView = MathHelper::Identity4x4();
-	XMFLOAT4X4 mProj = MathHelper::Identity4x4();
-
 	float mTheta = 1.5f * XM_PI;
 	float mPhi = 0.2f * XM_PI;
 	float mRadius = 15.0f;
@@ -163,10 +259,32 @@ ShapesApp::~ShapesApp()
 {
 	if (md3dDevice != nullptr)
 		FlushCommandQueue();
+
+	// Let the workers finish with the slots before the pool and the uploader go.
+	mGeometryStreamer.reset();
+
+#if PROFILER_ENABLED
+	// Open in chrome://tracing or ui.perfetto.dev.
+	Profiler::WriteChromeTrace("ShapeComplete_trace.json");
+
+	// Bytes written and copied on the way from the generators to the GPU.
+	mGeometryCopies.WriteReport("ShapeComplete_copies.txt");
+
+	// Upload bytes per frame and the staging ring's peak use.
+	if (mUploader != nullptr)
+		mUploader->WriteReport("ShapeComplete_uploads.txt");
+#endif
+
+#if ALLOCATION_TRACKING_ENABLED
+	// Per-frame scopes should read zero once the app is past its first frames.
+	AllocationTracker::WriteReport("ShapeComplete_allocations.txt");
+#endif
 }
 
 bool ShapesApp::Initialize()
 {
+	Profiler::SetThreadName("Main");
+
 	if (!D3DApp::Initialize())
 		return false;
 
@@ -175,6 +293,10 @@ bool ShapesApp::Initialize()
 
 	BuildRootSignature();
 	BuildShadersAndInputLayout();
+
+	mCopyQueue = std::make_unique<D3D12CopyQueue>(md3dDevice.Get(), StagingByteSize);
+	mUploader = std::make_unique<StagingUploader>(*mCopyQueue, mCopyQueue->GetStagingMemory(), StagingByteSize);
+
 	BuildShapeGeometry();
 	BuildRenderItems();
 	BuildFrameResources();
@@ -197,16 +319,22 @@ void ShapesApp::OnResize()
 {
 	D3DApp::OnResize();
 
-	// The window resized, so update the aspect ratio and recompute the projection matrix.
-	XMMATRIX P = XMMatrixPerspectiveFovLH(0.25f * MathHelper::Pi, AspectRatio(), 1.0f, 1000.0f);
-	XMStoreFloat4x4(&mProj, P);
+	// The window resized, so update the viewports and the aspect ratios of the cameras.
+	LayoutPasses();
 }
 
 void ShapesApp::Update(const GameTimer& gt)
 {
+	PROFILE_SCOPE("ShapesApp::Update");
+	ALLOCATION_SCOPE("ShapesApp::Update");
+
 	OnKeyboardInput(gt);
 	UpdateCamera(gt);
 
+	// Propagate moved nodes down the hierarchy.  This only touches CPU data, so it
+	// runs before we wait on the GPU.
+	mSceneGraph.Update(&mThreadPool);
+
 	// Cycle through the circular frame resource array.
 	mCurrFrameResourceIndex = (mCurrFrameResourceIndex + 1) % gNumFrameResources;
 	mCurrFrameResource = mFrameResources[mCurrFrameResourceIndex].get();
@@ -222,11 +350,23 @@ void ShapesApp::Update(const GameTimer& gt)
 	}
 
 	UpdateObjectCBs(gt);
-	UpdateMainPassCB(gt);
+	UpdatePassCBs(gt);
+	UpdateAnimatedTransforms(gt);
+
+	// Upload the shapes the workers have finished and show the ones now resident.
+	mGeometryStreamer->Pump(UploadBytesPerFrame);
+
+	// Release the staging space of finished uploads and count this frame's bytes.
+	mUploader->EndFrame();
+
+	UpdateVisibility();
 }
 
 void ShapesApp::Draw(const GameTimer& gt)
 {
+	PROFILE_SCOPE("ShapesApp::Draw");
+	ALLOCATION_SCOPE("ShapesApp::Draw");
+
 	auto cmdListAlloc = mCurrFrameResource->CmdListAlloc;
 
 	// Reuse the memory associated with command recording.
@@ -237,16 +377,13 @@ void ShapesApp::Draw(const GameTimer& gt)
 	// Reusing the command list reuses memory.
 	if (mIsWireframe)
 	{
-		ThrowIfFailed(mCommandList->Reset(cmdListAlloc.Get(), mPSOs["opaque_wireframe"].Get()));
+		ThrowIfFailed(mCommandList->Reset(cmdListAlloc.Get(), mPSOs[mOpaqueWireframePSO].Get()));
 	}
 	else
 	{
-		ThrowIfFailed(mCommandList->Reset(cmdListAlloc.Get(), mPSOs["opaque"].Get()));
+		ThrowIfFailed(mCommandList->Reset(cmdListAlloc.Get(), mPSOs[mOpaquePSO].Get()));
 	}
 
-	mCommandList->RSSetViewports(1, &mScreenViewport);
-	mCommandList->RSSetScissorRects(1, &mScissorRect);
-
 	// Indicate a state transition on the resource usage.
 	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
 		D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
@@ -263,12 +400,45 @@ void ShapesApp::Draw(const GameTimer& gt)
 
 	mCommandList->SetGraphicsRootSignature(mRootSignature.Get());
 
-	int passCbvIndex = mPassCbvOffset + mCurrFrameResourceIndex;
-	auto passCbvHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(mCbvHeap->GetGPUDescriptorHandleForHeapStart());
-	passCbvHandle.Offset(passCbvIndex, mCbvSrvUavDescriptorSize);
-	mCommandList->SetGraphicsRootDescriptorTable(1, passCbvHandle);
+	for (UINT passIndex = 0; passIndex < mPassCount; ++passIndex)
+	{
+		const RenderPass& pass = mPasses[passIndex];
 
-	DrawRenderItems(mCommandList.Get(), mOpaqueRitems);
+		mCommandList->RSSetViewports(1, &pass.Viewport);
+		mCommandList->RSSetScissorRects(1, &pass.ScissorRect);
+
+		int passCbvIndex = mPassCbvOffset + mCurrFrameResourceIndex * gMaxPassCount + passIndex;
+		auto passCbvHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(mCbvHeap->GetGPUDescriptorHandleForHeapStart());
+		passCbvHandle.Offset(passCbvIndex, mCbvSrvUavDescriptorSize);
+		mCommandList->SetGraphicsRootDescriptorTable(1, passCbvHandle);
+
+		// Only draw what this pass's view can see: the view's visible list, split by PSO.
+		// mAllRitems is in ObjCBIndex order.
+		mVisibleRitems.clear();
+		mVisibleAnimatedRitems.clear();
+		for (UINT objCBIndex : mCuller.GetVisible(pass.CullView))
+		{
+			RenderItem* ri = mAllRitems[objCBIndex].get();
+			if (!ri->Drawable)
+				continue;
+
+			if (ri->AnimatedIndex != -1)
+				mVisibleAnimatedRitems.push_back(ri);
+			else
+				mVisibleRitems.push_back(ri);
+		}
+
+		mCommandList->SetPipelineState(mIsWireframe ? mPSOs[mOpaqueWireframePSO].Get() : mPSOs[mOpaquePSO].Get());
+		DrawRenderItems(mCommandList.Get(), mVisibleRitems);
+
+		if (!mVisibleAnimatedRitems.empty())
+		{
+			mCommandList->SetPipelineState(mIsWireframe ? mPSOs[mAnimatedWireframePSO].Get() : mPSOs[mAnimatedPSO].Get());
+			mCommandList->SetGraphicsRootShaderResourceView(3, mCurrFrameResource->AnimatedTransforms->Resource()->GetGPUVirtualAddress());
+
+			DrawRenderItems(mCommandList.Get(), mVisibleAnimatedRitems);
+		}
+	}
 
 	// Indicate a state transition on the resource usage.
 	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
@@ -345,29 +515,58 @@ void ShapesApp::OnKeyboardInput(const GameTimer& gt)
 		mIsWireframe = true;
 	else
 		mIsWireframe = false;
+
+	bool splitScreen = (GetAsyncKeyState('2') & 0x8000) != 0;
+	if (splitScreen != mSplitScreen)
+	{
+		mSplitScreen = splitScreen;
+		LayoutPasses();
+	}
+}
+
+void ShapesApp::LayoutPasses()
+{
+	mPassCount = mSplitScreen ? 2 : 1;
+
+	float width = (float)mClientWidth / mPassCount;
+	for (UINT i = 0; i < mPassCount; ++i)
+	{
+		RenderPass& pass = mPasses[i];
+		pass.Viewport = { i * width, 0.0f, width, (float)mClientHeight, 0.0f, 1.0f };
+		pass.ScissorRect = { (LONG)(i * width), 0, (LONG)((i + 1) * width), mClientHeight };
+		pass.Camera.SetLens(0.25f * MathHelper::Pi, width / mClientHeight, 1.0f, 1000.0f);
+	}
 }
 
 void ShapesApp::UpdateCamera(const GameTimer& gt)
 {
-	// Convert Spherical to Cartesian coordinates.
-	mEyePos.x = mRadius * sinf(mPhi) * cosf(mTheta);
-	mEyePos.z = mRadius * sinf(mPhi) * sinf(mTheta);
-	mEyePos.y = mRadius * cosf(mPhi);
-
-	// Build the view matrix.
-	XMVECTOR pos = XMVectorSet(mEyePos.x, mEyePos.y, mEyePos.z, 1.0f);
-	XMVECTOR target = XMVectorZero();
-	XMVECTOR up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
-
-	XMMATRIX view = XMMatrixLookAtLH(pos, target, up);
-	XMStoreFloat4x4(&mView, view);
+	// The cameras only rebuild their matrices if the orbit or the lens changed.
+	mPasses[0].Camera.SetOrbit(mTheta, mPhi, mRadius);
+
+	// The overhead view looks almost straight down and turns with the main camera.
+	mPasses[1].Camera.SetOrbit(mTheta, 0.1f, 120.0f);
+
+	for (UINT i = 0; i < mPassCount; ++i)
+		mPasses[i].Camera.Update();
 }
 
 void ShapesApp::UpdateObjectCBs(const GameTimer& gt)
 {
+	PROFILE_SCOPE("ShapesApp::UpdateObjectCBs");
+
 	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
 	for (auto& e : mAllRitems)
 	{
+		if (e->Node != SceneGraph::InvalidNode && mSceneGraph.WorldChanged(e->Node))
+		{
+			e->World = mSceneGraph.GetWorld(e->Node);
+			e->NumFramesDirty = gNumFrameResources;
+
+			XMFLOAT4 localSphere(e->Bounds.Center.x, e->Bounds.Center.y, e->Bounds.Center.z,
+				XMVectorGetX(XMVector3Length(XMLoadFloat3(&e->Bounds.Extents))));
+			mObjectBounds[e->ObjCBIndex] = TransformBoundingSphere(localSphere, XMLoadFloat4x4(&e->World));
+		}
+
 		// Only update the cbuffer data if the constants have changed.  
 		// This needs to be tracked per frame resource.
 		if (e->NumFramesDirty > 0)
@@ -385,43 +584,99 @@ void ShapesApp::UpdateObjectCBs(const GameTimer& gt)
 	}
 }
 
-void ShapesApp::UpdateMainPassCB(const GameTimer& gt)
+void ShapesApp::UpdatePassCBs(const GameTimer& gt)
 {
-	XMMATRIX view = XMLoadFloat4x4(&mView);
-	XMMATRIX proj = XMLoadFloat4x4(&mProj);
-
-	XMMATRIX viewProj = XMMatrixMultiply(view, proj);
-	XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
-	XMMATRIX invProj = XMMatrixInverse(&XMMatrixDeterminant(proj), proj);
-	XMMATRIX invViewProj = XMMatrixInverse(&XMMatrixDeterminant(viewProj), viewProj);
-
-	XMStoreFloat4x4(&mMainPassCB.View, XMMatrixTranspose(view));
-	XMStoreFloat4x4(&mMainPassCB.InvView, XMMatrixTranspose(invView));
-	XMStoreFloat4x4(&mMainPassCB.Proj, XMMatrixTranspose(proj));
-	XMStoreFloat4x4(&mMainPassCB.InvProj, XMMatrixTranspose(invProj));
-	XMStoreFloat4x4(&mMainPassCB.ViewProj, XMMatrixTranspose(viewProj));
-	XMStoreFloat4x4(&mMainPassCB.InvViewProj, XMMatrixTranspose(invViewProj));
-	mMainPassCB.EyePosW = mEyePos;
-	mMainPassCB.RenderTargetSize = XMFLOAT2((float)mClientWidth, (float)mClientHeight);
-	mMainPassCB.InvRenderTargetSize = XMFLOAT2(1.0f / mClientWidth, 1.0f / mClientHeight);
-	mMainPassCB.NearZ = 1.0f;
-	mMainPassCB.FarZ = 1000.0f;
-	mMainPassCB.TotalTime = gt.TotalTime();
-	mMainPassCB.DeltaTime = gt.DeltaTime();
+	PROFILE_SCOPE("ShapesApp::UpdatePassCBs");
 
 	auto currPassCB = mCurrFrameResource->PassCB.get();
-	currPassCB->CopyData(0, mMainPassCB);
+	for (UINT i = 0; i < mPassCount; ++i)
+	{
+		RenderPass& pass = mPasses[i];
+		const OrbitCamera& camera = pass.Camera;
+		PassConstants& passCB = pass.Constants;
+
+		// The matrices only change with the camera, which already has the inverses.
+		if (pass.ConstantsVersion != camera.GetVersion())
+		{
+			XMStoreFloat4x4(&passCB.View, XMMatrixTranspose(XMLoadFloat4x4(&camera.GetView())));
+			XMStoreFloat4x4(&passCB.InvView, XMMatrixTranspose(XMLoadFloat4x4(&camera.GetInvView())));
+			XMStoreFloat4x4(&passCB.Proj, XMMatrixTranspose(XMLoadFloat4x4(&camera.GetProj())));
+			XMStoreFloat4x4(&passCB.InvProj, XMMatrixTranspose(XMLoadFloat4x4(&camera.GetInvProj())));
+			XMStoreFloat4x4(&passCB.ViewProj, XMMatrixTranspose(XMLoadFloat4x4(&camera.GetViewProj())));
+			XMStoreFloat4x4(&passCB.InvViewProj, XMMatrixTranspose(XMLoadFloat4x4(&camera.GetInvViewProj())));
+			passCB.EyePosW = camera.GetPosition();
+			passCB.NearZ = camera.GetNearZ();
+			passCB.FarZ = camera.GetFarZ();
+
+			pass.ConstantsVersion = camera.GetVersion();
+		}
+
+		passCB.RenderTargetSize = XMFLOAT2(pass.Viewport.Width, pass.Viewport.Height);
+		passCB.InvRenderTargetSize = XMFLOAT2(1.0f / pass.Viewport.Width, 1.0f / pass.Viewport.Height);
+		passCB.TotalTime = gt.TotalTime();
+		passCB.DeltaTime = gt.DeltaTime();
+
+		currPassCB->CopyData(i, passCB);
+	}
+}
+
+void ShapesApp::UpdateAnimatedTransforms(const GameTimer& gt)
+{
+	PROFILE_SCOPE("ShapesApp::UpdateAnimatedTransforms");
+
+	if (mAnimatedRitems.empty())
+		return;
+
+	// The diamonds spin and bob above their towers.
+	float t = gt.TotalTime();
+	for (auto& e : mAnimatedRitems)
+	{
+		UINT i = e->AnimatedIndex;
+		const XMFLOAT4X4& rest = mSceneGraph.GetWorld(e->Node);
+		float phase = 1.5f * i;
+
+		mAnimatedPositions[i] = XMFLOAT3(rest._41, rest._42 + 1.5f * sinf(2.0f * t + phase), rest._43);
+		XMStoreFloat4(&mAnimatedRotations[i], XMQuaternionRotationRollPitchYaw(0.0f, 1.5f * t + phase, 0.0f));
+	}
+
+	// Every animated object is rewritten each frame, 32 bytes apiece.
+	PackAnimatedTransforms(mAnimatedPositions.data(), mAnimatedScales.data(), mAnimatedRotations.data(),
+		(UINT)mAnimatedRitems.size(), mCurrFrameResource->MappedAnimatedTransforms);
+
+	// Culling bounds come from the CPU copies; the mapped upload heap is write-combined.
+	for (auto& e : mAnimatedRitems)
+	{
+		UINT i = e->AnimatedIndex;
+		XMFLOAT4 localSphere(e->Bounds.Center.x, e->Bounds.Center.y, e->Bounds.Center.z,
+			XMVectorGetX(XMVector3Length(XMLoadFloat3(&e->Bounds.Extents))));
+		XMMATRIX world = XMMatrixAffineTransformation(XMVectorReplicate(mAnimatedScales[i]), XMVectorZero(),
+			XMLoadFloat4(&mAnimatedRotations[i]), XMLoadFloat3(&mAnimatedPositions[i]));
+		mObjectBounds[e->ObjCBIndex] = TransformBoundingSphere(localSphere, world);
+	}
+}
+
+void ShapesApp::UpdateVisibility()
+{
+	PROFILE_SCOPE("ShapesApp::UpdateVisibility");
+
+	// Every pass registers its frustum; passes that see the same frustum share a view,
+	// and all views are culled together on the thread pool.
+	mCuller.ClearViews();
+	for (UINT i = 0; i < mPassCount; ++i)
+		mPasses[i].CullView = mCuller.AddView(mPasses[i].Camera.GetFrustumPlanes());
+
+	mCuller.Cull(mObjectBounds.data(), (UINT)mObjectBounds.size(), &mThreadPool);
 }
 
 void ShapesApp::BuildDescriptorHeaps()
 {
-	UINT objCount = (UINT)mOpaqueRitems.size();
+	UINT objCount = (UINT)mAllRitems.size();
 
 	// Need a CBV descriptor for each object for each frame resource,
-	// +1 for the perPass CBV for each frame resource.
-	UINT numDescriptors = (objCount + 1) * gNumFrameResources;
+	// +gMaxPassCount for the perPass CBVs for each frame resource.
+	UINT numDescriptors = (objCount + gMaxPassCount) * gNumFrameResources;
 
-	// Save an offset to the start of the pass CBVs.  These are the last 3 descriptors.
+	// Save an offset to the start of the pass CBVs.  These are the last descriptors.
 	mPassCbvOffset = objCount * gNumFrameResources;
 
 	D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc;
@@ -437,7 +692,7 @@ void ShapesApp::BuildConstantBufferViews()
 {
 	UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
 
-	UINT objCount = (UINT)mOpaqueRitems.size();
+	UINT objCount = (UINT)mAllRitems.size();
 
 	// Need a CBV descriptor for each object for each frame resource.
 	for (int frameIndex = 0; frameIndex < gNumFrameResources; ++frameIndex)
@@ -465,22 +720,28 @@ void ShapesApp::BuildConstantBufferViews()
 
 	UINT passCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(PassConstants));
 
-	// Last three descriptors are the pass CBVs for each frame resource.
+	// Last descriptors are the pass CBVs for each frame resource.
 	for (int frameIndex = 0; frameIndex < gNumFrameResources; ++frameIndex)
 	{
 		auto passCB = mFrameResources[frameIndex]->PassCB->Resource();
-		D3D12_GPU_VIRTUAL_ADDRESS cbAddress = passCB->GetGPUVirtualAddress();
+		for (int passIndex = 0; passIndex < gMaxPassCount; ++passIndex)
+		{
+			D3D12_GPU_VIRTUAL_ADDRESS cbAddress = passCB->GetGPUVirtualAddress();
 
-		// Offset to the pass cbv in the descriptor heap.
-		int heapIndex = mPassCbvOffset + frameIndex;
-		auto handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(mCbvHeap->GetCPUDescriptorHandleForHeapStart());
-		handle.Offset(heapIndex, mCbvSrvUavDescriptorSize);
+			// Offset to the pass constant buffer in the buffer.
+			cbAddress += passIndex * passCBByteSize;
 
-		D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc;
-		cbvDesc.BufferLocation = cbAddress;
-		cbvDesc.SizeInBytes = passCBByteSize;
+			// Offset to the pass cbv in the descriptor heap.
+			int heapIndex = mPassCbvOffset + frameIndex * gMaxPassCount + passIndex;
+			auto handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(mCbvHeap->GetCPUDescriptorHandleForHeapStart());
+			handle.Offset(heapIndex, mCbvSrvUavDescriptorSize);
 
-		md3dDevice->CreateConstantBufferView(&cbvDesc, handle);
+			D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc;
+			cbvDesc.BufferLocation = cbAddress;
+			cbvDesc.SizeInBytes = passCBByteSize;
+
+			md3dDevice->CreateConstantBufferView(&cbvDesc, handle);
+		}
 	}
 }
 
@@ -493,14 +754,18 @@ void ShapesApp::BuildRootSignature()
 	cbvTable1.Init(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 1);
 
 	// Root parameter can be a table, root descriptor or root constants.
-	CD3DX12_ROOT_PARAMETER slotRootParameter[2];
+	CD3DX12_ROOT_PARAMETER slotRootParameter[4];
 
 	// Create root CBVs.
 	slotRootParameter[0].InitAsDescriptorTable(1, &cbvTable0);
 	slotRootParameter[1].InitAsDescriptorTable(1, &cbvTable1);
 
+	// Animated objects: their index as a root constant and the transform buffer as a root SRV.
+	slotRootParameter[2].InitAsConstants(1, 2);
+	slotRootParameter[3].InitAsShaderResourceView(0);
+
 	// A root signature is an array of root parameters.
-	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(2, slotRootParameter, 0, nullptr,
+	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(4, slotRootParameter, 0, nullptr,
 		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
 	// create a root signature with a single slot which points to a descriptor range consisting of a single constant buffer
@@ -525,6 +790,7 @@ void ShapesApp::BuildRootSignature()
 void ShapesApp::BuildShadersAndInputLayout()
 {
 	mShaders["standardVS"] = d3dUtil::CompileShader(L"Shaders\\VS.hlsl", nullptr, "VS", "vs_5_1");
+	mShaders["animatedVS"] = d3dUtil::CompileShader(L"Shaders\\VS.hlsl", nullptr, "VSAnimated", "vs_5_1");
 	mShaders["opaquePS"] = d3dUtil::CompileShader(L"Shaders\\PS.hlsl", nullptr, "PS", "ps_5_1");
 
 	mInputLayout =
@@ -537,230 +803,162 @@ void ShapesApp::BuildShadersAndInputLayout()
 
 void ShapesApp::BuildShapeGeometry()
 {
-	GeometryGenerator geoGen;
-	GeometryGenerator::MeshData box = geoGen.CreateBox(1.0f, 1.0f, 1.0f, 0);
-	GeometryGenerator::MeshData grid = geoGen.CreateGrid(75.0f, 75.0f, 60, 20);
-	GeometryGenerator::MeshData sphere = geoGen.CreateSphere(0.5f, 20, 20);
-	GeometryGenerator::MeshData cylinder = geoGen.CreateCylinder(0.5f, 0.4f, 3.0f, 20, 20);
-	GeometryGenerator::MeshData cone = geoGen.CreateCone(0.5f, 0.5f, 0.5f, 1.0f, 10.0f, 10.0f);
-	GeometryGenerator::MeshData wedge = geoGen.CreateWedge(2.0f, 2.0f, 2.0f, 4.0f);
-	GeometryGenerator::MeshData pyramid = geoGen.CreatePyramid(2.0f, 2.0f, 2.0f, 4.0f);
-	GeometryGenerator::MeshData diamond = geoGen.CreateDiamond(2.0f, 2.0f, 2.0f, 4.0f);
-	GeometryGenerator::MeshData triPrism = geoGen.CreateTriPrism(2.0f, 2.0f, 2.0f, 4.0f);
-	/*GeometryGenerator::MeshData torus = geoGen.CreateTorus(0.5f, 20, 20, 20);*/
-
-	// We are concatenating all the geometry into one big vertex/index buffer.  So
-	// define the regions in the buffer each submesh covers.
-
-	// Cache the vertex offsets to each object in the concatenated vertex buffer.
-	UINT boxVertexOffset = 0;
-	UINT gridVertexOffset = (UINT)box.Vertices.size();
-	UINT sphereVertexOffset = gridVertexOffset + (UINT)grid.Vertices.size();
-	UINT cylinderVertexOffset = sphereVertexOffset + (UINT)sphere.Vertices.size();
-	UINT coneVertexOffset = cylinderVertexOffset + (UINT)cylinder.Vertices.size();
-	UINT wedgeVertexOffset = coneVertexOffset + (UINT)cone.Vertices.size();
-	UINT pyramidVertexOffset = wedgeVertexOffset + (UINT)wedge.Vertices.size();
-	UINT diamondVertexOffset = pyramidVertexOffset + (UINT)pyramid.Vertices.size();
-	UINT triPrismVertexOffset = diamondVertexOffset + (UINT)diamond.Vertices.size();
-	/*UINT torusVertexOffset = triPrismVertexOffset + (UINT)triPrism.Vertices.size();*/
-
-	// Cache the starting index for each object in the concatenated index buffer.
-	UINT boxIndexOffset = 0;
-	UINT gridIndexOffset = (UINT)box.Indices32.size();
-	UINT sphereIndexOffset = gridIndexOffset + (UINT)grid.Indices32.size();
-	UINT cylinderIndexOffset = sphereIndexOffset + (UINT)sphere.Indices32.size();
-	UINT coneIndexOffset = cylinderIndexOffset + (UINT)cylinder.Indices32.size();
-	UINT wedgeIndexOffset = coneIndexOffset + (UINT)cone.Indices32.size();
-	UINT pyramidIndexOffset = wedgeIndexOffset + (UINT)wedge.Indices32.size();
-	UINT diamondIndexOffset = pyramidIndexOffset + (UINT)pyramid.Indices32.size();
-	UINT triPrismIndexOffset = diamondIndexOffset + (UINT)diamond.Indices32.size();
-	/*UINT torusIndexOffset = triPrismIndexOffset + (UINT)triPrism.Indices32.size();*/
-
-	// Define the SubmeshGeometry that cover different
-	// regions of the vertex/index buffers.
-
-	SubmeshGeometry boxSubmesh;
-	boxSubmesh.IndexCount = (UINT)box.Indices32.size();
-	boxSubmesh.StartIndexLocation = boxIndexOffset;
-	boxSubmesh.BaseVertexLocation = boxVertexOffset;	
-
-	SubmeshGeometry gridSubmesh;
-	gridSubmesh.IndexCount = (UINT)grid.Indices32.size();
-	gridSubmesh.StartIndexLocation = gridIndexOffset;
-	gridSubmesh.BaseVertexLocation = gridVertexOffset;
-
-	SubmeshGeometry sphereSubmesh;
-	sphereSubmesh.IndexCount = (UINT)sphere.Indices32.size();
-	sphereSubmesh.StartIndexLocation = sphereIndexOffset;
-	sphereSubmesh.BaseVertexLocation = sphereVertexOffset;
-
-	SubmeshGeometry cylinderSubmesh;
-	cylinderSubmesh.IndexCount = (UINT)cylinder.Indices32.size();
-	cylinderSubmesh.StartIndexLocation = cylinderIndexOffset;
-	cylinderSubmesh.BaseVertexLocation = cylinderVertexOffset;
-
-	SubmeshGeometry coneSubmesh;
-	coneSubmesh.IndexCount = (UINT)cone.Indices32.size();
-	coneSubmesh.StartIndexLocation = coneIndexOffset;
-	coneSubmesh.BaseVertexLocation = coneVertexOffset;
-
-	SubmeshGeometry wedgeSubmesh;
-	wedgeSubmesh.IndexCount = (UINT)wedge.Indices32.size();
-	wedgeSubmesh.StartIndexLocation = wedgeIndexOffset;
-	wedgeSubmesh.BaseVertexLocation = wedgeVertexOffset;
-
-	SubmeshGeometry pyramidSubmesh;
-	pyramidSubmesh.IndexCount = (UINT)pyramid.Indices32.size();
-	pyramidSubmesh.StartIndexLocation = pyramidIndexOffset;
-	pyramidSubmesh.BaseVertexLocation = pyramidVertexOffset;
-
-	SubmeshGeometry diamondSubmesh;
-	diamondSubmesh.IndexCount = (UINT)diamond.Indices32.size();
-	diamondSubmesh.StartIndexLocation = diamondIndexOffset;
-	diamondSubmesh.BaseVertexLocation = diamondVertexOffset;
-
-	SubmeshGeometry triPrismSubmesh;
-	triPrismSubmesh.IndexCount = (UINT)triPrism.Indices32.size();
-	triPrismSubmesh.StartIndexLocation = triPrismIndexOffset;
-	triPrismSubmesh.BaseVertexLocation = triPrismVertexOffset;	
-	
-	//SubmeshGeometry torusSubmesh;
-	//torusSubmesh.IndexCount = (UINT)torus.Indices32.size();
-	//torusSubmesh.StartIndexLocation = torusIndexOffset;
-	//torusSubmesh.BaseVertexLocation = torusVertexOffset;
-
-	// Extract the vertex elements we are interested in and pack the
-	// vertices of all the meshes into one vertex buffer.
-
-	auto totalVertexCount =
-		box.Vertices.size() +
-		grid.Vertices.size() +
-		sphere.Vertices.size() +
-		cylinder.Vertices.size() +
-		cone.Vertices.size() +
-		wedge.Vertices.size() +
-		pyramid.Vertices.size() +
-		diamond.Vertices.size() +
-		triPrism.Vertices.size();
-		//torus.Vertices.size();
-
+	// We are concatenating all the geometry into one big vertex/index buffer.  The
+	// packer lays the shapes out first, so the buffer sizes are known before anything
+	// is generated.  Each shape is then generated on the thread pool and streamed into
+	// its region of the buffers, so the first frame doesn't wait for the scene.
 
-	std::vector<Vertex> vertices(totalVertexCount);
+	using ColorWriter = ShapeWriter::PositionColorWriter<Vertex>;
 
-	UINT k = 0;
-
-	for (size_t i = 0; i < box.Vertices.size(); ++i, ++k)
+	struct Shape
 	{
-		vertices[k].Pos = box.Vertices[i].Position;
-		vertices[k].Color = XMFLOAT4(DirectX::Colors::DarkSlateGray);
-	}	
+		const char* Name;
+		UINT Entry;
+	};
 
-	for (size_t i = 0; i < grid.Vertices.size(); ++i, ++k)
+	const Shape shapes[] =
 	{
-		vertices[k].Pos = grid.Vertices[i].Position;
-		vertices[k].Color = XMFLOAT4(DirectX::Colors::ForestGreen);
-	}
+		{ "box", mShapePacker.AddBox(ColorWriter{ XMFLOAT4(DirectX::Colors::DarkSlateGray) }, 1.0f, 1.0f, 1.0f, 0) },
+		{ "grid", mShapePacker.AddGrid(ColorWriter{ XMFLOAT4(DirectX::Colors::ForestGreen) }, 75.0f, 75.0f, 60, 20) },
+		{ "sphere", mShapePacker.AddSphere(ColorWriter{ XMFLOAT4(DirectX::Colors::Crimson) }, 0.5f, 20, 20) },
+		{ "cylinder", mShapePacker.AddCylinder(ColorWriter{ XMFLOAT4(DirectX::Colors::GreenYellow) }, 0.5f, 0.4f, 3.0f, 20, 20) },
+		{ "cone", mShapePacker.AddCone(ColorWriter{ XMFLOAT4(DirectX::Colors::Red) }, 0.5f, 0.5f, 0.5f, 1.0f, 10, 10) },
+		{ "wedge", mShapePacker.AddWedge(ColorWriter{ XMFLOAT4(DirectX::Colors::Yellow) }, 2.0f, 2.0f, 2.0f, 4) },
+		{ "pyramid", mShapePacker.AddPyramid(ColorWriter{ XMFLOAT4(DirectX::Colors::PeachPuff) }, 2.0f, 2.0f, 2.0f, 4) },
+		{ "diamond", mShapePacker.AddDiamond(ColorWriter{ XMFLOAT4(DirectX::Colors::Purple) }, 2.0f, 2.0f, 2.0f, 4) },
+		{ "triPrism", mShapePacker.AddTriPrism(ColorWriter{ XMFLOAT4(DirectX::Colors::Orange) }, 2.0f, 2.0f, 2.0f, 4) },
+	};
 
-	for (size_t i = 0; i < sphere.Vertices.size(); ++i, ++k)
-	{
-		vertices[k].Pos = sphere.Vertices[i].Position;
-		vertices[k].Color = XMFLOAT4(DirectX::Colors::Crimson);
-	}
+	// Buffer views and MeshGeometry size buffers in 32 bits.
+	assert(mShapePacker.GetVertexByteSize() <= UINT_MAX && mShapePacker.GetIndexByteSize() <= UINT_MAX);
+	const UINT vbByteSize = (UINT)mShapePacker.GetVertexByteSize();
+	const UINT ibByteSize = (UINT)mShapePacker.GetIndexByteSize();
 
-	for (size_t i = 0; i < cylinder.Vertices.size(); ++i, ++k)
-	{
-		vertices[k].Pos = cylinder.Vertices[i].Position;
-		vertices[k].Color = XMFLOAT4(DirectX::Colors::GreenYellow);
-	}
+	auto geo = std::make_unique<MeshGeometry>();
+	geo->Name = "shapeGeo";
 
-	for (size_t i = 0; i < cone.Vertices.size(); ++i, ++k)
-	{
-		vertices[k].Pos = cone.Vertices[i].Position;
-		vertices[k].Color = XMFLOAT4(DirectX::Colors::Red);
-	}
+	// Buffers are safe to copy into on the copy queue while the direct queue draws
+	// other regions of them, so every shape streams into its own range.
+	geo->VertexBufferGPU = CreateGpuBuffer(vbByteSize);
+	geo->IndexBufferGPU = CreateGpuBuffer(ibByteSize);
 
-	for (size_t i = 0; i < wedge.Vertices.size(); ++i, ++k)
+	BYTE* cpuVertices = nullptr;
+	BYTE* cpuIndices = nullptr;
+	if (mRetainCpuGeometry)
 	{
-		vertices[k].Pos = wedge.Vertices[i].Position;
-		vertices[k].Color = XMFLOAT4(DirectX::Colors::Yellow);
+		// Keep a CPU copy for picking or collision; each worker fills its shape's part.
+		ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
+		ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
+		cpuVertices = reinterpret_cast<BYTE*>(geo->VertexBufferCPU->GetBufferPointer());
+		cpuIndices = reinterpret_cast<BYTE*>(geo->IndexBufferCPU->GetBufferPointer());
 	}
 
-	for (size_t i = 0; i < pyramid.Vertices.size(); ++i, ++k)
-	{
-		vertices[k].Pos = pyramid.Vertices[i].Position;
-		vertices[k].Color = XMFLOAT4(DirectX::Colors::PeachPuff);
-	}
+	geo->VertexByteStride = sizeof(Vertex);
+	geo->VertexBufferByteSize = vbByteSize;
+	geo->IndexFormat = DXGI_FORMAT_R16_UINT;
+	geo->IndexBufferByteSize = ibByteSize;
 
-	for (size_t i = 0; i < diamond.Vertices.size(); ++i, ++k)
-	{
-		vertices[k].Pos = diamond.Vertices[i].Position;
-		vertices[k].Color = XMFLOAT4(DirectX::Colors::Purple);
-	}	
-	
-	for (size_t i = 0; i < triPrism.Vertices.size(); ++i, ++k)
+	mGeometryStreamer = std::make_unique<GeometryStreamer>(mThreadPool, *mUploader);
+
+	for (const Shape& shape : shapes)
 	{
-		vertices[k].Pos = triPrism.Vertices[i].Position;
-		vertices[k].Color = XMFLOAT4(DirectX::Colors::Orange);
+		const ShapeWriter::Range& range = mShapePacker.GetEntry(shape.Entry).Range;
+		const UINT64 vertexOffset = range.BaseVertex * sizeof(Vertex);
+		const UINT64 indexOffset = range.StartIndex * sizeof(std::uint16_t);
+
+		// Define the SubmeshGeometry that covers this shape's region of the
+		// vertex/index buffers.  Its bounds are known once it has been generated.
+		SubmeshGeometry submesh;
+		submesh.IndexCount = range.IndexCount;
+		submesh.StartIndexLocation = range.StartIndex;
+		submesh.BaseVertexLocation = range.BaseVertex;
+		geo->DrawArgs[shape.Name] = submesh;
+
+		GeometryStreamer::Request request;
+		request.Generate = [this, entry = shape.Entry, cpuVertices, cpuIndices, vertexOffset, indexOffset](GeometryStreamer::MeshData& mesh)
+		{
+			const ShapeWriter::Range& range = mShapePacker.GetEntry(entry).Range;
+			mesh.Vertices.resize(range.VertexCount * sizeof(Vertex));
+			mesh.Indices.resize(range.IndexCount * sizeof(std::uint16_t));
+
+			mShapePacker.WriteEntry(entry, reinterpret_cast<Vertex*>(mesh.Vertices.data()),
+				reinterpret_cast<std::uint16_t*>(mesh.Indices.data()));
+
+			if (cpuVertices != nullptr)
+			{
+				CopyMemory(cpuVertices + vertexOffset, mesh.Vertices.data(), mesh.Vertices.size());
+				CopyMemory(cpuIndices + indexOffset, mesh.Indices.data(), mesh.Indices.size());
+			}
+		};
+		request.VertexDestination = geo->VertexBufferGPU.Get();
+		request.VertexOffset = vertexOffset;
+		request.IndexDestination = geo->IndexBufferGPU.Get();
+		request.IndexOffset = indexOffset;
+		request.OnResident = [this, entry = shape.Entry, name = shape.Name]() { OnShapeResident(entry, name); };
+
+		mShapeRequests[shape.Name] = mGeometryStreamer->Add(std::move(request));
 	}
 
-	//for (size_t i = 0; i < torus.Vertices.size(); ++i, ++k)
-	//{
-	//	vertices[k].Pos = torus.Vertices[i].Position;
-	//	vertices[k].Color = XMFLOAT4(DirectX::Colors::AliceBlue);
-	//}
-
-	std::vector<std::uint16_t> indices;
-	indices.insert(indices.end(), std::begin(box.GetIndices16()), std::end(box.GetIndices16()));
-	indices.insert(indices.end(), std::begin(grid.GetIndices16()), std::end(grid.GetIndices16()));
-	indices.insert(indices.end(), std::begin(sphere.GetIndices16()), std::end(sphere.GetIndices16()));
-	indices.insert(indices.end(), std::begin(cylinder.GetIndices16()), std::end(cylinder.GetIndices16()));
-	indices.insert(indices.end(), std::begin(cone.GetIndices16()), std::end(cone.GetIndices16()));
-	indices.insert(indices.end(), std::begin(wedge.GetIndices16()), std::end(wedge.GetIndices16()));
-	indices.insert(indices.end(), std::begin(pyramid.GetIndices16()), std::end(pyramid.GetIndices16()));
-	indices.insert(indices.end(), std::begin(diamond.GetIndices16()), std::end(diamond.GetIndices16()));
-	indices.insert(indices.end(), std::begin(triPrism.GetIndices16()), std::end(triPrism.GetIndices16()));
-	/*indices.insert(indices.end(), std::begin(torus.GetIndices16()), std::end(torus.GetIndices16()));*/
-
-	const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
-	const UINT ibByteSize = (UINT)indices.size() * sizeof(std::uint16_t);
-
-	auto geo = std::make_unique<MeshGeometry>();
-	geo->Name = "shapeGeo";
-
-
-	ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
-	CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
-
-	ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
-	CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
+	mGeometries[geo->Name] = std::move(geo);
 
-	geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-		mCommandList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader);
+	// Get the workers going while the rest of Initialize runs.
+	mGeometryStreamer->Pump(UploadBytesPerFrame);
+}
 
-	geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-		mCommandList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
+void ShapesApp::OnShapeResident(UINT entry, const char* name)
+{
+	const ShapePacker::Entry& e = mShapePacker.GetEntry(entry);
+
+	const UINT64 byteSize = e.Range.VertexCount * sizeof(Vertex) + e.Range.IndexCount * sizeof(std::uint16_t);
+	mGeometryCopies.Record("generate into mesh slots", CopyLedger::Kind::Write, byteSize);
+	if (mRetainCpuGeometry)
+		mGeometryCopies.Record("mesh slots to CPU blobs", CopyLedger::Kind::CpuCopy, byteSize);
+	mGeometryCopies.Record("mesh slots to staging ring", CopyLedger::Kind::CpuCopy, byteSize);
+	mGeometryCopies.Record("staging ring to default heap", CopyLedger::Kind::GpuCopy, byteSize);
+
+	SubmeshGeometry& submesh = mGeometries["shapeGeo"]->DrawArgs[name];
+	BoundingBox::CreateFromPoints(submesh.Bounds, XMLoadFloat3(&e.BoundsMin), XMLoadFloat3(&e.BoundsMax));
+
+	// The items' culling spheres were built from empty bounds; redo them now.  Animated
+	// items rebuild theirs every frame anyway.
+	GeometryStreamer::Handle request = mShapeRequests[name];
+	for (auto& ri : mAllRitems)
+	{
+		if (ri->GeometryRequest != request)
+			continue;
 
-	geo->VertexByteStride = sizeof(Vertex);
-	geo->VertexBufferByteSize = vbByteSize;
-	geo->IndexFormat = DXGI_FORMAT_R16_UINT;
-	geo->IndexBufferByteSize = ibByteSize;
+		ri->Bounds = submesh.Bounds;
+		ri->Drawable = true;
 
-	geo->DrawArgs["box"] = boxSubmesh;
-	geo->DrawArgs["grid"] = gridSubmesh;
-	geo->DrawArgs["sphere"] = sphereSubmesh;
-	geo->DrawArgs["cylinder"] = cylinderSubmesh;
-	geo->DrawArgs["cone"] = coneSubmesh;
-	geo->DrawArgs["wedge"] = wedgeSubmesh;
-	geo->DrawArgs["pyramid"] = pyramidSubmesh;
-	geo->DrawArgs["diamond"] = diamondSubmesh;
-	geo->DrawArgs["triPrism"] = triPrismSubmesh;/*
-	geo->DrawArgs["torus"] = torusSubmesh;*/
+		XMFLOAT4 localSphere(ri->Bounds.Center.x, ri->Bounds.Center.y, ri->Bounds.Center.z,
+			XMVectorGetX(XMVector3Length(XMLoadFloat3(&ri->Bounds.Extents))));
+		mObjectBounds[ri->ObjCBIndex] = TransformBoundingSphere(localSphere, XMLoadFloat4x4(&ri->World));
+	}
+}
 
-	mGeometries[geo->Name] = std::move(geo);
+ComPtr<ID3D12Resource> ShapesApp::CreateGpuBuffer(UINT64 byteSize)
+{
+	// Created in COMMON: the copy queue promotes it to COPY_DEST for the upload, and
+	// the direct queue promotes it to the vertex/index buffer state when it draws.
+	ComPtr<ID3D12Resource> buffer;
+	ThrowIfFailed(md3dDevice->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(byteSize),
+		D3D12_RESOURCE_STATE_COMMON,
+		nullptr,
+		IID_PPV_ARGS(buffer.GetAddressOf())));
+
+	return buffer;
 }
 
 void ShapesApp::BuildPSOs()
 {
+	mOpaquePSO = mPSOs.Intern("opaque");
+	mOpaqueWireframePSO = mPSOs.Intern("opaque_wireframe");
+	mAnimatedPSO = mPSOs.Intern("opaque_animated");
+	mAnimatedWireframePSO = mPSOs.Intern("opaque_animated_wireframe");
+
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC opaquePsoDesc;
 
 	// PSO for opaque objects.
@@ -793,28 +991,52 @@ void ShapesApp::BuildPSOs()
 	opaquePsoDesc.SampleDesc.Quality = m4xMsaaState ? (m4xMsaaQuality - 1) : 0;
 	opaquePsoDesc.DSVFormat = mDepthStencilFormat;
 
-	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&opaquePsoDesc, IID_PPV_ARGS(&mPSOs["opaque"])));
+	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&opaquePsoDesc, IID_PPV_ARGS(&mPSOs[mOpaquePSO])));
 
 	// PSO for opaque wireframe objects.
 
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC opaqueWireframePsoDesc = opaquePsoDesc;
 	opaqueWireframePsoDesc.RasterizerState.FillMode = D3D12_FILL_MODE_WIREFRAME;
-	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&opaqueWireframePsoDesc, IID_PPV_ARGS(&mPSOs["opaque_wireframe"])));
+	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&opaqueWireframePsoDesc, IID_PPV_ARGS(&mPSOs[mOpaqueWireframePSO])));
+
+	// PSOs for animated objects, which rebuild their world matrix in the vertex shader.
+
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC animatedPsoDesc = opaquePsoDesc;
+	animatedPsoDesc.VS =
+	{
+	 reinterpret_cast<BYTE*>(mShaders["animatedVS"]->GetBufferPointer()),
+	 mShaders["animatedVS"]->GetBufferSize()
+	};
+	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&animatedPsoDesc, IID_PPV_ARGS(&mPSOs[mAnimatedPSO])));
+
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC animatedWireframePsoDesc = animatedPsoDesc;
+	animatedWireframePsoDesc.RasterizerState.FillMode = D3D12_FILL_MODE_WIREFRAME;
+	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&animatedWireframePsoDesc, IID_PPV_ARGS(&mPSOs[mAnimatedWireframePSO])));
 }
 void ShapesApp::BuildFrameResources()
 {
 	for (int i = 0; i < gNumFrameResources; ++i)
 	{
 		mFrameResources.push_back(std::make_unique<FrameResource>(md3dDevice.Get(),
-			1, (UINT)mAllRitems.size()));
+			gMaxPassCount, (UINT)mAllRitems.size(), (UINT)mAnimatedRitems.size()));
 	}
 }
 
 void ShapesApp::BuildRenderItems()
 {
+	// The corner towers and the gate towers each group a cylinder, a cone roof and, on
+	// the corners, a floating diamond, so their parts are placed relative to the tower.
+	SceneGraph::NodeHandle sceneRoot = mSceneGraph.CreateNode(SceneGraph::InvalidNode, XMMatrixIdentity());
+	SceneGraph::NodeHandle towerNE = mSceneGraph.CreateNode(sceneRoot, XMMatrixTranslation(25.0f, 0.0f, 25.0f));
+	SceneGraph::NodeHandle towerSE = mSceneGraph.CreateNode(sceneRoot, XMMatrixTranslation(25.0f, 0.0f, -25.0f));
+	SceneGraph::NodeHandle towerSW = mSceneGraph.CreateNode(sceneRoot, XMMatrixTranslation(-25.0f, 0.0f, -25.0f));
+	SceneGraph::NodeHandle towerNW = mSceneGraph.CreateNode(sceneRoot, XMMatrixTranslation(-25.0f, 0.0f, 25.0f));
+	SceneGraph::NodeHandle gateEast = mSceneGraph.CreateNode(sceneRoot, XMMatrixTranslation(7.0f, 0.0f, -25.0f));
+	SceneGraph::NodeHandle gateWest = mSceneGraph.CreateNode(sceneRoot, XMMatrixTranslation(-7.0f, 0.0f, -25.0f));
+
 	auto boxRitem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&boxRitem->World, XMMatrixScaling(50.0f, 10.0f, 1.0f) * XMMatrixTranslation(0.0f, 5.0f, 25.0f));
+	boxRitem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixScaling(50.0f, 10.0f, 1.0f) * XMMatrixTranslation(0.0f, 5.0f, 25.0f));
 
 	boxRitem->ObjCBIndex = 0;
 	boxRitem->Geo = mGeometries["shapeGeo"].get();
@@ -822,11 +1044,13 @@ void ShapesApp::BuildRenderItems()
 	boxRitem->IndexCount = boxRitem->Geo->DrawArgs["box"].IndexCount;
 	boxRitem->StartIndexLocation = boxRitem->Geo->DrawArgs["box"].StartIndexLocation;
 	boxRitem->BaseVertexLocation = boxRitem->Geo->DrawArgs["box"].BaseVertexLocation;
+	boxRitem->Bounds = boxRitem->Geo->DrawArgs["box"].Bounds;
+	boxRitem->GeometryRequest = mShapeRequests["box"];
 	mAllRitems.push_back(std::move(boxRitem));
 
 	auto box2Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&box2Ritem->World, XMMatrixScaling(1.0f, 10.0f, 50.0f) * XMMatrixTranslation(25.0f, 5.0f, 0.0f));
+	box2Ritem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixScaling(1.0f, 10.0f, 50.0f) * XMMatrixTranslation(25.0f, 5.0f, 0.0f));
 
 	box2Ritem->ObjCBIndex = 1;
 	box2Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -834,11 +1058,13 @@ void ShapesApp::BuildRenderItems()
 	box2Ritem->IndexCount = box2Ritem->Geo->DrawArgs["box"].IndexCount;
 	box2Ritem->StartIndexLocation = box2Ritem->Geo->DrawArgs["box"].StartIndexLocation;
 	box2Ritem->BaseVertexLocation = box2Ritem->Geo->DrawArgs["box"].BaseVertexLocation;
+	box2Ritem->Bounds = box2Ritem->Geo->DrawArgs["box"].Bounds;
+	box2Ritem->GeometryRequest = mShapeRequests["box"];
 	mAllRitems.push_back(std::move(box2Ritem));
 
 	auto box3Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&box3Ritem->World, XMMatrixScaling(1.0f, 10.0f, 50.0f) * XMMatrixTranslation(-25.0f, 5.0f, 0.0f));
+	box3Ritem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixScaling(1.0f, 10.0f, 50.0f) * XMMatrixTranslation(-25.0f, 5.0f, 0.0f));
 
 	box3Ritem->ObjCBIndex = 2;
 	box3Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -846,11 +1072,13 @@ void ShapesApp::BuildRenderItems()
 	box3Ritem->IndexCount = box3Ritem->Geo->DrawArgs["box"].IndexCount;
 	box3Ritem->StartIndexLocation = box3Ritem->Geo->DrawArgs["box"].StartIndexLocation;
 	box3Ritem->BaseVertexLocation = box3Ritem->Geo->DrawArgs["box"].BaseVertexLocation;
+	box3Ritem->Bounds = box3Ritem->Geo->DrawArgs["box"].Bounds;
+	box3Ritem->GeometryRequest = mShapeRequests["box"];
 	mAllRitems.push_back(std::move(box3Ritem));
 
 	auto box4Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&box4Ritem->World, XMMatrixScaling(15.0f, 7.0f, 1.0f) * XMMatrixTranslation(17.5f, 3.5f, -25.0f));
+	box4Ritem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixScaling(15.0f, 7.0f, 1.0f) * XMMatrixTranslation(17.5f, 3.5f, -25.0f));
 
 	box4Ritem->ObjCBIndex = 3;
 	box4Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -858,11 +1086,13 @@ void ShapesApp::BuildRenderItems()
 	box4Ritem->IndexCount = box4Ritem->Geo->DrawArgs["box"].IndexCount;
 	box4Ritem->StartIndexLocation = box4Ritem->Geo->DrawArgs["box"].StartIndexLocation;
 	box4Ritem->BaseVertexLocation = box4Ritem->Geo->DrawArgs["box"].BaseVertexLocation;
+	box4Ritem->Bounds = box4Ritem->Geo->DrawArgs["box"].Bounds;
+	box4Ritem->GeometryRequest = mShapeRequests["box"];
 	mAllRitems.push_back(std::move(box4Ritem));
 
 	auto box5Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&box5Ritem->World, XMMatrixScaling(15.0f, 7.0f, 2.0f) * XMMatrixTranslation(-17.5f, 3.5f, -25.0f));
+	box5Ritem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixScaling(15.0f, 7.0f, 2.0f) * XMMatrixTranslation(-17.5f, 3.5f, -25.0f));
 
 	box5Ritem->ObjCBIndex = 4;
 	box5Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -870,11 +1100,13 @@ void ShapesApp::BuildRenderItems()
 	box5Ritem->IndexCount = box5Ritem->Geo->DrawArgs["box"].IndexCount;
 	box5Ritem->StartIndexLocation = box5Ritem->Geo->DrawArgs["box"].StartIndexLocation;
 	box5Ritem->BaseVertexLocation = box5Ritem->Geo->DrawArgs["box"].BaseVertexLocation;
+	box5Ritem->Bounds = box5Ritem->Geo->DrawArgs["box"].Bounds;
+	box5Ritem->GeometryRequest = mShapeRequests["box"];
 	mAllRitems.push_back(std::move(box5Ritem));
 
 	auto box6Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&box6Ritem->World, XMMatrixScaling(5.0f, 7.0f, 4.0f) * XMMatrixTranslation(4.0f, 3.5f, -26.0f));
+	box6Ritem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixScaling(5.0f, 7.0f, 4.0f) * XMMatrixTranslation(4.0f, 3.5f, -26.0f));
 
 	box6Ritem->ObjCBIndex = 5;
 	box6Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -882,11 +1114,13 @@ void ShapesApp::BuildRenderItems()
 	box6Ritem->IndexCount = box6Ritem->Geo->DrawArgs["box"].IndexCount;
 	box6Ritem->StartIndexLocation = box6Ritem->Geo->DrawArgs["box"].StartIndexLocation;
 	box6Ritem->BaseVertexLocation = box6Ritem->Geo->DrawArgs["box"].BaseVertexLocation;
+	box6Ritem->Bounds = box6Ritem->Geo->DrawArgs["box"].Bounds;
+	box6Ritem->GeometryRequest = mShapeRequests["box"];
 	mAllRitems.push_back(std::move(box6Ritem));
 
 	auto box7Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&box7Ritem->World, XMMatrixScaling(5.0f, 7.0f, 4.0f) * XMMatrixTranslation(-4.0f, 3.5f, -26.0f));
+	box7Ritem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixScaling(5.0f, 7.0f, 4.0f) * XMMatrixTranslation(-4.0f, 3.5f, -26.0f));
 
 	box7Ritem->ObjCBIndex = 6;
 	box7Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -894,11 +1128,13 @@ void ShapesApp::BuildRenderItems()
 	box7Ritem->IndexCount = box7Ritem->Geo->DrawArgs["box"].IndexCount;
 	box7Ritem->StartIndexLocation = box7Ritem->Geo->DrawArgs["box"].StartIndexLocation;
 	box7Ritem->BaseVertexLocation = box7Ritem->Geo->DrawArgs["box"].BaseVertexLocation;
+	box7Ritem->Bounds = box7Ritem->Geo->DrawArgs["box"].Bounds;
+	box7Ritem->GeometryRequest = mShapeRequests["box"];
 	mAllRitems.push_back(std::move(box7Ritem));
 
 	auto box8Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&box8Ritem->World, XMMatrixScaling(4.0f, 1.0f, 4.0f) * XMMatrixTranslation(0.0f, 6.5f, -26.0f));
+	box8Ritem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixScaling(4.0f, 1.0f, 4.0f) * XMMatrixTranslation(0.0f, 6.5f, -26.0f));
 
 	box8Ritem->ObjCBIndex = 7;
 	box8Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -906,11 +1142,13 @@ void ShapesApp::BuildRenderItems()
 	box8Ritem->IndexCount = box8Ritem->Geo->DrawArgs["box"].IndexCount;
 	box8Ritem->StartIndexLocation = box8Ritem->Geo->DrawArgs["box"].StartIndexLocation;
 	box8Ritem->BaseVertexLocation = box8Ritem->Geo->DrawArgs["box"].BaseVertexLocation;
+	box8Ritem->Bounds = box8Ritem->Geo->DrawArgs["box"].Bounds;
+	box8Ritem->GeometryRequest = mShapeRequests["box"];
 	mAllRitems.push_back(std::move(box8Ritem));
 
 	auto box9Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&box9Ritem->World, XMMatrixScaling(4.0f, 2.0f, 4.0f) * XMMatrixTranslation(0.0f, 1.0f, -26.0f));
+	box9Ritem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixScaling(4.0f, 2.0f, 4.0f) * XMMatrixTranslation(0.0f, 1.0f, -26.0f));
 
 	box9Ritem->ObjCBIndex = 8;
 	box9Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -918,11 +1156,13 @@ void ShapesApp::BuildRenderItems()
 	box9Ritem->IndexCount = box9Ritem->Geo->DrawArgs["box"].IndexCount;
 	box9Ritem->StartIndexLocation = box9Ritem->Geo->DrawArgs["box"].StartIndexLocation;
 	box9Ritem->BaseVertexLocation = box9Ritem->Geo->DrawArgs["box"].BaseVertexLocation;
+	box9Ritem->Bounds = box9Ritem->Geo->DrawArgs["box"].Bounds;
+	box9Ritem->GeometryRequest = mShapeRequests["box"];
 	mAllRitems.push_back(std::move(box9Ritem));
 
 	auto box10Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&box10Ritem->World, XMMatrixScaling(20.0f, 2.0f, 20.0f)* XMMatrixTranslation(0.0f, 1.0f, 0.0f));
+	box10Ritem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixScaling(20.0f, 2.0f, 20.0f)* XMMatrixTranslation(0.0f, 1.0f, 0.0f));
 
 	box10Ritem->ObjCBIndex = 9;
 	box10Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -930,24 +1170,28 @@ void ShapesApp::BuildRenderItems()
 	box10Ritem->IndexCount = box10Ritem->Geo->DrawArgs["box"].IndexCount;
 	box10Ritem->StartIndexLocation = box10Ritem->Geo->DrawArgs["box"].StartIndexLocation;
 	box10Ritem->BaseVertexLocation = box10Ritem->Geo->DrawArgs["box"].BaseVertexLocation;
+	box10Ritem->Bounds = box10Ritem->Geo->DrawArgs["box"].Bounds;
+	box10Ritem->GeometryRequest = mShapeRequests["box"];
 	mAllRitems.push_back(std::move(box10Ritem));
 
 
 
 	auto gridRitem = std::make_unique<RenderItem>();
 
-	gridRitem->World = MathHelper::Identity4x4();
+	gridRitem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixIdentity());
 	gridRitem->ObjCBIndex = 10;
 	gridRitem->Geo = mGeometries["shapeGeo"].get();
 	gridRitem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 	gridRitem->IndexCount = gridRitem->Geo->DrawArgs["grid"].IndexCount;
 	gridRitem->StartIndexLocation = gridRitem->Geo->DrawArgs["grid"].StartIndexLocation;
 	gridRitem->BaseVertexLocation = gridRitem->Geo->DrawArgs["grid"].BaseVertexLocation;
+	gridRitem->Bounds = gridRitem->Geo->DrawArgs["grid"].Bounds;
+	gridRitem->GeometryRequest = mShapeRequests["grid"];
 	mAllRitems.push_back(std::move(gridRitem));
 
 	auto wedgeRitem = std::make_unique<RenderItem>();
 	
-	XMStoreFloat4x4(&wedgeRitem->World, XMMatrixScaling(1.0f, 1.0f, 1.0f) * XMMatrixTranslation(0.0f, 1.0f, -11.0f));
+	wedgeRitem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixScaling(1.0f, 1.0f, 1.0f) * XMMatrixTranslation(0.0f, 1.0f, -11.0f));
 	
 	wedgeRitem->ObjCBIndex = 11;
 	wedgeRitem->Geo = mGeometries["shapeGeo"].get();
@@ -955,11 +1199,13 @@ void ShapesApp::BuildRenderItems()
 	wedgeRitem->IndexCount = wedgeRitem->Geo->DrawArgs["wedge"].IndexCount;
 	wedgeRitem->StartIndexLocation = wedgeRitem->Geo->DrawArgs["wedge"].StartIndexLocation;
 	wedgeRitem->BaseVertexLocation = wedgeRitem->Geo->DrawArgs["wedge"].BaseVertexLocation;
+	wedgeRitem->Bounds = wedgeRitem->Geo->DrawArgs["wedge"].Bounds;
+	wedgeRitem->GeometryRequest = mShapeRequests["wedge"];
 	mAllRitems.push_back(std::move(wedgeRitem));
 
 	auto pyramidRitem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&pyramidRitem->World, XMMatrixScaling(7.5f, 7.5f, 7.5f) * XMMatrixTranslation(0.0f, 9.5f, 0.0f));
+	pyramidRitem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixScaling(7.5f, 7.5f, 7.5f) * XMMatrixTranslation(0.0f, 9.5f, 0.0f));
 
 	pyramidRitem->ObjCBIndex = 12;
 	pyramidRitem->Geo = mGeometries["shapeGeo"].get();
@@ -967,56 +1213,70 @@ void ShapesApp::BuildRenderItems()
 	pyramidRitem->IndexCount = pyramidRitem->Geo->DrawArgs["pyramid"].IndexCount;
 	pyramidRitem->StartIndexLocation = pyramidRitem->Geo->DrawArgs["pyramid"].StartIndexLocation;
 	pyramidRitem->BaseVertexLocation = pyramidRitem->Geo->DrawArgs["pyramid"].BaseVertexLocation;
+	pyramidRitem->Bounds = pyramidRitem->Geo->DrawArgs["pyramid"].Bounds;
+	pyramidRitem->GeometryRequest = mShapeRequests["pyramid"];
 	mAllRitems.push_back(std::move(pyramidRitem));
 
 	auto diamondRitem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&diamondRitem->World, XMMatrixScaling(1.0f, 1.0f, 1.0f) * XMMatrixTranslation(25.0f, 22.0f, 25.0f));
+	diamondRitem->Node = mSceneGraph.CreateNode(towerNE, XMMatrixTranslation(0.0f, 22.0f, 0.0f));
 
 	diamondRitem->ObjCBIndex = 13;
+	diamondRitem->AnimatedIndex = 0;
 	diamondRitem->Geo = mGeometries["shapeGeo"].get();
 	diamondRitem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 	diamondRitem->IndexCount = diamondRitem->Geo->DrawArgs["diamond"].IndexCount;
 	diamondRitem->StartIndexLocation = diamondRitem->Geo->DrawArgs["diamond"].StartIndexLocation;
 	diamondRitem->BaseVertexLocation = diamondRitem->Geo->DrawArgs["diamond"].BaseVertexLocation;
+	diamondRitem->Bounds = diamondRitem->Geo->DrawArgs["diamond"].Bounds;
+	diamondRitem->GeometryRequest = mShapeRequests["diamond"];
 	mAllRitems.push_back(std::move(diamondRitem));
 
 	auto diamond2Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&diamond2Ritem->World, XMMatrixScaling(1.0f, 1.0f, 1.0f)* XMMatrixTranslation(-25.0f, 22.0f, -25.0f));
+	diamond2Ritem->Node = mSceneGraph.CreateNode(towerSW, XMMatrixTranslation(0.0f, 22.0f, 0.0f));
 	diamond2Ritem->ObjCBIndex = 14;
+	diamond2Ritem->AnimatedIndex = 1;
 	diamond2Ritem->Geo = mGeometries["shapeGeo"].get();
 	diamond2Ritem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 	diamond2Ritem->IndexCount = diamond2Ritem->Geo->DrawArgs["diamond"].IndexCount;
 	diamond2Ritem->StartIndexLocation = diamond2Ritem->Geo->DrawArgs["diamond"].StartIndexLocation;
 	diamond2Ritem->BaseVertexLocation = diamond2Ritem->Geo->DrawArgs["diamond"].BaseVertexLocation;
+	diamond2Ritem->Bounds = diamond2Ritem->Geo->DrawArgs["diamond"].Bounds;
+	diamond2Ritem->GeometryRequest = mShapeRequests["diamond"];
 	mAllRitems.push_back(std::move(diamond2Ritem));
 
 	auto diamond3Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&diamond3Ritem->World, XMMatrixScaling(1.0f, 1.0f, 1.0f)* XMMatrixTranslation(-25.0f, 22.0f, 25.0f));
+	diamond3Ritem->Node = mSceneGraph.CreateNode(towerNW, XMMatrixTranslation(0.0f, 22.0f, 0.0f));
 	diamond3Ritem->ObjCBIndex = 15;
+	diamond3Ritem->AnimatedIndex = 2;
 	diamond3Ritem->Geo = mGeometries["shapeGeo"].get();
 	diamond3Ritem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 	diamond3Ritem->IndexCount = diamond3Ritem->Geo->DrawArgs["diamond"].IndexCount;
 	diamond3Ritem->StartIndexLocation = diamond3Ritem->Geo->DrawArgs["diamond"].StartIndexLocation;
 	diamond3Ritem->BaseVertexLocation = diamond3Ritem->Geo->DrawArgs["diamond"].BaseVertexLocation;
+	diamond3Ritem->Bounds = diamond3Ritem->Geo->DrawArgs["diamond"].Bounds;
+	diamond3Ritem->GeometryRequest = mShapeRequests["diamond"];
 	mAllRitems.push_back(std::move(diamond3Ritem));
 
 	auto diamond4Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&diamond4Ritem->World, XMMatrixScaling(1.0f, 1.0f, 1.0f)* XMMatrixTranslation(25.0f, 22.0f, -25.0f));
+	diamond4Ritem->Node = mSceneGraph.CreateNode(towerSE, XMMatrixTranslation(0.0f, 22.0f, 0.0f));
 	diamond4Ritem->ObjCBIndex = 16;
+	diamond4Ritem->AnimatedIndex = 3;
 	diamond4Ritem->Geo = mGeometries["shapeGeo"].get();
 	diamond4Ritem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 	diamond4Ritem->IndexCount = diamond4Ritem->Geo->DrawArgs["diamond"].IndexCount;
 	diamond4Ritem->StartIndexLocation = diamond4Ritem->Geo->DrawArgs["diamond"].StartIndexLocation;
 	diamond4Ritem->BaseVertexLocation = diamond4Ritem->Geo->DrawArgs["diamond"].BaseVertexLocation;
+	diamond4Ritem->Bounds = diamond4Ritem->Geo->DrawArgs["diamond"].Bounds;
+	diamond4Ritem->GeometryRequest = mShapeRequests["diamond"];
 	mAllRitems.push_back(std::move(diamond4Ritem));
 
 	auto triPrismRitem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&triPrismRitem->World, XMMatrixScaling(1.0f, 1.0f, 1.0f) * XMMatrixTranslation(0.0f, 1.0f, -29.0f));
+	triPrismRitem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixScaling(1.0f, 1.0f, 1.0f) * XMMatrixTranslation(0.0f, 1.0f, -29.0f));
 
 	triPrismRitem->ObjCBIndex = 17;
 	triPrismRitem->Geo = mGeometries["shapeGeo"].get();
@@ -1024,11 +1284,13 @@ void ShapesApp::BuildRenderItems()
 	triPrismRitem->IndexCount = triPrismRitem->Geo->DrawArgs["triPrism"].IndexCount;
 	triPrismRitem->StartIndexLocation = triPrismRitem->Geo->DrawArgs["triPrism"].StartIndexLocation;
 	triPrismRitem->BaseVertexLocation = triPrismRitem->Geo->DrawArgs["triPrism"].BaseVertexLocation;
+	triPrismRitem->Bounds = triPrismRitem->Geo->DrawArgs["triPrism"].Bounds;
+	triPrismRitem->GeometryRequest = mShapeRequests["triPrism"];
 	mAllRitems.push_back(std::move(triPrismRitem));
 
 	auto triPrism2Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&triPrism2Ritem->World, XMMatrixScaling(1.0f, 1.0f, 1.0f)* XMMatrixRotationX(1.51f) * XMMatrixTranslation(0.0f, 1.0f, -23.0f));
+	triPrism2Ritem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixScaling(1.0f, 1.0f, 1.0f)* XMMatrixRotationX(1.51f) * XMMatrixTranslation(0.0f, 1.0f, -23.0f));
 
 	triPrism2Ritem->ObjCBIndex = 18;
 	triPrism2Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -1036,11 +1298,13 @@ void ShapesApp::BuildRenderItems()
 	triPrism2Ritem->IndexCount = triPrism2Ritem->Geo->DrawArgs["triPrism"].IndexCount;
 	triPrism2Ritem->StartIndexLocation = triPrism2Ritem->Geo->DrawArgs["triPrism"].StartIndexLocation;
 	triPrism2Ritem->BaseVertexLocation = triPrism2Ritem->Geo->DrawArgs["triPrism"].BaseVertexLocation;
+	triPrism2Ritem->Bounds = triPrism2Ritem->Geo->DrawArgs["triPrism"].Bounds;
+	triPrism2Ritem->GeometryRequest = mShapeRequests["triPrism"];
 	mAllRitems.push_back(std::move(triPrism2Ritem));
 
 	auto cylinderRitem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&cylinderRitem->World, XMMatrixScaling(7.0f, 5.0f, 7.0f)* XMMatrixTranslation(25.0f, 7.5f, 25.0f));
+	cylinderRitem->Node = mSceneGraph.CreateNode(towerNE, XMMatrixScaling(7.0f, 5.0f, 7.0f)* XMMatrixTranslation(0.0f, 7.5f, 0.0f));
 
 	cylinderRitem->ObjCBIndex = 19;
 	cylinderRitem->Geo = mGeometries["shapeGeo"].get();
@@ -1048,11 +1312,13 @@ void ShapesApp::BuildRenderItems()
 	cylinderRitem->IndexCount = cylinderRitem->Geo->DrawArgs["cylinder"].IndexCount;
 	cylinderRitem->StartIndexLocation = cylinderRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 	cylinderRitem->BaseVertexLocation = cylinderRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+	cylinderRitem->Bounds = cylinderRitem->Geo->DrawArgs["cylinder"].Bounds;
+	cylinderRitem->GeometryRequest = mShapeRequests["cylinder"];
 	mAllRitems.push_back(std::move(cylinderRitem));
 
 	auto cylinder2Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&cylinder2Ritem->World, XMMatrixScaling(7.0f, 5.0f, 7.0f)* XMMatrixTranslation(25.0f, 7.5f, -25.0f));
+	cylinder2Ritem->Node = mSceneGraph.CreateNode(towerSE, XMMatrixScaling(7.0f, 5.0f, 7.0f)* XMMatrixTranslation(0.0f, 7.5f, 0.0f));
 
 	cylinder2Ritem->ObjCBIndex = 20;
 	cylinder2Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -1060,11 +1326,13 @@ void ShapesApp::BuildRenderItems()
 	cylinder2Ritem->IndexCount = cylinder2Ritem->Geo->DrawArgs["cylinder"].IndexCount;
 	cylinder2Ritem->StartIndexLocation = cylinder2Ritem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 	cylinder2Ritem->BaseVertexLocation = cylinder2Ritem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+	cylinder2Ritem->Bounds = cylinder2Ritem->Geo->DrawArgs["cylinder"].Bounds;
+	cylinder2Ritem->GeometryRequest = mShapeRequests["cylinder"];
 	mAllRitems.push_back(std::move(cylinder2Ritem));
 
 	auto cylinder3Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&cylinder3Ritem->World, XMMatrixScaling(7.0f, 5.0f, 7.0f)* XMMatrixTranslation(-25.0f, 7.5f, -25.0f));
+	cylinder3Ritem->Node = mSceneGraph.CreateNode(towerSW, XMMatrixScaling(7.0f, 5.0f, 7.0f)* XMMatrixTranslation(0.0f, 7.5f, 0.0f));
 
 	cylinder3Ritem->ObjCBIndex = 21;
 	cylinder3Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -1072,11 +1340,13 @@ void ShapesApp::BuildRenderItems()
 	cylinder3Ritem->IndexCount = cylinder3Ritem->Geo->DrawArgs["cylinder"].IndexCount;
 	cylinder3Ritem->StartIndexLocation = cylinder3Ritem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 	cylinder3Ritem->BaseVertexLocation = cylinder3Ritem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+	cylinder3Ritem->Bounds = cylinder3Ritem->Geo->DrawArgs["cylinder"].Bounds;
+	cylinder3Ritem->GeometryRequest = mShapeRequests["cylinder"];
 	mAllRitems.push_back(std::move(cylinder3Ritem));
 
 	auto cylinder4Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&cylinder4Ritem->World, XMMatrixScaling(7.0f, 5.0f, 7.0f)* XMMatrixTranslation(-25.0f, 7.5f, 25.0f));
+	cylinder4Ritem->Node = mSceneGraph.CreateNode(towerNW, XMMatrixScaling(7.0f, 5.0f, 7.0f)* XMMatrixTranslation(0.0f, 7.5f, 0.0f));
 
 	cylinder4Ritem->ObjCBIndex = 22;
 	cylinder4Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -1084,11 +1354,13 @@ void ShapesApp::BuildRenderItems()
 	cylinder4Ritem->IndexCount = cylinder4Ritem->Geo->DrawArgs["cylinder"].IndexCount;
 	cylinder4Ritem->StartIndexLocation = cylinder4Ritem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 	cylinder4Ritem->BaseVertexLocation = cylinder4Ritem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+	cylinder4Ritem->Bounds = cylinder4Ritem->Geo->DrawArgs["cylinder"].Bounds;
+	cylinder4Ritem->GeometryRequest = mShapeRequests["cylinder"];
 	mAllRitems.push_back(std::move(cylinder4Ritem));
 
 	auto cylinder5Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&cylinder5Ritem->World, XMMatrixScaling(8.0f, 3.0f, 8.0f)* XMMatrixTranslation(7.0f, 4.5f, -25.0f));
+	cylinder5Ritem->Node = mSceneGraph.CreateNode(gateEast, XMMatrixScaling(8.0f, 3.0f, 8.0f)* XMMatrixTranslation(0.0f, 4.5f, 0.0f));
 
 	cylinder5Ritem->ObjCBIndex = 23;
 	cylinder5Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -1096,11 +1368,13 @@ void ShapesApp::BuildRenderItems()
 	cylinder5Ritem->IndexCount = cylinder5Ritem->Geo->DrawArgs["cylinder"].IndexCount;
 	cylinder5Ritem->StartIndexLocation = cylinder5Ritem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 	cylinder5Ritem->BaseVertexLocation = cylinder5Ritem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+	cylinder5Ritem->Bounds = cylinder5Ritem->Geo->DrawArgs["cylinder"].Bounds;
+	cylinder5Ritem->GeometryRequest = mShapeRequests["cylinder"];
 	mAllRitems.push_back(std::move(cylinder5Ritem));
 
 	auto cylinder6Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&cylinder6Ritem->World, XMMatrixScaling(8.0f, 3.0f, 8.0f)* XMMatrixTranslation(-7.0f, 4.5f, -25.0f));
+	cylinder6Ritem->Node = mSceneGraph.CreateNode(gateWest, XMMatrixScaling(8.0f, 3.0f, 8.0f)* XMMatrixTranslation(0.0f, 4.5f, 0.0f));
 
 	cylinder6Ritem->ObjCBIndex = 24;
 	cylinder6Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -1108,11 +1382,13 @@ void ShapesApp::BuildRenderItems()
 	cylinder6Ritem->IndexCount = cylinder6Ritem->Geo->DrawArgs["cylinder"].IndexCount;
 	cylinder6Ritem->StartIndexLocation = cylinder6Ritem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 	cylinder6Ritem->BaseVertexLocation = cylinder6Ritem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+	cylinder6Ritem->Bounds = cylinder6Ritem->Geo->DrawArgs["cylinder"].Bounds;
+	cylinder6Ritem->GeometryRequest = mShapeRequests["cylinder"];
 	mAllRitems.push_back(std::move(cylinder6Ritem));
 
 	auto coneRitem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&coneRitem->World, XMMatrixScaling(10.0f, 5.0f, 10.0f)* XMMatrixTranslation(25.0f, 17.5f, 25.0f));
+	coneRitem->Node = mSceneGraph.CreateNode(towerNE, XMMatrixScaling(10.0f, 5.0f, 10.0f)* XMMatrixTranslation(0.0f, 17.5f, 0.0f));
 
 	coneRitem->ObjCBIndex = 25;
 	coneRitem->Geo = mGeometries["shapeGeo"].get();
@@ -1120,11 +1396,13 @@ void ShapesApp::BuildRenderItems()
 	coneRitem->IndexCount = coneRitem->Geo->DrawArgs["cone"].IndexCount;
 	coneRitem->StartIndexLocation = coneRitem->Geo->DrawArgs["cone"].StartIndexLocation;
 	coneRitem->BaseVertexLocation = coneRitem->Geo->DrawArgs["cone"].BaseVertexLocation;
+	coneRitem->Bounds = coneRitem->Geo->DrawArgs["cone"].Bounds;
+	coneRitem->GeometryRequest = mShapeRequests["cone"];
 	mAllRitems.push_back(std::move(coneRitem));
 
 	auto cone2Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&cone2Ritem->World, XMMatrixScaling(10.0f, 5.0f, 10.0f)* XMMatrixTranslation(-25.0f, 17.5f, -25.0f));
+	cone2Ritem->Node = mSceneGraph.CreateNode(towerSW, XMMatrixScaling(10.0f, 5.0f, 10.0f)* XMMatrixTranslation(0.0f, 17.5f, 0.0f));
 
 	cone2Ritem->ObjCBIndex = 26;
 	cone2Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -1132,11 +1410,13 @@ void ShapesApp::BuildRenderItems()
 	cone2Ritem->IndexCount = cone2Ritem->Geo->DrawArgs["cone"].IndexCount;
 	cone2Ritem->StartIndexLocation = cone2Ritem->Geo->DrawArgs["cone"].StartIndexLocation;
 	cone2Ritem->BaseVertexLocation = cone2Ritem->Geo->DrawArgs["cone"].BaseVertexLocation;
+	cone2Ritem->Bounds = cone2Ritem->Geo->DrawArgs["cone"].Bounds;
+	cone2Ritem->GeometryRequest = mShapeRequests["cone"];
 	mAllRitems.push_back(std::move(cone2Ritem));
 
 	auto cone3Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&cone3Ritem->World, XMMatrixScaling(10.0f, 5.0f, 10.0f)* XMMatrixTranslation(25.0f, 17.5f, -25.0f));
+	cone3Ritem->Node = mSceneGraph.CreateNode(towerSE, XMMatrixScaling(10.0f, 5.0f, 10.0f)* XMMatrixTranslation(0.0f, 17.5f, 0.0f));
 
 	cone3Ritem->ObjCBIndex = 27;
 	cone3Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -1144,11 +1424,13 @@ void ShapesApp::BuildRenderItems()
 	cone3Ritem->IndexCount = cone3Ritem->Geo->DrawArgs["cone"].IndexCount;
 	cone3Ritem->StartIndexLocation = cone3Ritem->Geo->DrawArgs["cone"].StartIndexLocation;
 	cone3Ritem->BaseVertexLocation = cone3Ritem->Geo->DrawArgs["cone"].BaseVertexLocation;
+	cone3Ritem->Bounds = cone3Ritem->Geo->DrawArgs["cone"].Bounds;
+	cone3Ritem->GeometryRequest = mShapeRequests["cone"];
 	mAllRitems.push_back(std::move(cone3Ritem));
 
 	auto cone4Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&cone4Ritem->World, XMMatrixScaling(10.0f, 5.0f, 10.0f)* XMMatrixTranslation(-25.0f, 17.5f, 25.0f));
+	cone4Ritem->Node = mSceneGraph.CreateNode(towerNW, XMMatrixScaling(10.0f, 5.0f, 10.0f)* XMMatrixTranslation(0.0f, 17.5f, 0.0f));
 
 	cone4Ritem->ObjCBIndex = 28;
 	cone4Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -1156,11 +1438,13 @@ void ShapesApp::BuildRenderItems()
 	cone4Ritem->IndexCount = cone4Ritem->Geo->DrawArgs["cone"].IndexCount;
 	cone4Ritem->StartIndexLocation = cone4Ritem->Geo->DrawArgs["cone"].StartIndexLocation;
 	cone4Ritem->BaseVertexLocation = cone4Ritem->Geo->DrawArgs["cone"].BaseVertexLocation;
+	cone4Ritem->Bounds = cone4Ritem->Geo->DrawArgs["cone"].Bounds;
+	cone4Ritem->GeometryRequest = mShapeRequests["cone"];
 	mAllRitems.push_back(std::move(cone4Ritem));
 
 	auto cone5Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&cone5Ritem->World, XMMatrixScaling(10.0f, 5.0f, 10.0f)* XMMatrixTranslation(7.0f, 11.5f, -25.0f));
+	cone5Ritem->Node = mSceneGraph.CreateNode(gateEast, XMMatrixScaling(10.0f, 5.0f, 10.0f)* XMMatrixTranslation(0.0f, 11.5f, 0.0f));
 
 	cone5Ritem->ObjCBIndex = 29;
 	cone5Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -1168,11 +1452,13 @@ void ShapesApp::BuildRenderItems()
 	cone5Ritem->IndexCount = cone5Ritem->Geo->DrawArgs["cone"].IndexCount;
 	cone5Ritem->StartIndexLocation = cone5Ritem->Geo->DrawArgs["cone"].StartIndexLocation;
 	cone5Ritem->BaseVertexLocation = cone5Ritem->Geo->DrawArgs["cone"].BaseVertexLocation;
+	cone5Ritem->Bounds = cone5Ritem->Geo->DrawArgs["cone"].Bounds;
+	cone5Ritem->GeometryRequest = mShapeRequests["cone"];
 	mAllRitems.push_back(std::move(cone5Ritem));
 
 	auto cone6Ritem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&cone6Ritem->World, XMMatrixScaling(10.0f, 5.0f, 10.0f)* XMMatrixTranslation(-7.0f, 11.5f, -25.0f));
+	cone6Ritem->Node = mSceneGraph.CreateNode(gateWest, XMMatrixScaling(10.0f, 5.0f, 10.0f)* XMMatrixTranslation(0.0f, 11.5f, 0.0f));
 
 	cone6Ritem->ObjCBIndex = 30;
 	cone6Ritem->Geo = mGeometries["shapeGeo"].get();
@@ -1180,30 +1466,46 @@ void ShapesApp::BuildRenderItems()
 	cone6Ritem->IndexCount = cone6Ritem->Geo->DrawArgs["cone"].IndexCount;
 	cone6Ritem->StartIndexLocation = cone6Ritem->Geo->DrawArgs["cone"].StartIndexLocation;
 	cone6Ritem->BaseVertexLocation = cone6Ritem->Geo->DrawArgs["cone"].BaseVertexLocation;
+	cone6Ritem->Bounds = cone6Ritem->Geo->DrawArgs["cone"].Bounds;
+	cone6Ritem->GeometryRequest = mShapeRequests["cone"];
 	mAllRitems.push_back(std::move(cone6Ritem));
 
 	auto sphereRitem = std::make_unique<RenderItem>();
 
-	XMStoreFloat4x4(&sphereRitem->World, XMMatrixScaling(2.0f, 2.0f, 2.0f)* XMMatrixTranslation(0.0f, 17.0f, 0.0f));
+	sphereRitem->Node = mSceneGraph.CreateNode(sceneRoot, XMMatrixScaling(2.0f, 2.0f, 2.0f)* XMMatrixTranslation(0.0f, 17.0f, 0.0f));
 	sphereRitem->ObjCBIndex = 31;
 	sphereRitem->Geo = mGeometries["shapeGeo"].get();
 	sphereRitem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 	sphereRitem->IndexCount = sphereRitem->Geo->DrawArgs["sphere"].IndexCount;
 	sphereRitem->StartIndexLocation = sphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 	sphereRitem->BaseVertexLocation = sphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+	sphereRitem->Bounds = sphereRitem->Geo->DrawArgs["sphere"].Bounds;
+	sphereRitem->GeometryRequest = mShapeRequests["sphere"];
 	mAllRitems.push_back(std::move(sphereRitem));
 
 	UINT objCBIndex = 32;
 
-	// All the render items are opaque.
 	for (auto& e : mAllRitems)
-		mOpaqueRitems.push_back(e.get());
+	{
+		e->Drawable = mGeometryStreamer->IsResident(e->GeometryRequest);
+
+		if (e->AnimatedIndex != -1)
+			mAnimatedRitems.push_back(e.get());
+	}
+
+	mObjectBounds.resize(mAllRitems.size());
+
+	mAnimatedPositions.resize(mAnimatedRitems.size());
+	mAnimatedScales.assign(mAnimatedRitems.size(), 1.0f);
+	mAnimatedRotations.resize(mAnimatedRitems.size(), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
 }
 
 
 
 void ShapesApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems)
 {
+	PROFILE_SCOPE("ShapesApp::DrawRenderItems");
+
 	UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
 	auto objectCB = mCurrFrameResource->ObjectCB->Resource();
 	// For each render item...
@@ -1215,15 +1517,23 @@ void ShapesApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::v
 		cmdList->IASetIndexBuffer(&ri->Geo->IndexBufferView());
 		cmdList->IASetPrimitiveTopology(ri->PrimitiveType);
 
-		// Offset to the CBV in the descriptor heap for this object and for this frame resource.
+		if (ri->AnimatedIndex != -1)
+		{
+			// Animated items only need their slot in the transform buffer.
+			cmdList->SetGraphicsRoot32BitConstant(2, ri->AnimatedIndex, 0);
+		}
+		else
+		{
+			// Offset to the CBV in the descriptor heap for this object and for this frame resource.
 
-		UINT cbvIndex = mCurrFrameResourceIndex * (UINT)mOpaqueRitems.size() + ri->ObjCBIndex;
+			UINT cbvIndex = mCurrFrameResourceIndex * (UINT)mAllRitems.size() + ri->ObjCBIndex;
 
-		auto cbvHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(mCbvHeap->GetGPUDescriptorHandleForHeapStart());
+			auto cbvHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(mCbvHeap->GetGPUDescriptorHandleForHeapStart());
 
-		cbvHandle.Offset(cbvIndex, mCbvSrvUavDescriptorSize);
+			cbvHandle.Offset(cbvIndex, mCbvSrvUavDescriptorSize);
 
-		cmdList->SetGraphicsRootDescriptorTable(0, cbvHandle);
+			cmdList->SetGraphicsRootDescriptorTable(0, cbvHandle);
+		}
 		cmdList->DrawIndexedInstanced(ri->IndexCount, 1, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
 	}
 }
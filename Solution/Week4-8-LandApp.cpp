@@ -7,6 +7,7 @@
  *
  *   Controls:
  *   Hold down '1' key to view scene in wireframe mode.
+ *   Press 'N' to switch the land between the hills and fractal noise.
  *   Hold the left mouse button down and move the mouse to rotate.
  *   Hold the right mouse button down and move the mouse to zoom in and out.
  *
@@ -16,8 +17,8 @@
 #include "../../Common/d3dApp.h"
 #include "../../Common/MathHelper.h"
 #include "../../Common/UploadBuffer.h"
-#include "../../Common/GeometryGenerator.h"
 #include "FrameResource.h"
+#include "Terrain.h"
 
 #include <iostream>
 #include <string>
@@ -29,6 +30,10 @@ using namespace DirectX::PackedVector;
 //step3: Our application class will then instantiate a vector of three frame resources, 
 const int gNumFrameResources = 3;
 
+// Size of the land grid and its vertices along each side.
+const float gLandSize = 160.0f;
+const UINT gLandVertices = 50;
+
 // Step10: Lightweight structure stores parameters to draw a shape.  This will vary from app-to-app.
 struct RenderItem
 {
@@ -90,6 +95,7 @@ private:
 	void BuildRootSignature();
 	void BuildShadersAndInputLayout();
 	void BuildLandGeometry();
+	void RebuildLandGeometry();
 	void BuildPSOs();
 
 
@@ -97,8 +103,6 @@ private:
 
 	void BuildRenderItems();
 	void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems);
-	//step2
-	float GetHillsHeight(float x, float z)const;
 
 private:
 
@@ -142,6 +146,12 @@ private:
 
 	bool mIsWireframe = false;
 
+	// Build the land from fractal noise (GetLandNoise in Terrain.h) instead of the hills;
+	// 'N' switches and rebuilds the grid.  The pool samples the noise.
+	bool mNoiseTerrain = false;
+	bool mNoiseKeyDown = false;
+	ThreadPool mPool;
+
 	XMFLOAT3 mEyePos = { 0.0f, 0.0f, 0.0f };
 	XMFLOAT4X4 mView = MathHelper::Identity4x4();
 	XMFLOAT4X4 mProj = MathHelper::Identity4x4();
@@ -396,6 +406,15 @@ void LandApp::OnKeyboardInput(const GameTimer& gt)
 		mIsWireframe = true;
 	else
 		mIsWireframe = false;
+
+	// Switch the height source once per press, not every frame the key is held.
+	bool noiseKeyDown = (GetAsyncKeyState('N') & 0x8000) != 0;
+	if(noiseKeyDown && !mNoiseKeyDown)
+	{
+		mNoiseTerrain = !mNoiseTerrain;
+		RebuildLandGeometry();
+	}
+	mNoiseKeyDown = noiseKeyDown;
 }
 
 void LandApp::UpdateCamera(const GameTimer& gt)
@@ -596,107 +615,51 @@ void LandApp::BuildShadersAndInputLayout()
 //step1
 void LandApp::BuildLandGeometry()
 {
-	//GeometryGenerator is a utility class for generating simple geometric shapes like grids, grid, grids, and boxes
-	GeometryGenerator geoGen;
-	//The MeshData structure is a simple structure nested inside GeometryGenerator that stores a vertexand index list
-
-	//GeometryGenerator::CreateGrid(float width, float depth, uint32 m, uint32 n)
-	GeometryGenerator::MeshData grid = geoGen.CreateGrid(160.0f, 160.0f, 50, 50);
-
 	//number of cells 2x(m-1)(n-1)
 	//Vij = [-0.5w+jdx, 0, 0.5=i-dz]
 
 	//
-	// Extract the vertex elements we are interested and apply the height function to
+	// Generate the grid straight into our vertex format, applying the height function to
 	// each vertex.  In addition, color the vertices based on their height so we have
 	// sandy looking beaches, grassy low hills, and snow mountain peaks.
 	//
 
-	std::vector<Vertex> vertices(grid.Vertices.size());
-	for (size_t i = 0; i < grid.Vertices.size(); ++i)
+	std::vector<Vertex> vertices;
+	std::vector<std::uint16_t> indices;
+	ShapeWriter::Range grid;
+	if(mNoiseTerrain)
 	{
-		auto& p = grid.Vertices[i].Position;
-		vertices[i].Pos = p;
-		vertices[i].Pos.y = GetHillsHeight(p.x, p.z);
-
-		// Color the vertex based on its height.
-		if (vertices[i].Pos.y < -10.0f)
-		{
-			// Sandy beach color.
-			vertices[i].Color = XMFLOAT4(1.0f, 0.96f, 0.62f, 1.0f);
-		}
-		else if (vertices[i].Pos.y < 5.0f)
-		{
-			// Light yellow-green.
-			vertices[i].Color = XMFLOAT4(0.48f, 0.77f, 0.46f, 1.0f);
-		}
-		else if (vertices[i].Pos.y < 12.0f)
-		{
-			// Dark yellow-green.
-			vertices[i].Color = XMFLOAT4(0.1f, 0.48f, 0.19f, 1.0f);
-		}
-		else if (vertices[i].Pos.y < 20.0f)
-		{
-			// Dark brown.
-			vertices[i].Color = XMFLOAT4(0.45f, 0.39f, 0.34f, 1.0f);
-		}
-		else
-		{
-			// White snow.
-			vertices[i].Color = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
-		}
+		// Sample the whole grid up front, a row per task, then look the heights up.
+		std::vector<float> heights = GetGridHeights(GetLandNoise(), gLandSize, gLandSize, gLandVertices, gLandVertices, mPool);
+		grid = ShapeWriter::AppendGrid(vertices, indices, HeightMapVertexWriter{ heights.data(), gLandVertices, gLandVertices },
+			gLandSize, gLandSize, gLandVertices, gLandVertices);
+	}
+	else
+	{
+		grid = ShapeWriter::AppendGrid(vertices, indices, HillsVertexWriter(), gLandSize, gLandSize, gLandVertices, gLandVertices);
 	}
-
-
 
 	//
 	// We are concatenating all the geometry into one big vertex/index buffer.  So
 	// define the regions in the buffer each submesh covers.
 	//
 
-	// Cache the vertex offsets to each object in the concatenated vertex buffer.
-	UINT gridVertexOffset = 0;
-
-
-	// Cache the starting index for each object in the concatenated index buffer.
-	UINT gridIndexOffset = 0;
-
-
 	// Define the SubmeshGeometry that cover different 
 	// regions of the vertex/index buffers.
 
 	SubmeshGeometry gridSubmesh;
-	gridSubmesh.IndexCount = (UINT)grid.Indices32.size();
-	gridSubmesh.StartIndexLocation = gridIndexOffset;
-	gridSubmesh.BaseVertexLocation = gridVertexOffset;
-
-
-	//
-	// Extract the vertex elements we are interested in and pack the
-	// vertices of all the meshes into one vertex buffer.
-	//
-
-	//auto totalVertexCount = grid.Vertices.size();
-
-
-	//std::vector<Vertex> vertices(totalVertexCount);
-
-	//UINT k = 0;
-	//for (size_t i = 0; i < grid.Vertices.size(); ++i, ++k)
-	//{
-	//	vertices[k].Pos = grid.Vertices[i].Position;
-	//	vertices[k].Color = XMFLOAT4(DirectX::Colors::DarkOrange);
-	//}
-
-
-	std::vector<std::uint16_t> indices;
-	indices.insert(indices.end(), std::begin(grid.GetIndices16()), std::end(grid.GetIndices16()));
+	gridSubmesh.IndexCount = grid.IndexCount;
+	gridSubmesh.StartIndexLocation = grid.StartIndex;
+	gridSubmesh.BaseVertexLocation = grid.BaseVertex;
 
 
 	const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
 	const UINT ibByteSize = (UINT)indices.size() * sizeof(std::uint16_t);
 
-	auto geo = std::make_unique<MeshGeometry>();
+	// Rebuilt in place, so the render items keep pointing at it.
+	std::unique_ptr<MeshGeometry>& geo = mGeometries["landGeo"];
+	if(geo == nullptr)
+		geo = std::make_unique<MeshGeometry>();
 	geo->Name = "landGeo";
 
 	ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
@@ -717,9 +680,24 @@ void LandApp::BuildLandGeometry()
 	geo->IndexBufferByteSize = ibByteSize;
 
 	geo->DrawArgs["grid"] = gridSubmesh;
+}
+
+// Builds the land again outside Initialize: the GPU has to be done with the old buffers
+// before they are replaced, and with the upload before the next frame draws the grid.
+void LandApp::RebuildLandGeometry()
+{
+	FlushCommandQueue();
+
+	ThrowIfFailed(mDirectCmdListAlloc->Reset());
+	ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), nullptr));
 
+	BuildLandGeometry();
+
+	ThrowIfFailed(mCommandList->Close());
+	ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
+	mCommandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
 
-	mGeometries[geo->Name] = std::move(geo);
+	FlushCommandQueue();
 }
 
 void LandApp::BuildPSOs()
@@ -824,12 +802,3 @@ void LandApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vec
 		cmdList->DrawIndexedInstanced(ri->IndexCount, 1, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
 	}
 }
-
-float LandApp::GetHillsHeight(float x, float z)const
-{
-	//https://www.geogebra.org/3d?lang=en
-	//f(x,z)=0.3 (z sin(0.1 x)+x cos(0.1 z))
-	return 0.3f * (z * sinf(0.1f * x) + x * cosf(0.1f * z));
-}
-
-